@@ -0,0 +1,94 @@
+// BENCH_HPP - Khung đo hiệu năng (microbenchmark) xuất kết quả dạng JSON lines
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+// Thư viện chuẩn C++
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Chặn compiler loại bỏ phép tính có kết quả không được dùng
+template <typename T> inline void doNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Cách tính thông lượng của một benchmark
+struct BenchOptions {
+  uint64_t items_per_iter = 1; // Số thao tác trong một lần gọi (ns/op chia cho)
+  uint64_t bytes_per_iter = 0; // Số byte xử lý mỗi lần gọi (0 = không báo MB/s)
+};
+
+/**
+ * @brief Bộ chạy benchmark.
+ *
+ * Mỗi benchmark là một hàm nhận số lần lặp; số lần lặp được nhân đôi cho tới
+ * khi một lượt chạy dài hơn min_time_ms, kết quả của lượt cuối được in thành
+ * một dòng JSON trên stdout:
+ *
+ *   {"bench":"protocol.serialize","params":{"message":"MoveMessage"},
+ *    "iterations":1048576,"ns_per_op":41.2,"ops_per_sec":24271844.7}
+ *
+ * Thao tác đắt (vài giây) chỉ chạy một lần. Dòng JSON có thể so sánh giữa các
+ * commit bằng khóa (bench, params).
+ */
+class Bench {
+public:
+  Bench(const std::string &filter, uint32_t min_time_ms)
+      : filter(filter), min_time_ms(min_time_ms) {}
+
+  // Benchmark có bị lọc bỏ bởi --filter không
+  bool enabled(const std::string &name) const {
+    return filter.empty() || name.find(filter) != std::string::npos;
+  }
+
+  /**
+   * @param name Tên benchmark (nhóm.tên).
+   * @param params Các tham số dạng JSON object, ví dụ {"users":10000}.
+   * @param fn Hàm void(uint64_t iterations) thực hiện iterations lần thao tác.
+   */
+  template <typename Fn>
+  void run(const std::string &name, const std::string &params, Fn &&fn,
+           BenchOptions options = BenchOptions()) {
+    if (!enabled(name))
+      return;
+
+    uint64_t iterations = 1;
+    double elapsed_ns = 0;
+    while (true) {
+      auto start = std::chrono::steady_clock::now();
+      fn(iterations);
+      elapsed_ns = std::chrono::duration<double, std::nano>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+      if (elapsed_ns >= min_time_ms * 1e6 || iterations >= (1ull << 40))
+        break;
+
+      // Tăng số lần lặp theo tỉ lệ thời gian còn thiếu (tối đa x10 mỗi bước)
+      double scale = elapsed_ns > 0 ? (min_time_ms * 1.2e6) / elapsed_ns : 10;
+      scale = scale < 2 ? 2 : (scale > 10 ? 10 : scale);
+      iterations = static_cast<uint64_t>(iterations * scale);
+    }
+
+    double ops = static_cast<double>(iterations * options.items_per_iter);
+    std::printf("{\"bench\":\"%s\",\"params\":%s,\"iterations\":%llu,"
+                "\"ns_per_op\":%.2f,\"ops_per_sec\":%.6g",
+                name.c_str(), params.c_str(),
+                static_cast<unsigned long long>(iterations), elapsed_ns / ops,
+                ops / (elapsed_ns / 1e9));
+    if (options.bytes_per_iter > 0) {
+      double bytes = static_cast<double>(iterations * options.bytes_per_iter);
+      std::printf(",\"mb_per_sec\":%.1f", bytes / (elapsed_ns / 1e3));
+    }
+    std::printf("}\n");
+    std::fflush(stdout);
+  }
+
+private:
+  std::string filter;
+  uint32_t min_time_ms;
+};
+
+#endif // BENCH_HPP
@@ -0,0 +1,940 @@
+// Microbenchmark cho các đường nóng của server: giao thức (message.hpp), tách
+// gói tin (NetworkServer), lưu trữ (DataStorage), luật cờ (GameStatus, tra cứu quân trượt, perft),
+// máy chơi cờ (Engine và bộ lập lịch tìm kiếm), ghép cặp (GameManager) và sảnh chờ (Lobby). Mỗi kết quả là một dòng JSON
+// trên stdout.
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench.hpp"
+
+#include "../chess_engine/chess.hpp"
+#include "../common/message.hpp"
+#include "../server/data_storage.hpp"
+#include "../server/engine.hpp"
+#include "../server/game_log_stream.hpp"
+#include "../server/game_manager.hpp"
+#include "../server/game_status.hpp"
+#include "../server/lobby.hpp"
+#include "../server/network_server.hpp"
+#include "../server/opening_explorer.hpp"
+#include "../server/server_config.hpp"
+
+struct BenchConfig
+{
+    std::string filter;           // Chỉ chạy benchmark có tên chứa chuỗi này
+    uint32_t min_time_ms = 200;   // Thời gian tối thiểu của một lượt đo
+    size_t max_size = 1000000;    // Kích thước dữ liệu lớn nhất cho storage
+};
+
+void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --filter=SUBSTR      Chỉ chạy benchmark có tên chứa SUBSTR\n"
+              << "  --min-time-ms=N      Thời gian tối thiểu mỗi lượt đo (mặc định 200)\n"
+              << "  --max-size=N         Số user/trận lớn nhất cho storage (mặc định 1000000)"
+              << std::endl;
+}
+
+bool parseArgs(int argc, char *argv[], BenchConfig &config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (eq == std::string::npos)
+            return false;
+        std::string key = arg.substr(0, eq);
+        std::string value = arg.substr(eq + 1);
+
+        if (key == "--filter")
+            config.filter = value;
+        else if (key == "--min-time-ms")
+            config.min_time_ms = static_cast<uint32_t>(std::stoul(value));
+        else if (key == "--max-size")
+            config.max_size = std::stoul(value);
+        else
+            return false;
+    }
+    return true;
+}
+
+std::string quoted(const std::string &value)
+{
+    return "\"" + value + "\"";
+}
+
+// Một ván cờ ngẫu nhiên (toàn nước hợp lệ) dùng làm dữ liệu đầu vào
+std::vector<std::string> randomGame(uint32_t seed, size_t max_plies)
+{
+    std::mt19937 rng(seed);
+    chess::Board board;
+    std::vector<std::string> moves;
+
+    while (moves.size() < max_plies)
+    {
+        chess::Movelist legal;
+        chess::movegen::legalmoves(legal, board);
+        if (legal.empty())
+            break;
+
+        std::uniform_int_distribution<int> pick(0, legal.size() - 1);
+        chess::Move move = legal[pick(rng)];
+        moves.push_back(chess::uci::moveToUci(move));
+        board.makeMove(move);
+    }
+    return moves;
+}
+
+#pragma region Protocol
+
+template <typename Message>
+void benchMessage(Bench &bench, const std::string &name, const Message &message)
+{
+    std::string params = "{\"message\":" + quoted(name) + "}";
+    std::vector<uint8_t> payload = message.serialize();
+
+    bench.run("protocol.serialize", params, [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            std::vector<uint8_t> bytes = message.serialize();
+            doNotOptimize(bytes);
+        }
+    }, BenchOptions{1, payload.size()});
+
+    bench.run("protocol.deserialize", params, [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            Message decoded = Message::deserialize(payload);
+            doNotOptimize(decoded);
+        }
+    }, BenchOptions{1, payload.size()});
+}
+
+void benchProtocol(Bench &bench)
+{
+    const std::string game_id = "3f2b8c1e-9d4a-4e7b-a1c5-6d8e0f2a4b7c";
+    const std::string fen = "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4";
+    std::vector<std::string> game_moves = randomGame(1, 80);
+
+    RegisterMessage reg;
+    reg.username = "alice";
+    benchMessage(bench, "RegisterMessage", reg);
+
+    RegisterSuccessMessage reg_ok;
+    reg_ok.username = "alice";
+    reg_ok.elo = 1200;
+    benchMessage(bench, "RegisterSuccessMessage", reg_ok);
+
+    RegisterFailureMessage reg_fail;
+    reg_fail.error_message = "Username already exists.";
+    benchMessage(bench, "RegisterFailureMessage", reg_fail);
+
+    LoginMessage login;
+    login.username = "alice";
+    benchMessage(bench, "LoginMessage", login);
+
+    LoginSuccessMessage login_ok;
+    login_ok.username = "alice";
+    login_ok.elo = 1200;
+    benchMessage(bench, "LoginSuccessMessage", login_ok);
+
+    LoginFailureMessage login_fail;
+    login_fail.error_message = "Invalid username.";
+    benchMessage(bench, "LoginFailureMessage", login_fail);
+
+    GameStartMessage start;
+    start.game_id = game_id;
+    start.player1_username = "alice";
+    start.player2_username = "bob";
+    start.starting_player_username = "alice";
+    start.fen = chess::constants::STARTPOS;
+    benchMessage(bench, "GameStartMessage", start);
+
+    MoveMessage move;
+    move.game_id = game_id;
+    move.uci_move = "e2e4";
+    benchMessage(bench, "MoveMessage", move);
+
+    InvalidMoveMessage invalid;
+    invalid.game_id = game_id;
+    invalid.error_message = "Invalid move.";
+    benchMessage(bench, "InvalidMoveMessage", invalid);
+
+    GameStatusUpdateMessage update;
+    update.game_id = game_id;
+    update.fen = fen;
+    update.current_turn_username = "alice";
+    update.is_game_over = 0;
+    update.message = "Move accepted.";
+    update.white_time_ms = 287000;
+    update.black_time_ms = 291500;
+    benchMessage(bench, "GameStatusUpdateMessage", update);
+
+    GameEndMessage end;
+    end.game_id = game_id;
+    end.winner_username = "alice";
+    end.reason = "checkmate";
+    end.half_moves_count = 57;
+    benchMessage(bench, "GameEndMessage", end);
+
+    AutoMatchRequestMessage auto_request;
+    auto_request.username = "alice";
+    benchMessage(bench, "AutoMatchRequestMessage", auto_request);
+
+    AutoMatchFoundMessage auto_found;
+    auto_found.opponent_username = "bob";
+    auto_found.opponent_elo = 1250;
+    auto_found.game_id = game_id;
+    benchMessage(bench, "AutoMatchFoundMessage", auto_found);
+
+    AutoMatchAcceptedMessage auto_accepted;
+    auto_accepted.game_id = game_id;
+    benchMessage(bench, "AutoMatchAcceptedMessage", auto_accepted);
+
+    AutoMatchDeclinedMessage auto_declined;
+    auto_declined.game_id = game_id;
+    benchMessage(bench, "AutoMatchDeclinedMessage", auto_declined);
+
+    MatchDeclinedNotificationMessage declined_notification;
+    declined_notification.game_id = game_id;
+    benchMessage(bench, "MatchDeclinedNotificationMessage", declined_notification);
+
+    benchMessage(bench, "RequestPlayerListMessage", RequestPlayerListMessage());
+
+    PlayerListMessage player_list;
+    for (int i = 0; i < 50; i++)
+    {
+        PlayerListMessage::Player player;
+        player.username = "player" + std::to_string(i);
+        player.elo = static_cast<uint16_t>(1000 + i * 10);
+        player.in_game = (i % 3 == 0);
+        player.game_id = player.in_game ? game_id : "";
+        player_list.players.push_back(player);
+    }
+    benchMessage(bench, "PlayerListMessage", player_list);
+
+    ChallengeRequestMessage challenge;
+    challenge.to_username = "bob";
+    benchMessage(bench, "ChallengeRequestMessage", challenge);
+
+    ChallengeNotificationMessage challenge_notification;
+    challenge_notification.from_username = "alice";
+    challenge_notification.elo = 1200;
+    benchMessage(bench, "ChallengeNotificationMessage", challenge_notification);
+
+    ChallengeResponseMessage challenge_response;
+    challenge_response.response = ChallengeResponseMessage::Response::ACCEPTED;
+    challenge_response.from_username = "alice";
+    benchMessage(bench, "ChallengeResponseMessage", challenge_response);
+
+    ChallengeAcceptedMessage challenge_accepted;
+    challenge_accepted.from_username = "bob";
+    challenge_accepted.game_id = game_id;
+    benchMessage(bench, "ChallengeAcceptedMessage", challenge_accepted);
+
+    ChallengeDeclinedMessage challenge_declined;
+    challenge_declined.from_username = "bob";
+    benchMessage(bench, "ChallengeDeclinedMessage", challenge_declined);
+
+    SurrenderMessage surrender;
+    surrender.game_id = game_id;
+    surrender.from_username = "alice";
+    benchMessage(bench, "SurrenderMessage", surrender);
+
+    ChallengeErrorMessage challenge_error;
+    challenge_error.error_message = "Player is busy.";
+    benchMessage(bench, "ChallengeErrorMessage", challenge_error);
+
+    GameLogMessage log;
+    log.game_id = game_id;
+    log.flags = GameLogMessage::FLAG_HEADER | GameLogMessage::FLAG_LAST;
+    log.start_time = 1700000000;
+    log.end_time = 1700001800;
+    log.white = "alice";
+    log.black = "bob";
+    log.white_ip = "192.168.1.10";
+    log.black_ip = "192.168.1.11";
+    log.winner = "alice";
+    log.reason = "checkmate";
+    log.total_moves = static_cast<uint32_t>(game_moves.size());
+    log.moves = game_moves;
+    benchMessage(bench, "GameLogMessage", log);
+
+    WatchGameMessage watch;
+    watch.game_id = game_id;
+    benchMessage(bench, "WatchGameMessage", watch);
+
+    UnwatchGameMessage unwatch;
+    unwatch.game_id = game_id;
+    benchMessage(bench, "UnwatchGameMessage", unwatch);
+
+    GameKeyframeMessage keyframe;
+    keyframe.game_id = game_id;
+    keyframe.white_username = "alice";
+    keyframe.black_username = "bob";
+    keyframe.packed_board = chess::Board::Compact::encode(chess::Board(fen));
+    keyframe.moves = game_moves;
+    benchMessage(bench, "GameKeyframeMessage", keyframe);
+
+    WatchErrorMessage watch_error;
+    watch_error.error_message = "Game not found.";
+    benchMessage(bench, "WatchErrorMessage", watch_error);
+
+    benchMessage(bench, "PingMessage", PingMessage());
+    benchMessage(bench, "PongMessage", PongMessage());
+}
+
+#pragma endregion Protocol
+
+#pragma region Framing
+
+// Dòng byte giống lưu lượng một ván cờ: MOVE/STATUS_UPDATE xen kẽ PING/PONG
+std::vector<uint8_t> syntheticStream(size_t packets)
+{
+    const std::string game_id = "3f2b8c1e-9d4a-4e7b-a1c5-6d8e0f2a4b7c";
+    std::vector<uint8_t> stream;
+
+    for (size_t i = 0; i < packets; i++)
+    {
+        SharedPacket frame;
+        switch (i % 4)
+        {
+        case 0:
+        {
+            MoveMessage move;
+            move.game_id = game_id;
+            move.uci_move = "e2e4";
+            frame = NetworkServer::encodePacket(move.getType(), move.serialize());
+            break;
+        }
+        case 1:
+        {
+            GameStatusUpdateMessage update;
+            update.game_id = game_id;
+            update.fen = chess::constants::STARTPOS;
+            update.current_turn_username = "alice";
+            update.is_game_over = 0;
+            update.message = "Move accepted.";
+            frame = NetworkServer::encodePacket(update.getType(), update.serialize());
+            break;
+        }
+        case 2:
+            frame = NetworkServer::encodePacket(MessageType::PING, {});
+            break;
+        default:
+            frame = NetworkServer::encodePacket(MessageType::PONG, {});
+            break;
+        }
+        stream.insert(stream.end(), frame->begin(), frame->end());
+    }
+    return stream;
+}
+
+void benchFraming(Bench &bench)
+{
+    const size_t packets = 1024;
+    std::vector<uint8_t> stream = syntheticStream(packets);
+
+    // Cắt dòng byte thành các đoạn như recv() trả về
+    for (size_t chunk : {size_t(64), size_t(1448), size_t(Const::BUFFER_SIZE * 16)})
+    {
+        bench.run("framing.extract", "{\"chunk_bytes\":" + std::to_string(chunk) + "}",
+                  [&](uint64_t iterations) {
+                      std::vector<uint8_t> buffer;
+                      Packet packet;
+                      for (uint64_t i = 0; i < iterations; i++)
+                      {
+                          for (size_t offset = 0; offset < stream.size(); offset += chunk)
+                          {
+                              size_t n = std::min(chunk, stream.size() - offset);
+                              buffer.insert(buffer.end(), stream.begin() + offset,
+                                            stream.begin() + offset + n);
+                              while (NetworkServer::extractPacket(buffer, packet))
+                                  doNotOptimize(packet);
+                          }
+                      }
+                  },
+                  BenchOptions{packets, stream.size()});
+    }
+}
+
+#pragma endregion Framing
+
+#pragma region Game
+
+void benchGame(Bench &bench)
+{
+    std::vector<std::string> moves = randomGame(7, 200);
+
+    bench.run("game.makeMove", "{\"plies\":" + std::to_string(moves.size()) + "}",
+              [&](uint64_t iterations) {
+                  for (uint64_t i = 0; i < iterations; i++)
+                  {
+                      GameStatus game("bench", "alice", "bob", chess::constants::STARTPOS);
+                      for (const std::string &move : moves)
+                          doNotOptimize(game.makeMove(move));
+                  }
+              },
+              BenchOptions{moves.size(), 0});
+}
+
+// Đếm số nút perft (không dùng bulk counting ở lá, để đo cả makeMove)
+uint64_t perft(chess::Board &board, int depth)
+{
+    if (depth == 0)
+        return 1;
+    chess::Movelist moves;
+    chess::movegen::legalmoves(moves, board);
+    uint64_t nodes = 0;
+    for (const chess::Move &move : moves)
+    {
+        board.makeMove(move);
+        nodes += perft(board, depth - 1);
+        board.unmakeMove(move);
+    }
+    return nodes;
+}
+
+// So sánh tra cứu quân trượt bằng magic và PEXT (nếu CPU hỗ trợ BMI2)
+void benchSliders(Bench &bench)
+{
+    using chess::attacks;
+
+    // Ô và bàn cờ ngẫu nhiên (mật độ quân như giữa ván)
+    std::mt19937_64 rng(11);
+    std::vector<std::pair<chess::Square, chess::Bitboard>> samples(4096);
+    for (auto &sample : samples)
+    {
+        sample.first = chess::Square(static_cast<int>(rng() % 64));
+        sample.second = chess::Bitboard(rng() & rng());
+    }
+
+    std::vector<attacks::SliderImpl> impls = {attacks::SliderImpl::MAGIC};
+    if (attacks::pextSupported())
+        impls.push_back(attacks::SliderImpl::PEXT);
+
+    attacks::SliderImpl initial = attacks::sliderImpl();
+    for (attacks::SliderImpl impl : impls)
+    {
+        attacks::selectSliders(impl);
+        std::string params = std::string("{\"impl\":") +
+                             (impl == attacks::SliderImpl::PEXT ? "\"pext\"" : "\"magic\"");
+
+        bench.run("chess.sliders", params + "}", [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                const auto &sample = samples[i % samples.size()];
+                doNotOptimize(attacks::queen(sample.first, sample.second));
+            }
+        });
+
+        // Kiwipete: nhiều quân trượt, đủ loại nước đặc biệt
+        chess::Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+        uint64_t nodes = perft(board, 3);
+        bench.run("chess.perft", params + ",\"position\":\"kiwipete\",\"depth\":3}",
+                  [&](uint64_t iterations) {
+                      for (uint64_t i = 0; i < iterations; i++)
+                          doNotOptimize(perft(board, 3));
+                  },
+                  BenchOptions{nodes, 0});
+    }
+    attacks::selectSliders(initial);
+}
+
+// Máy chơi cờ: một lần tìm tới độ sâu cố định (bảng chuyển vị mới mỗi lần),
+// đơn luồng và Lazy SMP với mọi lõi
+void benchEngine(Bench &bench)
+{
+    chess::Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    SearchLimits limits;
+    limits.time_ms = 60000;
+    limits.max_depth = 5;
+
+    std::vector<unsigned> thread_counts = {1};
+    if (std::thread::hardware_concurrency() > 1)
+        thread_counts.push_back(std::thread::hardware_concurrency());
+
+    for (unsigned threads : thread_counts)
+    {
+        bench.run("engine.search",
+                  "{\"position\":\"kiwipete\",\"depth\":5,\"threads\":" + std::to_string(threads) + "}",
+                  [&](uint64_t iterations) {
+                      for (uint64_t i = 0; i < iterations; i++)
+                      {
+                          Engine engine;
+                          engine.configure(threads, 4);
+                          doNotOptimize(engine.search(board, limits).move);
+                      }
+                  });
+    }
+}
+
+// Bộ lập lịch của máy: nhiều ván cùng gửi yêu cầu tìm (đồng hồ khác nhau) lên
+// một nhóm luồng dùng chung, đo thời gian tới khi mọi ván có nước đi
+void benchEngineScheduler(Bench &bench)
+{
+    const std::vector<std::string> fens = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    };
+    const int games = 16;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    bench.run("engine.scheduler",
+              "{\"games\":" + std::to_string(games) + ",\"depth\":4,\"threads\":" +
+                  std::to_string(threads) + "}",
+              [&](uint64_t iterations) {
+                  for (uint64_t i = 0; i < iterations; i++)
+                  {
+                      Engine engine;
+                      engine.configure(threads, 4);
+                      std::mutex mutex;
+                      std::condition_variable cv;
+                      int done = 0;
+                      for (int game = 0; game < games; game++)
+                      {
+                          SearchLimits limits;
+                          limits.time_ms = 60000;
+                          limits.max_depth = 4;
+                          limits.clock_ms = 1000 * (games - game);
+                          engine.submit(chess::Board(fens[game % fens.size()]), limits,
+                                        [&](const SearchResult &result) {
+                                            doNotOptimize(result.move);
+                                            std::lock_guard<std::mutex> lock(mutex);
+                                            done++;
+                                            cv.notify_one();
+                                        });
+                      }
+                      std::unique_lock<std::mutex> lock(mutex);
+                      cv.wait(lock, [&] { return done == games; });
+                  }
+              });
+}
+
+#pragma endregion Game
+
+#pragma region Matchmaking
+
+void benchMatchmaking(Bench &bench)
+{
+    // Trường hợp xấu nhất: đối thủ phù hợp duy nhất nằm cuối queue, các ứng
+    // viên khác chênh nhau hơn 10 bậc
+    for (size_t queue_size : {size_t(10), size_t(100), size_t(1000), size_t(10000)})
+    {
+        std::queue<int> queue;
+        std::vector<int> ranks(queue_size);
+        for (size_t i = 0; i < queue_size; i++)
+        {
+            queue.push(static_cast<int>(i));
+            ranks[i] = static_cast<int>(i) * 100;
+        }
+        int rank1 = ranks.back();
+
+        bench.run("matchmaking.takeOpponent",
+                  "{\"queue\":" + std::to_string(queue_size) + "}",
+                  [&](uint64_t iterations) {
+                      for (uint64_t i = 0; i < iterations; i++)
+                      {
+                          std::queue<int> pass = queue;
+                          int matched = GameManager::takeOpponent(
+                              pass, rank1, [](int) { return true; },
+                              [&](int fd) { return ranks[fd]; });
+                          doNotOptimize(matched);
+                      }
+                  });
+    }
+}
+
+#pragma endregion Matchmaking
+
+#pragma region Lobby
+
+void benchLobby(Bench &bench)
+{
+    Lobby &lobby = Lobby::getInstance();
+    size_t online = 0;
+    for (size_t players : {size_t(100), size_t(1000), size_t(10000)})
+    {
+        for (; online < players; online++)
+        {
+            char name[24]; // "p" + tối đa 20 chữ số của size_t + '\0'
+            std::snprintf(name, sizeof(name), "p%06zu", online);
+            lobby.playerOnline(name, static_cast<uint16_t>(1000 + online % 1000));
+        }
+
+        std::string params = "{\"online\":" + std::to_string(players);
+        bench.run("lobby.page", params + ",\"cached\":true}", [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++)
+                doNotOptimize(lobby.page(0, 0));
+        });
+
+        // Mỗi lần lấy trang sau một thay đổi (cache bị xóa)
+        bench.run("lobby.page", params + ",\"cached\":false}", [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                lobby.setElo("p000000", static_cast<uint16_t>(1000 + i % 2));
+                doNotOptimize(lobby.page(0, 0));
+            }
+        });
+    }
+}
+
+#pragma endregion Lobby
+
+#pragma region Storage
+
+// Ghi users.json/matches.json tổng hợp vào thư mục tạm
+void writeDataset(const std::string &dir, size_t users, size_t matches)
+{
+    FILE *file = std::fopen((dir + "/users.json").c_str(), "w");
+    std::fputc('{', file);
+    for (size_t i = 0; i < users; i++)
+        std::fprintf(file, "%s\"user%zu\":{\"elo\":%zu}", i ? "," : "", i, 800 + (i * 7919) % 1600);
+    std::fputs("}\n", file);
+    std::fclose(file);
+
+    file = std::fopen((dir + "/matches.json").c_str(), "w");
+    std::fputc('{', file);
+    for (size_t i = 0; i < matches; i++)
+        std::fprintf(file,
+                     "%s\"game%zu\":{\"white_username\":\"user%zu\",\"black_username\":\"user%zu\","
+                     "\"white_ip\":\"127.0.0.1\",\"black_ip\":\"127.0.0.1\",\"start_fen\":\"%s\","
+                     "\"start_time\":1700000000000000000,\"end_time\":0,\"moves\":[],"
+                     "\"result\":\"\",\"reason\":\"\"}",
+                     i ? "," : "", i, i % (users ? users : 1), (i + 1) % (users ? users : 1),
+                     chess::constants::STARTPOS);
+    std::fputs("}\n", file);
+    std::fclose(file);
+}
+
+// DataStorage là singleton đọc dữ liệu một lần khi khởi tạo: mỗi kích thước
+// chạy trong một process con với thư mục dữ liệu riêng
+template <typename Fn>
+void runIsolated(const std::string &label, size_t users, size_t matches, Fn &&fn)
+{
+    char dir_template[] = "/tmp/chess_bench_XXXXXX";
+    char *dir = mkdtemp(dir_template);
+    if (dir == nullptr)
+    {
+        perror("mkdtemp failed");
+        return;
+    }
+
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        writeDataset(dir, users, matches);
+        ServerConfig::getInstance().data_dir = dir;
+        fn(DataStorage::getInstance());
+        std::fflush(stdout);
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        std::cerr << label << ": process con kết thúc bất thường" << std::endl;
+
+    unlink((std::string(dir) + "/users.json").c_str());
+    unlink((std::string(dir) + "/matches.json").c_str());
+    unlink((std::string(dir) + "/matches.arc").c_str());
+    rmdir(dir);
+}
+
+// Mã hóa/giải mã một ván trong matches.arc (giải mã = đi lại cả ván)
+void benchArchive(Bench &bench)
+{
+    MatchModel match;
+    match.game_id = "game0";
+    match.white_username = "white";
+    match.black_username = "black";
+    match.start_fen = chess::constants::STARTPOS;
+    match.result = "white";
+    match.start_time = std::chrono::system_clock::now();
+    auto move_time = match.start_time;
+    chess::Board board;
+    for (const std::string &uci : randomGame(1, 80))
+    {
+        board.makeMove(chess::uci::uciToMove(board, uci));
+        move_time += std::chrono::milliseconds(2500);
+        match.moves.push_back({uci, board.getFen(), move_time});
+    }
+
+    std::string payload;
+    GameArchive::encode(match, payload);
+    std::string params = "{\"plies\":" + std::to_string(match.moves.size()) +
+                         ",\"bytes\":" + std::to_string(payload.size()) +
+                         ",\"json_bytes\":" + std::to_string(match.serialize().dump().size()) + "}";
+    bench.run("archive.encode", params, [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            std::string out;
+            GameArchive::encode(match, out);
+            doNotOptimize(out.size());
+        }
+    });
+    bench.run("archive.decode", params, [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            MatchModel decoded;
+            doNotOptimize(GameArchive::decode(payload, decoded));
+        }
+    });
+}
+
+// Gửi nhật ký một ván rất dài theo chunk (client xác nhận ngay từng chunk)
+void benchGameLogStream(Bench &bench)
+{
+    MatchModel match;
+    match.game_id = "game0";
+    match.white_username = "white";
+    match.black_username = "black";
+    match.result = "<0>";
+    const char *shuffle[] = {"g1f3", "g8f6", "f3g1", "f6g8"};
+    for (size_t i = 0; i < 20000; i++)
+        match.moves.push_back({shuffle[i % 4], "", match.start_time});
+
+    // Trả về số chunk đã gửi
+    auto stream_all = [&]() {
+        GameLogStream stream;
+        stream.start(match, Const::GAME_LOG_WINDOW);
+        GameLogMessage chunk;
+        size_t chunks = 0;
+        while (stream.next(chunk))
+        {
+            doNotOptimize(chunk.serialize().size());
+            stream.ack(chunk.game_id, chunk.seq);
+            chunks++;
+        }
+        return chunks;
+    };
+
+    std::string params = "{\"plies\":" + std::to_string(match.moves.size()) +
+                         ",\"chunks\":" + std::to_string(stream_all()) + "}";
+    bench.run("gamelog.stream", params, [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++)
+            doNotOptimize(stream_all());
+    });
+}
+
+void benchStorage(Bench &bench, size_t max_size)
+{
+    for (size_t size = 10000; size <= max_size; size *= 10)
+    {
+        std::string size_str = std::to_string(size);
+
+        if (bench.enabled("storage.getUserRank"))
+        {
+            runIsolated("storage.getUserRank", size, 0, [&](DataStorage &storage) {
+                std::mt19937 rng(size);
+                std::uniform_int_distribution<size_t> pick(0, size - 1);
+                bench.run("storage.getUserRank", "{\"users\":" + size_str + "}",
+                          [&](uint64_t iterations) {
+                              for (uint64_t i = 0; i < iterations; i++)
+                                  doNotOptimize(storage.getUserRank("user" + std::to_string(pick(rng))));
+                          });
+            });
+        }
+
+        if (bench.enabled("storage.leaderboard"))
+        {
+            runIsolated("storage.leaderboard", size, 0, [&](DataStorage &storage) {
+                std::mt19937 rng(size);
+                std::uniform_int_distribution<size_t> pick(0, size - 1);
+                uint32_t total = 0;
+                bench.run("storage.leaderboard", "{\"users\":" + size_str + ",\"mode\":\"top\"}",
+                          [&](uint64_t iterations) {
+                              for (uint64_t i = 0; i < iterations; i++)
+                                  doNotOptimize(storage.getLeaderboardTop(Const::LEADERBOARD_MAX_SIZE, total));
+                          });
+                bench.run("storage.leaderboard", "{\"users\":" + size_str + ",\"mode\":\"around\"}",
+                          [&](uint64_t iterations) {
+                              for (uint64_t i = 0; i < iterations; i++)
+                                  doNotOptimize(storage.getLeaderboardAround(
+                                      "user" + std::to_string(pick(rng)), Const::LEADERBOARD_MAX_SIZE, total));
+                          });
+            });
+        }
+
+        if (bench.enabled("storage.matchHistory"))
+        {
+            // 100 người chơi, mỗi người size / 50 ván: trang đầu và một trang
+            // bắt đầu giữa danh sách (theo con trỏ)
+            runIsolated("storage.matchHistory", 100, size, [&](DataStorage &storage) {
+                uint32_t total = 0;
+                bool has_more = false;
+                std::vector<MatchHistoryIndex::Entry> first = storage.getMatchHistory(
+                    "user0", nullptr, Const::MATCH_HISTORY_MAX_SIZE, total, has_more);
+                bench.run("storage.matchHistory", "{\"matches\":" + size_str + ",\"page\":\"first\"}",
+                          [&](uint64_t iterations) {
+                              for (uint64_t i = 0; i < iterations; i++)
+                                  doNotOptimize(storage.getMatchHistory(
+                                      "user0", nullptr, Const::MATCH_HISTORY_PAGE_SIZE, total, has_more));
+                          });
+                MatchHistoryIndex::Key middle = first.back().key;
+                bench.run("storage.matchHistory", "{\"matches\":" + size_str + ",\"page\":\"cursor\"}",
+                          [&](uint64_t iterations) {
+                              for (uint64_t i = 0; i < iterations; i++)
+                                  doNotOptimize(storage.getMatchHistory(
+                                      "user0", &middle, Const::MATCH_HISTORY_PAGE_SIZE, total, has_more));
+                          });
+            });
+        }
+
+        if (bench.enabled("storage.addMove"))
+        {
+            // Mỗi lần addMove ghi lại toàn bộ matches.json
+            runIsolated("storage.addMove", 2, size, [&](DataStorage &storage) {
+                bench.run("storage.addMove", "{\"matches\":" + size_str + "}",
+                          [&](uint64_t iterations) {
+                              for (uint64_t i = 0; i < iterations; i++)
+                                  storage.addMove("game0", "e2e4", chess::constants::STARTPOS);
+                          });
+            });
+        }
+    }
+}
+
+#pragma endregion Storage
+
+#pragma region Explorer
+
+// Chỉ mục khai cuộc trên các ván ngẫu nhiên: dựng lại toàn bộ, thêm từng ván
+// (gồm cả lúc bảng phải nới rộng) và tra cứu một thế cờ
+void benchExplorer(Bench &bench)
+{
+    if (!bench.enabled("explorer.rebuild") && !bench.enabled("explorer.addGame") &&
+        !bench.enabled("explorer.query"))
+        return;
+    // Bỏ log explorer_rebuilt xen giữa các dòng kết quả
+    Logger::getInstance().configure("", LogLevel::WARN);
+
+    char path_template[] = "/tmp/chess_explorer_XXXXXX";
+    int fd = mkstemp(path_template);
+    if (fd < 0)
+    {
+        perror("mkstemp failed");
+        return;
+    }
+    close(fd);
+    std::string path = path_template;
+
+    std::vector<MatchModel> matches;
+    std::vector<std::string> game_ids;
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        MatchModel match;
+        match.game_id = std::to_string(i);
+        match.white_username = "white";
+        match.black_username = "black";
+        match.start_fen = chess::constants::STARTPOS;
+        match.result = i % 3 == 0 ? "white" : i % 3 == 1 ? "black" : "<0>";
+        for (const std::string &uci : randomGame(i, Const::EXPLORER_MAX_PLIES))
+        {
+            MatchModel::Move move;
+            move.uci_move = uci;
+            match.moves.push_back(move);
+        }
+        game_ids.push_back(match.game_id);
+        matches.push_back(std::move(match));
+    }
+    // Ván đã nằm sẵn trong bộ nhớ: chỉ đo phần đi lại ván và dựng bảng
+    OpeningExplorer::FetchGame fetch = [&matches](const std::string &game_id, MatchModel &match) {
+        match = matches[std::stoul(game_id)];
+        return true;
+    };
+
+    OpeningExplorer &explorer = OpeningExplorer::getInstance();
+    for (size_t games : {size_t(1000), size_t(10000)})
+    {
+        std::vector<std::string> subset(game_ids.begin(), game_ids.begin() + games);
+        bench.run("explorer.rebuild", "{\"games\":" + std::to_string(games) + "}",
+                  [&](uint64_t iterations) {
+                      for (uint64_t i = 0; i < iterations; i++)
+                      {
+                          explorer.open(path);
+                          explorer.rebuild(subset, fetch);
+                      }
+                  });
+    }
+
+    size_t next = 0;
+    explorer.open(path);
+    explorer.rebuild({}, fetch);
+    bench.run("explorer.addGame", "{\"plies\":" + std::to_string(Const::EXPLORER_MAX_PLIES) + "}",
+              [&](uint64_t iterations) {
+                  for (uint64_t i = 0; i < iterations; i++)
+                      explorer.addGame(matches[next++ % matches.size()]);
+              });
+
+    explorer.rebuild(game_ids, fetch);
+    chess::Board start;
+    chess::Board after_e4;
+    after_e4.makeMove(chess::uci::uciToMove(after_e4, "e2e4"));
+    bench.run("explorer.query", "{\"games\":10000,\"position\":\"startpos\"}",
+              [&](uint64_t iterations) {
+                  for (uint64_t i = 0; i < iterations; i++)
+                      doNotOptimize(explorer.query(start));
+              });
+    bench.run("explorer.query", "{\"games\":10000,\"position\":\"e2e4\"}",
+              [&](uint64_t iterations) {
+                  for (uint64_t i = 0; i < iterations; i++)
+                      doNotOptimize(explorer.query(after_e4));
+              });
+    unlink(path.c_str());
+}
+
+#pragma endregion Explorer
+
+int main(int argc, char *argv[])
+{
+    BenchConfig config;
+    try
+    {
+        if (!parseArgs(argc, argv, config))
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    catch (const std::exception &)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Dòng đầu mô tả môi trường đo, để so sánh kết quả giữa các lần chạy
+    std::printf("{\"suite\":\"chess_tcp\",\"compiler\":\"%s\",\"timestamp\":%lld,"
+                "\"min_time_ms\":%u}\n",
+                __VERSION__, static_cast<long long>(std::time(nullptr)), config.min_time_ms);
+
+    Bench bench(config.filter, config.min_time_ms);
+    benchProtocol(bench);
+    benchFraming(bench);
+    benchGame(bench);
+    benchSliders(bench);
+    benchEngine(bench);
+    benchEngineScheduler(bench);
+    benchMatchmaking(bench);
+    benchLobby(bench);
+    benchArchive(bench);
+    benchGameLogStream(bench);
+    benchStorage(bench, config.max_size);
+    benchExplorer(bench);
+    return 0;
+}
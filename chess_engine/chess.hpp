@@ -25,6 +25,17 @@
 #    include <nmmintrin.h>
 #endif
 
+// PEXT slider lookups are selected at runtime (CPUID) on x86-64 GCC/Clang.
+// Define CHESS_NO_PEXT to always use fancy magics.
+#if !defined(CHESS_NO_PEXT) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#    define CHESS_HAS_PEXT 1
+#    if defined(__BMI2__)
+#        include <immintrin.h>
+#    endif
+#else
+#    define CHESS_HAS_PEXT 0
+#endif
+
 
 #include <string_view>
 
@@ -692,9 +703,28 @@ class attacks {
         Bitboard *attacks;
         U64 shift;
 
-        U64 operator()(Bitboard b) const { return (((b & mask)).getBits() * magic) >> shift; }
+        U64 operator()(Bitboard b) const {
+#if CHESS_HAS_PEXT
+            if (UsePext) return pext(b.getBits(), mask);
+#endif
+            return (((b & mask)).getBits() * magic) >> shift;
+        }
     };
 
+#if CHESS_HAS_PEXT
+    // Parallel bit extract (BMI2). Emitted as inline asm when the translation unit is not
+    // compiled with -mbmi2, so only the runtime-selected path executes the instruction.
+    static U64 pext(U64 bits, U64 mask) noexcept {
+#    if defined(__BMI2__)
+        return _pext_u64(bits, mask);
+#    else
+        U64 result;
+        asm("pextq %2, %1, %0" : "=r"(result) : "r"(bits), "r"(mask));
+        return result;
+#    endif
+    }
+#endif
+
     // Slow function to calculate bishop attacks
     [[nodiscard]] static Bitboard bishopAttacks(Square sq, Bitboard occupied);
 
@@ -822,6 +852,10 @@ class attacks {
     static inline Magic RookTable[64]   = {};
     static inline Magic BishopTable[64] = {};
 
+    // Slider tables are indexed by pext(occupied, mask) instead of the magic multiply.
+    // Both schemes use 2^popcount(mask) entries per square, so the tables are shared.
+    static inline bool UsePext = false;
+
    public:
     static constexpr Bitboard MASK_RANK[8] = {0xff,         0xff00,         0xff0000,         0xff000000,
                                               0xff00000000, 0xff0000000000, 0xff000000000000, 0xff00000000000000};
@@ -913,8 +947,34 @@ class attacks {
      */
     [[nodiscard]] static Bitboard attackers(const Board &board, Color color, Square square) noexcept;
 
+    /**
+     * @brief Slider lookup implementation
+     */
+    enum class SliderImpl : std::uint8_t { MAGIC, PEXT };
+
+    /**
+     * @brief Whether this build and CPU can use PEXT slider lookups
+     * @return
+     */
+    [[nodiscard]] static bool pextSupported() noexcept;
+
+    /**
+     * @brief Returns the slider implementation currently in use
+     * @return
+     */
+    [[nodiscard]] static SliderImpl sliderImpl() noexcept;
+
+    /**
+     * @brief Rebuilds the slider tables for the given implementation (PEXT falls back to
+     * magics if unsupported). Not thread-safe: call before any other thread uses the engine.
+     * @param impl
+     * @return the implementation actually selected
+     */
+    static SliderImpl selectSliders(SliderImpl impl);
+
     /**
      * @brief [Internal Usage] Initializes the attacks for the bishop and rook. Called once at startup.
+     * Uses PEXT when the CPU supports BMI2, magics otherwise.
      */
     static inline void initAttacks();
 };
@@ -3288,7 +3348,23 @@ inline void attacks::initSliders(Square sq, Magic table[], U64 magic,
     } while (occ);
 }
 
-inline void attacks::initAttacks() {
+inline bool attacks::pextSupported() noexcept {
+#if CHESS_HAS_PEXT
+    // May run during static initialization, before the runtime has queried the CPU
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2");
+#else
+    return false;
+#endif
+}
+
+inline attacks::SliderImpl attacks::sliderImpl() noexcept {
+    return UsePext ? SliderImpl::PEXT : SliderImpl::MAGIC;
+}
+
+inline attacks::SliderImpl attacks::selectSliders(SliderImpl impl) {
+    UsePext = impl == SliderImpl::PEXT && pextSupported();
+
     BishopTable[0].attacks = BishopAttacks;
     RookTable[0].attacks   = RookAttacks;
 
@@ -3296,7 +3372,11 @@ inline void attacks::initAttacks() {
         initSliders(static_cast<Square>(i), BishopTable, BishopMagics[i], bishopAttacks);
         initSliders(static_cast<Square>(i), RookTable, RookMagics[i], rookAttacks);
     }
+
+    return sliderImpl();
 }
+
+inline void attacks::initAttacks() { selectSliders(SliderImpl::PEXT); }
 }  // namespace chess
 
 
@@ -12,6 +12,7 @@
 #include "network_client.hpp"
 #include "message_handler.hpp"
 #include "input_processor.hpp"
+#include "stdin_reader.hpp"
 #include "ui.hpp"
 
 // Global state for cleanup
@@ -39,36 +40,6 @@ void cleanupTerminal()
     fcntl(STDIN_FILENO, F_SETFL, g_stdinFlags);
 }
 
-/**
- * @brief Đọc một dòng từ stdin (non-blocking)
- */
-bool readLineNonBlocking(std::string &line_buffer)
-{
-    char c;
-    while (read(STDIN_FILENO, &c, 1) > 0)
-    {
-        if (c == '\n' || c == '\r')
-        {
-            std::cout << std::endl;
-            return true;
-        }
-        else if (c == 127 || c == 8)  // Backspace
-        {
-            if (!line_buffer.empty())
-            {
-                line_buffer.pop_back();
-                std::cout << "\b \b" << std::flush;
-            }
-        }
-        else if (c >= 32 && c < 127)  // Printable
-        {
-            line_buffer += c;
-            std::cout << c << std::flush;
-        }
-    }
-    return false;
-}
-
 int main()
 {
     NetworkClient &network = NetworkClient::getInstance();
@@ -84,11 +55,9 @@ int main()
 
     fcntl(STDIN_FILENO, F_SETFL, g_stdinFlags | O_NONBLOCK);
 
-    struct termios new_tio = g_oldTio;
-    new_tio.c_lflag &= ~(ICANON | ECHO);
-    new_tio.c_cc[VMIN] = 0;
-    new_tio.c_cc[VTIME] = 0;
+    struct termios new_tio = StdinReader::rawMode(g_oldTio);
     tcsetattr(STDIN_FILENO, TCSANOW, &new_tio);
+    StdinReader stdinReader;
 
     // State machine
     ClientState currentState = ClientState::INITIAL_MENU;
@@ -112,7 +81,10 @@ int main()
     // Main event loop
     while (currentState != ClientState::EXITING)
     {
-        int ret = poll(fds, 2, 10);  // 10ms timeout for very responsive input
+        // Chờ vô hạn: client không có timer cục bộ nào (đồng hồ cờ và heartbeat
+        // đều do server đẩy xuống), nên chỉ thức dậy khi có input hoặc packet.
+        // Ctrl+C làm poll() trả về EINTR.
+        int ret = poll(fds, 2, -1);
 
         if (ret < 0)
         {
@@ -120,14 +92,19 @@ int main()
             break;
         }
 
-        // Process stdin
-        if (fds[0].revents & POLLIN)
+        // Process stdin (có thể có nhiều dòng trong một lần đọc)
+        if (fds[0].revents & (POLLIN | POLLHUP))
         {
-            if (readLineNonBlocking(inputBuffer))
+            while (currentState != ClientState::EXITING &&
+                   stdinReader.readLine(inputBuffer))
             {
                 currentState = inputProcessor.processInput(currentState, inputBuffer, context);
                 inputBuffer.clear();
             }
+
+            // stdin đã đóng (EOF): ngừng theo dõi để poll() không thức liên tục
+            if (stdinReader.isClosed())
+                fds[0].fd = -1;
         }
 
         // Check if connection was closed
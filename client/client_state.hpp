@@ -34,6 +34,10 @@ enum class ClientState {
     CHALLENGE_INPUT,            // Chờ user nhập username để challenge
     WAITING_CHALLENGE_RESPONSE, // Đã gửi challenge, chờ opponent response
     CHALLENGE_RECEIVED,         // Nhận challenge từ người khác, chờ user accept/decline
+
+    // Spectator states
+    WATCH_INPUT,                // Chờ user nhập username của người chơi muốn xem
+    SPECTATING,                 // Đang xem ván cờ của người khác
     
     // In-game states
     IN_GAME_MY_TURN,            // Trong game, lượt của mình - chờ user nhập move
@@ -69,8 +73,17 @@ struct StateContext {
     std::string challenger_username;
     uint16_t challenger_elo;
     
-    // Player list cache
+    // Player list cache (trang đang xem)
     std::vector<PlayerListMessage::Player> player_list_cache;
+    uint16_t player_list_offset = 0;
+    uint16_t player_list_total = 0;
+
+    // Match history: con trỏ tới trang tiếp theo (rỗng = từ ván mới nhất)
+    int64_t history_cursor_time = 0;
+    std::string history_cursor_id;
+
+    // Spectator data
+    std::string watching_game_id;
     
     // Timeout tracking
     int timeout_counter;
@@ -82,6 +95,11 @@ struct StateContext {
         challenger_username.clear();
         challenger_elo = 0;
         player_list_cache.clear();
+        player_list_offset = 0;
+        player_list_total = 0;
+        history_cursor_time = 0;
+        history_cursor_id.clear();
+        watching_game_id.clear();
         timeout_counter = 0;
     }
 };
@@ -105,6 +123,8 @@ inline const char* getStateName(ClientState state) {
         case ClientState::CHALLENGE_INPUT: return "CHALLENGE_INPUT";
         case ClientState::WAITING_CHALLENGE_RESPONSE: return "WAITING_CHALLENGE_RESPONSE";
         case ClientState::CHALLENGE_RECEIVED: return "CHALLENGE_RECEIVED";
+        case ClientState::WATCH_INPUT: return "WATCH_INPUT";
+        case ClientState::SPECTATING: return "SPECTATING";
         case ClientState::IN_GAME_MY_TURN: return "IN_GAME_MY_TURN";
         case ClientState::IN_GAME_OPPONENT_TURN: return "IN_GAME_OPPONENT_TURN";
         case ClientState::EXITING: return "EXITING";
@@ -50,7 +50,7 @@ public:
             return processLoginInput(input);
             
         case ClientState::GAME_MENU:
-            return processGameMenu(input);
+            return processGameMenu(input, context);
             
         case ClientState::AUTO_MATCH_DECISION:
             return processAutoMatchDecision(input, context);
@@ -63,6 +63,12 @@ public:
             
         case ClientState::CHALLENGE_RECEIVED:
             return processChallengeReceived(input, context);
+
+        case ClientState::WATCH_INPUT:
+            return processWatchInput(input, context);
+
+        case ClientState::SPECTATING:
+            return processSpectating(input, context);
             
         case ClientState::IN_GAME_MY_TURN:
             return processGameMove(input);
@@ -175,7 +181,7 @@ private:
 
     // ==================== Game Menu ====================
 
-    ClientState processGameMenu(const std::string &input)
+    ClientState processGameMenu(const std::string &input, StateContext &context)
     {
         int choice = 0;
         try
@@ -222,7 +228,93 @@ private:
             return ClientState::WAITING_PLAYER_LIST;
         }
             
-        case 3: // Back to initial menu
+        case 3: // Leaderboard: top 10 và 5 người quanh mình
+        {
+            LeaderboardRequestMessage top;
+            top.mode = LeaderboardRequestMessage::Mode::TOP;
+            top.limit = 10;
+            LeaderboardRequestMessage around;
+            around.mode = LeaderboardRequestMessage::Mode::AROUND_ME;
+            around.limit = 5;
+
+            if (!network_.sendPacket(top.getType(), top.serialize()) ||
+                !network_.sendPacket(around.getType(), around.serialize()))
+            {
+                UI::printErrorMessage("Gửi yêu cầu bảng xếp hạng thất bại.");
+                UI::displayGameMenuPrompt();
+            }
+            return ClientState::GAME_MENU;
+        }
+
+        case 4: // Play vs engine: màu ngẫu nhiên, cấp độ mạnh nhất
+        {
+            PlayVsEngineMessage msg;
+            msg.color = PlayVsEngineMessage::Color::RANDOM;
+
+            if (!network_.sendPacket(msg.getType(), msg.serialize()))
+            {
+                UI::printErrorMessage("Gửi yêu cầu chơi với máy thất bại.");
+                UI::displayGameMenuPrompt();
+                return ClientState::GAME_MENU;
+            }
+
+            UI::printInfoMessage("Đang tạo ván cờ với máy...");
+            return ClientState::WAITING_MATCH_START;
+        }
+
+        case 5: // Post-game analysis của ván vừa kết thúc
+        {
+            if (session_.getLastGameId().empty())
+            {
+                UI::printErrorMessage("Bạn chưa chơi ván nào.");
+                UI::displayGameMenuPrompt();
+                return ClientState::GAME_MENU;
+            }
+
+            AnalysisRequestMessage msg;
+            msg.game_id = session_.getLastGameId();
+            if (!network_.sendPacket(msg.getType(), msg.serialize()))
+            {
+                UI::printErrorMessage("Gửi yêu cầu phân tích thất bại.");
+                UI::displayGameMenuPrompt();
+            }
+            return ClientState::GAME_MENU;
+        }
+
+        case 6: // Match history: trang tiếp theo nếu trang trước còn ván cũ hơn
+        {
+            MatchHistoryRequestMessage msg;
+            msg.limit = 10;
+            msg.cursor_time = context.history_cursor_time;
+            msg.cursor_id = context.history_cursor_id;
+            if (!network_.sendPacket(msg.getType(), msg.serialize()))
+            {
+                UI::printErrorMessage("Gửi yêu cầu lịch sử ván đấu thất bại.");
+                UI::displayGameMenuPrompt();
+            }
+            return ClientState::GAME_MENU;
+        }
+
+        case 7: // Nhật ký ván vừa chơi, nhận theo chunk (xem handleGameLog)
+        {
+            if (session_.getLastGameId().empty())
+            {
+                UI::printErrorMessage("Bạn chưa chơi ván nào.");
+                UI::displayGameMenuPrompt();
+                return ClientState::GAME_MENU;
+            }
+
+            GameLogRequestMessage msg;
+            msg.game_id = session_.getLastGameId();
+            if (!network_.sendPacket(msg.getType(), msg.serialize()))
+            {
+                UI::printErrorMessage("Gửi yêu cầu nhật ký ván thất bại.");
+                UI::displayGameMenuPrompt();
+            }
+            return ClientState::GAME_MENU;
+        }
+
+        case 8: // Back to initial menu
             UI::clearConsole();
             UI::printLogo();
             UI::displayInitialMenuPrompt();
@@ -305,8 +397,9 @@ private:
         }
         catch (...)
         {
-            UI::printErrorMessage("Vui lòng chọn 1 (Thách đấu) hoặc 2 (Quay lại).");
-            UI::displayPlayerList(context.player_list_cache, session_.getUsername());
+            UI::printErrorMessage("Vui lòng chọn 1 (Thách đấu), 2 (Xem trận đấu), 3 (Quay lại), 4 (Trang sau) hoặc 5 (Trang trước).");
+            UI::displayPlayerList(context.player_list_cache, session_.getUsername(),
+                                  context.player_list_offset, context.player_list_total);
             return ClientState::PLAYER_LIST_VIEW;
         }
 
@@ -315,6 +408,35 @@ private:
             UI::displayChallengeInputPrompt();
             return ClientState::CHALLENGE_INPUT;
         }
+        else if (choice == 2) // Watch
+        {
+            UI::displayWatchInputPrompt();
+            return ClientState::WATCH_INPUT;
+        }
+        else if (choice == 4 || choice == 5) // Next / previous page
+        {
+            int page_size = Const::PLAYER_LIST_PAGE_SIZE;
+            int offset = context.player_list_offset + (choice == 4 ? page_size : -page_size);
+            if (offset < 0 || offset >= context.player_list_total)
+            {
+                UI::printErrorMessage("Không còn trang nào theo hướng này.");
+                UI::displayPlayerList(context.player_list_cache, session_.getUsername(),
+                                      context.player_list_offset, context.player_list_total);
+                return ClientState::PLAYER_LIST_VIEW;
+            }
+
+            RequestPlayerListMessage msg;
+            msg.offset = static_cast<uint16_t>(offset);
+            msg.limit = Const::PLAYER_LIST_PAGE_SIZE;
+            if (!network_.sendPacket(msg.getType(), msg.serialize()))
+            {
+                UI::printErrorMessage("Gửi yêu cầu danh sách thất bại.");
+                UI::displayPlayerList(context.player_list_cache, session_.getUsername(),
+                                      context.player_list_offset, context.player_list_total);
+                return ClientState::PLAYER_LIST_VIEW;
+            }
+            return ClientState::WAITING_PLAYER_LIST;
+        }
         else // Back
         {
             context.clear();
@@ -427,6 +549,61 @@ private:
         }
     }
 
+    // ==================== Spectator ====================
+
+    ClientState processWatchInput(const std::string &input, StateContext &context)
+    {
+        // Tìm ván cờ mà người chơi này đang tham gia
+        std::string game_id;
+        for (const auto &player : context.player_list_cache)
+        {
+            if (player.username == input && player.in_game)
+            {
+                game_id = player.game_id;
+                break;
+            }
+        }
+
+        if (game_id.empty())
+        {
+            UI::printErrorMessage("Người chơi không online hoặc không ở trong trận đấu.");
+            UI::displayGameMenuPrompt();
+            return ClientState::GAME_MENU;
+        }
+
+        WatchGameMessage msg;
+        msg.game_id = game_id;
+
+        if (!network_.sendPacket(msg.getType(), msg.serialize()))
+        {
+            UI::printErrorMessage("Gửi yêu cầu xem trận thất bại.");
+            UI::displayGameMenuPrompt();
+            return ClientState::GAME_MENU;
+        }
+
+        context.watching_game_id = game_id;
+        UI::printInfoMessage("Đang tải trận đấu...");
+        return ClientState::SPECTATING;
+    }
+
+    ClientState processSpectating(const std::string &input, StateContext &context)
+    {
+        if (input != "q" && input != "quit")
+        {
+            UI::displaySpectatorPrompt();
+            return ClientState::SPECTATING;
+        }
+
+        UnwatchGameMessage msg;
+        msg.game_id = context.watching_game_id;
+        network_.sendPacket(msg.getType(), msg.serialize());
+
+        context.clear();
+        UI::clearConsole();
+        UI::displayGameMenuPrompt();
+        return ClientState::GAME_MENU;
+    }
+
     // ==================== In-Game ====================
 
     ClientState processGameMove(const std::string &input)
@@ -503,7 +680,8 @@ private:
                                               context.pending_game_id);
             break;
         case ClientState::PLAYER_LIST_VIEW:
-            UI::displayPlayerList(context.player_list_cache, session_.getUsername());
+            UI::displayPlayerList(context.player_list_cache, session_.getUsername(),
+                                  context.player_list_offset, context.player_list_total);
             break;
         case ClientState::CHALLENGE_INPUT:
             UI::displayChallengeInputPrompt();
@@ -511,6 +689,12 @@ private:
         case ClientState::CHALLENGE_RECEIVED:
             UI::displayChallengeDecisionPrompt(context.challenger_username, context.challenger_elo);
             break;
+        case ClientState::WATCH_INPUT:
+            UI::displayWatchInputPrompt();
+            break;
+        case ClientState::SPECTATING:
+            UI::displaySpectatorPrompt();
+            break;
         case ClientState::IN_GAME_MY_TURN:
             UI::displayMovePrompt();
             break;
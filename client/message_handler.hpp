@@ -1,6 +1,7 @@
 #ifndef MESSAGE_HANDLER_HPP
 #define MESSAGE_HANDLER_HPP
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -10,6 +11,7 @@
 
 #include "client_state.hpp"
 #include "session_data.hpp"
+#include "network_client.hpp"
 #include "ui.hpp"
 
 /**
@@ -33,6 +35,10 @@ public:
     {
         switch (packet.type)
         {
+        // heartbeat
+        case MessageType::PING:
+            return handlePing(currentState);
+
         // login and register
         case MessageType::REGISTER_SUCCESS:
             return handleRegisterSuccess(packet.payload);
@@ -51,16 +57,29 @@ public:
             return handleGameStart(packet.payload);
             
         case MessageType::GAME_STATUS_UPDATE:
+            if (currentState == ClientState::SPECTATING)
+                return handleSpectatorUpdate(packet.payload, context);
             return handleGameStatusUpdate(packet.payload);
             
         case MessageType::INVALID_MOVE:
             return handleInvalidMove(packet.payload);
             
         case MessageType::GAME_END:
+            if (currentState == ClientState::SPECTATING)
+                return handleSpectatorGameEnd(packet.payload, context);
             return handleGameEnd(packet.payload);
 
+        // spectator messages
+        case MessageType::GAME_KEYFRAME:
+            return handleGameKeyframe(currentState, packet.payload, context);
+
+        case MessageType::WATCH_ERROR:
+            return handleWatchError(packet.payload, context);
+
         // matchmaking and challenges
         case MessageType::CHALLENGE_NOTIFICATION:
+            if (currentState == ClientState::SPECTATING)
+                stopWatching(context);
             return handleChallengeNotification(packet.payload, context);
 
         case MessageType::AUTO_MATCH_FOUND:
@@ -71,6 +90,21 @@ public:
 
         case MessageType::PLAYER_LIST:
             return handlePlayerList(packet.payload, context);
+
+        case MessageType::PRESENCE_UPDATE:
+            return handlePresenceUpdate(currentState, packet.payload, context);
+
+        case MessageType::LEADERBOARD_RESPONSE:
+            return handleLeaderboard(currentState, packet.payload);
+
+        case MessageType::ANALYSIS_RESPONSE:
+            return handleAnalysis(currentState, packet.payload);
+
+        case MessageType::GAME_LOG:
+            return handleGameLog(currentState, packet.payload);
+
+        case MessageType::MATCH_HISTORY_RESPONSE:
+            return handleMatchHistory(currentState, packet.payload, context);
             
         case MessageType::CHALLENGE_DECLINED:
             return handleChallengeDeclined(packet.payload);
@@ -89,6 +123,16 @@ public:
     }
 
 private:
+    // ==================== Heartbeat ====================
+
+    // Trả lời PING ngay, không thay đổi state hay giao diện
+    ClientState handlePing(ClientState currentState)
+    {
+        PongMessage pong;
+        NetworkClient::getInstance().sendPacket(pong.getType(), pong.serialize());
+        return currentState;
+    }
+
     // ==================== Auth handlers ====================
     
     ClientState handleRegisterSuccess(const std::vector<uint8_t> &payload)
@@ -103,11 +147,19 @@ private:
         SessionData &session = SessionData::getInstance();
         session.setUsername(message.username);
         session.setElo(message.elo);
+        subscribePresence();
 
         UI::displayGameMenuPrompt();
         return ClientState::GAME_MENU;
     }
 
+    // Nhận thay đổi sảnh chờ thay vì hỏi lại REQUEST_PLAYER_LIST
+    void subscribePresence()
+    {
+        SubscribePresenceMessage subscribe;
+        NetworkClient::getInstance().sendPacket(subscribe.getType(), subscribe.serialize());
+    }
+
     ClientState handleRegisterFailure(const std::vector<uint8_t> &payload)
     {
         RegisterFailureMessage message = RegisterFailureMessage::deserialize(payload);
@@ -129,6 +181,7 @@ private:
         SessionData &session = SessionData::getInstance();
         session.setUsername(message.username);
         session.setElo(message.elo);
+        subscribePresence();
 
         UI::displayGameMenuPrompt();
         return ClientState::GAME_MENU;
@@ -181,6 +234,7 @@ private:
         session.setTurn(is_my_turn);
 
         UI::showBoard(message.fen, !session.isWhite());
+        UI::displayClocks(message.white_time_ms, message.black_time_ms);
 
         if (message.is_game_over)
         {
@@ -218,11 +272,85 @@ private:
         UI::displayGameEnd(message.game_id, message.winner_username, 
                           message.reason, message.half_moves_count);
         
+        session.setLastGameId(message.game_id);
         session.clearGameStatus();
         UI::displayGameMenuPrompt();
         return ClientState::GAME_MENU;
     }
 
+    // ==================== Spectator handlers ====================
+
+    ClientState handleGameKeyframe(ClientState currentState, const std::vector<uint8_t> &payload,
+                                   StateContext &context)
+    {
+        GameKeyframeMessage message = GameKeyframeMessage::deserialize(payload);
+
+        // Keyframe đến muộn sau khi đã ngừng xem
+        if (currentState != ClientState::SPECTATING || message.game_id != context.watching_game_id)
+            return currentState;
+
+        chess::PackedBoard packed_board;
+        std::copy(message.packed_board.begin(), message.packed_board.end(), packed_board.begin());
+        std::string fen = chess::Board::Compact::decode(packed_board).getFen();
+
+        UI::clearConsole();
+        UI::displaySpectatorHeader(message.game_id, message.white_username,
+                                   message.black_username, message.moves.size());
+        UI::showBoard(fen);
+        UI::displaySpectatorPrompt();
+        return ClientState::SPECTATING;
+    }
+
+    ClientState handleSpectatorUpdate(const std::vector<uint8_t> &payload, StateContext &context)
+    {
+        GameStatusUpdateMessage message = GameStatusUpdateMessage::deserialize(payload);
+
+        if (message.game_id != context.watching_game_id)
+            return ClientState::SPECTATING;
+
+        UI::showBoard(message.fen);
+        UI::displayClocks(message.white_time_ms, message.black_time_ms);
+        std::cout << "Lượt đi: " << message.current_turn_username;
+        if (!message.message.empty())
+            std::cout << " - " << message.message;
+        std::cout << std::endl;
+        UI::displaySpectatorPrompt();
+        return ClientState::SPECTATING;
+    }
+
+    ClientState handleSpectatorGameEnd(const std::vector<uint8_t> &payload, StateContext &context)
+    {
+        GameEndMessage message = GameEndMessage::deserialize(payload);
+
+        if (message.game_id != context.watching_game_id)
+            return ClientState::SPECTATING;
+
+        UI::displayGameEnd(message.game_id, message.winner_username,
+                           message.reason, message.half_moves_count);
+        context.clear();
+        UI::displayGameMenuPrompt();
+        return ClientState::GAME_MENU;
+    }
+
+    ClientState handleWatchError(const std::vector<uint8_t> &payload, StateContext &context)
+    {
+        WatchErrorMessage message = WatchErrorMessage::deserialize(payload);
+
+        UI::printErrorMessage("Không thể xem trận đấu: " + message.error_message);
+        context.clear();
+        UI::displayGameMenuPrompt();
+        return ClientState::GAME_MENU;
+    }
+
+    // Báo server ngừng gửi cập nhật của ván đang xem
+    void stopWatching(StateContext &context)
+    {
+        UnwatchGameMessage msg;
+        msg.game_id = context.watching_game_id;
+        NetworkClient::getInstance().sendPacket(msg.getType(), msg.serialize());
+        context.watching_game_id.clear();
+    }
+
     // ==================== Matchmaking handlers ====================
 
     ClientState handleAutoMatchFound(const std::vector<uint8_t> &payload, StateContext &context)
@@ -256,11 +384,124 @@ private:
         SessionData &session = SessionData::getInstance();
         
         context.player_list_cache = message.players;
+        context.player_list_offset = message.offset;
+        context.player_list_total = message.total;
         UI::clearConsole();
-        UI::displayPlayerList(message.players, session.getUsername());
+        UI::displayPlayerList(message.players, session.getUsername(), message.offset, message.total);
         return ClientState::PLAYER_LIST_VIEW;
     }
 
+    // Áp dụng thay đổi sảnh chờ vào player_list_cache (sắp xếp theo username)
+    ClientState handlePresenceUpdate(ClientState currentState, const std::vector<uint8_t> &payload, StateContext &context)
+    {
+        PresenceUpdateMessage message = PresenceUpdateMessage::deserialize(payload);
+        SessionData &session = SessionData::getInstance();
+        auto &players = context.player_list_cache;
+
+        for (const auto &event : message.events)
+        {
+            const PlayerListMessage::Player &player = event.player;
+            auto it = std::lower_bound(players.begin(), players.end(), player.username,
+                                       [](const PlayerListMessage::Player &p, const std::string &name)
+                                       { return p.username < name; });
+            bool present = it != players.end() && it->username == player.username;
+
+            if (event.kind == PresenceUpdateMessage::Kind::LEFT)
+            {
+                if (present)
+                    players.erase(it);
+                if (context.player_list_total > 0)
+                    context.player_list_total--;
+                continue;
+            }
+
+            if (present)
+            {
+                *it = player;
+            }
+            else
+            {
+                players.insert(it, player);
+                if (event.kind == PresenceUpdateMessage::Kind::JOINED)
+                    context.player_list_total++;
+            }
+
+            if (player.username == session.getUsername())
+                session.setElo(player.elo);
+        }
+
+        // Chỉ vẽ lại khi người dùng đang xem danh sách
+        if (currentState == ClientState::PLAYER_LIST_VIEW)
+        {
+            UI::clearConsole();
+            UI::displayPlayerList(players, session.getUsername(),
+                                  context.player_list_offset, context.player_list_total);
+        }
+        return currentState;
+    }
+
+    // Bảng xếp hạng được hiển thị ngay trong game menu; menu được in lại sau
+    // phần "quanh mình" (gửi sau cùng)
+    ClientState handleLeaderboard(ClientState currentState, const std::vector<uint8_t> &payload)
+    {
+        LeaderboardResponseMessage message = LeaderboardResponseMessage::deserialize(payload);
+        if (currentState != ClientState::GAME_MENU)
+            return currentState;
+
+        UI::displayLeaderboard(message, SessionData::getInstance().getUsername());
+        if (message.mode == LeaderboardRequestMessage::Mode::AROUND_ME)
+            UI::displayGameMenuPrompt();
+        return currentState;
+    }
+
+    // Lịch sử ván đấu hiển thị trong game menu; con trỏ trang tiếp theo được
+    // giữ trong context (xóa khi đã hết ván)
+    ClientState handleMatchHistory(ClientState currentState, const std::vector<uint8_t> &payload,
+                                   StateContext &context)
+    {
+        MatchHistoryResponseMessage message = MatchHistoryResponseMessage::deserialize(payload);
+        if (currentState != ClientState::GAME_MENU)
+            return currentState;
+
+        UI::displayMatchHistory(message, context.history_cursor_id.empty());
+        context.history_cursor_time = message.has_more ? message.next_time : 0;
+        context.history_cursor_id = message.has_more ? message.next_id : "";
+        UI::displayGameMenuPrompt();
+        return currentState;
+    }
+
+    // Mỗi chunk được in ngay và xác nhận để server gửi tiếp; menu được in lại
+    // sau chunk cuối
+    ClientState handleGameLog(ClientState currentState, const std::vector<uint8_t> &payload)
+    {
+        GameLogMessage chunk = GameLogMessage::deserialize(payload);
+        if (chunk.status == GameLogMessage::Status::OK && !(chunk.flags & GameLogMessage::FLAG_LAST))
+        {
+            GameLogAckMessage ack;
+            ack.game_id = chunk.game_id;
+            ack.seq = chunk.seq;
+            NetworkClient::getInstance().sendPacket(ack.getType(), ack.serialize());
+        }
+        if (currentState != ClientState::GAME_MENU)
+            return currentState;
+
+        UI::displayGameLogChunk(chunk);
+        if (chunk.flags & GameLogMessage::FLAG_LAST)
+            UI::displayGameMenuPrompt();
+        return currentState;
+    }
+
+    ClientState handleAnalysis(ClientState currentState, const std::vector<uint8_t> &payload)
+    {
+        AnalysisResponseMessage message = AnalysisResponseMessage::deserialize(payload);
+        if (currentState != ClientState::GAME_MENU)
+            return currentState;
+
+        UI::displayAnalysis(message);
+        UI::displayGameMenuPrompt();
+        return currentState;
+    }
+
     ClientState handleChallengeNotification(const std::vector<uint8_t> &payload, StateContext &context)
     {
         ChallengeNotificationMessage message = ChallengeNotificationMessage::deserialize(payload);
@@ -7,6 +7,9 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <cerrno>
 #include <cstring>
 #include <iostream>
 
@@ -30,7 +33,8 @@ private:
     /**
      * @brief Kết nối đến máy chủ với IP và cổng được cung cấp.
      *
-     * Tạo socket, thiết lập timeout, và kết nối TCP tới máy chủ. Xử lý các lỗi liên quan.
+     * Tạo socket và kết nối TCP tới máy chủ, sau đó chuyển socket sang chế độ
+     * non-blocking để event loop chỉ thức dậy khi có dữ liệu. Xử lý các lỗi liên quan.
      *
      * @param ip IP của máy chủ.
      * @param port Cổng của máy chủ.
@@ -45,15 +49,6 @@ private:
             return false;
         }
 
-        struct timeval timeout;
-        timeout.tv_sec = 0;
-        timeout.tv_usec = 100000;  // 100ms - poll already handles waiting
-
-        if (setsockopt(socket_fd, SOL_SOCKET, SO_RCVTIMEO, (char *)&timeout, sizeof(timeout)) < 0)
-        {
-            perror("setsockopt failed");
-        }
-
         sockaddr_in server_address;
         std::memset(&server_address, 0, sizeof(server_address));
         server_address.sin_family = AF_INET;
@@ -71,10 +66,45 @@ private:
             return false;
         }
 
+        // Non-blocking: recv() trả về EAGAIN thay vì chờ, poll() lo việc chờ
+        int flags = fcntl(socket_fd, F_GETFL, 0);
+        if (flags < 0 || fcntl(socket_fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        {
+            perror("fcntl O_NONBLOCK failed");
+            return false;
+        }
+
         std::cout << "Đã kết nối tới server trên: " << ip << ":" << port << std::endl;
         return true;
     }
 
+    /**
+     * @brief Tách một packet hoàn chỉnh từ đầu buffer (nếu có).
+     * @return true nếu tách được, packet đã bị xóa khỏi buffer.
+     */
+    bool extractPacket(Packet &packet)
+    {
+        if (buffer.size() < Const::PACKET_HEADER_SIZE)
+            return false;
+
+        MessageType type = static_cast<MessageType>(buffer[0]);
+        uint16_t length = (static_cast<uint16_t>(buffer[1]) << 8) |
+                          static_cast<uint16_t>(buffer[2]);
+
+        // Chuyển từ network byte order về host byte order
+        length = ntohs(length);
+
+        // Kiểm tra đủ dữ liệu cho payload
+        if (buffer.size() < Const::PACKET_HEADER_SIZE + length)
+            return false;
+
+        std::vector<uint8_t> payload(buffer.begin() + Const::PACKET_HEADER_SIZE,
+                                     buffer.begin() + Const::PACKET_HEADER_SIZE + length);
+        packet = Packet{type, length, payload};
+        buffer.erase(buffer.begin(), buffer.begin() + Const::PACKET_HEADER_SIZE + length);
+        return true;
+    }
+
     // Private constructor for Singleton
     NetworkClient() : socket_fd(-1)
     {
@@ -129,13 +159,28 @@ public:
 
         std::vector<uint8_t> serialized = packet.serialize();
 
-        ssize_t sent = send(socket_fd, serialized.data(), serialized.size(), 0);
-        if (sent != static_cast<ssize_t>(serialized.size()))
+        // Socket non-blocking: gửi từng phần, khi bộ đệm gửi đầy thì chờ
+        // POLLOUT (gói tin của client rất nhỏ nên hiếm khi xảy ra)
+        size_t offset = 0;
+        while (offset < serialized.size())
         {
-            // make it more precise
-            std::string err_msg = (sent < 0) ? std::strerror(errno) : "Incomplete send";
-            std::cerr << "Gửi gói tin thất bại: " << err_msg << std::endl;
-            
+            ssize_t sent = send(socket_fd, serialized.data() + offset,
+                                serialized.size() - offset, MSG_NOSIGNAL);
+            if (sent >= 0)
+            {
+                offset += static_cast<size_t>(sent);
+                continue;
+            }
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                struct pollfd pfd = {socket_fd, POLLOUT, 0};
+                if (poll(&pfd, 1, -1) >= 0 || errno == EINTR)
+                    continue;
+            }
+
+            std::cerr << "Gửi gói tin thất bại: " << std::strerror(errno) << std::endl;
             return false;
         }
         return true;
@@ -149,70 +194,30 @@ public:
      */
     int receivePacket(Packet &packet)
     {
-        // Kiểm tra buffer hiện tại TRƯỚC khi gọi recv()
-        // Vì có thể recv() trước đó đã nhận nhiều packets cùng lúc
-        if (buffer.size() >= Const::PACKET_HEADER_SIZE)
+        while (true)
         {
-            MessageType type = static_cast<MessageType>(buffer[0]);
-            uint16_t length = (static_cast<uint16_t>(buffer[1]) << 8) |
-                              static_cast<uint16_t>(buffer[2]);
-            
-            // Chuyển từ network byte order về host byte order
-            length = ntohs(length);
-
-            // Kiểm tra đủ dữ liệu cho payload
-            if (buffer.size() >= Const::PACKET_HEADER_SIZE + length)
-            {
-                std::vector<uint8_t> payload(buffer.begin() + Const::PACKET_HEADER_SIZE, 
-                                              buffer.begin() + Const::PACKET_HEADER_SIZE + length);
-                packet = Packet{type, length, payload};
-                buffer.erase(buffer.begin(), buffer.begin() + Const::PACKET_HEADER_SIZE + length);
-                return 1; // Thành công - trả về packet từ buffer
-            }
-        }
+            // Kiểm tra buffer hiện tại TRƯỚC khi gọi recv()
+            // Vì có thể recv() trước đó đã nhận nhiều packets cùng lúc
+            if (extractPacket(packet))
+                return 1;
 
-        // de den duoc day => buffer 0 du du lieu de tao ra packet
-        // Nhan them du lieu tu socket
-        uint8_t temp_buffer[Const::BUFFER_SIZE];
+            // Buffer chưa đủ dữ liệu để tạo packet → nhận thêm từ socket
+            uint8_t temp_buffer[Const::BUFFER_SIZE];
 
-        ssize_t bytes_received = recv(socket_fd, temp_buffer, sizeof(temp_buffer), 0);
-        if (bytes_received < 0)
-        {
-            if (errno == EWOULDBLOCK || errno == EAGAIN)
+            ssize_t bytes_received = recv(socket_fd, temp_buffer, sizeof(temp_buffer), 0);
+            if (bytes_received < 0)
             {
-                return 0; // Không có dữ liệu - poll lại sau
+                if (errno == EINTR)
+                    continue;
+                if (errno == EWOULDBLOCK || errno == EAGAIN)
+                    return 0; // Đã đọc hết dữ liệu đang có - chờ poll báo tiếp
+                return -1;    // Lỗi socket
             }
-            return -1; // Lỗi socket
-        }
-        else if (bytes_received == 0)
-        {
-            return -1; // Connection đóng
-        }
-
-        buffer.insert(buffer.end(), temp_buffer, temp_buffer + bytes_received);
+            if (bytes_received == 0)
+                return -1; // Connection đóng
 
-        // Thử parse sau khi nhận thêm dữ liệu
-        if (buffer.size() >= Const::PACKET_HEADER_SIZE)
-        {
-            MessageType type = static_cast<MessageType>(buffer[0]);
-            uint16_t length = (static_cast<uint16_t>(buffer[1]) << 8) |
-                              static_cast<uint16_t>(buffer[2]);
-            
-            // Chuyển từ network byte order về host byte order
-            length = ntohs(length);
-
-            // Kiểm tra đủ dữ liệu cho payload
-            if (buffer.size() >= Const::PACKET_HEADER_SIZE + length)
-            {
-                std::vector<uint8_t> payload(buffer.begin() + Const::PACKET_HEADER_SIZE, 
-                                              buffer.begin() + Const::PACKET_HEADER_SIZE + length);
-                packet = Packet{type, length, payload};
-                buffer.erase(buffer.begin(), buffer.begin() + Const::PACKET_HEADER_SIZE + length);
-                return 1; // Thành công
-            }
+            buffer.insert(buffer.end(), temp_buffer, temp_buffer + bytes_received);
         }
-
-        return 0; // still 0 du du lieu de tao packet
     }
 
     void closeConnection()
@@ -92,12 +92,22 @@ public:
         return !game_status_.game_id.empty();
     }
 
+    // Ván vừa kết thúc (dùng để yêu cầu phân tích)
+    const std::string& getLastGameId() const {
+        return last_game_id_;
+    }
+
+    void setLastGameId(const std::string& game_id) {
+        last_game_id_ = game_id;
+    }
+
 private:
     SessionData() : username_(""), elo_(0) {}
 
     std::string username_;
     uint16_t elo_;
     GameStatus game_status_;
+    std::string last_game_id_;
 };
 
 #endif // SESSION_DATA_HPP
\ No newline at end of file
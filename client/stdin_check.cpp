@@ -0,0 +1,116 @@
+// Kiểm tra StdinReader với terminal thật (pty) và với pipe: gõ từng phím
+// không được làm client coi stdin là đã đóng, còn pipe hết dữ liệu thì phải.
+// Chạy bằng `make check`, trả về mã lỗi khác 0 nếu có kiểm tra thất bại.
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "stdin_reader.hpp"
+
+static int g_failed = 0;
+
+void expect(bool ok, const std::string &name)
+{
+    std::cout << (ok ? "PASS " : "FAIL ") << name << std::endl;
+    if (!ok)
+        g_failed++;
+}
+
+bool waitReadable(int fd)
+{
+    struct pollfd pfd = {fd, POLLIN, 0};
+    return poll(&pfd, 1, 1000) == 1;
+}
+
+void checkTerminal()
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        expect(false, "tty.open");
+        return;
+    }
+    int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+    if (slave < 0)
+    {
+        expect(false, "tty.open");
+        close(master);
+        return;
+    }
+
+    // Cấu hình giống client_main
+    struct termios old_tio;
+    tcgetattr(slave, &old_tio);
+    struct termios new_tio = StdinReader::rawMode(old_tio);
+    tcsetattr(slave, TCSANOW, &new_tio);
+    fcntl(slave, F_SETFL, fcntl(slave, F_GETFL, 0) | O_NONBLOCK);
+
+    std::ostringstream echo;
+    StdinReader reader(slave, echo);
+    std::string line;
+
+    // Phím đầu tiên: chưa đủ dòng, đọc tiếp khi không có dữ liệu vẫn không phải EOF
+    write(master, "a", 1);
+    waitReadable(slave);
+    bool complete = reader.readLine(line);
+    expect(!complete && line == "a", "tty.first_key");
+    complete = reader.readLine(line);
+    expect(!complete && !reader.isClosed(), "tty.idle_not_eof");
+
+    // Các phím sau vẫn được đọc (kể cả backspace)
+    write(master, "bx\x7f", 3);
+    waitReadable(slave);
+    reader.readLine(line);
+    write(master, "c\n", 2);
+    waitReadable(slave);
+    complete = reader.readLine(line);
+    expect(complete && line == "abc" && !reader.isClosed(), "tty.line");
+    expect(echo.str() == "abx\b \bc\n", "tty.echo");
+
+    close(slave);
+    close(master);
+}
+
+void checkPipe()
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        expect(false, "pipe.open");
+        return;
+    }
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL, 0) | O_NONBLOCK);
+
+    std::ostringstream echo;
+    StdinReader reader(fds[0], echo);
+    std::string line;
+
+    // Pipe còn mở nhưng chưa có dữ liệu: EAGAIN, không phải EOF
+    expect(!reader.readLine(line) && !reader.isClosed(), "pipe.idle_not_eof");
+
+    // Nhiều dòng trong một khối rồi EOF
+    write(fds[1], "x\ny\n", 4);
+    close(fds[1]);
+    bool first = reader.readLine(line) && line == "x";
+    line.clear();
+    bool second = reader.readLine(line) && line == "y";
+    line.clear();
+    expect(first && second, "pipe.lines");
+    expect(!reader.readLine(line) && reader.isClosed(), "pipe.eof");
+
+    close(fds[0]);
+}
+
+int main()
+{
+    checkTerminal();
+    checkPipe();
+    return g_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+#ifndef STDIN_READER_HPP
+#define STDIN_READER_HPP
+
+#include <cerrno>
+#include <iostream>
+#include <string>
+#include <termios.h>
+#include <unistd.h>
+
+/**
+ * @brief Đọc từng dòng từ stdin không chặn (fd đã bật O_NONBLOCK).
+ *
+ * Đọc theo khối thay vì từng byte. Một khối có thể chứa nhiều dòng (dán hoặc
+ * pipe input): mỗi lần readLine() trả về tối đa một dòng, caller gọi lại đến
+ * khi trả về false. read() trả về 0 chỉ được coi là EOF khi fd không phải
+ * terminal hoặc terminal đã được cấu hình bằng rawMode() (VMIN = 1: không có
+ * dữ liệu thì read() báo EAGAIN thay vì 0).
+ */
+class StdinReader
+{
+public:
+    explicit StdinReader(int fd = STDIN_FILENO, std::ostream &echo_out = std::cout)
+        : fd(fd), echo_out(echo_out)
+    {
+    }
+
+    /**
+     * @brief Cấu hình terminal cho client: tắt chế độ dòng và echo (client tự
+     * echo), mỗi read() trả về ngay khi có ít nhất 1 byte.
+     */
+    static struct termios rawMode(const struct termios &old_tio)
+    {
+        struct termios new_tio = old_tio;
+        new_tio.c_lflag &= ~(ICANON | ECHO);
+        new_tio.c_cc[VMIN] = 1;
+        new_tio.c_cc[VTIME] = 0;
+        return new_tio;
+    }
+
+    /**
+     * @brief Đọc tiếp vào line_buffer.
+     * @return true nếu đã đủ một dòng (line_buffer chứa dòng, không có '\n').
+     */
+    bool readLine(std::string &line_buffer)
+    {
+        std::string echo;
+        bool line_complete = false;
+
+        while (!line_complete)
+        {
+            if (pos == len)
+            {
+                ssize_t n = read(fd, buf, sizeof(buf));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n == 0 && (!isatty(fd) || rawModeActive()))
+                    closed = true;
+                if (n <= 0)
+                    break;
+                len = static_cast<size_t>(n);
+                pos = 0;
+            }
+
+            char c = buf[pos++];
+            if (c == '\n' || c == '\r')
+            {
+                echo += '\n';
+                line_complete = true;
+            }
+            else if (c == 127 || c == 8)  // Backspace
+            {
+                if (!line_buffer.empty())
+                {
+                    line_buffer.pop_back();
+                    echo += "\b \b";
+                }
+            }
+            else if (c >= 32 && c < 127)  // Printable
+            {
+                line_buffer += c;
+                echo += c;
+            }
+        }
+
+        // Echo cả khối một lần thay vì flush từng ký tự
+        if (!echo.empty())
+            echo_out << echo << std::flush;
+        return line_complete;
+    }
+
+    // stdin đã kết thúc (EOF): không cần theo dõi fd nữa
+    bool isClosed() const { return closed; }
+
+private:
+    int fd;
+    std::ostream &echo_out;
+    char buf[256];
+    size_t len = 0;
+    size_t pos = 0;
+    bool closed = false;
+
+    // Terminal với VMIN > 0 chỉ trả về 0 byte khi thật sự hết dữ liệu (hangup)
+    bool rawModeActive() const
+    {
+        struct termios tio;
+        return tcgetattr(fd, &tio) == 0 && tio.c_cc[VMIN] > 0;
+    }
+};
+
+#endif // STDIN_READER_HPP
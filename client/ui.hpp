@@ -5,6 +5,8 @@
 #include <iostream>
 #include <string>
 #include <cstring>
+#include <cstdio>
+#include <ctime>
 #include <vector>
 
 #include "../libraries/tabulate.hpp"
@@ -104,7 +106,12 @@ namespace UI
         std::cout << "Chọn hành động: " << std::endl;
         std::cout << "  1. Ghép trận tự động" << std::endl;
         std::cout << "  2. Danh sách người chơi trực tuyến" << std::endl;
-        std::cout << "  3. Trở về" << std::endl;
+        std::cout << "  3. Bảng xếp hạng" << std::endl;
+        std::cout << "  4. Chơi với máy" << std::endl;
+        std::cout << "  5. Phân tích ván vừa chơi" << std::endl;
+        std::cout << "  6. Lịch sử ván đấu" << std::endl;
+        std::cout << "  7. Xem lại nước đi ván vừa chơi" << std::endl;
+        std::cout << "  8. Trở về" << std::endl;
         std::cout << "> " << std::flush;
     }
 
@@ -133,9 +140,16 @@ namespace UI
     }
 
     // Display player list
-    void displayPlayerList(const std::vector<PlayerListMessage::Player>& players, const std::string& current_user)
+    void displayPlayerList(const std::vector<PlayerListMessage::Player>& players, const std::string& current_user,
+                           uint16_t offset, uint16_t total)
     {
         std::cout << "\n========= Danh sách người chơi =========" << std::endl;
+        bool paged = total > players.size();
+        if (paged && !players.empty())
+        {
+            std::cout << "(Hiển thị " << offset + 1 << "-" << offset + players.size()
+                      << " / " << total << " người chơi online)" << std::endl;
+        }
         
         if (players.empty())
         {
@@ -154,16 +168,178 @@ namespace UI
         
         std::cout << "\n===== Lựa chọn =====" << std::endl;
         std::cout << "1. Thách đấu người chơi khác" << std::endl;
-        std::cout << "2. Quay lại" << std::endl;
+        std::cout << "2. Xem trận đấu" << std::endl;
+        std::cout << "3. Quay lại" << std::endl;
+        if (paged)
+        {
+            std::cout << "4. Trang sau" << std::endl;
+            std::cout << "5. Trang trước" << std::endl;
+        }
         std::cout << "> " << std::flush;
     }
 
+    // Display leaderboard (top hoặc quanh người chơi hiện tại)
+    void displayLeaderboard(const LeaderboardResponseMessage& message, const std::string& current_user)
+    {
+        bool around_me = message.mode == LeaderboardRequestMessage::Mode::AROUND_ME;
+        std::cout << "\n========= " << (around_me ? "Thứ hạng của bạn" : "Bảng xếp hạng")
+                  << " (" << message.total << " người chơi) =========" << std::endl;
+
+        if (message.entries.empty())
+        {
+            std::cout << "(Không có dữ liệu)" << std::endl;
+            return;
+        }
+
+        for (const auto &entry : message.entries)
+        {
+            std::string marker = (entry.username == current_user) ? " (Bạn)" : "";
+            std::cout << "  #" << entry.rank << "  " << entry.username
+                      << " (ELO: " << entry.elo << ")" << marker << std::endl;
+        }
+    }
+
+    // Display one page of match history (mới nhất trước)
+    void displayMatchHistory(const MatchHistoryResponseMessage& message, bool first_page)
+    {
+        using Outcome = MatchHistoryResponseMessage::Outcome;
+        if (message.status != MatchHistoryResponseMessage::Status::OK)
+        {
+            printErrorMessage("Không tìm thấy người chơi " + message.username + ".");
+            return;
+        }
+
+        if (first_page)
+            std::cout << "\n========= Lịch sử ván đấu của " << message.username << " ("
+                      << message.total << " ván) =========" << std::endl;
+        if (message.entries.empty())
+        {
+            std::cout << "(Chưa có ván nào)" << std::endl;
+            return;
+        }
+
+        static const char *outcomes[] = {"Thắng", "Thua", "Hòa", "Đang chơi"};
+        for (const auto &entry : message.entries)
+        {
+            char date[32] = "?";
+            std::time_t seconds = static_cast<std::time_t>(entry.start_time / 1000000000LL);
+            std::tm tm{};
+            if (seconds > 0 && localtime_r(&seconds, &tm) != nullptr)
+                std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M", &tm);
+
+            std::cout << "  " << date << "  " << (entry.color == 0 ? "Trắng" : "Đen  ")
+                      << "  vs " << entry.opponent << "  "
+                      << outcomes[static_cast<uint8_t>(entry.outcome) & 3];
+            if (!entry.reason.empty() && entry.outcome != Outcome::ONGOING)
+                std::cout << " (" << entry.reason << ")";
+            std::cout << ", " << entry.plies << " nước  [" << entry.game_id << "]" << std::endl;
+        }
+        if (message.has_more)
+            std::cout << "(Chọn 6 lần nữa để xem các ván cũ hơn)" << std::endl;
+    }
+
+    // Display one GAME_LOG chunk: thông tin chung ở chunk đầu, rồi các nước
+    void displayGameLogChunk(const GameLogMessage& chunk)
+    {
+        if (chunk.status != GameLogMessage::Status::OK)
+        {
+            printErrorMessage("Không tìm thấy ván " + chunk.game_id + ".");
+            return;
+        }
+
+        if (chunk.flags & GameLogMessage::FLAG_HEADER)
+        {
+            std::string result = chunk.winner.empty() ? "Đang chơi"
+                                 : chunk.winner == "<0>" ? "Hòa"
+                                                         : chunk.winner + " thắng";
+            std::cout << "\n========= Nhật ký ván " << chunk.game_id << " =========" << std::endl;
+            std::cout << chunk.white << " (Trắng) vs " << chunk.black << " (Đen): " << result;
+            if (!chunk.reason.empty())
+                std::cout << " (" << chunk.reason << ")";
+            std::cout << ", " << chunk.total_moves << " nước" << std::endl;
+        }
+
+        for (size_t i = 0; i < chunk.moves.size(); i++)
+        {
+            uint32_t ply = chunk.first_ply + static_cast<uint32_t>(i);
+            if (ply % 2 == 0)
+                std::cout << (ply % 16 == 0 ? "\n" : " ") << (ply / 2 + 1) << ".";
+            std::cout << " " << chunk.moves[i];
+        }
+        if (chunk.flags & GameLogMessage::FLAG_LAST)
+            std::cout << std::endl;
+        std::cout << std::flush;
+    }
+
+    // Display post-game analysis: điểm sau mỗi nước, đánh dấu nước sai
+    void displayAnalysis(const AnalysisResponseMessage& message)
+    {
+        using Status = AnalysisResponseMessage::Status;
+        if (message.status == Status::PENDING)
+        {
+            printInfoMessage("Ván đang được phân tích, hãy thử lại sau.");
+            return;
+        }
+        if (message.status != Status::READY)
+        {
+            printErrorMessage(message.status == Status::NOT_FOUND
+                                  ? "Không tìm thấy ván đã kết thúc."
+                                  : "Server không hỗ trợ phân tích lúc này.");
+            return;
+        }
+
+        static const char *marks[] = {"", "?!", "?", "??"};
+        std::cout << "\n========= Phân tích (độ sâu " << static_cast<int>(message.depth)
+                  << ") =========" << std::endl;
+        int counts[4] = {};
+        for (size_t i = 0; i < message.moves.size(); i++)
+        {
+            const auto &move = message.moves[i];
+            counts[move.judgement & 3]++;
+            char eval[16];
+            if (move.eval >= 30000 || move.eval <= -30000)
+                std::snprintf(eval, sizeof(eval), "%s#", move.eval > 0 ? "+" : "-"); // Chiếu hết
+            else
+                std::snprintf(eval, sizeof(eval), "%+.2f", move.eval / 100.0);
+            std::cout << "  " << (i / 2 + 1) << (i % 2 == 0 ? ". " : "... ") << eval
+                      << " " << marks[move.judgement & 3];
+            if (move.judgement != AnalysisResponseMessage::GOOD && !move.best_move.empty())
+                std::cout << " (tốt hơn: " << move.best_move << ")";
+            std::cout << std::endl;
+        }
+        std::cout << "Không chính xác: " << counts[1] << ", sai lầm: " << counts[2]
+                  << ", sai lầm nghiêm trọng: " << counts[3] << std::endl;
+    }
+
     // Display challenge input prompt
     void displayChallengeInputPrompt()
     {
         std::cout << "Nhập tên người chơi muốn thách đấu: " << std::flush;
     }
 
+    // Display watch input prompt
+    void displayWatchInputPrompt()
+    {
+        std::cout << "Nhập tên người chơi có trận đấu muốn xem: " << std::flush;
+    }
+
+    // Display spectator prompt
+    void displaySpectatorPrompt()
+    {
+        std::cout << "Đang xem trận đấu. Nhập 'q' để ngừng xem: " << std::flush;
+    }
+
+    // Display spectator header (keyframe)
+    void displaySpectatorHeader(const std::string& game_id, const std::string& white,
+                                const std::string& black, size_t moves_count)
+    {
+        printInfoMessage("Đang xem trận đấu!");
+        std::cout << "Game ID: " << game_id << std::endl;
+        std::cout << "White: " << white << std::endl;
+        std::cout << "Black: " << black << std::endl;
+        std::cout << "Số nước đã đi: " << moves_count << std::endl;
+    }
+
     // Display move prompt
     void displayMovePrompt()
     {
@@ -194,6 +370,19 @@ namespace UI
         board_display::printBoard(fen, flip);
     }
 
+    // Display both chess clocks (mm:ss)
+    void displayClocks(uint32_t white_time_ms, uint32_t black_time_ms)
+    {
+        auto format = [](uint32_t ms) {
+            uint32_t seconds = ms / 1000;
+            char buffer[16];
+            snprintf(buffer, sizeof(buffer), "%u:%02u", seconds / 60, seconds % 60);
+            return std::string(buffer);
+        };
+        std::cout << "Đồng hồ - White: " << format(white_time_ms)
+                  << " | Black: " << format(black_time_ms) << std::endl;
+    }
+
     // Display game start info
     void displayGameStart(const std::string& game_id, const std::string& player1, 
                           const std::string& player2, const std::string& starting_player)
@@ -13,13 +13,76 @@ namespace Const
     const uint8_t PACKET_HEADER_SIZE = 3;
     const uint8_t BACKLOG = 5;
 
+    // io_uring backend constants (bật bằng --io-backend=uring)
+    const unsigned IO_URING_ENTRIES = 256;     // Số ô SQ (CQ gấp 4 lần)
+    const unsigned IO_URING_BUFFERS = 512;     // Số bộ đệm recv dùng chung (lũy thừa của 2)
+    const unsigned IO_URING_BUFFER_SIZE = 4096; // Kích thước một bộ đệm recv
+    const uint32_t CLIENT_MAX_BACKLOG = 1024 * 1024; // Số byte tồn đọng tối đa của một client khi gửi không chặn
+    const uint32_t IO_WORKER_BATCH = 16;       // Số packet liên tiếp của một kết nối mỗi lượt xử lý
+
     // Game constants
     const uint16_t DEFAULT_ELO = 1200;
     const uint16_t DEFAULT_TIME = 300; // 5 minutes
     const uint16_t DEFAULT_INCREMENT = 5; // 5 seconds
 
+    // Engine constants (đối thủ máy, có thể đổi qua tham số dòng lệnh của server)
+    const std::string ENGINE_USERNAME = "<engine>"; // Không thể đăng ký vì bắt đầu bằng '<'
+    const uint8_t ENGINE_MAX_LEVEL = 10;     // Cấp độ n: tìm tối đa 2n nước
+    const uint32_t ENGINE_MOVE_MS = 3000;    // Thời gian tối đa cho một nước
+    const uint32_t ENGINE_HASH_MB = 32;      // Kích thước bảng chuyển vị dùng chung
+    const int ENGINE_NICE = 10;              // Luồng tìm kiếm nhường CPU cho luồng mạng
+
+    // Analysis constants (phân tích sau ván, bật bằng --analysis-depth)
+    const uint32_t ANALYSIS_THREADS = 1;       // Số luồng tìm kiếm của bộ phân tích
+    const uint32_t ANALYSIS_HASH_MB = 16;      // Bảng chuyển vị riêng của bộ phân tích
+    const int ANALYSIS_NICE = 19;              // Độ ưu tiên thấp nhất
+    const uint32_t ANALYSIS_BATCH_GAMES = 8;   // Số ván mỗi lô (một lần ghi matches.json)
+    const uint32_t ANALYSIS_QUEUE_MAX = 256;   // Số ván chờ tối đa, quá thì bỏ
+    const uint32_t ANALYSIS_BACKOFF_MS = 50;   // Chờ khi máy đang tìm nước cho ván đang chơi
+    const uint32_t ANALYSIS_POSITION_MS = 10000; // Giới hạn an toàn cho một thế cờ
+    const uint16_t ANALYSIS_MAX_PLIES = 1024;  // Chỉ phân tích tối đa chừng này nước đầu
+    const int INACCURACY_CP = 50;              // Mất từ chừng này centipawn: không chính xác
+    const int MISTAKE_CP = 100;                //   ... sai lầm
+    const int BLUNDER_CP = 300;                //   ... sai lầm nghiêm trọng
+
+    // Opening explorer constants
+    const uint16_t EXPLORER_MAX_PLIES = 40;           // Chỉ đếm chừng này nước đầu mỗi ván
+    const uint64_t EXPLORER_MIN_CAPACITY = 1 << 16;   // Số ô tối thiểu của bảng chỉ mục
+    const uint8_t EXPLORER_MAX_LINE = EXPLORER_MAX_PLIES; // Số nước tối đa trong EXPLORER_REQUEST
+
+    // Game log stream constants
+    const uint32_t GAME_LOG_CHUNK_BYTES = 4096; // Kích thước payload tối đa của một GAME_LOG chunk
+    const uint8_t GAME_LOG_WINDOW = 4;          // Số chunk chưa xác nhận mặc định
+    const uint8_t GAME_LOG_MAX_WINDOW = 16;     // Số chunk chưa xác nhận tối đa
+
+    // Timer constants
+    const uint32_t TIMER_TICK_MS = 10; // Độ phân giải của bánh xe hẹn giờ
+
+    // Reaper constants (mặc định, có thể đổi qua tham số dòng lệnh của server)
+    const uint32_t HEARTBEAT_INTERVAL_MS = 10000;   // Chu kỳ gửi PING
+    const uint32_t HEARTBEAT_TIMEOUT_MS = 30000;    // Im lặng quá lâu → ngắt kết nối
+    const uint32_t MATCH_ACCEPT_TIMEOUT_MS = 30000; // Hạn chấp nhận trận tự động
+    const uint32_t CHALLENGE_TIMEOUT_MS = 60000;    // Hạn trả lời thách đấu
+
+    // Lobby constants
+    const uint8_t PLAYER_LIST_PAGE_SIZE = 50; // Số người chơi mỗi trang PLAYER_LIST
+    const uint32_t PRESENCE_TICK_MS = 250;    // Nhịp gom và gửi PRESENCE_UPDATE
+    const uint32_t PRESENCE_MAX_BACKLOG = 64 * 1024; // Byte tồn đọng tối đa của người đăng ký
+    const uint8_t LEADERBOARD_MAX_SIZE = 100; // Số người chơi tối đa mỗi LEADERBOARD_RESPONSE
+    const uint8_t MATCH_HISTORY_PAGE_SIZE = 20; // Số ván mặc định mỗi MATCH_HISTORY_RESPONSE
+    const uint8_t MATCH_HISTORY_MAX_SIZE = 50;  // Số ván tối đa mỗi MATCH_HISTORY_RESPONSE
+
     // Matchmaking constants
     const uint16_t ELO_THRESHOLD = 300;
+
+    // Storage constants
+    const uint32_t USERS_FLUSH_MS = 1000; // Chu kỳ ghi trễ users.json sau khi Elo thay đổi
+
+    // Spectator constants
+    const uint32_t WATCHER_MAX_BACKLOG = 64 * 1024; // Số byte tồn đọng tối đa của một người xem
+
+    // Tracing constants
+    const uint32_t TRACE_SAMPLE_EVERY = 100; // Mặc định theo dõi 1 trên 100 request
 }
 
 enum class GameResult
@@ -6,6 +6,8 @@
 #include <string>       // Thư viện xử lý chuỗi ký tự
 #include <vector>       // Thư viện xử lý mảng động
 #include <memory>       // Thư viện quản lý bộ nhớ (smart pointers)
+#include <array>        // Mảng kích thước cố định
+#include <algorithm>    // std::copy
 
 #include "utils.hpp"    // File chứa các hàm tiện ích
 #include "protocol.hpp" // File định nghĩa giao thức truyền thông
@@ -49,6 +51,16 @@ inline uint16_t read_u16_be(const std::vector<uint8_t>& payload, size_t &pos)
     return v;
 }
 
+// Hàm đọc 4 bytes (uint32_t) từ payload theo định dạng Big Endian
+inline uint32_t read_u32_be(const std::vector<uint8_t>& payload, size_t &pos)
+{
+    // Đảm bảo còn đủ 4 bytes để đọc
+    ensure_available(payload, pos, 4);
+    uint32_t v = from_big_endian_32(payload, pos);
+    pos += 4;
+    return v;
+}
+
 // Hàm đọc 8 bytes (int64_t) từ payload theo định dạng Big Endian
 inline int64_t read_i64_be(const std::vector<uint8_t>& payload, size_t &pos)
 {
@@ -505,6 +517,8 @@ Cấu trúc Payload:
     - uint8_t is_game_over (1 byte): Cờ báo ván cờ kết thúc (0: chưa, 1: đã kết thúc)
     - uint8_t message_length (1 byte): Độ dài thông báo
     - char[message_length] message: Nội dung thông báo
+    - uint32_t white_time_ms (4 bytes): Thời gian còn lại của bên trắng (ms)
+    - uint32_t black_time_ms (4 bytes): Thời gian còn lại của bên đen (ms)
 */
 struct GameStatusUpdateMessage
 {
@@ -513,6 +527,8 @@ struct GameStatusUpdateMessage
     std::string current_turn_username; // Người chơi có lượt đi tiếp theo
     uint8_t is_game_over;             // 1 nếu ván cờ đã kết thúc, 0 nếu chưa
     std::string message;               // Thông báo (ví dụ: "Chiếu", "Hết giờ", v.v.)
+    uint32_t white_time_ms = 0;        // Đồng hồ bên trắng (ms)
+    uint32_t black_time_ms = 0;        // Đồng hồ bên đen (ms)
 
     MessageType getType() const
     {
@@ -541,7 +557,13 @@ struct GameStatusUpdateMessage
         // Thêm thông báo
         payload.push_back(static_cast<uint8_t>(message.size()));
         payload.insert(payload.end(), message.begin(), message.end());
-        
+
+        // Thêm đồng hồ hai bên
+        std::vector<uint8_t> white_bytes = to_big_endian_32(white_time_ms);
+        payload.insert(payload.end(), white_bytes.begin(), white_bytes.end());
+        std::vector<uint8_t> black_bytes = to_big_endian_32(black_time_ms);
+        payload.insert(payload.end(), black_bytes.begin(), black_bytes.end());
+
         return payload;
     }
 
@@ -554,6 +576,8 @@ struct GameStatusUpdateMessage
         message.current_turn_username = read_string(payload, pos);
         message.is_game_over = read_u8(payload, pos);
         message.message = read_string(payload, pos);
+        message.white_time_ms = read_u32_be(payload, pos);
+        message.black_time_ms = read_u32_be(payload, pos);
         return message;
     }
 };
@@ -823,13 +847,17 @@ struct MatchDeclinedNotificationMessage
 
 #pragma region RequestPlayerListMessage 
 // ===== MESSAGE YÊU CẦU DANH SÁCH NGƯỜI CHƠI =====
-// Được gửi từ client đến server để lấy danh sách người chơi đang online
+// Được gửi từ client đến server để lấy một trang danh sách người chơi đang online
 /*
-Cấu trúc Payload:
-    - Không có payload
+Cấu trúc Payload (không bắt buộc, payload rỗng = trang đầu, cỡ trang mặc định):
+    - uint16_t offset (2 bytes): Vị trí bắt đầu của trang
+    - uint8_t limit (1 byte): Số người chơi tối đa trong trang (0 = mặc định)
 */
 struct RequestPlayerListMessage
 {
+    uint16_t offset = 0;
+    uint8_t limit = 0;
+
     MessageType getType() const
     {
         return MessageType::REQUEST_PLAYER_LIST;
@@ -837,13 +865,21 @@ struct RequestPlayerListMessage
 
     std::vector<uint8_t> serialize() const
     {
-        return {}; // Không có dữ liệu payload
+        std::vector<uint8_t> payload = to_big_endian_16(offset);
+        payload.push_back(limit);
+        return payload;
     }
 
     static RequestPlayerListMessage deserialize(const std::vector<uint8_t> &payload)
     {
-        // Không có dữ liệu để deserialize
-        return RequestPlayerListMessage();
+        RequestPlayerListMessage message;
+        if (payload.empty())
+            return message; // Client cũ: không có tham số phân trang
+
+        size_t pos = 0;
+        message.offset = read_u16_be(payload, pos);
+        message.limit = read_u8(payload, pos);
+        return message;
     }
 };
 #pragma endregion RequestPlayerListMessage
@@ -853,7 +889,7 @@ struct RequestPlayerListMessage
 // Được gửi từ server đến client để cung cấp danh sách người chơi
 /*
 Cấu trúc Payload:
-    - uint8_t number_of_players (1 byte): Số lượng người chơi
+    - uint8_t number_of_players (1 byte): Số lượng người chơi trong trang
     - [Player 1][Player 2]... (danh sách người chơi)
 
 Cấu trúc mỗi Player:
@@ -864,6 +900,10 @@ Cấu trúc mỗi Player:
     - Nếu in_game = 1:
         - uint8_t game_id_length (1 byte): Độ dài ID ván cờ
         - char[game_id_length] game_id: ID ván cờ đang chơi
+
+Sau danh sách (server gửi danh sách theo trang, sắp xếp theo username):
+    - uint16_t offset (2 bytes): Vị trí của người chơi đầu tiên trong trang
+    - uint16_t total (2 bytes): Tổng số người chơi online
 */
 struct PlayerListMessage
 {
@@ -876,13 +916,49 @@ struct PlayerListMessage
         std::string game_id;  // ID ván cờ (nếu đang chơi)
     };
 
-    std::vector<Player> players;  // Danh sách người chơi
+    std::vector<Player> players;  // Danh sách người chơi (một trang)
+    uint16_t offset = 0;          // Vị trí của trang trong danh sách đầy đủ
+    uint16_t total = 0;           // Tổng số người chơi online
 
     MessageType getType() const
     {
         return MessageType::PLAYER_LIST;
     }
 
+    // Mã hóa một người chơi (server dùng lại để lưu sẵn bytes của từng người)
+    static void serializePlayer(std::vector<uint8_t> &payload, const Player &player)
+    {
+        // Thêm tên người chơi
+        payload.push_back(static_cast<uint8_t>(player.username.size()));
+        payload.insert(payload.end(), player.username.begin(), player.username.end());
+
+        // Thêm Elo (2 bytes, Big Endian)
+        std::vector<uint8_t> elo_bytes = to_big_endian_16(player.elo);
+        payload.insert(payload.end(), elo_bytes.begin(), elo_bytes.end());
+
+        // Thêm cờ in_game
+        payload.push_back(static_cast<uint8_t>(player.in_game));
+
+        // Nếu đang chơi, thêm game_id
+        if (player.in_game) {
+            payload.push_back(static_cast<uint8_t>(player.game_id.size()));
+            payload.insert(payload.end(), player.game_id.begin(), player.game_id.end());
+        }
+    }
+
+    static Player deserializePlayer(const std::vector<uint8_t> &payload, size_t &pos)
+    {
+        Player player;
+        player.username = read_string(payload, pos);
+        player.elo = read_u16_be(payload, pos);
+        player.in_game = static_cast<bool>(read_u8(payload, pos));
+        // Nếu đang chơi, đọc game_id
+        if (player.in_game) {
+            player.game_id = read_string(payload, pos);
+        }
+        return player;
+    }
+
     std::vector<uint8_t> serialize() const
     {
         std::vector<uint8_t> payload;
@@ -892,24 +968,15 @@ struct PlayerListMessage
         // Lặp qua từng người chơi
         for (const auto &player : players)
         {
-            // Thêm tên người chơi
-            payload.push_back(static_cast<uint8_t>(player.username.size()));
-            payload.insert(payload.end(), player.username.begin(), player.username.end());
-
-            // Thêm Elo (2 bytes, Big Endian)
-            std::vector<uint8_t> elo_bytes = to_big_endian_16(player.elo);
-            payload.insert(payload.end(), elo_bytes.begin(), elo_bytes.end());
-
-            // Thêm cờ in_game
-            payload.push_back(static_cast<uint8_t>(player.in_game));
-            
-            // Nếu đang chơi, thêm game_id
-            if (player.in_game) {
-                payload.push_back(static_cast<uint8_t>(player.game_id.size()));
-                payload.insert(payload.end(), player.game_id.begin(), player.game_id.end());
-            }
+            serializePlayer(payload, player);
         }
 
+        // Thông tin phân trang
+        std::vector<uint8_t> offset_bytes = to_big_endian_16(offset);
+        payload.insert(payload.end(), offset_bytes.begin(), offset_bytes.end());
+        std::vector<uint8_t> total_bytes = to_big_endian_16(total);
+        payload.insert(payload.end(), total_bytes.begin(), total_bytes.end());
+
         return payload;
     }
 
@@ -923,21 +990,415 @@ struct PlayerListMessage
         // Lặp qua từng người chơi
         for (uint8_t i = 0; i < number_of_players; ++i)
         {
-            Player player;
-            player.username = read_string(payload, pos);
-            player.elo = read_u16_be(payload, pos);
-            player.in_game = static_cast<bool>(read_u8(payload, pos));
-            // Nếu đang chơi, đọc game_id
-            if (player.in_game) {
-                player.game_id = read_string(payload, pos);
-            }
-            message.players.push_back(player);
+            message.players.push_back(deserializePlayer(payload, pos));
+        }
+
+        // Server cũ không gửi thông tin phân trang
+        if (pos < payload.size())
+        {
+            message.offset = read_u16_be(payload, pos);
+            message.total = read_u16_be(payload, pos);
+        }
+        else
+        {
+            message.total = static_cast<uint16_t>(message.players.size());
         }
         return message;
     }
 };
 #pragma endregion PlayerListMessage
 
+#pragma region SubscribePresenceMessage
+// ===== MESSAGE ĐĂNG KÝ NHẬN THAY ĐỔI SẢNH CHỜ =====
+// Được gửi từ client đến server để bật/tắt nhận PRESENCE_UPDATE
+/*
+Cấu trúc Payload:
+    - uint8_t subscribe (1 byte): 1 = đăng ký, 0 = hủy đăng ký
+*/
+struct SubscribePresenceMessage
+{
+    bool subscribe = true;
+
+    MessageType getType() const
+    {
+        return MessageType::SUBSCRIBE_PRESENCE;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        return {static_cast<uint8_t>(subscribe)};
+    }
+
+    static SubscribePresenceMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        SubscribePresenceMessage message;
+        size_t pos = 0;
+        message.subscribe = read_u8(payload, pos) != 0;
+        return message;
+    }
+};
+#pragma endregion SubscribePresenceMessage
+
+#pragma region PresenceUpdateMessage
+// ===== MESSAGE THAY ĐỔI SẢNH CHỜ =====
+// Server gom các thay đổi trong một nhịp và gửi cho client đã đăng ký
+/*
+Cấu trúc Payload:
+    - uint16_t number_of_events (2 bytes): Số sự kiện
+    - [Event 1][Event 2]...
+
+Cấu trúc mỗi Event:
+    - uint8_t kind (1 byte): Loại thay đổi (PresenceUpdateMessage::Kind)
+    - Player (như trong PLAYER_LIST): Trạng thái của người chơi sau thay đổi
+*/
+struct PresenceUpdateMessage
+{
+    enum class Kind : uint8_t
+    {
+        JOINED = 0,         // Người chơi vừa online
+        LEFT = 1,           // Người chơi vừa offline
+        GAME_STARTED = 2,   // Vào ván (game_id trong Player)
+        GAME_ENDED = 3,     // Ra khỏi ván
+        RATING_CHANGED = 4  // Elo thay đổi
+    };
+
+    struct Event
+    {
+        Kind kind;
+        PlayerListMessage::Player player;
+    };
+
+    std::vector<Event> events;
+
+    MessageType getType() const
+    {
+        return MessageType::PRESENCE_UPDATE;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload = to_big_endian_16(static_cast<uint16_t>(events.size()));
+        for (const auto &event : events)
+        {
+            payload.push_back(static_cast<uint8_t>(event.kind));
+            PlayerListMessage::serializePlayer(payload, event.player);
+        }
+        return payload;
+    }
+
+    static PresenceUpdateMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        PresenceUpdateMessage message;
+        size_t pos = 0;
+        uint16_t number_of_events = read_u16_be(payload, pos);
+        for (uint16_t i = 0; i < number_of_events; ++i)
+        {
+            Event event;
+            event.kind = static_cast<Kind>(read_u8(payload, pos));
+            event.player = PlayerListMessage::deserializePlayer(payload, pos);
+            message.events.push_back(event);
+        }
+        return message;
+    }
+};
+#pragma endregion PresenceUpdateMessage
+
+#pragma region LeaderboardRequestMessage
+// ===== MESSAGE YÊU CẦU BẢNG XẾP HẠNG =====
+// Được gửi từ client đến server
+/*
+Cấu trúc Payload:
+    - uint8_t mode (1 byte): 0 = top, 1 = quanh người chơi hiện tại
+    - uint8_t limit (1 byte): Số người chơi muốn nhận (0 = mặc định)
+*/
+struct LeaderboardRequestMessage
+{
+    enum class Mode : uint8_t
+    {
+        TOP = 0,       // Những người có Elo cao nhất
+        AROUND_ME = 1  // Cửa sổ quanh người chơi đã đăng nhập
+    };
+
+    Mode mode = Mode::TOP;
+    uint8_t limit = 0;
+
+    MessageType getType() const
+    {
+        return MessageType::LEADERBOARD_REQUEST;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        return {static_cast<uint8_t>(mode), limit};
+    }
+
+    static LeaderboardRequestMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        LeaderboardRequestMessage message;
+        size_t pos = 0;
+        message.mode = static_cast<Mode>(read_u8(payload, pos));
+        message.limit = read_u8(payload, pos);
+        return message;
+    }
+};
+#pragma endregion LeaderboardRequestMessage
+
+#pragma region LeaderboardResponseMessage
+// ===== MESSAGE BẢNG XẾP HẠNG =====
+// Được gửi từ server đến client, sắp xếp theo Elo giảm dần
+/*
+Cấu trúc Payload:
+    - uint8_t mode (1 byte): Như trong LEADERBOARD_REQUEST
+    - uint32_t total (4 bytes): Tổng số người chơi đã đăng ký
+    - uint8_t number_of_entries (1 byte)
+    - [Entry 1][Entry 2]...
+
+Cấu trúc mỗi Entry:
+    - uint32_t rank (4 bytes): Thứ hạng (cùng Elo thì cùng hạng)
+    - uint8_t username_length (1 byte) + char[username_length] username
+    - uint16_t elo (2 bytes)
+*/
+struct LeaderboardResponseMessage
+{
+    struct Entry
+    {
+        uint32_t rank;
+        std::string username;
+        uint16_t elo;
+    };
+
+    LeaderboardRequestMessage::Mode mode = LeaderboardRequestMessage::Mode::TOP;
+    uint32_t total = 0;
+    std::vector<Entry> entries;
+
+    MessageType getType() const
+    {
+        return MessageType::LEADERBOARD_RESPONSE;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload;
+        payload.push_back(static_cast<uint8_t>(mode));
+        std::vector<uint8_t> total_bytes = to_big_endian_32(total);
+        payload.insert(payload.end(), total_bytes.begin(), total_bytes.end());
+        payload.push_back(static_cast<uint8_t>(entries.size()));
+
+        for (const auto &entry : entries)
+        {
+            std::vector<uint8_t> rank_bytes = to_big_endian_32(entry.rank);
+            payload.insert(payload.end(), rank_bytes.begin(), rank_bytes.end());
+            payload.push_back(static_cast<uint8_t>(entry.username.size()));
+            payload.insert(payload.end(), entry.username.begin(), entry.username.end());
+            std::vector<uint8_t> elo_bytes = to_big_endian_16(entry.elo);
+            payload.insert(payload.end(), elo_bytes.begin(), elo_bytes.end());
+        }
+        return payload;
+    }
+
+    static LeaderboardResponseMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        LeaderboardResponseMessage message;
+        size_t pos = 0;
+        message.mode = static_cast<LeaderboardRequestMessage::Mode>(read_u8(payload, pos));
+        message.total = read_u32_be(payload, pos);
+        uint8_t number_of_entries = read_u8(payload, pos);
+
+        for (uint8_t i = 0; i < number_of_entries; ++i)
+        {
+            Entry entry;
+            entry.rank = read_u32_be(payload, pos);
+            entry.username = read_string(payload, pos);
+            entry.elo = read_u16_be(payload, pos);
+            message.entries.push_back(entry);
+        }
+        return message;
+    }
+};
+#pragma endregion LeaderboardResponseMessage
+
+#pragma region MatchHistoryRequestMessage
+// ===== MESSAGE YÊU CẦU LỊCH SỬ VÁN ĐẤU =====
+// Được gửi từ client đến server. Trang tiếp theo được lấy bằng con trỏ
+// (next_time, next_id) của trang trước.
+/*
+Cấu trúc Payload:
+    - uint8_t username_length (1 byte) + char[username_length] username: Rỗng = người chơi hiện tại
+    - uint8_t limit (1 byte): Số ván muốn nhận (0 = mặc định)
+    - int64_t cursor_time (8 bytes): Thời điểm bắt đầu (ns) của ván cuối trang trước
+    - uint8_t cursor_id_length (1 byte) + char[cursor_id_length] cursor_id: Rỗng = từ ván mới nhất
+*/
+struct MatchHistoryRequestMessage
+{
+    std::string username;
+    uint8_t limit = 0;
+    int64_t cursor_time = 0;
+    std::string cursor_id;
+
+    MessageType getType() const
+    {
+        return MessageType::MATCH_HISTORY_REQUEST;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload;
+        payload.push_back(static_cast<uint8_t>(username.size()));
+        payload.insert(payload.end(), username.begin(), username.end());
+        payload.push_back(limit);
+        for (int i = 7; i >= 0; i--)
+        {
+            payload.push_back(static_cast<uint8_t>((cursor_time >> (i * 8)) & 0xFF));
+        }
+        payload.push_back(static_cast<uint8_t>(cursor_id.size()));
+        payload.insert(payload.end(), cursor_id.begin(), cursor_id.end());
+        return payload;
+    }
+
+    static MatchHistoryRequestMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        MatchHistoryRequestMessage message;
+        size_t pos = 0;
+        message.username = read_string(payload, pos);
+        message.limit = read_u8(payload, pos);
+        message.cursor_time = read_i64_be(payload, pos);
+        message.cursor_id = read_string(payload, pos);
+        return message;
+    }
+};
+#pragma endregion MatchHistoryRequestMessage
+
+#pragma region MatchHistoryResponseMessage
+// ===== MESSAGE LỊCH SỬ VÁN ĐẤU =====
+// Được gửi từ server đến client, ván mới nhất trước
+/*
+Cấu trúc Payload:
+    - uint8_t status (1 byte): 0 = OK, 1 = NOT_FOUND (không có người chơi)
+    - uint8_t username_length (1 byte) + char[username_length] username
+    - uint32_t total (4 bytes): Tổng số ván của người chơi
+    - uint8_t number_of_entries (1 byte)
+    - [Entry 1][Entry 2]...
+    - uint8_t has_more (1 byte): 1 nếu còn ván cũ hơn
+    - int64_t next_time (8 bytes) + uint8_t next_id_length (1 byte) + char[next_id_length] next_id:
+      Con trỏ cho trang tiếp theo
+
+Cấu trúc mỗi Entry:
+    - uint8_t game_id_length (1 byte) + char[game_id_length] game_id
+    - uint8_t opponent_length (1 byte) + char[opponent_length] opponent
+    - uint8_t color (1 byte): 0 = trắng, 1 = đen
+    - uint8_t outcome (1 byte): 0 = thắng, 1 = thua, 2 = hòa, 3 = đang chơi
+    - uint8_t reason_length (1 byte) + char[reason_length] reason
+    - int64_t start_time (8 bytes): Thời gian bắt đầu (ns)
+    - uint16_t plies (2 bytes): Số nước đã đi
+*/
+struct MatchHistoryResponseMessage
+{
+    enum class Status : uint8_t
+    {
+        OK = 0,
+        NOT_FOUND = 1
+    };
+
+    enum class Outcome : uint8_t
+    {
+        WIN = 0,
+        LOSS = 1,
+        DRAW = 2,
+        ONGOING = 3
+    };
+
+    struct Entry
+    {
+        std::string game_id;
+        std::string opponent;
+        uint8_t color;  // 0 = trắng, 1 = đen
+        Outcome outcome;
+        std::string reason;
+        int64_t start_time;
+        uint16_t plies;
+    };
+
+    Status status = Status::OK;
+    std::string username;
+    uint32_t total = 0;
+    std::vector<Entry> entries;
+    bool has_more = false;
+    int64_t next_time = 0;
+    std::string next_id;
+
+    MessageType getType() const
+    {
+        return MessageType::MATCH_HISTORY_RESPONSE;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload;
+        payload.push_back(static_cast<uint8_t>(status));
+        payload.push_back(static_cast<uint8_t>(username.size()));
+        payload.insert(payload.end(), username.begin(), username.end());
+        std::vector<uint8_t> total_bytes = to_big_endian_32(total);
+        payload.insert(payload.end(), total_bytes.begin(), total_bytes.end());
+
+        payload.push_back(static_cast<uint8_t>(entries.size()));
+        for (const auto &entry : entries)
+        {
+            payload.push_back(static_cast<uint8_t>(entry.game_id.size()));
+            payload.insert(payload.end(), entry.game_id.begin(), entry.game_id.end());
+            payload.push_back(static_cast<uint8_t>(entry.opponent.size()));
+            payload.insert(payload.end(), entry.opponent.begin(), entry.opponent.end());
+            payload.push_back(entry.color);
+            payload.push_back(static_cast<uint8_t>(entry.outcome));
+            payload.push_back(static_cast<uint8_t>(entry.reason.size()));
+            payload.insert(payload.end(), entry.reason.begin(), entry.reason.end());
+            for (int i = 7; i >= 0; i--)
+            {
+                payload.push_back(static_cast<uint8_t>((entry.start_time >> (i * 8)) & 0xFF));
+            }
+            std::vector<uint8_t> plies_bytes = to_big_endian_16(entry.plies);
+            payload.insert(payload.end(), plies_bytes.begin(), plies_bytes.end());
+        }
+
+        payload.push_back(has_more ? 1 : 0);
+        for (int i = 7; i >= 0; i--)
+        {
+            payload.push_back(static_cast<uint8_t>((next_time >> (i * 8)) & 0xFF));
+        }
+        payload.push_back(static_cast<uint8_t>(next_id.size()));
+        payload.insert(payload.end(), next_id.begin(), next_id.end());
+        return payload;
+    }
+
+    static MatchHistoryResponseMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        MatchHistoryResponseMessage message;
+        size_t pos = 0;
+        message.status = static_cast<Status>(read_u8(payload, pos));
+        message.username = read_string(payload, pos);
+        message.total = read_u32_be(payload, pos);
+        uint8_t number_of_entries = read_u8(payload, pos);
+
+        for (uint8_t i = 0; i < number_of_entries; ++i)
+        {
+            Entry entry;
+            entry.game_id = read_string(payload, pos);
+            entry.opponent = read_string(payload, pos);
+            entry.color = read_u8(payload, pos);
+            entry.outcome = static_cast<Outcome>(read_u8(payload, pos));
+            entry.reason = read_string(payload, pos);
+            entry.start_time = read_i64_be(payload, pos);
+            entry.plies = read_u16_be(payload, pos);
+            message.entries.push_back(entry);
+        }
+
+        message.has_more = read_u8(payload, pos) != 0;
+        message.next_time = read_i64_be(payload, pos);
+        message.next_id = read_string(payload, pos);
+        return message;
+    }
+};
+#pragma endregion MatchHistoryResponseMessage
+
 // ===== CÁC MESSAGE LIÊN QUAN ĐẾN THÁCH ĐẤU =====
 
 #pragma region ChallengeRequestMessage
@@ -1171,6 +1632,48 @@ struct SurrenderMessage
 };
 #pragma endregion SurrenderMessage
 
+#pragma region PlayVsEngineMessage
+// ===== MESSAGE CHƠI VỚI MÁY =====
+// Được gửi từ client đến server; server trả lời bằng GAME_START (máy có tên
+// Const::ENGINE_USERNAME) hoặc CHALLENGE_ERROR
+/*
+Cấu trúc Payload:
+    - uint8_t color (1 byte): Màu quân của người chơi, 0 = trắng, 1 = đen, 2 = ngẫu nhiên
+    - uint8_t level (1 byte): Cấp độ của máy 1..Const::ENGINE_MAX_LEVEL (0 = mạnh nhất)
+*/
+struct PlayVsEngineMessage
+{
+    enum class Color : uint8_t
+    {
+        WHITE = 0,
+        BLACK = 1,
+        RANDOM = 2
+    };
+
+    Color color = Color::RANDOM;
+    uint8_t level = 0;
+
+    MessageType getType() const
+    {
+        return MessageType::PLAY_VS_ENGINE;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        return {static_cast<uint8_t>(color), level};
+    }
+
+    static PlayVsEngineMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        PlayVsEngineMessage message;
+        size_t pos = 0;
+        message.color = static_cast<Color>(read_u8(payload, pos));
+        message.level = read_u8(payload, pos);
+        return message;
+    }
+};
+#pragma endregion PlayVsEngineMessage
+
 #pragma region ChallengeErrorMessage
 // ===== MESSAGE LỖI THÁCH ĐẤU =====
 // Được gửi từ server đến client để thông báo yêu cầu thách đấu không hợp lệ
@@ -1213,90 +1716,147 @@ struct ChallengeErrorMessage
 };
 #pragma endregion ChallengeErrorMessage
 
-#pragma region GameLogMessage
-// ===== MESSAGE NHẬT KÝ VÁN ĐẤU =====
-// Được gửi từ server đến cả 2 client sau khi ván cờ kết thúc để cung cấp lịch sử ván đấu
+#pragma region GameLogRequestMessage
+// ===== MESSAGE YÊU CẦU NHẬT KÝ VÁN ĐẤU =====
+// Được gửi từ client đến server để nhận nhật ký một ván (đã kết thúc hoặc
+// đang chơi) dưới dạng các GAME_LOG chunk
 /*
 Cấu trúc Payload:
-    - uint8_t game_id_length (1 byte): Độ dài ID ván cờ
-    - char[game_id_length] game_id: ID ván cờ
-    - uint64_t start_time (8 bytes): Thời gian bắt đầu (epoch time tính bằng nanoseconds)
-    - uint64_t end_time (8 bytes): Thời gian kết thúc (epoch time tính bằng nanoseconds)
-    - uint8_t white_ip_length (1 byte): Độ dài IP quân trắng
-    - char[white_ip_length] white_ip: Địa chỉ IP người chơi quân trắng
-    - uint8_t black_ip_length (1 byte): Độ dài IP quân đen
-    - char[black_ip_length] black_ip: Địa chỉ IP người chơi quân đen
-    - uint8_t winner_length (1 byte): Độ dài tên người thắng
-    - char[winner_length] winner: Tên người thắng
-    - uint8_t reason_length (1 byte): Độ dài lý do kết thúc
-    - char[reason_length] reason: Lý do kết thúc
-    - uint16_t moves_count (2 bytes): Số lượng nước đi
-    - [Move 1][Move 2]... (danh sách các nước đi)
-    
-Cấu trúc mỗi Move:
-    - uint8_t uci_move_length (1 byte): Độ dài nước đi UCI
-    - char[uci_move_length] uci_move: Nước đi theo định dạng UCI
+    - uint8_t game_id_length (1 byte) + char[game_id_length] game_id
+    - uint8_t window (1 byte): Số chunk tối đa server được gửi trước khi nhận GAME_LOG_ACK (0 = mặc định)
 */
-struct GameLogMessage
+struct GameLogRequestMessage
 {
-    std::string game_id;                 // ID ván cờ
-    int64_t start_time;                  // Thời gian bắt đầu
-    int64_t end_time;                    // Thời gian kết thúc
-    std::string white_ip;                // IP người chơi quân trắng
-    std::string black_ip;                // IP người chơi quân đen
-    std::string winner;                  // Tên người thắng
-    std::string reason;                  // Lý do kết thúc
-    std::vector<std::string> moves;      // Danh sách các nước đi
+    std::string game_id;
+    uint8_t window = 0;
 
     MessageType getType() const
     {
-        return MessageType::GAME_LOG;
+        return MessageType::GAME_LOG_REQUEST;
     }
 
     std::vector<uint8_t> serialize() const
     {
         std::vector<uint8_t> payload;
-
-        // Thêm game_id
         payload.push_back(static_cast<uint8_t>(game_id.size()));
         payload.insert(payload.end(), game_id.begin(), game_id.end());
+        payload.push_back(window);
+        return payload;
+    }
 
-        // Thêm start_time (8 bytes, Big Endian)
-        // Lặp từ byte cao nhất đến byte thấp nhất
-        for (int i = 7; i >= 0; i--)
-        {
-            // Dịch phải i*8 bit và lấy byte thấp nhất
-            payload.push_back(static_cast<uint8_t>((start_time >> (i * 8)) & 0xFF));
-        }
+    static GameLogRequestMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        GameLogRequestMessage message;
+        size_t pos = 0;
+        message.game_id = read_string(payload, pos);
+        message.window = read_u8(payload, pos);
+        return message;
+    }
+};
+#pragma endregion GameLogRequestMessage
 
-        // Thêm end_time (8 bytes, Big Endian)
-        for (int i = 7; i >= 0; i--)
-        {
-            payload.push_back(static_cast<uint8_t>((end_time >> (i * 8)) & 0xFF));
-        }
+#pragma region GameLogMessage
+// ===== MESSAGE NHẬT KÝ VÁN ĐẤU (MỘT CHUNK) =====
+// Được gửi từ server đến client theo GAME_LOG_REQUEST. Nhật ký được chia thành
+// các chunk có payload không quá Const::GAME_LOG_CHUNK_BYTES; chunk đầu tiên
+// mang thông tin chung của ván, chunk cuối có cờ LAST.
+/*
+Cấu trúc Payload:
+    - uint8_t game_id_length (1 byte) + char[game_id_length] game_id
+    - uint8_t status (1 byte): 0 = OK, 1 = NOT_FOUND (khi đó là chunk duy nhất)
+    - uint32_t seq (4 bytes): Số thứ tự chunk, bắt đầu từ 0
+    - uint8_t flags (1 byte): 0x01 = HEADER (có phần thông tin chung), 0x02 = LAST
+    - Nếu có HEADER:
+        - int64_t start_time (8 bytes), int64_t end_time (8 bytes): Epoch time (ns)
+        - white, black, white_ip, black_ip, winner, reason: Mỗi chuỗi 1 byte độ dài + nội dung
+        - uint32_t total_moves (4 bytes): Tổng số nước của ván
+    - uint32_t first_ply (4 bytes): Chỉ số (từ 0) của nước đầu tiên trong chunk
+    - uint16_t moves_count (2 bytes)
+    - [Move 1][Move 2]...
+
+Cấu trúc mỗi Move:
+    - uint8_t uci_move_length (1 byte) + char[uci_move_length] uci_move
+*/
+struct GameLogMessage
+{
+    enum class Status : uint8_t
+    {
+        OK = 0,
+        NOT_FOUND = 1
+    };
+
+    static const uint8_t FLAG_HEADER = 0x01;
+    static const uint8_t FLAG_LAST = 0x02;
+
+    std::string game_id;                 // ID ván cờ
+    Status status = Status::OK;
+    uint32_t seq = 0;
+    uint8_t flags = 0;
+
+    // Thông tin chung (chỉ có khi flags & FLAG_HEADER)
+    int64_t start_time = 0;              // Thời gian bắt đầu
+    int64_t end_time = 0;                // Thời gian kết thúc
+    std::string white;                   // Người chơi quân trắng
+    std::string black;                   // Người chơi quân đen
+    std::string white_ip;                // IP người chơi quân trắng
+    std::string black_ip;                // IP người chơi quân đen
+    std::string winner;                  // Tên người thắng
+    std::string reason;                  // Lý do kết thúc
+    uint32_t total_moves = 0;
 
-        // Thêm white_ip
-        payload.push_back(static_cast<uint8_t>(white_ip.size()));
-        payload.insert(payload.end(), white_ip.begin(), white_ip.end());
+    uint32_t first_ply = 0;
+    std::vector<std::string> moves;      // Các nước đi trong chunk
 
-        // Thêm black_ip
-        payload.push_back(static_cast<uint8_t>(black_ip.size()));
-        payload.insert(payload.end(), black_ip.begin(), black_ip.end());
+    MessageType getType() const
+    {
+        return MessageType::GAME_LOG;
+    }
 
-        // Thêm winner
-        payload.push_back(static_cast<uint8_t>(winner.size()));
-        payload.insert(payload.end(), winner.begin(), winner.end());
+    // Số byte payload khi chưa có nước đi nào
+    size_t baseSize() const
+    {
+        size_t size = 1 + game_id.size() + 1 + 4 + 1 + 4 + 2;
+        if (flags & FLAG_HEADER)
+            size += 16 + 6 + white.size() + black.size() + white_ip.size() + black_ip.size() +
+                    winner.size() + reason.size() + 4;
+        return size;
+    }
 
-        // Thêm reason
-        payload.push_back(static_cast<uint8_t>(reason.size()));
-        payload.insert(payload.end(), reason.begin(), reason.end());
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload;
+        payload.reserve(baseSize() + moves.size() * 6);
 
-        // Thêm moves_count (2 bytes, Big Endian)
-        uint16_t moves_count = static_cast<uint16_t>(moves.size());
-        payload.push_back(static_cast<uint8_t>((moves_count >> 8) & 0xFF));  // Byte cao
-        payload.push_back(static_cast<uint8_t>(moves_count & 0xFF));         // Byte thấp
+        payload.push_back(static_cast<uint8_t>(game_id.size()));
+        payload.insert(payload.end(), game_id.begin(), game_id.end());
+        payload.push_back(static_cast<uint8_t>(status));
+        std::vector<uint8_t> seq_bytes = to_big_endian_32(seq);
+        payload.insert(payload.end(), seq_bytes.begin(), seq_bytes.end());
+        payload.push_back(flags);
+
+        if (flags & FLAG_HEADER)
+        {
+            // start_time, end_time (8 bytes mỗi giá trị, Big Endian)
+            for (int64_t time : {start_time, end_time})
+            {
+                for (int i = 7; i >= 0; i--)
+                {
+                    payload.push_back(static_cast<uint8_t>((time >> (i * 8)) & 0xFF));
+                }
+            }
+            for (const std::string *text : {&white, &black, &white_ip, &black_ip, &winner, &reason})
+            {
+                payload.push_back(static_cast<uint8_t>(text->size()));
+                payload.insert(payload.end(), text->begin(), text->end());
+            }
+            std::vector<uint8_t> total_bytes = to_big_endian_32(total_moves);
+            payload.insert(payload.end(), total_bytes.begin(), total_bytes.end());
+        }
 
-        // Thêm từng nước đi
+        std::vector<uint8_t> ply_bytes = to_big_endian_32(first_ply);
+        payload.insert(payload.end(), ply_bytes.begin(), ply_bytes.end());
+        std::vector<uint8_t> count_bytes = to_big_endian_16(static_cast<uint16_t>(moves.size()));
+        payload.insert(payload.end(), count_bytes.begin(), count_bytes.end());
         for (const auto &move : moves)
         {
             payload.push_back(static_cast<uint8_t>(move.size()));
@@ -1309,65 +1869,586 @@ struct GameLogMessage
     static GameLogMessage deserialize(const std::vector<uint8_t> &payload)
     {
         GameLogMessage message;
+        size_t pos = 0;
+        message.game_id = read_string(payload, pos);
+        message.status = static_cast<Status>(read_u8(payload, pos));
+        message.seq = read_u32_be(payload, pos);
+        message.flags = read_u8(payload, pos);
+
+        if (message.flags & FLAG_HEADER)
+        {
+            message.start_time = read_i64_be(payload, pos);
+            message.end_time = read_i64_be(payload, pos);
+            message.white = read_string(payload, pos);
+            message.black = read_string(payload, pos);
+            message.white_ip = read_string(payload, pos);
+            message.black_ip = read_string(payload, pos);
+            message.winner = read_string(payload, pos);
+            message.reason = read_string(payload, pos);
+            message.total_moves = read_u32_be(payload, pos);
+        }
+
+        message.first_ply = read_u32_be(payload, pos);
+        uint16_t moves_count = read_u16_be(payload, pos);
+        for (uint16_t i = 0; i < moves_count; i++)
+        {
+            message.moves.push_back(read_string(payload, pos));
+        }
+
+        return message;
+    }
+};
+#pragma endregion GameLogMessage
+
+#pragma region GameLogAckMessage
+// ===== MESSAGE XÁC NHẬN CHUNK NHẬT KÝ =====
+// Được gửi từ client đến server: đã nhận mọi chunk tới seq, server được gửi
+// tiếp để số chunk chưa xác nhận không vượt quá window
+/*
+Cấu trúc Payload:
+    - uint8_t game_id_length (1 byte) + char[game_id_length] game_id
+    - uint32_t seq (4 bytes): Chunk cuối cùng đã nhận
+*/
+struct GameLogAckMessage
+{
+    std::string game_id;
+    uint32_t seq = 0;
+
+    MessageType getType() const
+    {
+        return MessageType::GAME_LOG_ACK;
+    }
 
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload;
+        payload.push_back(static_cast<uint8_t>(game_id.size()));
+        payload.insert(payload.end(), game_id.begin(), game_id.end());
+        std::vector<uint8_t> seq_bytes = to_big_endian_32(seq);
+        payload.insert(payload.end(), seq_bytes.begin(), seq_bytes.end());
+        return payload;
+    }
+
+    static GameLogAckMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        GameLogAckMessage message;
         size_t pos = 0;
+        message.game_id = read_string(payload, pos);
+        message.seq = read_u32_be(payload, pos);
+        return message;
+    }
+};
+#pragma endregion GameLogAckMessage
+
+// ===== CÁC MESSAGE LIÊN QUAN ĐẾN PHÂN TÍCH VÁN ĐẤU =====
 
-        // Đọc game_id
-        uint8_t game_id_length = payload[pos++];
-        message.game_id = std::string(payload.begin() + pos, payload.begin() + pos + game_id_length);
-        pos += game_id_length;
+#pragma region AnalysisRequestMessage
+// ===== MESSAGE YÊU CẦU PHÂN TÍCH =====
+// Được gửi từ client đến server để lấy đánh giá từng nước của một ván đã kết thúc
+/*
+Cấu trúc Payload:
+    - uint8_t game_id_length (1 byte) + char[game_id_length] game_id
+*/
+struct AnalysisRequestMessage
+{
+    std::string game_id;
+
+    MessageType getType() const
+    {
+        return MessageType::ANALYSIS_REQUEST;
+    }
 
-        // Đọc start_time (8 bytes, Big Endian)
-        message.start_time = 0;
-        for (int i = 0; i < 8; i++)
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload;
+        payload.push_back(static_cast<uint8_t>(game_id.size()));
+        payload.insert(payload.end(), game_id.begin(), game_id.end());
+        return payload;
+    }
+
+    static AnalysisRequestMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        AnalysisRequestMessage message;
+        size_t pos = 0;
+        message.game_id = read_string(payload, pos);
+        return message;
+    }
+};
+#pragma endregion AnalysisRequestMessage
+
+#pragma region AnalysisResponseMessage
+// ===== MESSAGE KẾT QUẢ PHÂN TÍCH =====
+// Được gửi từ server đến client. Chỉ có danh sách nước đi khi status = READY;
+// PENDING nghĩa là ván đang chờ phân tích, client có thể hỏi lại sau.
+/*
+Cấu trúc Payload:
+    - uint8_t game_id_length (1 byte) + char[game_id_length] game_id
+    - uint8_t status (1 byte): 0 = READY, 1 = PENDING, 2 = NOT_FOUND, 3 = UNAVAILABLE
+    - uint8_t depth (1 byte): Độ sâu tìm kiếm đã dùng
+    - uint16_t moves_count (2 bytes)
+    - [Move 1][Move 2]...
+
+Cấu trúc mỗi Move (theo thứ tự nước đi trong GAME_LOG):
+    - int16_t eval (2 bytes): Điểm sau nước đi, centipawn theo góc nhìn bên trắng
+      (|eval| gần 31000 là chiếu hết)
+    - uint8_t judgement (1 byte): 0 = tốt, 1 = không chính xác, 2 = sai lầm, 3 = sai lầm nghiêm trọng
+    - uint8_t best_move_length (1 byte) + char[best_move_length] best_move: Nước máy
+      chọn ở thế cờ trước nước đi (UCI)
+*/
+struct AnalysisResponseMessage
+{
+    enum class Status : uint8_t
+    {
+        READY = 0,       // Đã phân tích
+        PENDING = 1,     // Đang chờ hoặc đang phân tích
+        NOT_FOUND = 2,   // Không có ván đã kết thúc với ID này
+        UNAVAILABLE = 3  // Server không bật phân tích hoặc hàng đợi đầy
+    };
+
+    enum Judgement : uint8_t
+    {
+        GOOD = 0,
+        INACCURACY = 1,
+        MISTAKE = 2,
+        BLUNDER = 3
+    };
+
+    struct Move
+    {
+        int16_t eval;
+        uint8_t judgement;
+        std::string best_move;
+    };
+
+    std::string game_id;
+    Status status = Status::NOT_FOUND;
+    uint8_t depth = 0;
+    std::vector<Move> moves;
+
+    MessageType getType() const
+    {
+        return MessageType::ANALYSIS_RESPONSE;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload;
+        payload.push_back(static_cast<uint8_t>(game_id.size()));
+        payload.insert(payload.end(), game_id.begin(), game_id.end());
+        payload.push_back(static_cast<uint8_t>(status));
+        payload.push_back(depth);
+
+        std::vector<uint8_t> count_bytes = to_big_endian_16(static_cast<uint16_t>(moves.size()));
+        payload.insert(payload.end(), count_bytes.begin(), count_bytes.end());
+        for (const auto &move : moves)
+        {
+            std::vector<uint8_t> eval_bytes = to_big_endian_16(static_cast<uint16_t>(move.eval));
+            payload.insert(payload.end(), eval_bytes.begin(), eval_bytes.end());
+            payload.push_back(move.judgement);
+            payload.push_back(static_cast<uint8_t>(move.best_move.size()));
+            payload.insert(payload.end(), move.best_move.begin(), move.best_move.end());
+        }
+        return payload;
+    }
+
+    static AnalysisResponseMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        AnalysisResponseMessage message;
+        size_t pos = 0;
+        message.game_id = read_string(payload, pos);
+        message.status = static_cast<Status>(read_u8(payload, pos));
+        message.depth = read_u8(payload, pos);
+        uint16_t moves_count = read_u16_be(payload, pos);
+
+        for (uint16_t i = 0; i < moves_count; ++i)
         {
-            // Dịch trái 8 bit và OR với byte hiện tại
-            message.start_time = (message.start_time << 8) | payload[pos++];
+            Move move;
+            move.eval = static_cast<int16_t>(read_u16_be(payload, pos));
+            move.judgement = read_u8(payload, pos);
+            move.best_move = read_string(payload, pos);
+            message.moves.push_back(move);
         }
+        return message;
+    }
+};
+#pragma endregion AnalysisResponseMessage
+
+#pragma region ExplorerRequestMessage
+// ===== MESSAGE TRA CỨU KHAI CUỘC =====
+// Được gửi từ client đến server để lấy thống kê các nước đã được chơi từ một thế cờ.
+// Thế cờ được cho bằng chuỗi nước đi từ thế cờ ban đầu (không có nước nào = thế cờ ban đầu).
+/*
+Cấu trúc Payload:
+    - uint8_t moves_count (1 byte)
+    - [uint8_t move_length + char[move_length] move]...: Các nước đi (UCI)
+*/
+struct ExplorerRequestMessage
+{
+    std::vector<std::string> moves;
 
-        // Đọc end_time (8 bytes, Big Endian)
-        message.end_time = 0;
-        for (int i = 0; i < 8; i++)
+    MessageType getType() const
+    {
+        return MessageType::EXPLORER_REQUEST;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload;
+        payload.push_back(static_cast<uint8_t>(moves.size()));
+        for (const auto &move : moves)
         {
-            message.end_time = (message.end_time << 8) | payload[pos++];
+            payload.push_back(static_cast<uint8_t>(move.size()));
+            payload.insert(payload.end(), move.begin(), move.end());
         }
+        return payload;
+    }
 
-        // Đọc white_ip
-        uint8_t white_ip_length = payload[pos++];
-        message.white_ip = std::string(payload.begin() + pos, payload.begin() + pos + white_ip_length);
-        pos += white_ip_length;
+    static ExplorerRequestMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        ExplorerRequestMessage message;
+        size_t pos = 0;
+        uint8_t moves_count = read_u8(payload, pos);
+        for (uint8_t i = 0; i < moves_count; ++i)
+        {
+            message.moves.push_back(read_string(payload, pos));
+        }
+        return message;
+    }
+};
+#pragma endregion ExplorerRequestMessage
+
+#pragma region ExplorerResponseMessage
+// ===== MESSAGE KẾT QUẢ TRA CỨU KHAI CUỘC =====
+// Được gửi từ server đến client, các nước được sắp theo số ván giảm dần.
+/*
+Cấu trúc Payload:
+    - uint8_t status (1 byte): 0 = OK, 1 = INVALID_LINE (chuỗi nước đi không hợp lệ)
+    - uint32_t games (4 bytes): Tổng số ván trong chỉ mục
+    - uint8_t moves_count (1 byte)
+    - [Move 1][Move 2]...
 
-        // Đọc black_ip
-        uint8_t black_ip_length = payload[pos++];
-        message.black_ip = std::string(payload.begin() + pos, payload.begin() + pos + black_ip_length);
-        pos += black_ip_length;
+Cấu trúc mỗi Move:
+    - uint8_t move_length (1 byte) + char[move_length] move: Nước đi (UCI)
+    - uint32_t white (4 bytes): Số ván trắng thắng sau nước này
+    - uint32_t draws (4 bytes): Số ván hòa
+    - uint32_t black (4 bytes): Số ván đen thắng
+*/
+struct ExplorerResponseMessage
+{
+    enum class Status : uint8_t
+    {
+        OK = 0,
+        INVALID_LINE = 1
+    };
 
-        // Đọc winner
-        uint8_t winner_length = payload[pos++];
-        message.winner = std::string(payload.begin() + pos, payload.begin() + pos + winner_length);
-        pos += winner_length;
+    struct Move
+    {
+        std::string move;
+        uint32_t white;
+        uint32_t draws;
+        uint32_t black;
+    };
 
-        // Đọc reason
-        uint8_t reason_length = payload[pos++];
-        message.reason = std::string(payload.begin() + pos, payload.begin() + pos + reason_length);
-        pos += reason_length;
+    Status status = Status::OK;
+    uint32_t games = 0;
+    std::vector<Move> moves;
 
-        // Đọc moves_count (2 bytes, Big Endian)
-        // Byte cao << 8 | Byte thấp
-        uint16_t moves_count = (static_cast<uint16_t>(payload[pos]) << 8) | static_cast<uint16_t>(payload[pos + 1]);
-        pos += 2;
+    MessageType getType() const
+    {
+        return MessageType::EXPLORER_RESPONSE;
+    }
 
-        // Đọc từng nước đi
-        for (uint16_t i = 0; i < moves_count; i++)
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload;
+        payload.push_back(static_cast<uint8_t>(status));
+        std::vector<uint8_t> games_bytes = to_big_endian_32(games);
+        payload.insert(payload.end(), games_bytes.begin(), games_bytes.end());
+
+        payload.push_back(static_cast<uint8_t>(moves.size()));
+        for (const auto &move : moves)
         {
-            uint8_t move_length = payload[pos++];
-            message.moves.push_back(std::string(payload.begin() + pos, payload.begin() + pos + move_length));
-            pos += move_length;
+            payload.push_back(static_cast<uint8_t>(move.move.size()));
+            payload.insert(payload.end(), move.move.begin(), move.move.end());
+            for (uint32_t count : {move.white, move.draws, move.black})
+            {
+                std::vector<uint8_t> count_bytes = to_big_endian_32(count);
+                payload.insert(payload.end(), count_bytes.begin(), count_bytes.end());
+            }
         }
+        return payload;
+    }
+
+    static ExplorerResponseMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        ExplorerResponseMessage message;
+        size_t pos = 0;
+        message.status = static_cast<Status>(read_u8(payload, pos));
+        message.games = read_u32_be(payload, pos);
+        uint8_t moves_count = read_u8(payload, pos);
 
+        for (uint8_t i = 0; i < moves_count; ++i)
+        {
+            Move move;
+            move.move = read_string(payload, pos);
+            move.white = read_u32_be(payload, pos);
+            move.draws = read_u32_be(payload, pos);
+            move.black = read_u32_be(payload, pos);
+            message.moves.push_back(move);
+        }
         return message;
     }
 };
-#pragma endregion GameLogMessage
+#pragma endregion ExplorerResponseMessage
+
+// ===== CÁC MESSAGE LIÊN QUAN ĐẾN XEM TRẬN ĐẤU =====
+
+#pragma region WatchGameMessage
+// ===== MESSAGE YÊU CẦU XEM TRẬN ĐẤU =====
+// Được gửi từ client đến server để theo dõi một ván cờ đang diễn ra
+/*
+Cấu trúc Payload:
+    - uint8_t game_id_length (1 byte): Độ dài ID ván cờ
+    - char[game_id_length] game_id: ID ván cờ
+*/
+struct WatchGameMessage
+{
+    std::string game_id;  // ID ván cờ muốn xem
+
+    MessageType getType() const
+    {
+        return MessageType::WATCH_GAME;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload;
+
+        payload.push_back(static_cast<uint8_t>(game_id.size()));
+        payload.insert(payload.end(), game_id.begin(), game_id.end());
+
+        return payload;
+    }
+
+    static WatchGameMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        WatchGameMessage message;
+        size_t pos = 0;
+        message.game_id = read_string(payload, pos);
+        return message;
+    }
+};
+#pragma endregion WatchGameMessage
+
+#pragma region UnwatchGameMessage
+// ===== MESSAGE NGỪNG XEM TRẬN ĐẤU =====
+// Được gửi từ client đến server để ngừng theo dõi ván cờ
+/*
+Cấu trúc Payload:
+    - uint8_t game_id_length (1 byte): Độ dài ID ván cờ
+    - char[game_id_length] game_id: ID ván cờ
+*/
+struct UnwatchGameMessage
+{
+    std::string game_id;  // ID ván cờ đang xem
+
+    MessageType getType() const
+    {
+        return MessageType::UNWATCH_GAME;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload;
+
+        payload.push_back(static_cast<uint8_t>(game_id.size()));
+        payload.insert(payload.end(), game_id.begin(), game_id.end());
+
+        return payload;
+    }
+
+    static UnwatchGameMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        UnwatchGameMessage message;
+        size_t pos = 0;
+        message.game_id = read_string(payload, pos);
+        return message;
+    }
+};
+#pragma endregion UnwatchGameMessage
+
+#pragma region GameKeyframeMessage
+// ===== MESSAGE KEYFRAME VÁN CỜ =====
+// Được gửi từ server đến người xem khi bắt đầu xem (hoặc khi người xem bị tụt lại
+// quá xa): chứa toàn bộ trạng thái để dựng lại ván cờ, sau đó người xem chỉ nhận
+// các GAME_STATUS_UPDATE như người chơi.
+/*
+Cấu trúc Payload:
+    - uint8_t game_id_length (1 byte): Độ dài ID ván cờ
+    - char[game_id_length] game_id: ID ván cờ
+    - uint8_t white_username_length (1 byte): Độ dài tên quân trắng
+    - char[white_username_length] white_username: Tên người chơi quân trắng
+    - uint8_t black_username_length (1 byte): Độ dài tên quân đen
+    - char[black_username_length] black_username: Tên người chơi quân đen
+    - uint8_t packed_board[24] (24 bytes): Bàn cờ nén (chess::PackedBoard)
+    - uint16_t moves_count (2 bytes): Số lượng nước đi
+    - [Move 1][Move 2]... (mỗi nước: 1 byte độ dài + chuỗi UCI)
+*/
+struct GameKeyframeMessage
+{
+    static constexpr size_t PACKED_BOARD_SIZE = 24;
+
+    std::string game_id;                                 // ID ván cờ
+    std::string white_username;                          // Người chơi quân trắng
+    std::string black_username;                          // Người chơi quân đen
+    std::array<uint8_t, PACKED_BOARD_SIZE> packed_board; // Bàn cờ hiện tại (nén)
+    std::vector<std::string> moves;                      // Các nước đã đi (UCI)
+
+    MessageType getType() const
+    {
+        return MessageType::GAME_KEYFRAME;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload;
+
+        payload.push_back(static_cast<uint8_t>(game_id.size()));
+        payload.insert(payload.end(), game_id.begin(), game_id.end());
+
+        payload.push_back(static_cast<uint8_t>(white_username.size()));
+        payload.insert(payload.end(), white_username.begin(), white_username.end());
+
+        payload.push_back(static_cast<uint8_t>(black_username.size()));
+        payload.insert(payload.end(), black_username.begin(), black_username.end());
+
+        // Bàn cờ nén có độ dài cố định
+        payload.insert(payload.end(), packed_board.begin(), packed_board.end());
+
+        // Thêm moves_count (2 bytes, Big Endian) và từng nước đi
+        std::vector<uint8_t> count_bytes = to_big_endian_16(static_cast<uint16_t>(moves.size()));
+        payload.insert(payload.end(), count_bytes.begin(), count_bytes.end());
+        for (const auto &move : moves)
+        {
+            payload.push_back(static_cast<uint8_t>(move.size()));
+            payload.insert(payload.end(), move.begin(), move.end());
+        }
+
+        return payload;
+    }
+
+    static GameKeyframeMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        GameKeyframeMessage message;
+        size_t pos = 0;
+        message.game_id = read_string(payload, pos);
+        message.white_username = read_string(payload, pos);
+        message.black_username = read_string(payload, pos);
+
+        ensure_available(payload, pos, PACKED_BOARD_SIZE);
+        std::copy(payload.begin() + pos, payload.begin() + pos + PACKED_BOARD_SIZE,
+                  message.packed_board.begin());
+        pos += PACKED_BOARD_SIZE;
+
+        uint16_t moves_count = read_u16_be(payload, pos);
+        for (uint16_t i = 0; i < moves_count; ++i)
+        {
+            message.moves.push_back(read_string(payload, pos));
+        }
+        return message;
+    }
+};
+#pragma endregion GameKeyframeMessage
+
+#pragma region WatchErrorMessage
+// ===== MESSAGE LỖI XEM TRẬN ĐẤU =====
+// Được gửi từ server đến client khi không thể xem ván cờ (không tồn tại, đã kết thúc...)
+/*
+Cấu trúc Payload:
+    - uint8_t error_message_length (1 byte): Độ dài thông báo lỗi
+    - char[error_message_length] error_message: Nội dung thông báo lỗi
+*/
+struct WatchErrorMessage
+{
+    std::string error_message;  // Thông báo lỗi
+
+    MessageType getType() const
+    {
+        return MessageType::WATCH_ERROR;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> payload;
+
+        payload.push_back(static_cast<uint8_t>(error_message.size()));
+        payload.insert(payload.end(), error_message.begin(), error_message.end());
+
+        return payload;
+    }
+
+    static WatchErrorMessage deserialize(const std::vector<uint8_t> &payload)
+    {
+        WatchErrorMessage message;
+        size_t pos = 0;
+        message.error_message = read_string(payload, pos);
+        return message;
+    }
+};
+#pragma endregion WatchErrorMessage
+
+#pragma region PingMessage
+// ===== MESSAGE HEARTBEAT (PING) =====
+// Được server gửi định kỳ để kiểm tra client còn sống
+/*
+Cấu trúc Payload:
+    - Không có payload
+*/
+struct PingMessage
+{
+    MessageType getType() const
+    {
+        return MessageType::PING;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        return {}; // Không có dữ liệu payload
+    }
+
+    static PingMessage deserialize([[maybe_unused]] const std::vector<uint8_t> &payload)
+    {
+        // Không có dữ liệu để deserialize
+        return PingMessage();
+    }
+};
+#pragma endregion PingMessage
+
+#pragma region PongMessage
+// ===== MESSAGE HEARTBEAT (PONG) =====
+// Được client gửi để trả lời PING
+/*
+Cấu trúc Payload:
+    - Không có payload
+*/
+struct PongMessage
+{
+    MessageType getType() const
+    {
+        return MessageType::PONG;
+    }
+
+    std::vector<uint8_t> serialize() const
+    {
+        return {}; // Không có dữ liệu payload
+    }
+
+    static PongMessage deserialize([[maybe_unused]] const std::vector<uint8_t> &payload)
+    {
+        // Không có dữ liệu để deserialize
+        return PongMessage();
+    }
+};
+#pragma endregion PongMessage
 
 #endif // MESSAGE_HPP
\ No newline at end of file
@@ -13,6 +13,10 @@ enum class MessageType : uint8_t {
   TEST = 0x00,     // Dùng để kiểm tra kết nối
   RESPONSE = 0x01, // Phản hồi chung
 
+  // Heartbeat
+  PING = 0x02, // Server kiểm tra client còn sống
+  PONG = 0x03, // Client trả lời PING
+
   // Register
   REGISTER = 0x10,         // Client gửi yêu cầu đăng ký tài khoản
   REGISTER_SUCCESS = 0x11, // Server phản hồi đăng ký thành công
@@ -26,6 +30,16 @@ enum class MessageType : uint8_t {
   // Player list
   REQUEST_PLAYER_LIST = 0x30, // Client yêu cầu danh sách người chơi online
   PLAYER_LIST = 0x31,         // Server gửi danh sách người chơi
+  SUBSCRIBE_PRESENCE = 0x32,  // Client bật/tắt nhận thay đổi sảnh chờ
+  PRESENCE_UPDATE = 0x33,     // Server gửi các thay đổi sảnh chờ (theo nhịp)
+
+  // Leaderboard
+  LEADERBOARD_REQUEST = 0x34,  // Client yêu cầu bảng xếp hạng (top / quanh mình)
+  LEADERBOARD_RESPONSE = 0x35, // Server gửi bảng xếp hạng
+
+  // Match history
+  MATCH_HISTORY_REQUEST = 0x36,  // Client yêu cầu một trang lịch sử ván đấu
+  MATCH_HISTORY_RESPONSE = 0x37, // Server gửi trang lịch sử (mới nhất trước)
 
   // Game
   GAME_START = 0x40,   // Server thông báo bắt đầu ván cờ
@@ -35,6 +49,11 @@ enum class MessageType : uint8_t {
       0x43,         // Server cập nhật trạng thái ván cờ (FEN, lượt đi...)
   GAME_END = 0x44,  // Server thông báo kết thúc ván cờ
   SURRENDER = 0x45, // Client xin đầu hàng
+  PLAY_VS_ENGINE = 0x47, // Client yêu cầu chơi với máy của server
+  ANALYSIS_REQUEST = 0x48,  // Client yêu cầu phân tích một ván đã kết thúc
+  ANALYSIS_RESPONSE = 0x49, // Server gửi đánh giá từng nước (hoặc trạng thái)
+  EXPLORER_REQUEST = 0x4A,  // Client tra cứu thống kê khai cuộc của một thế cờ
+  EXPLORER_RESPONSE = 0x4B, // Server gửi các nước đã chơi và kết quả
 
   // Challenge
   CHALLENGE_REQUEST = 0x50, // Client gửi lời mời thách đấu
@@ -53,10 +72,73 @@ enum class MessageType : uint8_t {
       0x59, // Server thông báo đối thủ đã từ chối
 
   // Additional
-  CHALLENGE_ERROR = 0x5B, // Lỗi trong quá trình thách đấu
-  GAME_LOG = 0x46         // Ghi log ván đấu
+  CHALLENGE_ERROR = 0x5B,  // Lỗi trong quá trình thách đấu
+  GAME_LOG = 0x46,         // Server gửi một chunk nhật ký ván đấu
+  GAME_LOG_REQUEST = 0x4C, // Client yêu cầu nhật ký một ván (theo chunk)
+  GAME_LOG_ACK = 0x4D,     // Client xác nhận đã nhận chunk, mở thêm cửa sổ gửi
+
+  // Spectator
+  WATCH_GAME = 0x60,    // Client yêu cầu xem một ván cờ đang diễn ra
+  UNWATCH_GAME = 0x61,  // Client ngừng xem ván cờ
+  GAME_KEYFRAME = 0x62, // Server gửi toàn bộ trạng thái ván cờ cho người xem
+  WATCH_ERROR = 0x63    // Server thông báo không thể xem ván cờ
 };
 
+// Tên của loại thông điệp (dùng cho log, metrics), nullptr nếu không xác định
+inline const char *messageTypeName(MessageType type) {
+  switch (type) {
+  case MessageType::TEST: return "TEST";
+  case MessageType::RESPONSE: return "RESPONSE";
+  case MessageType::PING: return "PING";
+  case MessageType::PONG: return "PONG";
+  case MessageType::REGISTER: return "REGISTER";
+  case MessageType::REGISTER_SUCCESS: return "REGISTER_SUCCESS";
+  case MessageType::REGISTER_FAILURE: return "REGISTER_FAILURE";
+  case MessageType::LOGIN: return "LOGIN";
+  case MessageType::LOGIN_SUCCESS: return "LOGIN_SUCCESS";
+  case MessageType::LOGIN_FAILURE: return "LOGIN_FAILURE";
+  case MessageType::REQUEST_PLAYER_LIST: return "REQUEST_PLAYER_LIST";
+  case MessageType::PLAYER_LIST: return "PLAYER_LIST";
+  case MessageType::SUBSCRIBE_PRESENCE: return "SUBSCRIBE_PRESENCE";
+  case MessageType::PRESENCE_UPDATE: return "PRESENCE_UPDATE";
+  case MessageType::LEADERBOARD_REQUEST: return "LEADERBOARD_REQUEST";
+  case MessageType::LEADERBOARD_RESPONSE: return "LEADERBOARD_RESPONSE";
+  case MessageType::MATCH_HISTORY_REQUEST: return "MATCH_HISTORY_REQUEST";
+  case MessageType::MATCH_HISTORY_RESPONSE: return "MATCH_HISTORY_RESPONSE";
+  case MessageType::GAME_START: return "GAME_START";
+  case MessageType::MOVE: return "MOVE";
+  case MessageType::INVALID_MOVE: return "INVALID_MOVE";
+  case MessageType::GAME_STATUS_UPDATE: return "GAME_STATUS_UPDATE";
+  case MessageType::GAME_END: return "GAME_END";
+  case MessageType::SURRENDER: return "SURRENDER";
+  case MessageType::PLAY_VS_ENGINE: return "PLAY_VS_ENGINE";
+  case MessageType::ANALYSIS_REQUEST: return "ANALYSIS_REQUEST";
+  case MessageType::ANALYSIS_RESPONSE: return "ANALYSIS_RESPONSE";
+  case MessageType::EXPLORER_REQUEST: return "EXPLORER_REQUEST";
+  case MessageType::EXPLORER_RESPONSE: return "EXPLORER_RESPONSE";
+  case MessageType::CHALLENGE_REQUEST: return "CHALLENGE_REQUEST";
+  case MessageType::CHALLENGE_NOTIFICATION: return "CHALLENGE_NOTIFICATION";
+  case MessageType::CHALLENGE_RESPONSE: return "CHALLENGE_RESPONSE";
+  case MessageType::CHALLENGE_ACCEPTED: return "CHALLENGE_ACCEPTED";
+  case MessageType::CHALLENGE_DECLINED: return "CHALLENGE_DECLINED";
+  case MessageType::AUTO_MATCH_REQUEST: return "AUTO_MATCH_REQUEST";
+  case MessageType::AUTO_MATCH_FOUND: return "AUTO_MATCH_FOUND";
+  case MessageType::AUTO_MATCH_ACCEPTED: return "AUTO_MATCH_ACCEPTED";
+  case MessageType::AUTO_MATCH_DECLINED: return "AUTO_MATCH_DECLINED";
+  case MessageType::AUTO_MATCH_DECLINED_NOTIFICATION:
+    return "AUTO_MATCH_DECLINED_NOTIFICATION";
+  case MessageType::CHALLENGE_ERROR: return "CHALLENGE_ERROR";
+  case MessageType::GAME_LOG: return "GAME_LOG";
+  case MessageType::GAME_LOG_REQUEST: return "GAME_LOG_REQUEST";
+  case MessageType::GAME_LOG_ACK: return "GAME_LOG_ACK";
+  case MessageType::WATCH_GAME: return "WATCH_GAME";
+  case MessageType::UNWATCH_GAME: return "UNWATCH_GAME";
+  case MessageType::GAME_KEYFRAME: return "GAME_KEYFRAME";
+  case MessageType::WATCH_ERROR: return "WATCH_ERROR";
+  }
+  return nullptr;
+}
+
 // Cấu trúc gói tin cơ bản
 // +---------+-----------+------------------+
 // |  type   |  length   |     payload      |
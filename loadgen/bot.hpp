@@ -0,0 +1,252 @@
+// BOT_HPP - Một người chơi giả lập của load generator
+
+#ifndef BOT_HPP
+#define BOT_HPP
+
+// Thư viện chuẩn C++
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Thư viện hệ thống
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Thư viện dự án
+#include "../chess_engine/chess.hpp"
+#include "../common/const.hpp"
+#include "../common/message.hpp"
+#include "../common/protocol.hpp"
+#include "load_stats.hpp"
+
+// Trạng thái của một bot
+enum class BotState {
+  CONNECTING,     // Đang chờ connect() non-blocking hoàn tất
+  REGISTERING,    // Đã gửi REGISTER
+  LOGGING_IN,     // Username đã tồn tại, đã gửi LOGIN
+  QUEUED,         // Đã gửi AUTO_MATCH_REQUEST, chờ đối thủ
+  WAITING_START,  // Đã chấp nhận trận, chờ GAME_START
+  PLAYING,        // Đang chơi
+  CLOSED          // Đã đóng kết nối
+};
+
+/**
+ * @brief Một kết nối giả lập người chơi.
+ *
+ * Bot chỉ xử lý dữ liệu và trạng thái; vòng lặp epoll trong loadgen_main.cpp
+ * lo việc chờ socket và hẹn giờ "suy nghĩ" trước mỗi nước đi.
+ * Vòng đời: REGISTER (hoặc LOGIN nếu đã tồn tại) → AUTO_MATCH_REQUEST →
+ * AUTO_MATCH_ACCEPTED → đi các nước hợp lệ ngẫu nhiên → GAME_END → xếp hàng
+ * lại.
+ */
+class Bot {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  int fd = -1;
+  std::string username;
+  BotState state = BotState::CONNECTING;
+
+  std::vector<uint8_t> inbuf;  // Dữ liệu nhận chưa đủ một packet
+  std::vector<uint8_t> outbuf; // Dữ liệu chờ gửi khi socket đầy
+
+  std::string game_id;
+  chess::Board board;
+  bool plays_white = false;        // Mỗi ván chỉ được đếm một lần (bên trắng)
+  bool move_due = false;           // Đến lượt, chờ hết thời gian suy nghĩ
+  bool awaiting_update = false;    // Đã gửi MOVE, chờ GAME_STATUS_UPDATE
+  Clock::time_point move_sent_at;
+
+  explicit Bot(const std::string &name) : username(name) {}
+
+  // Đóng khung và xếp một message vào outbuf (caller gọi flush())
+  template <typename Message> void queue(const Message &message) {
+    std::vector<uint8_t> payload = message.serialize();
+    Packet packet;
+    packet.type = message.getType();
+    packet.length = htons(static_cast<uint16_t>(payload.size()));
+    packet.payload = payload;
+    std::vector<uint8_t> bytes = packet.serialize();
+    outbuf.insert(outbuf.end(), bytes.begin(), bytes.end());
+  }
+
+  /**
+   * @brief Ghi outbuf ra socket (non-blocking).
+   * @return false nếu socket lỗi.
+   */
+  bool flush() {
+    while (!outbuf.empty()) {
+      ssize_t sent = send(fd, outbuf.data(), outbuf.size(), MSG_NOSIGNAL);
+      if (sent < 0) {
+        if (errno == EINTR)
+          continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+      }
+      outbuf.erase(outbuf.begin(), outbuf.begin() + sent);
+    }
+    return true;
+  }
+
+  // Kết nối TCP đã sẵn sàng: bắt đầu đăng ký
+  void onConnected() {
+    RegisterMessage msg;
+    msg.username = username;
+    queue(msg);
+    state = BotState::REGISTERING;
+  }
+
+  /**
+   * @brief Tách một packet hoàn chỉnh từ inbuf (nếu có).
+   */
+  bool nextPacket(Packet &packet) {
+    if (inbuf.size() < Const::PACKET_HEADER_SIZE)
+      return false;
+    uint16_t length = ntohs(static_cast<uint16_t>(
+        (static_cast<uint16_t>(inbuf[1]) << 8) | inbuf[2]));
+    if (inbuf.size() < Const::PACKET_HEADER_SIZE + static_cast<size_t>(length))
+      return false;
+
+    packet.type = static_cast<MessageType>(inbuf[0]);
+    packet.length = length;
+    packet.payload.assign(inbuf.begin() + Const::PACKET_HEADER_SIZE,
+                          inbuf.begin() + Const::PACKET_HEADER_SIZE + length);
+    inbuf.erase(inbuf.begin(),
+                inbuf.begin() + Const::PACKET_HEADER_SIZE + length);
+    return true;
+  }
+
+  /**
+   * @brief Xử lý một packet từ server.
+   * Có thể ném std::runtime_error nếu payload hỏng (caller đếm protocol error).
+   */
+  void onPacket(const Packet &packet, LoadStats &stats) {
+    switch (packet.type) {
+    case MessageType::PING:
+      queue(PongMessage());
+      break;
+
+    case MessageType::REGISTER_SUCCESS:
+    case MessageType::LOGIN_SUCCESS:
+      stats.auth_ok++;
+      requestMatch();
+      break;
+
+    case MessageType::REGISTER_FAILURE: {
+      // Username đã có từ lần chạy trước → đăng nhập
+      LoginMessage msg;
+      msg.username = username;
+      queue(msg);
+      state = BotState::LOGGING_IN;
+      break;
+    }
+
+    case MessageType::LOGIN_FAILURE:
+      stats.auth_failures++;
+      state = BotState::CLOSED;
+      break;
+
+    case MessageType::AUTO_MATCH_FOUND: {
+      AutoMatchFoundMessage found =
+          AutoMatchFoundMessage::deserialize(packet.payload);
+      AutoMatchAcceptedMessage accept;
+      accept.game_id = found.game_id;
+      queue(accept);
+      state = BotState::WAITING_START;
+      break;
+    }
+
+    case MessageType::AUTO_MATCH_DECLINED_NOTIFICATION:
+      stats.match_declines++;
+      requestMatch();
+      break;
+
+    case MessageType::GAME_START: {
+      GameStartMessage start = GameStartMessage::deserialize(packet.payload);
+      game_id = start.game_id;
+      board.setFen(start.fen);
+      state = BotState::PLAYING;
+      awaiting_update = false;
+      plays_white = (start.starting_player_username == username);
+      move_due = plays_white;
+      if (plays_white)
+        stats.games_started++;
+      break;
+    }
+
+    case MessageType::GAME_STATUS_UPDATE: {
+      GameStatusUpdateMessage update =
+          GameStatusUpdateMessage::deserialize(packet.payload);
+      if (update.game_id != game_id)
+        break;
+
+      // Cập nhật đầu tiên sau khi gửi MOVE chính là kết quả của nước đó
+      if (awaiting_update) {
+        auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - move_sent_at);
+        stats.move_rtt_us.push_back(static_cast<uint32_t>(rtt.count()));
+        awaiting_update = false;
+      }
+
+      board.setFen(update.fen);
+      move_due = !update.is_game_over &&
+                 update.current_turn_username == username;
+      break;
+    }
+
+    case MessageType::INVALID_MOVE:
+      stats.invalid_moves++;
+      awaiting_update = false;
+      move_due = true; // Thử nước khác
+      break;
+
+    case MessageType::GAME_END:
+      if (plays_white)
+        stats.games_finished++;
+      plays_white = false;
+      game_id.clear();
+      move_due = false;
+      awaiting_update = false;
+      requestMatch();
+      break;
+
+    default:
+      break; // GAME_LOG, PLAYER_LIST... không cần xử lý
+    }
+  }
+
+  /**
+   * @brief Đi một nước hợp lệ ngẫu nhiên (gọi khi move_due và hết thời gian
+   * suy nghĩ).
+   */
+  void playRandomMove(std::mt19937 &rng, LoadStats &stats) {
+    move_due = false;
+
+    chess::Movelist moves;
+    chess::movegen::legalmoves(moves, board);
+    if (moves.empty())
+      return; // Ván cờ đã kết thúc, GAME_END sẽ đến
+
+    std::uniform_int_distribution<int> pick(0, moves.size() - 1);
+    MoveMessage msg;
+    msg.game_id = game_id;
+    msg.uci_move = chess::uci::moveToUci(moves[pick(rng)]);
+    queue(msg);
+
+    stats.moves_sent++;
+    awaiting_update = true;
+    move_sent_at = Clock::now();
+  }
+
+private:
+  void requestMatch() {
+    AutoMatchRequestMessage msg;
+    msg.username = username;
+    queue(msg);
+    state = BotState::QUEUED;
+  }
+};
+
+#endif // BOT_HPP
@@ -0,0 +1,93 @@
+// LOAD_STATS_HPP - Thống kê của load generator
+
+#ifndef LOAD_STATS_HPP
+#define LOAD_STATS_HPP
+
+// Thư viện chuẩn C++
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/**
+ * @brief Bộ đếm và mẫu độ trễ của một lần chạy loadgen.
+ *
+ * Loadgen chạy một luồng nên không cần khóa. Độ trễ nước đi (round-trip từ lúc
+ * gửi MOVE đến lúc nhận GAME_STATUS_UPDATE tương ứng) được giữ nguyên từng mẫu
+ * (micro giây) và chỉ sắp xếp một lần khi in báo cáo.
+ */
+struct LoadStats {
+  uint64_t connects_ok = 0;       // Kết nối TCP thành công
+  uint64_t connect_failures = 0;  // Kết nối TCP thất bại
+  uint64_t auth_ok = 0;           // Đăng ký/đăng nhập thành công
+  uint64_t auth_failures = 0;     // Đăng nhập thất bại
+  uint64_t games_started = 0;     // GAME_START nhận được
+  uint64_t games_finished = 0;    // GAME_END nhận được
+  uint64_t moves_sent = 0;        // MOVE đã gửi
+  uint64_t invalid_moves = 0;     // INVALID_MOVE nhận được
+  uint64_t match_declines = 0;    // Trận tự động bị hủy/từ chối
+  uint64_t disconnects = 0;       // Server đóng kết nối ngoài ý muốn
+  uint64_t protocol_errors = 0;   // Gói tin không giải mã được
+  std::vector<uint32_t> move_rtt_us; // Độ trễ round-trip của từng nước đi
+
+  double connect_phase_s = 0; // Thời gian mở hết các kết nối
+
+  static uint32_t percentile(const std::vector<uint32_t> &sorted, double p) {
+    if (sorted.empty())
+      return 0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+  }
+
+  // Một dòng tiến độ (in định kỳ trong lúc chạy)
+  void printProgress(double elapsed_s, size_t open_connections) const {
+    std::printf("[%6.1fs] conn=%zu auth=%llu games=%llu/%llu moves=%llu "
+                "errors=%llu\n",
+                elapsed_s, open_connections,
+                static_cast<unsigned long long>(auth_ok),
+                static_cast<unsigned long long>(games_finished),
+                static_cast<unsigned long long>(games_started),
+                static_cast<unsigned long long>(moves_sent),
+                static_cast<unsigned long long>(errorCount()));
+    std::fflush(stdout);
+  }
+
+  uint64_t errorCount() const {
+    return connect_failures + auth_failures + invalid_moves + disconnects +
+           protocol_errors;
+  }
+
+  // Báo cáo cuối cùng
+  void printSummary(double elapsed_s) {
+    std::sort(move_rtt_us.begin(), move_rtt_us.end());
+
+    auto ull = [](uint64_t v) { return static_cast<unsigned long long>(v); };
+    double connects_per_s =
+        connect_phase_s > 0 ? connects_ok / connect_phase_s : 0.0;
+    double moves_per_s = elapsed_s > 0 ? moves_sent / elapsed_s : 0.0;
+
+    std::printf("\n========= Loadgen summary =========\n");
+    std::printf("Duration:          %.1f s\n", elapsed_s);
+    std::printf("Connects:          %llu ok, %llu failed (%.1f connects/s)\n",
+                ull(connects_ok), ull(connect_failures), connects_per_s);
+    std::printf("Auth:              %llu ok, %llu failed\n", ull(auth_ok),
+                ull(auth_failures));
+    std::printf("Games:             %llu started, %llu finished, %llu "
+                "declined/expired\n",
+                ull(games_started), ull(games_finished), ull(match_declines));
+    std::printf("Moves:             %llu sent (%.1f moves/s)\n",
+                ull(moves_sent), moves_per_s);
+    std::printf("Move RTT (ms):     p50 %.2f  p90 %.2f  p99 %.2f  max %.2f "
+                "(%zu samples)\n",
+                percentile(move_rtt_us, 0.50) / 1000.0,
+                percentile(move_rtt_us, 0.90) / 1000.0,
+                percentile(move_rtt_us, 0.99) / 1000.0,
+                percentile(move_rtt_us, 1.0) / 1000.0, move_rtt_us.size());
+    std::printf("Errors:            %llu invalid moves, %llu disconnects, "
+                "%llu protocol errors\n",
+                ull(invalid_moves), ull(disconnects), ull(protocol_errors));
+    std::fflush(stdout);
+  }
+};
+
+#endif // LOAD_STATS_HPP
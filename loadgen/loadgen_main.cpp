@@ -0,0 +1,450 @@
+// Load generator: mở N kết nối đồng thời từ một process, mỗi kết nối là một
+// người chơi giả lập (đăng ký/đăng nhập, tìm trận tự động, đi nước ngẫu nhiên)
+// và báo cáo tốc độ kết nối, độ trễ nước đi và số lỗi.
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "bot.hpp"
+#include "load_stats.hpp"
+
+#include "../common/const.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// Cấu hình của một lần chạy
+struct LoadgenConfig
+{
+    std::string host = Const::SERVER_IP;
+    uint16_t port = Const::SERVER_PORT;
+    size_t clients = 100;        // Số kết nối đồng thời
+    double duration_s = 30;      // Thời gian chạy
+    double connect_rate = 200;   // Số kết nối mở mỗi giây
+    uint32_t think_ms = 0;       // Thời gian "suy nghĩ" trước mỗi nước đi
+    std::string prefix = "bot";  // Tiền tố username
+    uint32_t seed = 1;           // Seed cho việc chọn nước đi
+};
+
+static volatile std::sig_atomic_t g_stop = 0;
+
+void signalHandler(int)
+{
+    g_stop = 1;
+}
+
+void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --host=IP            (mặc định " << Const::SERVER_IP << ")\n"
+              << "  --port=N             (mặc định " << Const::SERVER_PORT << ")\n"
+              << "  --clients=N          Số kết nối đồng thời (mặc định 100)\n"
+              << "  --duration=S         Thời gian chạy, giây (mặc định 30)\n"
+              << "  --connect-rate=N     Số kết nối mở mỗi giây (mặc định 200)\n"
+              << "  --think-ms=N         Thời gian suy nghĩ mỗi nước (mặc định 0)\n"
+              << "  --prefix=NAME        Tiền tố username (mặc định bot)\n"
+              << "  --seed=N             Seed chọn nước đi (mặc định 1)" << std::endl;
+}
+
+bool parseArgs(int argc, char *argv[], LoadgenConfig &config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (eq == std::string::npos)
+            return false;
+        std::string key = arg.substr(0, eq);
+        std::string value = arg.substr(eq + 1);
+        if (value.empty())
+            return false;
+
+        if (key == "--host")
+            config.host = value;
+        else if (key == "--port")
+            config.port = static_cast<uint16_t>(std::stoul(value));
+        else if (key == "--clients")
+            config.clients = std::stoul(value);
+        else if (key == "--duration")
+            config.duration_s = std::stod(value);
+        else if (key == "--connect-rate")
+            config.connect_rate = std::stod(value);
+        else if (key == "--think-ms")
+            config.think_ms = static_cast<uint32_t>(std::stoul(value));
+        else if (key == "--prefix")
+            config.prefix = value;
+        else if (key == "--seed")
+            config.seed = static_cast<uint32_t>(std::stoul(value));
+        else
+            return false;
+    }
+    return config.clients > 0 && config.connect_rate > 0;
+}
+
+/**
+ * @brief Vòng lặp epoll điều khiển toàn bộ bot trên một luồng.
+ */
+class Loadgen
+{
+public:
+    explicit Loadgen(const LoadgenConfig &config)
+        : config(config), rng(config.seed)
+    {
+        epoll_fd = epoll_create1(0);
+        if (epoll_fd < 0)
+        {
+            perror("epoll_create1 failed");
+            exit(EXIT_FAILURE);
+        }
+
+        std::memset(&server_address, 0, sizeof(server_address));
+        server_address.sin_family = AF_INET;
+        server_address.sin_port = htons(config.port);
+        if (inet_pton(AF_INET, config.host.c_str(), &server_address.sin_addr) <= 0)
+        {
+            std::cerr << "Invalid host: " << config.host << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        bots.reserve(config.clients);
+    }
+
+    ~Loadgen()
+    {
+        for (auto &bot : bots)
+            if (bot->fd != -1)
+                close(bot->fd);
+        close(epoll_fd);
+    }
+
+    void run()
+    {
+        start = Clock::now();
+        Clock::time_point end = start + toDuration(config.duration_s * 1000);
+        Clock::time_point next_report = start + std::chrono::seconds(5);
+        std::vector<epoll_event> events(256);
+
+        while (!g_stop)
+        {
+            Clock::time_point now = Clock::now();
+            if (now >= end)
+                break;
+
+            openDueConnections(now);
+            playDueMoves(now);
+
+            if (now >= next_report)
+            {
+                stats.printProgress(secondsSince(start), open_connections);
+                next_report += std::chrono::seconds(5);
+            }
+
+            // Chỉ thức dậy sớm khi có việc hẹn giờ thật sự
+            Clock::time_point wake = std::min(end, next_report);
+            if (bots.size() < config.clients)
+                wake = std::min(wake, nextConnectTime());
+            if (!think_queue.empty())
+                wake = std::min(wake, think_queue.top().first);
+            int timeout_ms = static_cast<int>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(wake - now).count());
+
+            int n = epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()),
+                               std::max(timeout_ms, 0));
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                perror("epoll_wait failed");
+                break;
+            }
+
+            for (int i = 0; i < n; i++)
+                handleEvent(events[i].data.u32, events[i].events);
+        }
+
+        stats.printSummary(secondsSince(start));
+    }
+
+private:
+    const LoadgenConfig &config;
+    int epoll_fd;
+    sockaddr_in server_address;
+    std::mt19937 rng;
+    LoadStats stats;
+
+    std::vector<std::unique_ptr<Bot>> bots;
+    std::vector<uint32_t> interest; // Sự kiện epoll đang đăng ký của từng bot
+    size_t open_connections = 0;
+    size_t connects_done = 0;       // Số kết nối đã thành công hoặc thất bại
+    Clock::time_point start;
+
+    // Hàng đợi hẹn giờ đi nước: (thời điểm, chỉ số bot), nhỏ nhất ở đầu
+    using ThinkEntry = std::pair<Clock::time_point, uint32_t>;
+    std::priority_queue<ThinkEntry, std::vector<ThinkEntry>, std::greater<ThinkEntry>>
+        think_queue;
+
+    static Clock::duration toDuration(double ms)
+    {
+        return std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(ms));
+    }
+
+    static double secondsSince(Clock::time_point t)
+    {
+        return std::chrono::duration<double>(Clock::now() - t).count();
+    }
+
+    Clock::time_point nextConnectTime() const
+    {
+        return start + toDuration(bots.size() * 1000.0 / config.connect_rate);
+    }
+
+    // Mở các kết nối đã đến lượt theo connect_rate
+    void openDueConnections(Clock::time_point now)
+    {
+        while (bots.size() < config.clients && nextConnectTime() <= now)
+        {
+            uint32_t index = static_cast<uint32_t>(bots.size());
+            bots.push_back(std::make_unique<Bot>(config.prefix + std::to_string(index)));
+            interest.push_back(0);
+            Bot &bot = *bots.back();
+
+            bot.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            if (bot.fd < 0)
+            {
+                perror("socket failed");
+                connectFailed(bot);
+                continue;
+            }
+
+            int ret = connect(bot.fd, reinterpret_cast<sockaddr *>(&server_address),
+                              sizeof(server_address));
+            if (ret < 0 && errno != EINPROGRESS)
+            {
+                connectFailed(bot);
+                continue;
+            }
+
+            // Kết nối xong khi socket ghi được (EPOLLOUT)
+            open_connections++;
+            updateInterest(index, EPOLLIN | EPOLLOUT);
+        }
+    }
+
+    void connectFailed(Bot &bot)
+    {
+        stats.connect_failures++;
+        markConnectDone();
+        if (bot.fd != -1)
+            close(bot.fd);
+        bot.fd = -1;
+        bot.state = BotState::CLOSED;
+    }
+
+    void markConnectDone()
+    {
+        if (++connects_done == config.clients)
+            stats.connect_phase_s = secondsSince(start);
+    }
+
+    void updateInterest(uint32_t index, uint32_t events)
+    {
+        if (interest[index] == events)
+            return;
+
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u32 = index;
+        int op = interest[index] == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+        epoll_ctl(epoll_fd, op, bots[index]->fd, &ev);
+        interest[index] = events;
+    }
+
+    void closeBot(uint32_t index, bool unexpected)
+    {
+        Bot &bot = *bots[index];
+        if (bot.fd == -1)
+            return;
+        if (unexpected)
+            stats.disconnects++;
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, bot.fd, nullptr);
+        close(bot.fd);
+        bot.fd = -1;
+        bot.state = BotState::CLOSED;
+        interest[index] = 0;
+        open_connections--;
+    }
+
+    void handleEvent(uint32_t index, uint32_t events)
+    {
+        Bot &bot = *bots[index];
+        if (bot.fd == -1)
+            return;
+
+        if (bot.state == BotState::CONNECTING)
+        {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            getsockopt(bot.fd, SOL_SOCKET, SO_ERROR, &error, &len);
+            if (error != 0 || (events & (EPOLLERR | EPOLLHUP)))
+            {
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, bot.fd, nullptr);
+                open_connections--;
+                connectFailed(bot);
+                return;
+            }
+            if (!(events & EPOLLOUT))
+                return;
+
+            stats.connects_ok++;
+            markConnectDone();
+            bot.onConnected();
+        }
+        else if (events & EPOLLIN)
+        {
+            if (!readPackets(index))
+                return;
+        }
+
+        if (bot.state == BotState::CLOSED)
+        {
+            closeBot(index, false);
+            return;
+        }
+
+        scheduleMove(index);
+        if (!bot.flush())
+        {
+            closeBot(index, true);
+            return;
+        }
+        updateInterest(index, EPOLLIN | (bot.outbuf.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT)));
+    }
+
+    // Đọc hết dữ liệu đang có và xử lý từng packet
+    bool readPackets(uint32_t index)
+    {
+        Bot &bot = *bots[index];
+        uint8_t buffer[16 * 1024];
+
+        while (true)
+        {
+            ssize_t n = recv(bot.fd, buffer, sizeof(buffer), 0);
+            if (n > 0)
+            {
+                bot.inbuf.insert(bot.inbuf.end(), buffer, buffer + n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+
+            closeBot(index, true); // EOF hoặc lỗi socket
+            return false;
+        }
+
+        Packet packet;
+        while (bot.nextPacket(packet))
+        {
+            try
+            {
+                bot.onPacket(packet, stats);
+            }
+            catch (const std::exception &e)
+            {
+                stats.protocol_errors++;
+            }
+        }
+        return true;
+    }
+
+    // Đến lượt bot: đi ngay hoặc hẹn giờ theo think_ms
+    void scheduleMove(uint32_t index)
+    {
+        Bot &bot = *bots[index];
+        if (!bot.move_due || bot.awaiting_update)
+            return;
+
+        if (config.think_ms == 0)
+            bot.playRandomMove(rng, stats);
+        else
+            think_queue.emplace(Clock::now() + std::chrono::milliseconds(config.think_ms), index);
+    }
+
+    void playDueMoves(Clock::time_point now)
+    {
+        while (!think_queue.empty() && think_queue.top().first <= now)
+        {
+            uint32_t index = think_queue.top().second;
+            think_queue.pop();
+
+            Bot &bot = *bots[index];
+            if (bot.fd == -1 || !bot.move_due || bot.awaiting_update)
+                continue; // Hẹn giờ cũ, ván cờ đã kết thúc
+
+            bot.playRandomMove(rng, stats);
+            if (!bot.flush())
+            {
+                closeBot(index, true);
+                continue;
+            }
+            updateInterest(index, EPOLLIN | (bot.outbuf.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT)));
+        }
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    LoadgenConfig config;
+    try
+    {
+        if (!parseArgs(argc, argv, config))
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    catch (const std::exception &)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Mỗi bot cần một fd: nâng giới hạn lên mức tối đa cho phép
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        if (config.clients + 16 > limit.rlim_cur)
+            std::cerr << "Warning: RLIMIT_NOFILE=" << limit.rlim_cur
+                      << " is lower than --clients" << std::endl;
+    }
+
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGTERM, signalHandler);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Loadgen: " << config.clients << " clients -> " << config.host << ":"
+              << config.port << " for " << config.duration_s << " s" << std::endl;
+
+    Loadgen loadgen(config);
+    loadgen.run();
+    return 0;
+}
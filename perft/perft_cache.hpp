@@ -0,0 +1,79 @@
+// PERFT_CACHE_HPP - Bảng băm dùng chung (không khóa) cho số nút perft
+
+#ifndef PERFT_CACHE_HPP
+#define PERFT_CACHE_HPP
+
+// Thư viện chuẩn C++
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Cache perft: (Zobrist key, độ sâu) -> số nút.
+ *
+ * Kích thước là lũy thừa của 2, ghi đè luôn (always-replace). Nhiều luồng đọc
+ * ghi đồng thời mà không khóa: mỗi ô lưu data và check = key ^ data (kỹ thuật
+ * "lockless hashing" của Hyatt). Nếu hai luồng ghi xen kẽ, check không khớp và
+ * ô bị coi như trống, nên không bao giờ đọc được số nút của vị trí khác.
+ *
+ * data = (số nút << 8) | độ sâu; số nút perft thực tế nhỏ hơn 2^56.
+ */
+class PerftCache {
+public:
+  // size_mb = 0: không dùng cache
+  explicit PerftCache(size_t size_mb) {
+    size_t entries = size_mb * 1024 * 1024 / sizeof(Entry);
+    if (entries == 0)
+      return;
+    size_t power = 1;
+    while (power * 2 <= entries)
+      power *= 2;
+    table.reset(new Entry[power]);
+    mask = power - 1;
+  }
+
+  bool enabled() const { return table != nullptr; }
+
+  // Kích thước thực tế (MB), đã làm tròn xuống lũy thừa của 2 số ô
+  size_t sizeMb() const {
+    return enabled() ? (mask + 1) * sizeof(Entry) / (1024 * 1024) : 0;
+  }
+
+  bool probe(uint64_t key, int depth, uint64_t &nodes) const {
+    const Entry &entry = table[key & mask];
+    uint64_t data = entry.data.load(std::memory_order_relaxed);
+    uint64_t check = entry.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || (data & 0xFF) != uint64_t(depth))
+      return false;
+    nodes = data >> 8;
+    return true;
+  }
+
+  void store(uint64_t key, int depth, uint64_t nodes) {
+    Entry &entry = table[key & mask];
+    uint64_t data = (nodes << 8) | uint64_t(depth & 0xFF);
+    entry.data.store(data, std::memory_order_relaxed);
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+  }
+
+  void clear() {
+    if (!enabled())
+      return;
+    for (size_t i = 0; i <= mask; i++) {
+      table[i].data.store(0, std::memory_order_relaxed);
+      table[i].check.store(0, std::memory_order_relaxed);
+    }
+  }
+
+private:
+  struct Entry {
+    std::atomic<uint64_t> check{0};
+    std::atomic<uint64_t> data{0};
+  };
+
+  std::unique_ptr<Entry[]> table;
+  size_t mask = 0;
+};
+
+#endif // PERFT_CACHE_HPP
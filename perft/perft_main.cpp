@@ -0,0 +1,252 @@
+// Perft: đếm số nút của cây nước đi hợp lệ tới một độ sâu cho các thế cờ
+// chuẩn, so với kết quả đã biết để kiểm tra movegen/makeMove của
+// chess_engine/chess.hpp và đo tốc độ (nút/giây). Chạy đơn luồng và đa luồng
+// (chia các nước ở gốc), có cache số nút dùng chung. Mỗi kết quả là một dòng
+// JSON trên stdout; mã thoát khác 0 nếu có số nút sai.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "perft_cache.hpp"
+
+#include "../chess_engine/chess.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// Một thế cờ chuẩn và số nút đã biết theo độ sâu (nodes[d - 1])
+struct PerftPosition
+{
+    std::string name;
+    std::string fen;
+    std::vector<uint64_t> nodes;
+    int default_depth;
+};
+
+// Nguồn: https://www.chessprogramming.org/Perft_Results
+const std::vector<PerftPosition> SUITE = {
+    {"startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+     {20, 400, 8902, 197281, 4865609, 119060324}, 6},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+     {48, 2039, 97862, 4085603, 193690690}, 5},
+    {"position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+     {14, 191, 2812, 43238, 674624, 11030083}, 6},
+    {"position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+     {6, 264, 9467, 422333, 15833292}, 5},
+    {"position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+     {44, 1486, 62379, 2103487, 89941194}, 5},
+    {"position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+     {46, 2079, 89890, 3894594, 164075551}, 5},
+};
+
+struct PerftConfig
+{
+    std::string position;             // Chỉ chạy thế cờ có tên này (rỗng = tất cả)
+    std::string fen;                  // Thế cờ tùy chọn (cần --depth)
+    int depth = 0;                    // 0 = độ sâu mặc định của từng thế cờ
+    std::vector<unsigned> threads;    // Các số luồng cần chạy
+    size_t hash_mb = 16;              // Kích thước cache, 0 = tắt
+    std::string sliders = "auto";     // auto | magic | pext
+};
+
+void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --position=NAME      Chỉ chạy một thế cờ (startpos, kiwipete, position3..6)\n"
+              << "  --fen=FEN            Chạy thế cờ tùy chọn (không kiểm tra kết quả)\n"
+              << "  --depth=N            Độ sâu (mặc định theo từng thế cờ)\n"
+              << "  --threads=N[,M...]   Số luồng, có thể nhiều giá trị (mặc định 1 và số lõi)\n"
+              << "  --hash-mb=N          Kích thước cache số nút, 0 = tắt (mặc định 16)\n"
+              << "  --sliders=IMPL       auto | magic | pext (mặc định auto)" << std::endl;
+}
+
+bool parseArgs(int argc, char *argv[], PerftConfig &config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (eq == std::string::npos)
+            return false;
+        std::string key = arg.substr(0, eq);
+        std::string value = arg.substr(eq + 1);
+        if (value.empty())
+            return false;
+
+        if (key == "--position")
+            config.position = value;
+        else if (key == "--fen")
+            config.fen = value;
+        else if (key == "--depth")
+            config.depth = std::stoi(value);
+        else if (key == "--threads")
+        {
+            std::stringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ','))
+                config.threads.push_back(static_cast<unsigned>(std::stoul(item)));
+        }
+        else if (key == "--hash-mb")
+            config.hash_mb = std::stoul(value);
+        else if (key == "--sliders")
+            config.sliders = value;
+        else
+            return false;
+    }
+
+    if (config.threads.empty())
+    {
+        config.threads.push_back(1);
+        unsigned cores = std::thread::hardware_concurrency();
+        if (cores > 1)
+            config.threads.push_back(cores);
+    }
+    for (unsigned threads : config.threads)
+        if (threads == 0)
+            return false;
+
+    if (!config.fen.empty() && config.depth <= 0)
+        return false;
+    return config.depth >= 0 && config.depth < 256 &&
+           (config.sliders == "auto" || config.sliders == "magic" || config.sliders == "pext");
+}
+
+// Perft với bulk counting ở độ sâu 1 và cache từ độ sâu 2 trở lên
+uint64_t perft(chess::Board &board, int depth, PerftCache &cache)
+{
+    chess::Movelist moves;
+    chess::movegen::legalmoves(moves, board);
+    if (depth <= 1)
+        return depth == 1 ? moves.size() : 1;
+
+    uint64_t key = board.hash();
+    uint64_t nodes = 0;
+    if (cache.enabled() && cache.probe(key, depth, nodes))
+        return nodes;
+
+    for (const chess::Move &move : moves)
+    {
+        board.makeMove(move);
+        nodes += perft(board, depth - 1, cache);
+        board.unmakeMove(move);
+    }
+
+    if (cache.enabled())
+        cache.store(key, depth, nodes);
+    return nodes;
+}
+
+// Chia các nước ở gốc cho các luồng (mỗi luồng lấy nước kế tiếp khi rảnh)
+uint64_t parallelPerft(const chess::Board &root, int depth, unsigned threads, PerftCache &cache)
+{
+    if (threads == 1 || depth <= 1)
+    {
+        chess::Board board = root;
+        return perft(board, depth, cache);
+    }
+
+    chess::Movelist moves;
+    chess::movegen::legalmoves(moves, root);
+
+    std::atomic<int> next{0};
+    std::atomic<uint64_t> total{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&]() {
+            chess::Board board = root;
+            uint64_t nodes = 0;
+            for (int i = next++; i < moves.size(); i = next++)
+            {
+                board.makeMove(moves[i]);
+                nodes += perft(board, depth - 1, cache);
+                board.unmakeMove(moves[i]);
+            }
+            total += nodes;
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+    return total;
+}
+
+// Chạy một thế cờ với một số luồng, in một dòng JSON; false nếu sai số nút
+bool runPosition(const PerftPosition &position, int depth, unsigned threads, PerftCache &cache)
+{
+    chess::Board board(position.fen);
+    cache.clear(); // Mỗi lượt đo bắt đầu với cache trống
+
+    auto start = Clock::now();
+    uint64_t nodes = parallelPerft(board, depth, threads, cache);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    bool known = depth <= static_cast<int>(position.nodes.size());
+    uint64_t expected = known ? position.nodes[depth - 1] : 0;
+    bool ok = !known || nodes == expected;
+
+    const char *sliders =
+        chess::attacks::sliderImpl() == chess::attacks::SliderImpl::PEXT ? "pext" : "magic";
+    std::printf("{\"position\":\"%s\",\"depth\":%d,\"threads\":%u,\"hash_mb\":%zu,"
+                "\"sliders\":\"%s\",\"nodes\":%llu,",
+                position.name.c_str(), depth, threads,
+                cache.sizeMb(), sliders,
+                static_cast<unsigned long long>(nodes));
+    if (known)
+        std::printf("\"expected\":%llu,\"ok\":%s,", static_cast<unsigned long long>(expected),
+                    ok ? "true" : "false");
+    std::printf("\"seconds\":%.3f,\"nps\":%.0f}\n", seconds, seconds > 0 ? nodes / seconds : 0.0);
+    std::fflush(stdout);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    PerftConfig config;
+    try
+    {
+        if (!parseArgs(argc, argv, config))
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    catch (const std::exception &)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    using chess::attacks;
+    if (config.sliders == "magic")
+        attacks::selectSliders(attacks::SliderImpl::MAGIC);
+    else if (attacks::selectSliders(attacks::SliderImpl::PEXT) != attacks::SliderImpl::PEXT &&
+             config.sliders == "pext")
+        std::cerr << "PEXT không được hỗ trợ trên CPU này, dùng magic." << std::endl;
+
+    std::vector<PerftPosition> positions;
+    if (!config.fen.empty())
+        positions.push_back({"custom", config.fen, {}, config.depth});
+    for (const PerftPosition &position : SUITE)
+        if (config.fen.empty() && (config.position.empty() || config.position == position.name))
+            positions.push_back(position);
+    if (positions.empty())
+    {
+        std::cerr << "Không có thế cờ: " << config.position << std::endl;
+        return 1;
+    }
+
+    PerftCache cache(config.hash_mb);
+    bool all_ok = true;
+    for (const PerftPosition &position : positions)
+    {
+        int depth = config.depth > 0 ? config.depth : position.default_depth;
+        for (unsigned threads : config.threads)
+            all_ok = runPosition(position, depth, threads, cache) && all_ok;
+    }
+    return all_ok ? 0 : 2;
+}
@@ -0,0 +1,359 @@
+// PGN_CODEC_HPP - Chuyển MatchModel sang PGN và đọc PGN thành MatchModel
+
+#ifndef PGN_CODEC_HPP
+#define PGN_CODEC_HPP
+
+// Thư viện chuẩn C++
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <istream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Thư viện dự án
+#include "../chess_engine/chess.hpp"
+#include "../server/structs.hpp"
+
+namespace pgn_codec {
+
+// Kết quả PGN của một ván ("*" nếu chưa kết thúc)
+inline std::string resultTag(const MatchModel &match) {
+  if (match.result == "<0>")
+    return "1/2-1/2";
+  if (!match.result.empty() && match.result == match.white_username)
+    return "1-0";
+  if (!match.result.empty() && match.result == match.black_username)
+    return "0-1";
+  return "*";
+}
+
+inline void appendTag(std::string &out, const char *key,
+                      const std::string &value) {
+  out += '[';
+  out += key;
+  out += " \"";
+  for (char c : value) {
+    if (c == '"' || c == '\\')
+      out += '\\';
+    out += c;
+  }
+  out += "\"]\n";
+}
+
+/**
+ * @brief Một ván dạng PGN: bảy thẻ bắt buộc, GameId/Reason để nhập lại
+ * không mất thông tin, SetUp/FEN nếu không bắt đầu từ thế cờ ban đầu, rồi
+ * các nước SAN (dòng tối đa 80 ký tự).
+ */
+inline std::string toPgn(const MatchModel &match) {
+  std::string out;
+  std::string result = resultTag(match);
+
+  char date[16] = "????.??.??";
+  std::time_t seconds = std::chrono::system_clock::to_time_t(match.start_time);
+  std::tm tm{};
+  if (seconds > 0 && gmtime_r(&seconds, &tm) != nullptr)
+    std::strftime(date, sizeof(date), "%Y.%m.%d", &tm);
+
+  appendTag(out, "Event", "Chess_TCP_C");
+  appendTag(out, "Site", "?");
+  appendTag(out, "Date", date);
+  appendTag(out, "Round", "-");
+  appendTag(out, "White", match.white_username);
+  appendTag(out, "Black", match.black_username);
+  appendTag(out, "Result", result);
+  appendTag(out, "GameId", match.game_id);
+  if (!match.reason.empty())
+    appendTag(out, "Reason", match.reason);
+  chess::Board board(match.start_fen);
+  if (board.getFen() != chess::constants::STARTPOS) {
+    appendTag(out, "SetUp", "1");
+    appendTag(out, "FEN", match.start_fen);
+  }
+  out += '\n';
+
+  size_t line_start = out.size();
+  auto word = [&](const std::string &text) {
+    if (out.size() > line_start &&
+        out.size() - line_start + 1 + text.size() > 80) {
+      out += '\n';
+      line_start = out.size();
+    } else if (out.size() > line_start) {
+      out += ' ';
+    }
+    out += text;
+  };
+
+  bool first = true;
+  for (const MatchModel::Move &stored : match.moves) {
+    chess::Move move = chess::uci::uciToMove(board, stored.uci_move);
+    if (move == chess::Move::NO_MOVE)
+      break;
+    int number = board.fullMoveNumber();
+    if (board.sideToMove() == chess::Color::WHITE)
+      word(std::to_string(number) + ". " + chess::uci::moveToSan(board, move));
+    else if (first)
+      word(std::to_string(number) + "... " +
+           chess::uci::moveToSan(board, move));
+    else
+      word(chess::uci::moveToSan(board, move));
+    board.makeMove(move);
+    first = false;
+  }
+  word(result);
+  out += "\n\n";
+  return out;
+}
+
+/**
+ * @brief Visitor của chess::pgn::StreamParser: mỗi ván đọc được (có kết
+ * quả, mọi nước hợp lệ) thành một MatchModel. Ván "*" hoặc có nước sai bị
+ * bỏ qua và được đếm trong rejected.
+ *
+ * Parser cũng kết thúc ván khi hết dữ liệu mà chưa gặp kết quả, nên ván cuối
+ * cùng luôn được giữ lại trong games cho đến finish().
+ */
+class MatchCollector : public chess::pgn::Visitor {
+public:
+  std::vector<MatchModel> games;
+  uint64_t parsed = 0;   // Số ván hợp lệ (kể cả đã chuyển cho on_batch)
+  uint64_t rejected = 0;
+
+  // Nếu có: nhận và xử lý games mỗi khi đủ batch ván, để bộ nhớ không tăng
+  // theo kích thước file
+  std::function<void(std::vector<MatchModel> &)> on_batch;
+  size_t batch = 1024;
+
+  void startPgn() override {
+    last_accepted = false;
+    match = MatchModel();
+    board = chess::Board();
+    result.clear();
+    ok = true;
+  }
+
+  void header(std::string_view key, std::string_view value) override {
+    if (key == "White")
+      match.white_username = value;
+    else if (key == "Black")
+      match.black_username = value;
+    else if (key == "Result")
+      result = value;
+    else if (key == "GameId")
+      match.game_id = value;
+    else if (key == "Reason")
+      match.reason = value;
+    else if (key == "Date")
+      match.start_time = parseDate(value);
+    else if (key == "FEN") {
+      try {
+        board.setFen(value);
+      } catch (const std::exception &) {
+        ok = false;
+      }
+    }
+  }
+
+  void startMoves() override {}
+
+  void move(std::string_view san, std::string_view) override {
+    if (!ok)
+      return;
+    if (match.moves.empty())
+      match.start_fen = board.getFen();
+    try {
+      chess::Move move = chess::uci::parseSan(board, san);
+      if (move == chess::Move::NO_MOVE) {
+        reject();
+        return;
+      }
+      std::string uci = chess::uci::moveToUci(move);
+      board.makeMove(move);
+      match.moves.push_back({uci, board.getFen(), match.start_time});
+    } catch (const std::exception &) {
+      reject();
+    }
+  }
+
+  void endPgn() override {
+    if (match.moves.empty())
+      match.start_fen = board.getFen();
+    if (match.white_username.empty())
+      match.white_username = "?";
+    if (match.black_username.empty())
+      match.black_username = "?";
+
+    // Hai tên trùng nhau thì không phân biệt được người thắng qua result
+    if (result == "1/2-1/2")
+      match.result = "<0>";
+    else if (result == "1-0" && match.white_username != match.black_username)
+      match.result = match.white_username;
+    else if (result == "0-1" && match.white_username != match.black_username)
+      match.result = match.black_username;
+    else
+      ok = false;
+
+    if (!ok) {
+      rejected++;
+      return;
+    }
+    match.end_time = match.start_time;
+    games.push_back(std::move(match));
+    parsed++;
+    last_accepted = true;
+    if (on_batch && games.size() > batch) {
+      MatchModel last = std::move(games.back());
+      games.pop_back();
+      on_batch(games);
+      games.clear();
+      games.push_back(std::move(last));
+    }
+  }
+
+  /**
+   * @brief Gọi khi parser đã đọc hết dữ liệu.
+   * @param ends_with_result Phần nước đi cuối có kết thúc bằng kết quả
+   * (endsWithResult). Nếu không, ván cuối đã bị cắt ngang và bị loại.
+   */
+  void finish(bool ends_with_result) {
+    if (!ends_with_result && last_accepted) {
+      games.pop_back();
+      parsed--;
+      rejected++;
+    }
+    last_accepted = false;
+  }
+
+private:
+  MatchModel match;
+  chess::Board board;
+  std::string result;
+  bool ok = true;
+  bool last_accepted = false; // Ván đọc gần nhất đang nằm cuối games
+
+  void reject() {
+    ok = false;
+    skipPgn(true);
+  }
+
+  // "YYYY.MM.DD" (có thể có "??") → 00:00 UTC của ngày đó, không rõ = epoch
+  static std::chrono::system_clock::time_point parseDate(std::string_view text) {
+    std::tm tm{};
+    if (std::sscanf(std::string(text).c_str(), "%d.%d.%d", &tm.tm_year,
+                    &tm.tm_mon, &tm.tm_mday) != 3)
+      return {};
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    return std::chrono::system_clock::from_time_t(timegm(&tm));
+  }
+};
+
+// std::istream đọc thẳng từ một vùng nhớ (một đoạn của file được mmap)
+class MemoryStream : private std::streambuf, public std::istream {
+public:
+  MemoryStream(const char *begin, const char *end) : std::istream(this) {
+    char *data = const_cast<char *>(begin);
+    setg(data, data, data + (end - begin));
+  }
+};
+
+// Dòng bắt đầu tại pos có dạng thẻ [Name "value"]
+inline bool isTagLine(const char *data, size_t size, size_t pos) {
+  size_t i = pos + 1;
+  while (i < size && (std::isalnum(static_cast<unsigned char>(data[i])) ||
+                      data[i] == '_'))
+    i++;
+  if (i == pos + 1)
+    return false;
+  while (i < size && (data[i] == ' ' || data[i] == '\t'))
+    i++;
+  return i < size && data[i] == '"';
+}
+
+// Vị trí ký tự '\n' kết thúc dòng chứa pos (size nếu là dòng cuối)
+inline size_t lineEnd(const char *data, size_t size, size_t pos) {
+  const void *nl = std::memchr(data + pos, '\n', size - pos);
+  return nl == nullptr ? size : static_cast<const char *>(nl) - data;
+}
+
+/**
+ * @brief Vị trí bắt đầu ván đầu tiên tại hoặc sau target: một dòng thẻ
+ * [Name "value"] nằm ngoài comment và sau phần nước đi của ván trước. Trả về
+ * size nếu không còn ván nào.
+ *
+ * Trạng thái comment ({...} có thể nhiều dòng, ; và % đến hết dòng) chỉ biết
+ * được khi đọc từ đầu một ván, nên from phải là đầu một ván (hoặc đầu file).
+ * Chỉ là một lượt quét byte, nhanh hơn nhiều so với phân tích nước đi.
+ */
+inline size_t nextGameStart(const char *data, size_t size, size_t from,
+                            size_t target) {
+  bool movetext = true; // Đã có nước đi kể từ dòng thẻ gần nhất
+  bool line_start = true;
+  for (size_t pos = from; pos < size; pos++) {
+    char c = data[pos];
+    if (line_start && c == '[' && isTagLine(data, size, pos)) {
+      if (movetext && pos >= target)
+        return pos;
+      movetext = false;
+      pos = lineEnd(data, size, pos); // Giá trị thẻ không xuống dòng
+      continue;
+    }
+    if (line_start && c == '%') {
+      pos = lineEnd(data, size, pos);
+      continue;
+    }
+
+    line_start = c == '\n';
+    if (c == '{') {
+      const void *close = std::memchr(data + pos, '}', size - pos);
+      pos = close == nullptr ? size : static_cast<const char *>(close) - data;
+      movetext = true;
+    } else if (c == ';') {
+      pos = lineEnd(data, size, pos);
+      line_start = true;
+      movetext = true;
+    } else if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+      movetext = true;
+    }
+  }
+  return size;
+}
+
+/**
+ * @brief Phần nước đi của đoạn [begin, end) kết thúc bằng kết quả (1-0, 0-1,
+ * 1/2-1/2 hoặc *). Nếu không, ván cuối của đoạn đã bị cắt ngang.
+ */
+inline bool endsWithResult(const char *begin, const char *end) {
+  while (end > begin && std::isspace(static_cast<unsigned char>(end[-1])))
+    end--;
+  for (const char *token : {"1-0", "0-1", "1/2-1/2", "*"}) {
+    size_t length = std::strlen(token);
+    if (static_cast<size_t>(end - begin) >= length &&
+        std::memcmp(end - length, token, length) == 0 &&
+        (end - length == begin ||
+         std::isspace(static_cast<unsigned char>(end[-length - 1])) ||
+         end[-length - 1] == '}' || end[-length - 1] == ')'))
+      return true;
+  }
+  return false;
+}
+
+// Game id cho ván nhập không có thẻ GameId
+inline std::string newGameId(std::mt19937_64 &rng) {
+  char id[24];
+  std::snprintf(id, sizeof(id), "pgn-%016llx",
+                static_cast<unsigned long long>(rng()));
+  return id;
+}
+
+} // namespace pgn_codec
+
+#endif // PGN_CODEC_HPP
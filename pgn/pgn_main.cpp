@@ -0,0 +1,266 @@
+// Công cụ PGN cho dữ liệu của server (chạy khi server đã dừng):
+//   --export: ghi mọi ván đã kết thúc ra một file PGN theo từng lô game_id;
+//             việc đọc (giải mã) ván và chuyển nước đi sang SAN được chia
+//             cho nhiều luồng, bộ nhớ chỉ giữ một lô.
+//   --import: nạp file PGN (có thể nhiều GB) vào matches.arc; file được map
+//             vào bộ nhớ, chia thành các đoạn tại ranh giới ván và mỗi luồng
+//             phân tích một đoạn bằng chess::pgn::StreamParser.
+// Kết quả là một dòng JSON trên stdout; log ra stderr (hoặc --log-file).
+// Chỉ mục khai cuộc được server dựng
+// lại ở lần khởi động sau vì số ván đã thay đổi.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pgn_codec.hpp"
+
+#include "../server/data_storage.hpp"
+#include "../server/logger.hpp"
+#include "../server/server_config.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// Số ván mỗi lượt xuất (đọc và chuyển SAN song song rồi ghi theo thứ tự)
+const size_t EXPORT_BATCH = 4096;
+
+struct PgnConfig
+{
+    std::string data_dir;     // Thư mục dữ liệu của server (rỗng = ../data/)
+    std::string export_path;  // File PGN cần ghi
+    std::string import_path;  // File PGN cần đọc
+    std::string log_file;     // File log (rỗng = stderr)
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    bool dry_run = false;     // Chỉ phân tích, không ghi vào matches.arc
+};
+
+void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " (--export=FILE | --import=FILE) [options]\n"
+              << "  --export=FILE        Ghi mọi ván đã kết thúc ra FILE\n"
+              << "  --import=FILE        Nạp các ván trong FILE vào matches.arc\n"
+              << "  --data-dir=DIR       Thư mục dữ liệu của server (mặc định ../data/)\n"
+              << "  --threads=N          Số luồng (mặc định số lõi)\n"
+              << "  --log-file=FILE      Ghi log vào FILE (mặc định stderr)\n"
+              << "  --dry-run=1          Chỉ phân tích file nhập, không ghi" << std::endl;
+}
+
+bool parseArgs(int argc, char *argv[], PgnConfig &config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (eq == std::string::npos)
+            return false;
+        std::string key = arg.substr(0, eq);
+        std::string value = arg.substr(eq + 1);
+        if (value.empty())
+            return false;
+
+        if (key == "--export")
+            config.export_path = value;
+        else if (key == "--import")
+            config.import_path = value;
+        else if (key == "--data-dir")
+            config.data_dir = value;
+        else if (key == "--log-file")
+            config.log_file = value;
+        else if (key == "--threads")
+            config.threads = static_cast<unsigned>(std::stoul(value));
+        else if (key == "--dry-run")
+            config.dry_run = value == "1" || value == "true";
+        else
+            return false;
+    }
+    return config.threads > 0 && config.export_path.empty() != config.import_path.empty();
+}
+
+// Xuất theo thời gian bắt đầu để file ổn định giữa các lần chạy
+int exportGames(const PgnConfig &config)
+{
+    auto start = Clock::now();
+    DataStorage &storage = DataStorage::getInstance();
+    std::vector<std::string> game_ids = storage.getFinishedMatchIdsByStart();
+
+    FILE *out = std::fopen(config.export_path.c_str(), "w");
+    if (out == nullptr)
+    {
+        perror("fopen failed");
+        return 1;
+    }
+
+    size_t games = 0;
+    uint64_t bytes = 0;
+    std::vector<std::string> texts;
+    for (size_t first = 0; first < game_ids.size(); first += EXPORT_BATCH)
+    {
+        size_t count = std::min(EXPORT_BATCH, game_ids.size() - first);
+        texts.assign(count, std::string());
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < config.threads; t++)
+        {
+            workers.emplace_back([&, t]() {
+                MatchModel match;
+                for (size_t i = t; i < count; i += config.threads)
+                    if (storage.getFinishedMatch(game_ids[first + i], match))
+                        texts[i] = pgn_codec::toPgn(match);
+            });
+        }
+        for (auto &worker : workers)
+            worker.join();
+
+        for (const std::string &text : texts)
+        {
+            if (text.empty())
+                continue; // Ván không đọc được
+            std::fwrite(text.data(), 1, text.size(), out);
+            bytes += text.size();
+            games++;
+        }
+    }
+    bool ok = std::fclose(out) == 0;
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::printf("{\"mode\":\"export\",\"games\":%zu,\"bytes\":%llu,\"threads\":%u,"
+                "\"seconds\":%.3f,\"games_per_sec\":%.0f}\n",
+                games, static_cast<unsigned long long>(bytes), config.threads, seconds,
+                seconds > 0 ? games / seconds : 0.0);
+    return ok ? 0 : 1;
+}
+
+int importGames(const PgnConfig &config)
+{
+    auto start = Clock::now();
+    int fd = open(config.import_path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        perror("open failed");
+        return 1;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    const char *data = nullptr;
+    if (size > 0)
+    {
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED)
+        {
+            perror("mmap failed");
+            close(fd);
+            return 1;
+        }
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        data = static_cast<const char *>(mapped);
+    }
+    close(fd);
+
+    // Ranh giới các đoạn: điểm chia đều rồi dời tới đầu ván kế tiếp. Mỗi lần
+    // quét tiếp từ ranh giới trước để biết đang ở trong comment hay không
+    std::vector<size_t> bounds = {pgn_codec::nextGameStart(data, size, 0, 0)};
+    for (unsigned t = 1; t < config.threads; t++)
+        bounds.push_back(pgn_codec::nextGameStart(data, size, bounds.back(),
+                                                  std::max(bounds.back(), size / config.threads * t)));
+    bounds.push_back(size);
+
+    DataStorage *storage = config.dry_run ? nullptr : &DataStorage::getInstance();
+    std::vector<uint64_t> parsed(config.threads, 0), rejected(config.threads, 0), added(config.threads, 0);
+    std::vector<std::string> errors(config.threads);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < config.threads; t++)
+    {
+        workers.emplace_back([&, t]() {
+            std::mt19937_64 rng(std::random_device{}());
+            pgn_codec::MatchCollector collector;
+            collector.on_batch = [&](std::vector<MatchModel> &games) {
+                for (MatchModel &match : games)
+                    if (match.game_id.empty())
+                        match.game_id = pgn_codec::newGameId(rng);
+                if (storage != nullptr)
+                    added[t] += storage->importMatches(games);
+            };
+
+            pgn_codec::MemoryStream stream(data + bounds[t], data + bounds[t + 1]);
+            bool stopped = false;
+            try
+            {
+                chess::pgn::StreamParser<> parser(stream);
+                parser.readGames(collector);
+            }
+            catch (const std::exception &e)
+            {
+                errors[t] = e.what(); // Phần còn lại của đoạn bị bỏ
+                stopped = true;
+            }
+            // Ván cuối của đoạn chỉ hợp lệ nếu đoạn kết thúc bằng kết quả
+            collector.finish(stopped || pgn_codec::endsWithResult(data + bounds[t], data + bounds[t + 1]));
+            collector.on_batch(collector.games);
+            parsed[t] = collector.parsed;
+            rejected[t] = collector.rejected;
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+    if (data != nullptr)
+        munmap(const_cast<char *>(data), size);
+
+    uint64_t total_parsed = 0, total_rejected = 0, total_added = 0;
+    for (unsigned t = 0; t < config.threads; t++)
+    {
+        total_parsed += parsed[t];
+        total_rejected += rejected[t];
+        total_added += added[t];
+        if (!errors[t].empty())
+            std::cerr << "Đoạn " << t << ": " << errors[t] << std::endl;
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::printf("{\"mode\":\"import\",\"games\":%llu,\"rejected\":%llu,\"added\":%llu,"
+                "\"bytes\":%zu,\"threads\":%u,\"seconds\":%.3f,\"mb_per_sec\":%.1f}\n",
+                static_cast<unsigned long long>(total_parsed),
+                static_cast<unsigned long long>(total_rejected),
+                static_cast<unsigned long long>(total_added), size, config.threads, seconds,
+                seconds > 0 ? size / seconds / (1024 * 1024) : 0.0);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    PgnConfig config;
+    try
+    {
+        if (!parseArgs(argc, argv, config))
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    catch (const std::exception &)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // stdout chỉ dành cho dòng kết quả
+    Logger &logger = Logger::getInstance();
+    if (config.log_file.empty())
+        logger.configure(stderr, LogLevel::WARN);
+    else if (!logger.configure(config.log_file, LogLevel::WARN))
+    {
+        perror("log file open failed");
+        return 1;
+    }
+    ServerConfig::getInstance().data_dir = config.data_dir;
+
+    return config.export_path.empty() ? importGames(config) : exportGames(config);
+}
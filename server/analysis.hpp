@@ -0,0 +1,266 @@
+// ANALYSIS_HPP - Phân tích sau ván: đánh giá từng nước bằng máy, chạy nền
+
+#ifndef ANALYSIS_HPP
+#define ANALYSIS_HPP
+
+// Thư viện chuẩn C++
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Thư viện dự án
+#include "../chess_engine/chess.hpp"
+#include "../common/const.hpp"
+#include "../common/message.hpp"
+#include "data_storage.hpp"
+#include "engine.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "tracer.hpp"
+
+/**
+ * @brief Lớp Analyzer (Singleton) - Phân tích các ván đã kết thúc.
+ *
+ * Ván được xếp vào hàng đợi có giới hạn ngay khi kết thúc, hoặc khi
+ * có ANALYSIS_REQUEST cho ván chưa phân tích. Một luồng nền lấy tối đa
+ * Const::ANALYSIS_BATCH_GAMES ván mỗi lô, tìm mọi thế cờ tới độ sâu cố định
+ * trên một Engine riêng (ít luồng, nice thấp nhất) và lưu cả lô bằng một lần
+ * ghi matches.json.
+ *
+ * Trước mỗi thế cờ, nếu máy của các ván đang chơi còn việc (live_busy) thì
+ * bộ phân tích chờ, nên nó chỉ dùng CPU thừa của ván đang diễn ra.
+ */
+class Analyzer {
+public:
+  Analyzer(const Analyzer &) = delete;
+  Analyzer &operator=(const Analyzer &) = delete;
+
+  static Analyzer &getInstance() {
+    static Analyzer instance;
+    return instance;
+  }
+
+  ~Analyzer() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    cv.notify_all();
+    engine.stop();
+    if (worker.joinable())
+      worker.join();
+  }
+
+  /**
+   * @brief Bật bộ phân tích. depth = 0: không làm gì (phân tích bị tắt).
+   * @param live_busy Trả về true khi máy của các ván đang chơi còn việc.
+   */
+  void start(int depth, unsigned threads, std::function<bool()> live_busy) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (depth <= 0 || worker.joinable())
+      return;
+    this->depth = std::min(depth, Engine::MAX_PLY - 1);
+    this->live_busy = std::move(live_busy);
+    engine.configure(threads, Const::ANALYSIS_HASH_MB, Const::ANALYSIS_NICE);
+    worker = std::thread(&Analyzer::run, this);
+    LOG_INFO("analysis_started", "depth", this->depth, "threads",
+             engine.threadBudget());
+  }
+
+  bool enabled() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return worker.joinable();
+  }
+
+  /**
+   * @brief Xếp một ván đã kết thúc vào hàng đợi phân tích.
+   * @return true nếu ván đang chờ (mới xếp hoặc đã có sẵn); false nếu phân
+   * tích bị tắt hoặc hàng đợi đầy.
+   */
+  bool enqueue(const std::string &game_id) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!worker.joinable() || stopping)
+        return false;
+      if (pending.count(game_id))
+        return true;
+      if (queue.size() >= Const::ANALYSIS_QUEUE_MAX) {
+        LOG_WARN("analysis_queue_full", "game_id", game_id);
+        return false;
+      }
+      pending.insert(game_id);
+      queue.push_back(game_id);
+      Metrics::getInstance().analysis_queue_depth.set(queue.size());
+    }
+    cv.notify_all();
+    return true;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  // Đánh giá một thế cờ
+  struct Evaluation {
+    int white_eval = 0; // Centipawn, góc nhìn bên trắng
+    bool white_to_move = true;
+    std::string best; // Nước máy chọn (rỗng nếu hết nước đi)
+  };
+
+  Engine engine;
+  int depth = 0;
+  std::function<bool()> live_busy;
+
+  std::mutex mutex; // Bảo vệ queue, pending, worker
+  std::condition_variable cv;
+  std::deque<std::string> queue;
+  std::unordered_set<std::string> pending; // Trong hàng đợi hoặc đang xử lý
+  std::thread worker;
+  std::atomic<bool> stopping{false};
+
+  Analyzer() = default;
+
+  void run() {
+    while (true) {
+      std::vector<std::string> batch;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping)
+          return;
+        while (!queue.empty() && batch.size() < Const::ANALYSIS_BATCH_GAMES) {
+          batch.push_back(std::move(queue.front()));
+          queue.pop_front();
+        }
+        Metrics::getInstance().analysis_queue_depth.set(queue.size());
+      }
+
+      analyzeBatch(batch);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      for (const std::string &game_id : batch)
+        pending.erase(game_id);
+    }
+  }
+
+  // Phân tích một lô ván rồi lưu tất cả trong một lần ghi
+  void analyzeBatch(const std::vector<std::string> &batch) {
+    TraceSpan span("analysis.batch");
+    std::vector<std::pair<std::string, std::vector<MatchModel::MoveAnalysis>>>
+        results;
+
+    for (const std::string &game_id : batch) {
+      MatchModel match;
+      try {
+        match = DataStorage::getInstance().getMatch(game_id);
+      } catch (const std::exception &) {
+        continue; // Ván đã bị xóa
+      }
+
+      auto start = Clock::now();
+      std::vector<MatchModel::MoveAnalysis> moves;
+      if (!analyzeMatch(match, moves))
+        return; // Server đang dừng, bỏ cả lô
+
+      auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                        Clock::now() - start)
+                        .count();
+      Metrics &metrics = Metrics::getInstance();
+      metrics.analysis_game_us.observe(micros);
+      metrics.analysis_games.inc();
+      LOG_INFO("analysis_done", "game_id", game_id, "moves", moves.size(),
+               "blunders",
+               std::count_if(moves.begin(), moves.end(),
+                             [](const MatchModel::MoveAnalysis &move) {
+                               return move.judgement ==
+                                      AnalysisResponseMessage::BLUNDER;
+                             }),
+               "time_ms", micros / 1000);
+      results.emplace_back(game_id, std::move(moves));
+    }
+
+    if (!results.empty())
+      DataStorage::getInstance().storeAnalyses(results, depth);
+  }
+
+  /**
+   * @brief Đánh giá từng nước: so điểm trước và sau nước đi theo góc nhìn
+   * bên vừa đi (điểm chiếu hết được chặn ở ±1000 để một nước bỏ lỡ chiếu hết
+   * vẫn tính là sai lầm mà không lấn át phần còn lại).
+   * @return false nếu server dừng giữa chừng.
+   */
+  bool analyzeMatch(const MatchModel &match,
+                    std::vector<MatchModel::MoveAnalysis> &out) {
+    size_t plies =
+        std::min<size_t>(match.moves.size(), Const::ANALYSIS_MAX_PLIES);
+    if (!waitForIdle())
+      return false;
+    Evaluation before = evaluate(match.start_fen);
+
+    for (size_t i = 0; i < plies; i++) {
+      if (!waitForIdle())
+        return false;
+      Evaluation after = evaluate(match.moves[i].fen);
+
+      int gain = capped(after.white_eval) - capped(before.white_eval);
+      int loss = before.white_to_move ? -gain : gain;
+      out.push_back({after.white_eval, judge(loss), before.best});
+      before = std::move(after);
+    }
+    return true;
+  }
+
+  Evaluation evaluate(const std::string &fen) {
+    chess::Board board(fen);
+    Evaluation evaluation;
+    evaluation.white_to_move = board.sideToMove() == chess::Color::WHITE;
+
+    chess::Movelist moves;
+    chess::movegen::legalmoves(moves, board);
+    int score = 0;
+    if (moves.empty()) {
+      score = board.inCheck() ? -Engine::MATE : 0;
+    } else {
+      SearchLimits limits;
+      limits.max_depth = depth;
+      limits.time_ms = Const::ANALYSIS_POSITION_MS;
+      limits.abort = &stopping;
+      SearchResult result = engine.search(board, limits);
+      score = result.score;
+      evaluation.best = chess::uci::moveToUci(result.move);
+      Metrics::getInstance().analysis_nodes.inc(result.nodes);
+    }
+    evaluation.white_eval = evaluation.white_to_move ? score : -score;
+    return evaluation;
+  }
+
+  // Chờ tới khi máy của các ván đang chơi rảnh; false nếu server đang dừng
+  bool waitForIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping && live_busy && live_busy())
+      cv.wait_for(lock, std::chrono::milliseconds(Const::ANALYSIS_BACKOFF_MS));
+    return !stopping;
+  }
+
+  static int capped(int eval) { return std::clamp(eval, -1000, 1000); }
+
+  static uint8_t judge(int loss) {
+    if (loss >= Const::BLUNDER_CP)
+      return AnalysisResponseMessage::BLUNDER;
+    if (loss >= Const::MISTAKE_CP)
+      return AnalysisResponseMessage::MISTAKE;
+    if (loss >= Const::INACCURACY_CP)
+      return AnalysisResponseMessage::INACCURACY;
+    return AnalysisResponseMessage::GOOD;
+  }
+};
+
+#endif // ANALYSIS_HPP
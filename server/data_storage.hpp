@@ -1,17 +1,30 @@
 #ifndef DATA_STORAGE_HPP
 #define DATA_STORAGE_HPP
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
 #include <limits.h>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unistd.h>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "../common/const.hpp"
 #include "../common/json_handler.hpp"
 #include "../libraries/json.hpp"
+#include "game_archive.hpp"
+#include "logger.hpp"
+#include "match_history_index.hpp"
+#include "metrics.hpp"
+#include "rating.hpp"
+#include "rating_index.hpp"
+#include "server_config.hpp"
 #include "structs.hpp"
+#include "tracer.hpp"
 
 /**
  * @brief Lớp DataStorage quản lý việc lưu trữ và truy xuất dữ liệu (Người dùng
@@ -20,6 +33,10 @@
  * Sử dụng mẫu thiết kế Singleton: Đảm bảo chỉ có một đối tượng duy nhất tồn tại
  * trong suốt chương trình. Sử dụng Mutex để đảm bảo an toàn khi nhiều luồng
  * (thread) cùng truy cập dữ liệu (Thread-safe).
+ *
+ * Thay đổi Elo được ghi trễ (write-behind): chỉ đánh dấu users là "bẩn", một
+ * luồng nền ghi users.json tối đa một lần mỗi Const::USERS_FLUSH_MS. Đăng ký
+ * tài khoản vẫn được ghi ngay. Gọi flushUsers() trước khi dừng server.
  */
 class DataStorage {
 public:
@@ -42,15 +59,18 @@ public:
                     const uint16_t elo = Const::DEFAULT_ELO) {
     // Khóa mutex để đảm bảo không có luồng nào khác can thiệp khi đang ghi dữ
     // liệu
-    std::lock_guard<std::mutex> lock(users_mutex);
+    std::unique_lock<std::mutex> lock(users_mutex);
 
     if (users.find(username) != users.end()) {
       return false; // Username đã tồn tại
     }
 
     users[username] = UserModel{username, elo};
+    rating_index.insert(username, elo);
+    users_dirty = true;
+    lock.unlock();
 
-    saveUsersData(); // Lưu lại vào file JSON ngay lập tức
+    flushUsers(); // Lưu lại vào file JSON ngay lập tức
 
     return true;
   }
@@ -77,26 +97,62 @@ public:
   }
 
   /**
-   * @brief Cập nhật điểm ELO cho người dùng.
+   * @brief Cập nhật Elo của cả hai người chơi sau một ván (trong một lần
+   * khóa, cả hai đều tính từ rating trước ván) và đánh dấu cần ghi file.
+   *
+   * @param white_score Kết quả của bên trắng: 1 thắng, 0.5 hòa, 0 thua.
+   * @return false nếu một trong hai người chơi không tồn tại.
    */
-  bool updateUserELO(const std::string &username, const uint16_t elo) {
-    std::lock_guard<std::mutex> lock(users_mutex);
-
-    auto it = users.find(username);
-    if (it != users.end()) {
-      it->second.elo = elo;
-      saveUsersData(); // Lưu thay đổi vào file
-      return true;
+  bool applyGameResult(const std::string &white_username,
+                       const std::string &black_username, double white_score,
+                       RatingChange &change) {
+    {
+      std::lock_guard<std::mutex> lock(users_mutex);
+
+      auto white = users.find(white_username);
+      auto black = users.find(black_username);
+      if (white == users.end() || black == users.end() || white == black)
+        return false;
+
+      UserModel &w = white->second;
+      UserModel &b = black->second;
+      change.white_before = w.elo;
+      change.black_before = b.elo;
+      change.white_after =
+          Rating::updated(w.elo, w.games_played, b.elo, white_score);
+      change.black_after =
+          Rating::updated(b.elo, b.games_played, w.elo, 1.0 - white_score);
+
+      w.elo = change.white_after;
+      b.elo = change.black_after;
+      rating_index.update(white_username, change.white_before, w.elo);
+      rating_index.update(black_username, change.black_before, b.elo);
+      w.games_played++;
+      b.games_played++;
+      users_dirty = true;
     }
-    return false;
+    scheduleUsersFlush();
+    return true;
   }
 
   /**
-   * @brief Lấy danh sách toàn bộ người dùng.
+   * @brief Ghi users.json ngay nếu có thay đổi chưa được ghi.
    */
-  std::unordered_map<std::string, UserModel> getPlayerList() {
-    std::lock_guard<std::mutex> lock(users_mutex);
-    return users;
+  void flushUsers() {
+    // flush_mutex giữ thứ tự ghi: bản chụp mới hơn không bị bản cũ ghi đè
+    std::lock_guard<std::mutex> flush_lock(flush_mutex);
+    json j;
+    {
+      std::lock_guard<std::mutex> lock(users_mutex);
+      if (!users_dirty)
+        return;
+      users_dirty = false;
+      TraceSpan span("storage.users.serialize");
+      for (const auto &[username, user] : users) {
+        j[username] = user.serialize();
+      }
+    }
+    writeUsersJSON(j);
   }
 
   /**
@@ -113,17 +169,34 @@ public:
       return 0;
     }
 
-    uint16_t user_elo = it->second.elo;
-    int rank = 1;
+    // Rank = 1 + số người có Elo cao hơn, tra trong chỉ mục Elo
+    return static_cast<int>(rating_index.rankOf(it->second.elo));
+  }
 
-    // Duyệt qua tất cả người dùng để đếm xem có bao nhiêu người điểm cao hơn
-    for (const auto &[name, user] : users) {
-      if (user.elo > user_elo) {
-        rank++;
-      }
-    }
+  /**
+   * @brief Bảng xếp hạng: limit người chơi có Elo cao nhất.
+   * @param total Nhận tổng số người chơi đã đăng ký.
+   */
+  std::vector<RatingIndex::Entry> getLeaderboardTop(size_t limit,
+                                                    uint32_t &total) {
+    std::lock_guard<std::mutex> lock(users_mutex);
+    total = rating_index.size();
+    return rating_index.top(limit);
+  }
 
-    return rank;
+  /**
+   * @brief Bảng xếp hạng quanh một người chơi (người đó ở giữa nếu có thể).
+   * Rỗng nếu không tìm thấy người chơi.
+   */
+  std::vector<RatingIndex::Entry>
+  getLeaderboardAround(const std::string &username, size_t limit,
+                       uint32_t &total) {
+    std::lock_guard<std::mutex> lock(users_mutex);
+    total = rating_index.size();
+    auto it = users.find(username);
+    if (it == users.end())
+      return {};
+    return rating_index.around(username, it->second.elo, limit);
   }
 
 public:
@@ -146,7 +219,7 @@ public:
                      const std::string &black_ip = "") {
     std::lock_guard<std::mutex> lock(matches_mutex);
 
-    if (matches.find(game_id) != matches.end()) {
+    if (matches.find(game_id) != matches.end() || archive.contains(game_id)) {
       return false; // Trận đấu đã tồn tại
     }
 
@@ -165,13 +238,17 @@ public:
     match.reason = "";
 
     matches[game_id] = match;
+    MatchHistoryIndex::Key key{nanos(match.start_time), game_id};
+    history_index.add(white_username, key);
+    history_index.add(black_username, key);
 
     saveMatchesData(); // Lưu vào file matches.json
     return true;
   }
 
   /**
-   * @brief Cập nhật kết quả cuối cùng của trận đấu.
+   * @brief Cập nhật kết quả cuối cùng của trận đấu. Ván đã kết thúc được
+   * chuyển sang matches.arc (dạng nén), matches.json chỉ giữ ván đang chơi.
    */
   bool updateMatchResult(const std::string &game_id, const std::string &result,
                          const std::string &reason) {
@@ -183,12 +260,68 @@ public:
       it->second.reason = reason;
       it->second.end_time =
           std::chrono::system_clock::now(); // Ghi nhận thời gian kết thúc
+      archiveMatch(it);
       saveMatchesData();
       return true;
     }
     return false;
   }
 
+  /**
+   * @brief Xóa một trận chưa từng bắt đầu (trận tự động bị từ chối hoặc hết
+   * hạn chấp nhận) để nó không hiện trong lịch sử như một ván đang chơi.
+   * Trận đã có kết quả không bị xóa.
+   */
+  bool removeMatch(const std::string &game_id) {
+    std::lock_guard<std::mutex> lock(matches_mutex);
+
+    auto it = matches.find(game_id);
+    if (it == matches.end() || !it->second.result.empty())
+      return false;
+    MatchHistoryIndex::Key key{nanos(it->second.start_time), game_id};
+    history_index.remove(it->second.white_username, key);
+    history_index.remove(it->second.black_username, key);
+    matches.erase(it);
+    saveMatchesData();
+    return true;
+  }
+
+  /**
+   * @brief Đóng các trận còn mở nhưng không còn ván đang chơi (server dừng
+   * khi ván chưa kết thúc). Chỉ gọi lúc khởi động, trước khi có ván nào.
+   * Trận chưa có nước đi bị xóa; trận đã có nước đi được ghi là hòa do hủy
+   * (không tính Elo) và chuyển sang matches.arc.
+   * @return Số trận đã đóng.
+   */
+  size_t closeAbandonedMatches() {
+    std::lock_guard<std::mutex> lock(matches_mutex);
+    size_t closed = 0;
+    for (auto it = matches.begin(); it != matches.end();) {
+      MatchModel &match = it->second;
+      if (!match.result.empty()) {
+        ++it;
+        continue;
+      }
+      closed++;
+      if (match.moves.empty()) {
+        MatchHistoryIndex::Key key{nanos(match.start_time), it->first};
+        history_index.remove(match.white_username, key);
+        history_index.remove(match.black_username, key);
+        it = matches.erase(it);
+        continue;
+      }
+      match.result = "<0>";
+      match.reason = "Server restarted";
+      match.end_time = match.moves.back().move_time;
+      auto next = std::next(it);
+      archiveMatch(it); // Xóa it khỏi matches nếu ghi được
+      it = next;
+    }
+    if (closed > 0)
+      saveMatchesData();
+    return closed;
+  }
+
   /**
    * @brief Lấy thông tin chi tiết của một trận đấu qua ID.
    */
@@ -199,14 +332,147 @@ public:
     if (it != matches.end()) {
       return it->second;
     }
+    MatchModel match;
+    if (archive.read(game_id, match))
+      return match;
     throw std::runtime_error("Match not found.");
   }
 
+  // Số trận đã có kết quả, không cần đọc trận nào
+  size_t finishedMatchCount() {
+    std::lock_guard<std::mutex> lock(matches_mutex);
+    size_t count = archive.size();
+    for (const auto &[game_id, match] : matches)
+      if (!match.result.empty())
+        count++; // Ván không nén được
+    return count;
+  }
+
+  // game_id của mọi trận đã có kết quả
+  std::vector<std::string> getFinishedMatchIds() {
+    std::lock_guard<std::mutex> lock(matches_mutex);
+    std::vector<std::string> ids = archive.gameIds();
+    for (const auto &[game_id, match] : matches)
+      if (!match.result.empty())
+        ids.push_back(game_id);
+    return ids;
+  }
+
+  /**
+   * @brief Đọc một trận đã có kết quả. Chỉ giữ matches_mutex khi đọc bản
+   * ghi; việc giải mã (đi lại ván) chạy ngoài khóa nên nhiều luồng đọc song
+   * song được.
+   * @return false nếu không có trận hoặc trận chưa có kết quả.
+   */
+  bool getFinishedMatch(const std::string &game_id, MatchModel &match) {
+    std::string payload;
+    {
+      std::lock_guard<std::mutex> lock(matches_mutex);
+      auto it = matches.find(game_id);
+      if (it != matches.end()) {
+        match = it->second;
+        return !match.result.empty();
+      }
+      if (!archive.readPayload(game_id, payload))
+        return false;
+    }
+    return GameArchive::decode(payload, match);
+  }
+
+  /**
+   * @brief game_id của mọi trận đã có kết quả, theo thời gian bắt đầu (rồi
+   * game_id) để bản xuất ổn định giữa các lần chạy. Chỉ đọc thông tin chung
+   * của mỗi ván, không đi lại các nước.
+   */
+  std::vector<std::string> getFinishedMatchIdsByStart() {
+    std::vector<std::pair<int64_t, std::string>> order;
+    {
+      std::lock_guard<std::mutex> lock(matches_mutex);
+      for (const auto &[game_id, match] : matches)
+        if (!match.result.empty())
+          order.emplace_back(nanos(match.start_time), game_id);
+      for (const std::string &game_id : archive.gameIds()) {
+        MatchModel summary;
+        uint64_t plies = 0;
+        if (archive.readSummary(game_id, summary, plies))
+          order.emplace_back(nanos(summary.start_time), game_id);
+      }
+    }
+    std::sort(order.begin(), order.end());
+    std::vector<std::string> ids;
+    ids.reserve(order.size());
+    for (auto &[start, game_id] : order)
+      ids.push_back(std::move(game_id));
+    return ids;
+  }
+
+  /**
+   * @brief Thêm các ván đã kết thúc từ nguồn ngoài (công cụ pgn) thẳng vào
+   * matches.arc. Ván trùng game_id với ván đã có bị bỏ qua.
+   * @return Số ván đã thêm.
+   */
+  size_t importMatches(const std::vector<MatchModel> &imported) {
+    std::lock_guard<std::mutex> lock(matches_mutex);
+    size_t added = 0;
+    for (const MatchModel &match : imported) {
+      if (match.result.empty() || matches.count(match.game_id) ||
+          archive.contains(match.game_id))
+        continue;
+      if (archive.append(match)) {
+        indexHistory(match);
+        added++;
+      }
+    }
+    return added;
+  }
+
+  /**
+   * @brief Một trang lịch sử ván của người chơi, mới nhất trước.
+   *
+   * @param before Khóa của ván cuối trang trước (nullptr = từ ván mới nhất).
+   * @param total Nhận tổng số ván của người chơi.
+   * @param has_more Nhận true nếu còn ván cũ hơn trang này.
+   */
+  std::vector<MatchHistoryIndex::Entry>
+  getMatchHistory(const std::string &username,
+                  const MatchHistoryIndex::Key *before, size_t limit,
+                  uint32_t &total, bool &has_more) {
+    std::lock_guard<std::mutex> lock(matches_mutex);
+    total = static_cast<uint32_t>(history_index.count(username));
+    std::vector<MatchHistoryIndex::Entry> entries;
+    for (const MatchHistoryIndex::Key &key :
+         history_index.page(username, before, limit, has_more)) {
+      MatchHistoryIndex::Entry entry;
+      entry.key = key;
+      auto it = matches.find(key.game_id);
+      if (it != matches.end()) {
+        entry.match = it->second;
+        entry.match.moves.clear();
+        entry.match.analysis.clear();
+        entry.plies = it->second.moves.size();
+      } else if (!archive.readSummary(key.game_id, entry.match,
+                                      entry.plies)) {
+        continue;
+      }
+      entries.push_back(std::move(entry));
+    }
+    return entries;
+  }
+
+  /**
+   * @brief Người chơi đã từng có ván nào chưa.
+   */
+  bool hasMatchHistory(const std::string &username) {
+    std::lock_guard<std::mutex> lock(matches_mutex);
+    return history_index.contains(username);
+  }
+
   /**
    * @brief Lưu lại một nước đi mới vào lịch sử trận đấu.
    */
   bool addMove(const std::string &game_id, const std::string &uci_move,
                const std::string &fen) {
+    TraceSpan span("storage.addMove");
     std::lock_guard<std::mutex> lock(matches_mutex);
 
     auto it = matches.find(game_id);
@@ -222,25 +488,93 @@ public:
     return false;
   }
 
+  /**
+   * @brief Lưu kết quả phân tích của một lô ván trong một lần ghi
+   * matches.json. Ván đã nén được ghi lại (bản mới) vào cuối matches.arc.
+   *
+   * @param analyses Cặp (game_id, đánh giá từng nước); ván không còn tồn tại
+   * bị bỏ qua.
+   * @param depth Độ sâu tìm kiếm đã dùng.
+   */
+  void storeAnalyses(
+      const std::vector<std::pair<std::string,
+                                  std::vector<MatchModel::MoveAnalysis>>>
+          &analyses,
+      int depth) {
+    std::lock_guard<std::mutex> lock(matches_mutex);
+    bool changed = false;
+    for (const auto &[game_id, moves] : analyses) {
+      auto it = matches.find(game_id);
+      if (it == matches.end()) {
+        MatchModel match;
+        if (!archive.read(game_id, match))
+          continue;
+        match.analysis = moves;
+        match.analysis_depth = depth;
+        if (!archive.append(match))
+          LOG_ERROR("archive_write_failed", "game_id", game_id);
+        continue;
+      }
+      it->second.analysis = moves;
+      it->second.analysis_depth = depth;
+      changed = true;
+    }
+    if (changed)
+      saveMatchesData();
+  }
+
+  /**
+   * @brief Đường dẫn một file trong thư mục dữ liệu (cùng thư mục với
+   * users.json và matches.json).
+   */
+  std::string getDataFilePath(const std::string &name) {
+    return getDataPath() + name;
+  }
+
 private:
   // Dữ liệu người dùng: ánh xạ từ username sang UserModel
   std::unordered_map<std::string, UserModel> users;
   std::mutex users_mutex; // Mutex bảo vệ dữ liệu người dùng
+  bool users_dirty = false; // Có thay đổi chưa ghi ra users.json
+  RatingIndex rating_index; // Người chơi theo Elo (được bảo vệ bởi users_mutex)
 
-  // Dữ liệu trận đấu: ánh xạ từ game_id sang MatchModel
+  // Luồng ghi trễ users.json (chỉ tạo khi có thay đổi Elo đầu tiên)
+  std::mutex flush_mutex;
+  std::mutex writer_mutex;
+  std::condition_variable writer_cv;
+  std::thread writer;
+  bool writer_stopping = false;
+
+  // Dữ liệu trận đấu: ánh xạ từ game_id sang MatchModel (ván đang chơi)
   std::unordered_map<std::string, MatchModel> matches;
-  std::mutex matches_mutex; // Mutex bảo vệ dữ liệu trận đấu
+  GameArchive archive;      // Ván đã kết thúc (matches.arc)
+  MatchHistoryIndex history_index; // Ván của từng người chơi theo thời gian
+  std::mutex matches_mutex; // Mutex bảo vệ matches, archive và history_index
 
   // Các phương thức private để ngăn chặn việc tạo thêm instance (Singleton)
-  ~DataStorage() = default;
+  ~DataStorage() {
+    {
+      std::lock_guard<std::mutex> lock(writer_mutex);
+      writer_stopping = true;
+    }
+    writer_cv.notify_all();
+    if (writer.joinable())
+      writer.join();
+    flushUsers();
+  }
   DataStorage(const DataStorage &) = delete;
   DataStorage &operator=(const DataStorage &) = delete;
 
   /**
-   * @brief Xác định đường dẫn thư mục chứa dữ liệu (data/) tương đối với file
-   * thực thi.
+   * @brief Xác định đường dẫn thư mục chứa dữ liệu: --data-dir nếu có, mặc
+   * định là data/ tương đối với file thực thi.
    */
   std::string getDataPath() {
+    // Thư mục được chỉ định bằng --data-dir
+    const std::string &data_dir = ServerConfig::getInstance().data_dir;
+    if (!data_dir.empty())
+      return data_dir + "/";
+
     char result[PATH_MAX];
     ssize_t count = readlink("/proc/self/exe", result, PATH_MAX);
     std::string exePath = "";
@@ -265,38 +599,130 @@ private:
     for (auto it = users_j.begin(); it != users_j.end(); ++it) {
       std::string username = it.key();
       users[username] = UserModel::deserialize(username, it.value());
+      rating_index.insert(username, users[username].elo);
     }
 
     // Tải dữ liệu các trận đấu
+    if (!archive.open(dataPath + "matches.arc"))
+      LOG_ERROR("archive_open_failed", "path", dataPath + "matches.arc");
     json matches_j = JSONHandler::readJSON(dataPath + "matches.json");
+    bool migrated = false;
     for (auto it = matches_j.begin(); it != matches_j.end(); ++it) {
       std::string game_id = it.key();
-      matches[game_id] = MatchModel::deserialize(game_id, it.value());
+      MatchModel match = MatchModel::deserialize(game_id, it.value());
+      if (archive.contains(game_id)) {
+        migrated = true; // Đã nén nhưng server dừng trước khi ghi matches.json
+        continue;
+      }
+      auto inserted = matches.emplace(game_id, std::move(match)).first;
+      // Ván đã kết thúc từ file cũ được chuyển sang matches.arc
+      if (!inserted->second.result.empty())
+        migrated = archiveMatch(inserted) || migrated;
     }
+    if (migrated)
+      saveMatchesData();
+    buildHistoryIndex();
+    LOG_INFO("matches_loaded", "live", matches.size(), "archived",
+             archive.size(), "archive_bytes", archive.bytes());
   }
 
   /**
-   * @brief Ghi toàn bộ dữ liệu người dùng hiện tại vào file users.json.
+   * @brief Chuyển một ván đã kết thúc từ matches sang archive. Ván không nén
+   * được (lỗi ghi, nước đi lạ) vẫn ở lại matches.json.
+   * @return true nếu đã chuyển.
    */
-  bool saveUsersData() {
-    json j;
-    for (const auto &[username, user] : users) {
-      j[username] = user.serialize();
+  bool archiveMatch(
+      std::unordered_map<std::string, MatchModel>::iterator it) {
+    if (!archive.append(it->second)) {
+      LOG_ERROR("archive_write_failed", "game_id", it->first);
+      return false;
     }
+    matches.erase(it);
+    return true;
+  }
+
+  static int64_t nanos(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               time.time_since_epoch())
+        .count();
+  }
+
+  void indexHistory(const MatchModel &match) {
+    MatchHistoryIndex::Key key{nanos(match.start_time), match.game_id};
+    history_index.add(match.white_username, key);
+    history_index.add(match.black_username, key);
+  }
+
+  /**
+   * @brief Dựng chỉ mục lịch sử từ ván đang chơi và phần đầu các bản ghi
+   * trong matches.arc. Các ván được sắp theo thời gian trước nên mỗi lần
+   * add() chỉ là push_back.
+   */
+  void buildHistoryIndex() {
+    std::vector<MatchModel> loaded;
+    for (const auto &[game_id, match] : matches) {
+      MatchModel header = match;
+      header.moves.clear();
+      header.analysis.clear();
+      loaded.push_back(std::move(header));
+    }
+    for (const std::string &game_id : archive.gameIds()) {
+      MatchModel header;
+      uint64_t plies = 0;
+      if (archive.readSummary(game_id, header, plies))
+        loaded.push_back(std::move(header));
+    }
+    std::sort(loaded.begin(), loaded.end(),
+              [](const MatchModel &a, const MatchModel &b) {
+                return MatchHistoryIndex::Key{nanos(a.start_time), a.game_id} <
+                       MatchHistoryIndex::Key{nanos(b.start_time), b.game_id};
+              });
+    for (const MatchModel &match : loaded)
+      indexHistory(match);
+  }
+
+  // Khởi động luồng ghi trễ nếu chưa có và báo có thay đổi
+  void scheduleUsersFlush() {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    if (!writer.joinable() && !writer_stopping)
+      writer = std::thread(&DataStorage::runWriter, this);
+  }
+
+  void runWriter() {
+    std::unique_lock<std::mutex> lock(writer_mutex);
+    while (!writer_stopping) {
+      writer_cv.wait_for(lock,
+                         std::chrono::milliseconds(Const::USERS_FLUSH_MS));
+      lock.unlock();
+      flushUsers();
+      lock.lock();
+    }
+  }
+
+  /**
+   * @brief Ghi bản chụp dữ liệu người dùng vào file users.json.
+   */
+  void writeUsersJSON(const json &j) {
+    ScopedTimer timer(Metrics::getInstance().save_users_us);
     std::string dataPath = getDataPath();
+    TraceSpan span("storage.users.write");
     JSONHandler::writeJSON(dataPath + "users.json", j);
-    return true;
   }
 
   /**
    * @brief Ghi toàn bộ dữ liệu trận đấu hiện tại vào file matches.json.
    */
   bool saveMatchesData() {
+    ScopedTimer timer(Metrics::getInstance().save_matches_us);
     json j;
-    for (const auto &[game_id, match] : matches) {
-      j[game_id] = match.serialize();
+    {
+      TraceSpan span("storage.matches.serialize");
+      for (const auto &[game_id, match] : matches) {
+        j[game_id] = match.serialize();
+      }
     }
     std::string dataPath = getDataPath();
+    TraceSpan span("storage.matches.write");
     JSONHandler::writeJSON(dataPath + "matches.json", j);
     return true;
   }
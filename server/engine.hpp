@@ -0,0 +1,842 @@
+// ENGINE_HPP - Máy chơi cờ của server (đối thủ cho chế độ PLAY_VS_ENGINE)
+
+#ifndef ENGINE_HPP
+#define ENGINE_HPP
+
+// Thư viện chuẩn C++
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Thư viện hệ thống
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Thư viện dự án
+#include "../chess_engine/chess.hpp"
+
+/**
+ * @brief Bảng chuyển vị (transposition table) dùng chung, không khóa.
+ *
+ * Cùng kỹ thuật với perft/perft_cache.hpp: mỗi ô lưu data và check = key ^
+ * data, hai luồng ghi xen kẽ chỉ làm ô bị coi như trống. Khóa là
+ * Board::hash() nên mọi ván cờ và mọi luồng tìm kiếm dùng chung một bảng.
+ *
+ * data = nước đi (16 bit) | điểm (16) | độ sâu (8) | loại cận (8).
+ */
+class TranspositionTable {
+public:
+  enum Bound : uint8_t { NONE = 0, UPPER = 1, LOWER = 2, EXACT = 3 };
+
+  struct Hit {
+    uint16_t move;
+    int16_t score;
+    int depth;
+    Bound bound;
+  };
+
+  // Cấp phát lại bảng (xóa nội dung). Không gọi khi đang có tìm kiếm.
+  void resize(size_t size_mb) {
+    size_t entries = size_mb * 1024 * 1024 / sizeof(Entry);
+    size_t power = 1;
+    while (power * 2 <= entries)
+      power *= 2;
+    table.reset(new Entry[power]);
+    mask = power - 1;
+  }
+
+  size_t sizeMb() const {
+    return table ? (mask + 1) * sizeof(Entry) / (1024 * 1024) : 0;
+  }
+
+  bool probe(uint64_t key, Hit &hit) const {
+    if (!table)
+      return false;
+    const Entry &entry = table[key & mask];
+    uint64_t data = entry.data.load(std::memory_order_relaxed);
+    uint64_t check = entry.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || data == 0)
+      return false;
+    hit.move = static_cast<uint16_t>(data);
+    hit.score = static_cast<int16_t>(static_cast<uint16_t>(data >> 16));
+    hit.depth = static_cast<int>((data >> 32) & 0xFF);
+    hit.bound = static_cast<Bound>((data >> 40) & 0xFF);
+    return true;
+  }
+
+  // Giữ ô cũ của cùng vị trí nếu nó sâu hơn (trừ khi ô mới là giá trị đúng)
+  void store(uint64_t key, uint16_t move, int score, int depth, Bound bound) {
+    if (!table)
+      return;
+    Entry &entry = table[key & mask];
+    Hit old;
+    if (probe(key, old)) {
+      if (old.depth > depth && bound != EXACT)
+        return;
+      if (move == 0)
+        move = old.move;
+    }
+    uint64_t data = uint64_t(move) |
+                    uint64_t(static_cast<uint16_t>(score)) << 16 |
+                    uint64_t(std::clamp(depth, 0, 255)) << 32 |
+                    uint64_t(bound) << 40;
+    entry.data.store(data, std::memory_order_relaxed);
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+  }
+
+private:
+  struct Entry {
+    std::atomic<uint64_t> check{0};
+    std::atomic<uint64_t> data{0};
+  };
+
+  std::unique_ptr<Entry[]> table;
+  size_t mask = 0;
+};
+
+// Giới hạn cho một lần tìm nước đi
+struct SearchLimits {
+  int64_t time_ms = 1000; // Thời gian tối đa, tính từ lúc gửi (kể cả lúc chờ)
+  int max_depth = 64;     // Độ sâu tối đa (cấp độ của máy)
+  // Đồng hồ còn lại của bên đi: ván ít thời gian hơn được tìm trước
+  int64_t clock_ms = std::numeric_limits<int64_t>::max();
+  const std::atomic<bool> *abort = nullptr; // true: bỏ tìm kiếm (ván đã đóng)
+};
+
+struct SearchResult {
+  chess::Move move = chess::Move::NO_MOVE;
+  int score = 0;  // Centipawn, theo góc nhìn bên đi
+  int depth = 0;  // Độ sâu hoàn thành của kết quả được chọn
+  uint64_t nodes = 0;
+  int64_t time_ms = 0;  // Thời gian tìm, không tính lúc chờ trong hàng đợi
+  int64_t wait_us = 0;  // Thời gian chờ trong hàng đợi trước khi bắt đầu
+  unsigned threads = 0; // Số luồng đã tham gia tìm
+};
+
+/**
+ * @brief Máy chơi cờ: iterative deepening alpha-beta (PVS, null move, LMR,
+ * quiescence) trên chess::Board, đánh giá bằng vật chất + bảng vị trí quân.
+ *
+ * Mọi lần tìm kiếm chạy trên một nhóm luồng cố định của engine (tạo trong
+ * configure()), tách khỏi các luồng mạng; submit() chỉ xếp yêu cầu vào hàng
+ * đợi và trả về ngay. Hàng đợi ưu tiên ván có đồng hồ thấp nhất. Luồng rảnh
+ * nhận yêu cầu kế tiếp làm luồng chính, hoặc nếu hàng đợi trống thì "ăn cắp"
+ * việc: tham gia một lần tìm đang chạy (ít luồng nhất) làm luồng phụ Lazy
+ * SMP, chia sẻ kết quả qua bảng chuyển vị. Khi có yêu cầu đang chờ mà hết
+ * luồng rảnh, luồng phụ của các lần tìm vượt phần chia đều phải nhường.
+ *
+ * Thời gian của mỗi nước do caller tính từ đồng hồ ván cờ (moveTimeMs) và
+ * được đếm từ lúc gửi, nên thời gian chờ trong hàng đợi trừ vào chính nước đó.
+ */
+class Engine {
+public:
+  static constexpr int MAX_PLY = 96;
+  static constexpr int INF = 32000;
+  static constexpr int MATE = 31000;
+  static constexpr int MATE_BOUND = MATE - MAX_PLY; // Điểm >= đây là chiếu hết
+
+  using Callback = std::function<void(const SearchResult &)>;
+
+  Engine() = default;
+  Engine(const Engine &) = delete;
+  Engine &operator=(const Engine &) = delete;
+
+  ~Engine() {
+    stop();
+    for (std::thread &thread : pool)
+      thread.join();
+  }
+
+  /**
+   * @brief Tạo nhóm luồng tìm kiếm và bảng chuyển vị. Gọi một lần, trước lần
+   * submit() đầu tiên.
+   * @param threads Số luồng, 0 = số lõi CPU.
+   * @param nice > 0: hạ độ ưu tiên của các luồng tìm kiếm để luồng mạng luôn
+   * được chạy trước.
+   */
+  void configure(unsigned threads, size_t hash_mb, int nice = 0) {
+    if (threads == 0)
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!pool.empty())
+      return;
+    tt.resize(hash_mb);
+    for (unsigned i = 0; i < threads; i++)
+      pool.emplace_back([this, nice] { workerLoop(nice); });
+  }
+
+  unsigned threadBudget() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<unsigned>(pool.size());
+  }
+
+  // Còn yêu cầu đang chờ hoặc đang tìm
+  bool busy() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !pending.empty() || !running.empty();
+  }
+
+  /**
+   * @brief Thời gian cho một nước: khoảng 1/30 thời gian còn lại cộng phần
+   * lớn thời gian cộng thêm, không quá max_ms và luôn chừa lại một nửa đồng
+   * hồ để không bao giờ hết giờ vì suy nghĩ.
+   */
+  static int64_t moveTimeMs(int64_t remaining_ms, int64_t increment_ms,
+                            int64_t max_ms) {
+    int64_t budget = remaining_ms / 30 + increment_ms * 3 / 4;
+    budget = std::min({budget, max_ms, remaining_ms / 2});
+    return std::max<int64_t>(budget, 10);
+  }
+
+  /**
+   * @brief Xếp một lần tìm nước đi vào hàng đợi. done được gọi đúng một lần
+   * trên luồng tìm kiếm (hoặc ngay trên luồng gọi nếu vị trí hết nước đi hay
+   * engine đã dừng) và phải tự xử lý nhanh. Kết quả luôn có một nước hợp lệ
+   * (ít nhất độ sâu 1, hoặc nước đầu tiên nếu bị bỏ) khi vị trí còn nước đi.
+   */
+  void submit(const chess::Board &root, const SearchLimits &limits,
+              Callback done) {
+    auto job = std::make_shared<Job>(root, limits, std::move(done));
+    chess::movegen::legalmoves(job->root_moves, root);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!job->root_moves.empty() &&
+          !stopping.load(std::memory_order_relaxed)) {
+        job->seq = next_seq++;
+        pending.push(job);
+        rebalanceLocked();
+        cv.notify_all();
+        return;
+      }
+    }
+    SearchResult result;
+    if (!job->root_moves.empty())
+      result.move = job->root_moves[0];
+    job->done(result);
+  }
+
+  // Tìm đồng bộ: chờ kết quả của submit() (bench, công cụ dòng lệnh)
+  SearchResult search(const chess::Board &root, const SearchLimits &limits) {
+    std::promise<SearchResult> promise;
+    std::future<SearchResult> future = promise.get_future();
+    submit(root, limits,
+           [&promise](const SearchResult &result) { promise.set_value(result); });
+    return future.get();
+  }
+
+  /**
+   * @brief Dừng mọi tìm kiếm đang chạy (trả về nước tốt nhất đã có), bỏ các
+   * yêu cầu đang chờ (done vẫn được gọi) và từ chối yêu cầu mới.
+   */
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping.store(true, std::memory_order_relaxed);
+    }
+    cv.notify_all();
+  }
+
+  // Đánh giá tĩnh theo góc nhìn bên đang đi (centipawn)
+  static int evaluate(const chess::Board &board) {
+    int mg = 0, eg_king = 0, mg_king = 0, phase = 0;
+    for (int color = 0; color < 2; color++) {
+      int sign = color == 0 ? 1 : -1;
+      chess::Color side = color == 0 ? chess::Color::WHITE : chess::Color::BLACK;
+      for (int pt = 0; pt < 5; pt++) {
+        chess::Bitboard pieces =
+            board.pieces(static_cast<chess::PieceType::underlying>(pt), side);
+        phase += PHASE_WEIGHT[pt] * pieces.count();
+        while (!pieces.empty()) {
+          int sq = relativeSquare(pieces.pop(), color);
+          mg += sign * (PIECE_VALUE[pt] + PST[pt][sq]);
+        }
+      }
+      int king = relativeSquare(board.kingSq(side).index(), color);
+      mg_king += sign * KING_MG[king];
+      eg_king += sign * KING_EG[king];
+    }
+    phase = std::min(phase, 24);
+    int score = mg + (mg_king * phase + eg_king * (24 - phase)) / 24;
+    return board.sideToMove() == chess::Color::WHITE ? score : -score;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  // Trạng thái dùng chung của các luồng trong một lần search()
+  struct Shared {
+    TranspositionTable &tt;
+    const std::atomic<bool> &stopping;
+    const std::atomic<bool> *abort;
+    Clock::time_point deadline;
+    std::atomic<bool> stop{false};
+
+    Shared(TranspositionTable &tt, const std::atomic<bool> &stopping,
+           const std::atomic<bool> *abort, Clock::time_point deadline)
+        : tt(tt), stopping(stopping), abort(abort), deadline(deadline) {}
+  };
+
+  // Một yêu cầu tìm nước đi. Các trường không atomic được bảo vệ bởi mutex.
+  struct Job {
+    chess::Board root;
+    SearchLimits limits;
+    Callback done;
+    chess::Movelist root_moves;
+    Clock::time_point submitted = Clock::now();
+    uint64_t seq = 0;               // Thứ tự gửi, phân xử khi đồng hồ bằng nhau
+    std::unique_ptr<Shared> shared; // Tạo khi luồng chính nhận việc
+    std::atomic<bool> shrink{false}; // Luồng phụ phải rời để nhường luồng
+    unsigned threads = 0;           // Số luồng đang tìm, kể cả luồng chính
+    unsigned next_id = 1;           // id của luồng phụ kế tiếp
+    bool finishing = false;         // Không nhận thêm luồng phụ
+    // Kết quả sâu nhất của các luồng phụ đã rời và tổng số nút của họ
+    chess::Move helper_move = chess::Move::NO_MOVE;
+    int helper_score = 0;
+    int helper_depth = 0;
+    uint64_t helper_nodes = 0;
+
+    Job(const chess::Board &root, const SearchLimits &limits, Callback done)
+        : root(root), limits(limits), done(std::move(done)) {}
+  };
+
+  // Đỉnh hàng đợi: đồng hồ thấp nhất, rồi gửi sớm nhất
+  struct LowestClockFirst {
+    bool operator()(const std::shared_ptr<Job> &a,
+                    const std::shared_ptr<Job> &b) const {
+      if (a->limits.clock_ms != b->limits.clock_ms)
+        return a->limits.clock_ms > b->limits.clock_ms;
+      return a->seq > b->seq;
+    }
+  };
+
+  // Một luồng tìm kiếm: bản sao bàn cờ + bảng killer/history riêng
+  class Worker {
+  public:
+    chess::Move best_move = chess::Move::NO_MOVE;
+    int best_score = 0;
+    int completed_depth = 0;
+    uint64_t nodes = 0;
+
+    // yield (chỉ luồng phụ): true thì rời lần tìm này để nhường luồng
+    Worker(const chess::Board &root, Shared &shared, unsigned id,
+           const std::atomic<bool> *yield = nullptr)
+        : board(root), shared(shared), id(id), yield(yield) {}
+
+    /**
+     * @brief Iterative deepening tới max_depth. time_ms > 0 (luồng chính):
+     * không bắt đầu độ sâu mới khi đã dùng quá nửa thời gian. Luồng phụ lệch
+     * độ sâu theo id để các luồng không tìm trùng nhau hoàn toàn.
+     */
+    void iterate(int max_depth, int64_t time_ms) {
+      auto start = Clock::now();
+      for (int depth = 1 + int(id & 1); depth <= max_depth; depth++) {
+        root_move = chess::Move::NO_MOVE;
+        int score = negamax(-INF, INF, depth, 0, false);
+        if (stopped())
+          break;
+        best_move = root_move;
+        best_score = score;
+        completed_depth = depth;
+
+        if (time_ms > 0 && std::abs(score) >= MATE_BOUND)
+          break; // Đã thấy chiếu hết, tìm sâu hơn không đổi kết quả
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           Clock::now() - start)
+                           .count();
+        if (time_ms > 0 && elapsed * 2 >= time_ms)
+          break;
+      }
+    }
+
+  private:
+    chess::Board board;
+    Shared &shared;
+    unsigned id;
+    const std::atomic<bool> *yield;
+    bool yielded = false;
+    chess::Move root_move = chess::Move::NO_MOVE;
+    chess::Move killers[MAX_PLY][2] = {};
+    int history[2][64][64] = {};
+
+    // Luồng chính luôn hoàn thành độ sâu 1 để có nước đi
+    bool stopped() const {
+      return (shared.stop.load(std::memory_order_relaxed) || yielded) &&
+             (id != 0 || completed_depth > 0);
+    }
+
+    // Đếm nút, mỗi 1024 nút kiểm tra hết giờ / ván đã đóng / server dừng /
+    // phải nhường luồng
+    void visit() {
+      if ((++nodes & 1023) != 0)
+        return;
+      if (yield && yield->load(std::memory_order_relaxed))
+        yielded = true;
+      if (Clock::now() >= shared.deadline ||
+          shared.stopping.load(std::memory_order_relaxed) ||
+          (shared.abort && shared.abort->load(std::memory_order_relaxed)))
+        shared.stop.store(true, std::memory_order_relaxed);
+    }
+
+    // Điểm chiếu hết trong bảng tính từ vị trí đang lưu, không từ gốc
+    static int toTT(int score, int ply) {
+      return score >= MATE_BOUND ? score + ply
+             : score <= -MATE_BOUND ? score - ply
+                                    : score;
+    }
+    static int fromTT(int score, int ply) {
+      return score >= MATE_BOUND ? score - ply
+             : score <= -MATE_BOUND ? score + ply
+                                    : score;
+    }
+
+    int negamax(int alpha, int beta, int depth, int ply, bool allow_null) {
+      bool root = ply == 0;
+      if (!root && (board.isHalfMoveDraw() || board.isRepetition(1) ||
+                    board.isInsufficientMaterial()))
+        return 0;
+      if (ply >= MAX_PLY - 1)
+        return evaluate(board);
+
+      bool in_check = board.inCheck();
+      if (in_check)
+        depth++; // Mở rộng khi bị chiếu
+      if (depth <= 0)
+        return quiescence(alpha, beta, ply);
+
+      visit();
+      if (stopped())
+        return 0;
+
+      bool pv_node = beta - alpha > 1;
+      uint64_t key = board.hash();
+      uint16_t tt_move = 0;
+      TranspositionTable::Hit hit;
+      if (shared.tt.probe(key, hit)) {
+        tt_move = hit.move;
+        int score = fromTT(hit.score, ply);
+        if (!pv_node && hit.depth >= depth &&
+            (hit.bound == TranspositionTable::EXACT ||
+             (hit.bound == TranspositionTable::LOWER && score >= beta) ||
+             (hit.bound == TranspositionTable::UPPER && score <= alpha)))
+          return score;
+      }
+
+      // Null move: nhường lượt mà vẫn >= beta thì vị trí đủ tốt để cắt
+      if (allow_null && !pv_node && !in_check && depth >= 3 &&
+          board.hasNonPawnMaterial(board.sideToMove()) &&
+          evaluate(board) >= beta) {
+        board.makeNullMove();
+        int score =
+            -negamax(-beta, -beta + 1, depth - 3 - depth / 4, ply + 1, false);
+        board.unmakeNullMove();
+        if (stopped())
+          return 0;
+        if (score >= beta)
+          return score >= MATE_BOUND ? beta : score;
+      }
+
+      chess::Movelist moves;
+      chess::movegen::legalmoves(moves, board);
+      if (moves.empty())
+        return in_check ? -MATE + ply : 0;
+      scoreMoves(moves, tt_move, ply);
+
+      int alpha_orig = alpha;
+      int best = -INF;
+      uint16_t best_move = 0;
+      for (int i = 0; i < moves.size(); i++) {
+        pickNext(moves, i);
+        const chess::Move move = moves[i];
+        bool quiet = !board.isCapture(move) &&
+                     move.typeOf() != chess::Move::PROMOTION;
+
+        board.makeMove(move);
+        int score;
+        if (i == 0) {
+          score = -negamax(-beta, -alpha, depth - 1, ply + 1, true);
+        } else {
+          // Late move reduction cho nước yên tĩnh xếp cuối
+          int reduction =
+              (depth >= 3 && i >= 4 && quiet && !in_check) ? 1 + (i >= 12) : 0;
+          score = -negamax(-alpha - 1, -alpha, depth - 1 - reduction, ply + 1,
+                           true);
+          if (score > alpha && reduction > 0)
+            score = -negamax(-alpha - 1, -alpha, depth - 1, ply + 1, true);
+          if (score > alpha && score < beta)
+            score = -negamax(-beta, -alpha, depth - 1, ply + 1, true);
+        }
+        board.unmakeMove(move);
+        if (stopped())
+          return 0;
+
+        if (score <= best)
+          continue;
+        best = score;
+        best_move = move.move();
+        if (root)
+          root_move = move;
+        if (score <= alpha)
+          continue;
+        alpha = score;
+        if (alpha >= beta) {
+          if (quiet)
+            rememberCutoff(move, depth, ply);
+          break;
+        }
+      }
+
+      TranspositionTable::Bound bound =
+          best >= beta          ? TranspositionTable::LOWER
+          : best > alpha_orig   ? TranspositionTable::EXACT
+                                : TranspositionTable::UPPER;
+      shared.tt.store(key, best_move, toTT(best, ply), depth, bound);
+      return best;
+    }
+
+    // Chỉ xét nước ăn quân cho tới khi vị trí yên tĩnh
+    int quiescence(int alpha, int beta, int ply) {
+      visit();
+      if (stopped())
+        return 0;
+
+      int stand_pat = evaluate(board);
+      if (stand_pat >= beta || ply >= MAX_PLY - 1)
+        return stand_pat;
+      alpha = std::max(alpha, stand_pat);
+
+      chess::Movelist moves;
+      chess::movegen::legalmoves<chess::movegen::MoveGenType::CAPTURE>(moves,
+                                                                       board);
+      scoreMoves(moves, 0, ply);
+
+      int best = stand_pat;
+      for (int i = 0; i < moves.size(); i++) {
+        pickNext(moves, i);
+        board.makeMove(moves[i]);
+        int score = -quiescence(-beta, -alpha, ply + 1);
+        board.unmakeMove(moves[i]);
+        if (stopped())
+          return 0;
+        if (score <= best)
+          continue;
+        best = score;
+        if (score > alpha)
+          alpha = score;
+        if (alpha >= beta)
+          break;
+      }
+      return best;
+    }
+
+    // Thứ tự: nước trong bảng, ăn quân (MVV-LVA), phong cấp, killer, history
+    void scoreMoves(chess::Movelist &moves, uint16_t tt_move, int ply) {
+      int side = board.sideToMove() == chess::Color::WHITE ? 0 : 1;
+      for (auto &move : moves) {
+        int score;
+        if (move.move() == tt_move) {
+          score = 30000;
+        } else if (board.isCapture(move)) {
+          int victim = move.typeOf() == chess::Move::ENPASSANT
+                           ? 0
+                           : int(board.at<chess::PieceType>(move.to()));
+          int attacker = int(board.at<chess::PieceType>(move.from()));
+          score = 20000 + victim * 10 - attacker;
+        } else if (move.typeOf() == chess::Move::PROMOTION) {
+          score = 19000 + int(move.promotionType());
+        } else if (move == killers[ply][0]) {
+          score = 18000;
+        } else if (move == killers[ply][1]) {
+          score = 17000;
+        } else {
+          score = history[side][move.from().index()][move.to().index()];
+        }
+        move.setScore(static_cast<int16_t>(score));
+      }
+    }
+
+    static void pickNext(chess::Movelist &moves, int from) {
+      int best = from;
+      for (int i = from + 1; i < moves.size(); i++)
+        if (moves[i].score() > moves[best].score())
+          best = i;
+      std::swap(moves[from], moves[best]);
+    }
+
+    void rememberCutoff(const chess::Move &move, int depth, int ply) {
+      if (killers[ply][0] != move) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+      }
+      int side = board.sideToMove() == chess::Color::WHITE ? 0 : 1;
+      int &value = history[side][move.from().index()][move.to().index()];
+      value += depth * depth;
+      if (value > 16000) // Giữ dưới điểm killer
+        for (auto &from : history[side])
+          for (int &to : from)
+            to /= 2;
+    }
+  };
+
+  // Vòng lặp của một luồng tìm kiếm: ưu tiên yêu cầu đang chờ, sau đó giúp
+  // lần tìm đang chạy, không có việc thì ngủ
+  void workerLoop(int nice) {
+    if (nice > 0) // Trên Linux độ ưu tiên nice áp dụng cho từng luồng
+      setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      if (!pending.empty()) {
+        std::shared_ptr<Job> job = pending.top();
+        pending.pop();
+        runMain(job, lock);
+      } else if (std::shared_ptr<Job> job = pickHelpJobLocked()) {
+        runHelper(job, lock);
+      } else if (stopping.load(std::memory_order_relaxed)) {
+        return;
+      } else {
+        cv.wait(lock);
+      }
+    }
+  }
+
+  // Chạy luồng chính của một yêu cầu (gọi khi đang giữ lock, trả về vẫn giữ)
+  void runMain(const std::shared_ptr<Job> &job,
+               std::unique_lock<std::mutex> &lock) {
+    auto start = Clock::now();
+    auto deadline =
+        job->submitted + std::chrono::milliseconds(job->limits.time_ms);
+    job->shared = std::make_unique<Shared>(tt, stopping, job->limits.abort,
+                                           deadline);
+    job->threads = 1;
+    bool skip = stopping.load(std::memory_order_relaxed) ||
+                (job->limits.abort &&
+                 job->limits.abort->load(std::memory_order_relaxed));
+    if (!skip) {
+      running.push_back(job);
+      rebalanceLocked();
+      cv.notify_all(); // Luồng rảnh có thể vào giúp
+    }
+    lock.unlock();
+
+    Worker main(job->root, *job->shared, 0);
+    if (!skip) {
+      int64_t remaining_ms =
+          std::chrono::duration_cast<std::chrono::milliseconds>(deadline -
+                                                                start)
+              .count();
+      main.iterate(std::clamp(job->limits.max_depth, 1, MAX_PLY - 1),
+                   std::max<int64_t>(remaining_ms, 1));
+    }
+    job->shared->stop.store(true, std::memory_order_relaxed);
+
+    lock.lock();
+    job->finishing = true;
+    helpers_cv.wait(lock, [&job] { return job->threads == 1; });
+    job->threads = 0;
+    if (!skip) {
+      running.erase(std::find(running.begin(), running.end(), job));
+      rebalanceLocked();
+    }
+    lock.unlock();
+
+    // Chọn kết quả sâu nhất; cùng độ sâu thì ưu tiên luồng chính
+    SearchResult result;
+    result.move = main.best_move;
+    result.score = main.best_score;
+    result.depth = main.completed_depth;
+    if (job->helper_depth > main.completed_depth) {
+      result.move = job->helper_move;
+      result.score = job->helper_score;
+      result.depth = job->helper_depth;
+    }
+    result.nodes = main.nodes + job->helper_nodes;
+    result.threads = job->next_id;
+    result.time_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() -
+                                                              start)
+            .count();
+    result.wait_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                         start - job->submitted)
+                         .count();
+    if (result.move == chess::Move::NO_MOVE)
+      result.move = job->root_moves[0];
+    job->done(result);
+
+    lock.lock();
+  }
+
+  // Tham gia một lần tìm đang chạy làm luồng phụ (giữ lock khi gọi và trả về)
+  void runHelper(const std::shared_ptr<Job> &job,
+                 std::unique_lock<std::mutex> &lock) {
+    unsigned id = job->next_id++;
+    job->threads++;
+    lock.unlock();
+
+    Worker helper(job->root, *job->shared, id, &job->shrink);
+    int max_depth = std::clamp(job->limits.max_depth, 1, MAX_PLY - 1);
+    helper.iterate(max_depth, 0);
+
+    lock.lock();
+    if (helper.completed_depth >= max_depth)
+      job->finishing = true; // Đã tìm hết độ sâu, thêm luồng cũng vô ích
+    if (helper.completed_depth > job->helper_depth &&
+        helper.best_move != chess::Move::NO_MOVE) {
+      job->helper_move = helper.best_move;
+      job->helper_score = helper.best_score;
+      job->helper_depth = helper.completed_depth;
+    }
+    job->helper_nodes += helper.nodes;
+    job->threads--;
+    rebalanceLocked();
+    if (job->threads == 1)
+      helpers_cv.notify_all();
+  }
+
+  // Lần tìm đang chạy ít luồng nhất (cùng số luồng thì đồng hồ thấp nhất)
+  std::shared_ptr<Job> pickHelpJobLocked() {
+    if (stopping.load(std::memory_order_relaxed))
+      return nullptr;
+    std::shared_ptr<Job> best;
+    for (const std::shared_ptr<Job> &job : running) {
+      if (job->finishing || job->shared->stop.load(std::memory_order_relaxed))
+        continue;
+      if (!best || job->threads < best->threads ||
+          (job->threads == best->threads &&
+           job->limits.clock_ms < best->limits.clock_ms))
+        best = job;
+    }
+    return best;
+  }
+
+  /**
+   * @brief Chia đều luồng cho các lần tìm (đang chạy + đang chờ). Chỉ khi hết
+   * luồng rảnh mà vẫn có lần tìm thiếu luồng, các lần tìm vượt phần chia mới
+   * phải cho luồng phụ rời đi.
+   */
+  void rebalanceLocked() {
+    size_t searches = running.size() + pending.size();
+    if (searches == 0)
+      return;
+    unsigned share = std::max<unsigned>(
+        1, static_cast<unsigned>(pool.size() / searches));
+    unsigned busy = 0;
+    bool starving = !pending.empty();
+    for (const std::shared_ptr<Job> &job : running) {
+      busy += job->threads;
+      starving = starving || (job->threads < share && !job->finishing);
+    }
+    bool reclaim = starving && busy >= pool.size();
+    for (const std::shared_ptr<Job> &job : running)
+      job->shrink.store(reclaim && job->threads > share,
+                        std::memory_order_relaxed);
+  }
+
+  // Bảng vị trí viết từ hàng 8 xuống hàng 1 (góc nhìn bên trắng)
+  static int relativeSquare(int sq, int color) {
+    return color == 0 ? sq ^ 56 : sq;
+  }
+
+  static constexpr int PIECE_VALUE[5] = {100, 320, 330, 500, 900};
+  static constexpr int PHASE_WEIGHT[5] = {0, 1, 1, 2, 4};
+
+  // Simplified Evaluation Function (Tomasz Michniewski)
+  static constexpr int PST[5][64] = {
+      // Tốt
+      {
+            0,   0,   0,   0,   0,   0,   0,   0,
+           50,  50,  50,  50,  50,  50,  50,  50,
+           10,  10,  20,  30,  30,  20,  10,  10,
+            5,   5,  10,  25,  25,  10,   5,   5,
+            0,   0,   0,  20,  20,   0,   0,   0,
+            5,  -5, -10,   0,   0, -10,  -5,   5,
+            5,  10,  10, -20, -20,  10,  10,   5,
+            0,   0,   0,   0,   0,   0,   0,   0},
+      // Mã
+      {
+          -50, -40, -30, -30, -30, -30, -40, -50,
+          -40, -20,   0,   0,   0,   0, -20, -40,
+          -30,   0,  10,  15,  15,  10,   0, -30,
+          -30,   5,  15,  20,  20,  15,   5, -30,
+          -30,   0,  15,  20,  20,  15,   0, -30,
+          -30,   5,  10,  15,  15,  10,   5, -30,
+          -40, -20,   0,   5,   5,   0, -20, -40,
+          -50, -40, -30, -30, -30, -30, -40, -50},
+      // Tượng
+      {
+          -20, -10, -10, -10, -10, -10, -10, -20,
+          -10,   0,   0,   0,   0,   0,   0, -10,
+          -10,   0,   5,  10,  10,   5,   0, -10,
+          -10,   5,   5,  10,  10,   5,   5, -10,
+          -10,   0,  10,  10,  10,  10,   0, -10,
+          -10,  10,  10,  10,  10,  10,  10, -10,
+          -10,   5,   0,   0,   0,   0,   5, -10,
+          -20, -10, -10, -10, -10, -10, -10, -20},
+      // Xe
+      {
+            0,   0,   0,   0,   0,   0,   0,   0,
+            5,  10,  10,  10,  10,  10,  10,   5,
+           -5,   0,   0,   0,   0,   0,   0,  -5,
+           -5,   0,   0,   0,   0,   0,   0,  -5,
+           -5,   0,   0,   0,   0,   0,   0,  -5,
+           -5,   0,   0,   0,   0,   0,   0,  -5,
+           -5,   0,   0,   0,   0,   0,   0,  -5,
+            0,   0,   0,   5,   5,   0,   0,   0},
+      // Hậu
+      {
+          -20, -10, -10,  -5,  -5, -10, -10, -20,
+          -10,   0,   0,   0,   0,   0,   0, -10,
+          -10,   0,   5,   5,   5,   5,   0, -10,
+           -5,   0,   5,   5,   5,   5,   0,  -5,
+            0,   0,   5,   5,   5,   5,   0,  -5,
+          -10,   5,   5,   5,   5,   5,   0, -10,
+          -10,   0,   5,   0,   0,   0,   0, -10,
+          -20, -10, -10,  -5,  -5, -10, -10, -20}};
+
+  // Vua: đầu/trung cuộc và tàn cuộc, trộn theo lượng quân còn lại
+  static constexpr int KING_MG[64] = {
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -30, -40, -40, -50, -50, -40, -40, -30,
+      -20, -30, -30, -40, -40, -30, -30, -20,
+      -10, -20, -20, -20, -20, -20, -20, -10,
+       20,  20,   0,   0,   0,   0,  20,  20,
+       20,  30,  10,   0,   0,  10,  30,  20};
+
+  static constexpr int KING_EG[64] = {
+      -50, -40, -30, -20, -20, -30, -40, -50,
+      -30, -20, -10,   0,   0, -10, -20, -30,
+      -30, -10,  20,  30,  30,  20, -10, -30,
+      -30, -10,  30,  40,  40,  30, -10, -30,
+      -30, -10,  30,  40,  40,  30, -10, -30,
+      -30, -10,  20,  30,  30,  20, -10, -30,
+      -30, -30,   0,   0,   0,   0, -30, -30,
+      -50, -30, -30, -30, -30, -30, -30, -50};
+
+  TranspositionTable tt;
+  std::mutex mutex;                   // Bảo vệ hàng đợi và các Job
+  std::condition_variable cv;         // Có việc mới / engine dừng
+  std::condition_variable helpers_cv; // Luồng phụ đã rời một Job
+  std::vector<std::thread> pool;
+  std::priority_queue<std::shared_ptr<Job>, std::vector<std::shared_ptr<Job>>,
+                      LowestClockFirst>
+      pending;
+  std::vector<std::shared_ptr<Job>> running;
+  uint64_t next_seq = 0;
+  std::atomic<bool> stopping{false};
+};
+
+#endif // ENGINE_HPP
@@ -0,0 +1,412 @@
+// GAME_ARCHIVE_HPP - Lưu trữ gọn các ván đã kết thúc (chỉ số nước đi hợp lệ)
+
+#ifndef GAME_ARCHIVE_HPP
+#define GAME_ARCHIVE_HPP
+
+// Thư viện chuẩn C++
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Thư viện hệ thống
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Thư viện dự án
+#include "../chess_engine/chess.hpp"
+#include "logger.hpp"
+#include "structs.hpp"
+
+/**
+ * @brief File lưu trữ các ván đã kết thúc ở dạng nén.
+ *
+ * Mỗi nước đi được ghi bằng vị trí của nó trong danh sách
+ * movegen::legalmoves của thế cờ trước đó (1 byte). FEN và chuỗi UCI được
+ * dựng lại khi đọc bằng cách đi lại ván từ start_fen. Thời điểm mỗi nước lưu
+ * bằng độ lệch (mili giây, varint) so với nước trước, nên một nước thường
+ * chiếm 3-4 byte thay vì hơn 100 byte JSON.
+ *
+ * File gồm MAGIC rồi các bản ghi [u32 độ dài][payload], chỉ ghi nối thêm.
+ * Bản ghi sau của cùng game_id (ví dụ khi có kết quả phân tích) thay cho bản
+ * ghi trước. Chỉ mục game_id → offset nằm trong bộ nhớ và được dựng lại bằng
+ * một lượt quét khi mở file; đọc một ván chỉ cần một lần pread.
+ *
+ * @note Mã hóa phụ thuộc thứ tự sinh nước của chess.hpp: đổi thư viện cờ thì
+ * phải chuyển đổi file. Lớp không tự khóa: DataStorage gọi khi đang giữ
+ * matches_mutex.
+ */
+class GameArchive {
+public:
+  GameArchive() = default;
+  GameArchive(const GameArchive &) = delete;
+  GameArchive &operator=(const GameArchive &) = delete;
+
+  ~GameArchive() { close(); }
+
+  /**
+   * @brief Mở (hoặc tạo) file và dựng chỉ mục. Chỉ bản ghi dở dang ở cuối
+   * file (server dừng khi đang ghi) bị cắt bỏ; bản ghi hỏng ở giữa file thì
+   * từ chối mở để không mất các ván phía sau. Thất bại (kể cả file không
+   * phải archive) thì archive ở trạng thái đóng: append() và read() đều từ
+   * chối.
+   */
+  bool open(const std::string &path) {
+    close();
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+      return false;
+    if (!load()) {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  // Đóng file và bỏ chỉ mục
+  void close() {
+    if (fd >= 0)
+      ::close(fd);
+    fd = -1;
+    end = 0;
+    index.clear();
+  }
+
+  bool isOpen() const { return fd >= 0; }
+
+  bool contains(const std::string &game_id) const {
+    return index.count(game_id) > 0;
+  }
+
+  size_t size() const { return index.size(); }
+
+  uint64_t bytes() const { return end; }
+
+  std::vector<std::string> gameIds() const {
+    std::vector<std::string> ids;
+    ids.reserve(index.size());
+    for (const auto &[game_id, offset] : index)
+      ids.push_back(game_id);
+    return ids;
+  }
+
+  /**
+   * @brief Ghi (hoặc ghi đè) một ván vào cuối file.
+   * @return false nếu ván không mã hóa được (nước đi không hợp lệ) hoặc lỗi
+   * ghi file; khi đó ván nên được giữ ở matches.json.
+   */
+  bool append(const MatchModel &match) {
+    std::string payload;
+    if (!isOpen() || match.game_id.size() > 127 || !encode(match, payload))
+      return false;
+    std::string record(4, '\0');
+    writeU32(reinterpret_cast<uint8_t *>(&record[0]),
+             static_cast<uint32_t>(payload.size()));
+    record += payload;
+    if (pwrite(fd, record.data(), record.size(), end) !=
+        static_cast<ssize_t>(record.size()))
+      return false;
+    index[match.game_id] = end;
+    end += record.size();
+    return true;
+  }
+
+  /**
+   * @brief Đọc bản ghi (chưa giải mã) của một ván; decode() không cần file
+   * nên có thể chạy sau khi người gọi đã nhả khóa.
+   */
+  bool readPayload(const std::string &game_id, std::string &payload) const {
+    auto it = index.find(game_id);
+    if (it == index.end())
+      return false;
+    uint8_t head[4];
+    if (pread(fd, head, sizeof(head), it->second) != sizeof(head))
+      return false;
+    payload.assign(readU32(head), '\0');
+    return pread(fd, &payload[0], payload.size(), it->second + 4) ==
+           static_cast<ssize_t>(payload.size());
+  }
+
+  /**
+   * @brief Đọc và giải mã một ván.
+   * @return false nếu không có ván hoặc bản ghi hỏng.
+   */
+  bool read(const std::string &game_id, MatchModel &match) const {
+    std::string payload;
+    return readPayload(game_id, payload) && decode(payload, match);
+  }
+
+  /**
+   * @brief Đọc thông tin chung của một ván (không đi lại các nước, moves
+   * để trống) và số nước đã đi.
+   */
+  bool readSummary(const std::string &game_id, MatchModel &match,
+                   uint64_t &plies) const {
+    std::string payload;
+    if (!readPayload(game_id, payload))
+      return false;
+    Reader in{reinterpret_cast<const uint8_t *>(payload.data()),
+              payload.size()};
+    std::vector<uint8_t> best;
+    decodeHeader(in, match, best);
+    plies = in.varint();
+    return in.ok;
+  }
+
+  /**
+   * @brief Mã hóa một ván:
+   *   game_id, white, black, white_ip, black_ip, start_fen, result, reason
+   *   (chuỗi: varint độ dài + byte), start_time, end_time (varint ns),
+   *   độ sâu phân tích (varint), nếu > 0: số phần tử rồi mỗi phần tử
+   *   [zigzag varint eval][u8 judgement][u8 chỉ số nước gợi ý, 0xFF = không],
+   *   số nước (varint), mỗi nước [u8 chỉ số nước][zigzag varint độ lệch ms].
+   * Phân tích đứng trước nước đi để khi giải mã, nước gợi ý được dịch ngay
+   * trong lượt đi lại ván.
+   */
+  static bool encode(const MatchModel &match, std::string &out) {
+    for (const std::string *text :
+         {&match.game_id, &match.white_username, &match.black_username,
+          &match.white_ip, &match.black_ip, &match.start_fen, &match.result,
+          &match.reason})
+      putString(out, *text);
+    putVarint(out, nanos(match.start_time));
+    putVarint(out, nanos(match.end_time));
+
+    std::vector<uint8_t> best(match.analysis.size(), NO_INDEX);
+    std::string moves;
+    chess::Board board(match.start_fen);
+    int64_t previous_ms = nanos(match.start_time) / 1000000;
+    for (size_t i = 0; i < match.moves.size(); i++) {
+      chess::Movelist legal;
+      chess::movegen::legalmoves(legal, board);
+      if (i < best.size())
+        best[i] = indexOf(board, legal, match.analysis[i].best);
+      uint8_t move_index = indexOf(board, legal, match.moves[i].uci_move);
+      if (move_index == NO_INDEX)
+        return false;
+      moves.push_back(static_cast<char>(move_index));
+
+      int64_t move_ms = nanos(match.moves[i].move_time) / 1000000;
+      putVarint(moves, zigzag(move_ms - previous_ms));
+      previous_ms = move_ms;
+      board.makeMove(legal[move_index]);
+    }
+
+    putVarint(out, static_cast<uint64_t>(match.analysis_depth));
+    if (match.analysis_depth > 0) {
+      putVarint(out, match.analysis.size());
+      for (size_t i = 0; i < match.analysis.size(); i++) {
+        putVarint(out, zigzag(match.analysis[i].eval));
+        out.push_back(static_cast<char>(match.analysis[i].judgement));
+        out.push_back(static_cast<char>(best[i]));
+      }
+    }
+    putVarint(out, match.moves.size());
+    out += moves;
+    return true;
+  }
+
+  static bool decode(const std::string &payload, MatchModel &match) {
+    Reader in{reinterpret_cast<const uint8_t *>(payload.data()),
+              payload.size()};
+    std::vector<uint8_t> best;
+    decodeHeader(in, match, best);
+
+    chess::Board board(match.start_fen);
+    int64_t previous_ms = nanos(match.start_time) / 1000000;
+    uint64_t count = in.varint();
+    for (uint64_t i = 0; i < count && in.ok; i++) {
+      chess::Movelist legal;
+      chess::movegen::legalmoves(legal, board);
+      uint8_t move_index = in.u8();
+      if (move_index >= legal.size())
+        return false;
+      if (i < best.size() && best[i] < legal.size())
+        match.analysis[i].best = chess::uci::moveToUci(legal[best[i]]);
+      previous_ms += unzigzag(in.varint());
+
+      board.makeMove(legal[move_index]);
+      MatchModel::Move move;
+      move.uci_move = chess::uci::moveToUci(legal[move_index]);
+      move.fen = board.getFen();
+      move.move_time = timePoint(previous_ms * 1000000);
+      match.moves.push_back(std::move(move));
+    }
+    return in.ok;
+  }
+
+private:
+  static constexpr char MAGIC[8] = {'C', 'H', 'A', 'R', 'C', '0', '0', '1'};
+  static constexpr uint8_t NO_INDEX = 0xFF; // Số nước hợp lệ luôn < 256
+
+  // Đọc tuần tự payload; ok = false khi đọc quá cuối
+  struct Reader {
+    const uint8_t *data;
+    size_t size;
+    size_t pos = 0;
+    bool ok = true;
+
+    uint8_t u8() {
+      if (pos >= size) {
+        ok = false;
+        return 0;
+      }
+      return data[pos++];
+    }
+
+    uint64_t varint() {
+      uint64_t value = 0;
+      for (int shift = 0; shift < 64 && ok; shift += 7) {
+        uint8_t byte = u8();
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+          break;
+      }
+      return value;
+    }
+
+    std::string string() {
+      uint64_t length = varint();
+      if (!ok || length > size - pos) {
+        ok = false;
+        return "";
+      }
+      std::string text(reinterpret_cast<const char *>(data + pos), length);
+      pos += length;
+      return text;
+    }
+  };
+
+  int fd = -1;
+  uint64_t end = 0; // Kích thước file (vị trí ghi tiếp theo)
+  std::unordered_map<std::string, uint64_t> index; // game_id → offset
+
+  // Kiểm tra MAGIC (tạo mới nếu file rỗng) và quét các bản ghi
+  bool load() {
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+      return false;
+    end = static_cast<uint64_t>(st.st_size);
+    if (end < sizeof(MAGIC)) {
+      end = sizeof(MAGIC);
+      return ftruncate(fd, 0) == 0 &&
+             pwrite(fd, MAGIC, sizeof(MAGIC), 0) == sizeof(MAGIC);
+    }
+    char magic[sizeof(MAGIC)];
+    if (pread(fd, magic, sizeof(magic), 0) != sizeof(magic) ||
+        std::string(magic, sizeof(magic)) != std::string(MAGIC, sizeof(MAGIC)))
+      return false;
+
+    // Mỗi lần pread lấy độ dài bản ghi và game_id ở đầu payload
+    uint64_t offset = sizeof(MAGIC);
+    uint8_t head[4 + 1 + 255];
+    while (offset < end) {
+      ssize_t got = pread(fd, head, sizeof(head), offset);
+      if (got < 0)
+        return false;
+      // Bản ghi vượt quá cuối file: lần ghi cuối bị ngắt giữa chừng
+      if (got < 5 || offset + 4 + readU32(head) > end)
+        break;
+      uint32_t length = readU32(head);
+      size_t id_length = head[4]; // game_id < 128 byte: độ dài varint 1 byte
+      if (id_length + 1 > length || 5 + id_length > static_cast<size_t>(got)) {
+        LOG_ERROR("archive_corrupt", "offset", offset, "length", length,
+                  "file_bytes", end);
+        return false;
+      }
+      index[std::string(reinterpret_cast<char *>(head + 5), id_length)] =
+          offset;
+      offset += 4 + length;
+    }
+    if (offset < end) {
+      LOG_WARN("archive_tail_truncated", "offset", offset, "bytes",
+               end - offset);
+      end = offset;
+      return ftruncate(fd, end) == 0;
+    }
+    return true;
+  }
+
+  // Phần trước danh sách nước đi: thông tin chung và phân tích
+  static void decodeHeader(Reader &in, MatchModel &match,
+                           std::vector<uint8_t> &best) {
+    match = MatchModel();
+    for (std::string *text :
+         {&match.game_id, &match.white_username, &match.black_username,
+          &match.white_ip, &match.black_ip, &match.start_fen, &match.result,
+          &match.reason})
+      *text = in.string();
+    match.start_time = timePoint(in.varint());
+    match.end_time = timePoint(in.varint());
+
+    match.analysis_depth = static_cast<int>(in.varint());
+    if (match.analysis_depth > 0) {
+      uint64_t entries = in.varint();
+      for (uint64_t i = 0; i < entries && in.ok; i++) {
+        MatchModel::MoveAnalysis entry;
+        entry.eval = static_cast<int>(unzigzag(in.varint()));
+        entry.judgement = in.u8();
+        best.push_back(in.u8());
+        match.analysis.push_back(std::move(entry));
+      }
+    }
+  }
+
+  static int64_t nanos(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               time.time_since_epoch())
+        .count();
+  }
+
+  static std::chrono::system_clock::time_point timePoint(int64_t nanos) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(nanos)));
+  }
+
+  // Vị trí của nước uci trong legal (nước được chuẩn hóa qua uciToMove)
+  static uint8_t indexOf(const chess::Board &board,
+                         const chess::Movelist &legal, const std::string &uci) {
+    chess::Move move = chess::uci::uciToMove(board, uci);
+    for (int i = 0; i < legal.size(); i++)
+      if (legal[i] == move)
+        return static_cast<uint8_t>(i);
+    return NO_INDEX;
+  }
+
+  static uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^
+           static_cast<uint64_t>(value >> 63);
+  }
+
+  static int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  static void putVarint(std::string &out, uint64_t value) {
+    while (value >= 0x80) {
+      out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+      value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+  }
+
+  static void putString(std::string &out, const std::string &text) {
+    putVarint(out, text.size());
+    out += text;
+  }
+
+  static uint32_t readU32(const uint8_t *bytes) {
+    return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 |
+           uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+  }
+
+  static void writeU32(uint8_t *bytes, uint32_t value) {
+    for (int i = 0; i < 4; i++)
+      bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+};
+
+#endif // GAME_ARCHIVE_HPP
@@ -0,0 +1,108 @@
+// GAME_LOG_STREAM_HPP - Gửi nhật ký một ván theo các chunk có kiểm soát luồng
+
+#ifndef GAME_LOG_STREAM_HPP
+#define GAME_LOG_STREAM_HPP
+
+// Thư viện chuẩn C++
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// Thư viện dự án
+#include "../common/const.hpp"
+#include "../common/message.hpp"
+#include "structs.hpp"
+
+/**
+ * @brief Trạng thái gửi nhật ký của một kết nối.
+ *
+ * Nhật ký được cắt thành các GAME_LOG chunk có payload không quá
+ * Const::GAME_LOG_CHUNK_BYTES (chunk đầu mang thông tin chung), nên độ dài ván
+ * không bị giới hạn bởi trường length 16 bit của Packet và không chunk nào
+ * cần một vùng nhớ lớn. Tối đa window chunk được gửi khi chưa có GAME_LOG_ACK,
+ * nên các message khác của kết nối không phải xếp hàng sau cả nhật ký.
+ *
+ * Mỗi kết nối chỉ có một luồng gửi; yêu cầu mới thay thế luồng cũ. Lớp không
+ * tự khóa: MessageHandler của kết nối (một luồng) sở hữu nó.
+ */
+class GameLogStream {
+public:
+  void start(MatchModel loaded, size_t chunk_window) {
+    match = std::move(loaded);
+    window = chunk_window;
+    next_ply = 0;
+    next_seq = 0;
+    acked = 0;
+    active = true;
+  }
+
+  void stop() {
+    active = false;
+    match = MatchModel();
+  }
+
+  const std::string &gameId() const { return match.game_id; }
+
+  /**
+   * @brief Ghi nhận client đã nhận mọi chunk tới seq (ACK của ván khác hoặc
+   * cũ hơn bị bỏ qua).
+   */
+  void ack(const std::string &game_id, uint32_t seq) {
+    if (active && game_id == match.game_id && seq < next_seq)
+      acked = std::max(acked, seq + 1);
+  }
+
+  /**
+   * @brief Chunk kế tiếp nếu luồng chưa hết và cửa sổ còn chỗ. Luồng tự
+   * dừng sau chunk có cờ LAST.
+   */
+  bool next(GameLogMessage &chunk) {
+    if (!active || next_seq - acked >= window)
+      return false;
+
+    chunk = GameLogMessage();
+    chunk.game_id = match.game_id;
+    chunk.seq = next_seq++;
+    if (chunk.seq == 0) {
+      chunk.flags |= GameLogMessage::FLAG_HEADER;
+      chunk.start_time = match.start_time.time_since_epoch().count();
+      chunk.end_time = match.end_time.time_since_epoch().count();
+      chunk.white = match.white_username;
+      chunk.black = match.black_username;
+      chunk.white_ip = match.white_ip;
+      chunk.black_ip = match.black_ip;
+      chunk.winner = match.result;
+      chunk.reason = match.reason;
+      chunk.total_moves = static_cast<uint32_t>(match.moves.size());
+    }
+
+    // Thêm nước tới khi đầy chunk (luôn có ít nhất một nước nếu còn)
+    chunk.first_ply = static_cast<uint32_t>(next_ply);
+    size_t size = chunk.baseSize();
+    while (next_ply < match.moves.size() && chunk.moves.size() < UINT16_MAX) {
+      const std::string &uci = match.moves[next_ply].uci_move;
+      if (!chunk.moves.empty() && size + 1 + uci.size() > Const::GAME_LOG_CHUNK_BYTES)
+        break;
+      chunk.moves.push_back(uci);
+      size += 1 + uci.size();
+      next_ply++;
+    }
+
+    if (next_ply == match.moves.size()) {
+      chunk.flags |= GameLogMessage::FLAG_LAST;
+      stop();
+    }
+    return true;
+  }
+
+private:
+  MatchModel match;
+  size_t window = Const::GAME_LOG_WINDOW;
+  size_t next_ply = 0;   // Nước đầu tiên của chunk kế tiếp
+  uint32_t next_seq = 0; // seq của chunk kế tiếp
+  uint32_t acked = 0;    // Số chunk client đã xác nhận
+  bool active = false;
+};
+
+#endif // GAME_LOG_STREAM_HPP
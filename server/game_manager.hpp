@@ -4,7 +4,10 @@
 #define GAME_MANAGER_HPP
 
 // Thư viện chuẩn C++
+#include <algorithm>
 #include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -17,10 +20,19 @@
 // Thư viện dự án
 #include "../chess_engine/chess.hpp"
 #include "../common/message.hpp"
+#include "analysis.hpp"
 #include "data_storage.hpp"
+#include "engine.hpp"
 #include "game_status.hpp"
+#include "lobby.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
 #include "network_server.hpp"
+#include "opening_explorer.hpp"
+#include "server_config.hpp"
 #include "structs.hpp"
+#include "timer_wheel.hpp"
+#include "tracer.hpp"
 
 // Lớp GameManager - Singleton quản lý trận đấu, matchmaking
 class GameManager {
@@ -57,7 +69,19 @@ private:
   // Map lưu pending games chờ accep (dùng cho auto matchmaking)
   std::unordered_map<std::string, PendingGame> pending_games;
 
-  std::mutex games_mutex; // Bảo vệ games và pending_games
+  // Lời mời thách đấu đang chờ trả lời: challengeKey() -> hẹn giờ hết hạn
+  struct PendingChallenge {
+    TimerId timer = INVALID_TIMER;
+    uint64_t seq = 0; // Phân biệt lời mời cũ/mới của cùng một cặp người chơi
+  };
+  std::unordered_map<std::string, PendingChallenge> pending_challenges;
+  uint64_t challenge_seq = 0;
+
+  std::mutex games_mutex; // Bảo vệ games, pending_games và pending_challenges
+
+  // Người xem: game_id -> danh sách client_fd đang theo dõi ván cờ
+  std::unordered_map<std::string, std::vector<int>> watchers;
+  std::mutex watchers_mutex; // Bảo vệ watchers
 
   NetworkServer *network_server_; // Inject qua init()
   DataStorage *data_storage_;     // Inject qua init()
@@ -69,6 +93,25 @@ private:
   bool stop_matching;                // Cờ dừng matchmaking loop
   std::thread matchmaking_thread;    // Thread chạy matchmaking loop
   std::mutex matchmaking_mutex;      // Bảo vệ matchmaking_queue
+  // Thời điểm mỗi client vào queue (đo thời gian chờ), bảo vệ bởi
+  // matchmaking_mutex
+  std::unordered_map<int, std::chrono::steady_clock::time_point> queued_at;
+
+  // Đối thủ máy: các nước của máy được tìm trên nhóm luồng riêng của Engine
+  // (engine_jobs đếm số yêu cầu chưa xong để destructor chờ)
+  Engine engine;
+  std::mutex engine_jobs_mutex;
+  std::condition_variable engine_jobs_cv;
+  int engine_jobs = 0;
+  bool engine_stopping = false; // Bảo vệ bởi engine_jobs_mutex
+
+  // Luồng việc nền: kết thúc ván cờ (gửi GAME_END, ghi storage, cập nhật Elo)
+  // được đẩy vào đây từ các luồng không được chặn (TimerWheel)
+  std::deque<std::function<void()>> tasks;
+  std::mutex tasks_mutex;
+  std::condition_variable tasks_cv;
+  bool tasks_stopping = false; // Bảo vệ bởi tasks_mutex
+  std::thread task_thread;
 
   // Constructor private (Singleton)
   GameManager()
@@ -88,12 +131,12 @@ private:
 
       count++;
       if (count % 10 == 0) {
-        std::cout << "\nMatchmaking loop " << count
-                  << ", queue size: " << matchmaking_queue.size() << std::endl;
+        LOG_DEBUG("matchmaking_tick", "iteration", count, "queue_size",
+                  matchmaking_queue.size());
       }
 
       if (stop_matching) {
-        std::cout << "Stopping matchmaking loop." << std::endl;
+        LOG_INFO("matchmaking_stopped");
         break;
       }
 
@@ -103,6 +146,8 @@ private:
         matchmaking_queue.pop();
 
         if (!network_server_->isClientConnected(client1_fd)) {
+          queued_at.erase(client1_fd);
+          publishQueueDepthLocked();
           lock.unlock();
           std::this_thread::sleep_for(std::chrono::milliseconds(100));
           continue;
@@ -112,54 +157,20 @@ private:
         uint16_t elo1 = data_storage_->getUserELO(username1);
         int rank1 = data_storage_->getUserRank(username1);
 
-        // Biến lưu kết quả tìm kiếm
-        int matched_client_fd = -1; // -1 = chưa tìm thấy
+        // Tìm đối thủ phù hợp trong queue
+        int matched_client_fd = takeOpponent(
+            matchmaking_queue, rank1,
+            [this](int fd) { return network_server_->isClientConnected(fd); },
+            [this](int fd) {
+              return data_storage_->getUserRank(
+                  network_server_->getUsername(fd));
+            });
+
         std::string matched_username;
         uint16_t matched_elo = 0;
-
-        // Lưu kích thước queue hiện tại (để duyệt đúng số lượng)
-        size_t queue_size = matchmaking_queue.size();
-
-        std::queue<int> temp_queue;
-
-        // Duyệt qua tất cả các client trong queue
-        for (size_t i = 0; i < queue_size; i++) {
-          int candidate_fd = matchmaking_queue.front();
-          matchmaking_queue.pop();
-
-          // Kiểm tra candidate còn kết nối không
-          if (!network_server_->isClientConnected(candidate_fd)) {
-            // Ngắt kết nối → bỏ qua (không đưa vào temp_queue)
-            continue;
-          }
-
-          // Nếu chưa tìm thấy match
-          if (matched_client_fd == -1) {
-            std::string candidate_username =
-                network_server_->getUsername(candidate_fd);
-            int candidate_rank = data_storage_->getUserRank(candidate_username);
-
-            // Kiểm tra rank (bậc hạng) có phù hợp không
-            // abs(rank1 - rank2) <= 10 (chênh không quá 10 bậc)
-            if (abs(static_cast<int>(rank1) -
-                    static_cast<int>(candidate_rank)) <= 10) {
-              // Tìm thấy đối thủ phù hợp!
-              matched_client_fd = candidate_fd;
-              matched_username = candidate_username;
-              matched_elo = data_storage_->getUserELO(candidate_username);
-            } else {
-              // Rank không khớp → giữ lại trong temp_queue
-              temp_queue.push(candidate_fd);
-            }
-          } else {
-            temp_queue.push(candidate_fd);
-          }
-        }
-
-        // Đưa các client chưa match lại vào matchmaking_queue
-        while (!temp_queue.empty()) {
-          matchmaking_queue.push(temp_queue.front());
-          temp_queue.pop();
+        if (matched_client_fd != -1) {
+          matched_username = network_server_->getUsername(matched_client_fd);
+          matched_elo = data_storage_->getUserELO(matched_username);
         }
 
         if (matched_client_fd != -1) {
@@ -168,13 +179,21 @@ private:
           // Tạo game mới (sẽ được lưu vào database)
           std::string game_id = createGame(username1, matched_username);
 
-          // Thêm vào pending_games (chờ cả hai chấp nhận)
+          // Thêm vào pending_games (chờ cả hai chấp nhận trước hạn)
           {
             std::lock_guard<std::mutex> games_lock(games_mutex);
-            pending_games[game_id] =
-                PendingGame(game_id, client1_fd, matched_client_fd);
+            PendingGame pending(game_id, client1_fd, matched_client_fd);
+            pending.accept_timer = TimerWheel::getInstance().schedule(
+                std::chrono::milliseconds(
+                    ServerConfig::getInstance().match_accept_timeout_ms),
+                [this, game_id] { onMatchAcceptExpired(game_id); });
+            pending_games[game_id] = pending;
           }
 
+          recordMatchWaitLocked(client1_fd);
+          recordMatchWaitLocked(matched_client_fd);
+          publishQueueDepthLocked();
+
           // Unlock matchmaking_mutex trước khi gửi packet
           lock.unlock();
 
@@ -201,6 +220,7 @@ private:
           // Không tìm thấy đối thủ → Đưa client1 vào cuối queue
 
           matchmaking_queue.push(client1_fd);
+          publishQueueDepthLocked();
           lock.unlock();
         }
       } else {
@@ -213,21 +233,255 @@ private:
     }
   }
 
-  bool makeMove(const std::string &game_id, const std::string &uci_move) {
+  // Chạy lần lượt các việc nền; khi dừng vẫn chạy nốt những việc còn lại
+  void taskLoop() {
+    std::unique_lock<std::mutex> lock(tasks_mutex);
+    while (true) {
+      tasks_cv.wait(lock, [this] { return tasks_stopping || !tasks.empty(); });
+      if (tasks.empty())
+        return;
+      std::function<void()> task = std::move(tasks.front());
+      tasks.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+    }
+  }
+
+  // Đẩy một việc sang luồng nền, luồng gọi trả về ngay
+  void postTask(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(tasks_mutex);
+      if (tasks_stopping)
+        return;
+      tasks.push_back(std::move(task));
+    }
+    tasks_cv.notify_one();
+  }
+
+  // Cập nhật gauge độ dài queue (gọi khi đang giữ matchmaking_mutex)
+  void publishQueueDepthLocked() {
+    Metrics::getInstance().matchmaking_queue_depth.set(
+        static_cast<int64_t>(matchmaking_queue.size()));
+  }
+
+  // Client vừa được ghép trận: ghi thời gian chờ (giữ matchmaking_mutex)
+  void recordMatchWaitLocked(int client_fd) {
+    auto it = queued_at.find(client_fd);
+    if (it == queued_at.end())
+      return;
+    Metrics::getInstance().matchmaking_wait_us.observe(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - it->second)
+            .count()));
+    queued_at.erase(it);
+  }
+
+  MoveResult makeMove(const std::string &game_id, const std::string &uci_move) {
+    TraceSpan span("game.makeMove");
     auto game = getGame(game_id);
 
     // Kiểm tra game tồn tại VÀ chưa kết thúc
     if (game && !game->isGameOver())
       return game->makeMove(uci_move);
 
-    return false; // Game không tồn tại hoặc đã kết thúc
+    return MoveResult::ILLEGAL; // Game không tồn tại hoặc đã kết thúc
+  }
+
+  static std::string challengeKey(const std::string &from,
+                                  const std::string &to) {
+    return from + '\n' + to;
+  }
+
+  // Gửi thông báo không chặn (dùng trên luồng TimerWheel)
+  template <typename Message>
+  void notifyNonBlocking(const std::vector<int> &client_fds,
+                         const Message &message) {
+    SharedPacket frame =
+        NetworkServer::encodePacket(message.getType(), message.serialize());
+    for (int fd : client_fds)
+      network_server_->trySendEncoded(fd, frame, Const::WATCHER_MAX_BACKLOG);
+  }
+
+  // Hết hạn chấp nhận trận tự động: hủy ván cờ chưa bắt đầu, báo cả hai bên
+  void onMatchAcceptExpired(const std::string &game_id) {
+    PendingGame pending;
+    {
+      std::lock_guard<std::mutex> lock(games_mutex);
+      auto it = pending_games.find(game_id);
+      if (it == pending_games.end())
+        return; // Đã bắt đầu hoặc đã bị từ chối
+      pending = it->second;
+      pending_games.erase(it);
+      auto game_it = games.find(game_id);
+      if (game_it != games.end())
+        eraseGameLocked(game_it);
+    }
+
+    LOG_INFO("auto_match_expired", "game_id", game_id);
+
+    MatchDeclinedNotificationMessage decline_msg;
+    decline_msg.game_id = game_id;
+    notifyNonBlocking({pending.player1_fd, pending.player2_fd}, decline_msg);
+
+    // Ván chưa bắt đầu: xóa bản ghi khỏi storage (ghi file, không chạy trên
+    // luồng TimerWheel)
+    postTask([this, game_id] { data_storage_->removeMatch(game_id); });
+  }
+
+  // Lời mời thách đấu hết hạn: báo cho hai bên (nếu họ không đang chơi)
+  void onChallengeExpired(const std::string &from, const std::string &to,
+                          uint64_t seq) {
+    {
+      std::lock_guard<std::mutex> lock(games_mutex);
+      auto it = pending_challenges.find(challengeKey(from, to));
+      if (it == pending_challenges.end() || it->second.seq != seq)
+        return; // Đã được trả lời hoặc đã có lời mời mới hơn
+      pending_challenges.erase(it);
+    }
+
+    LOG_INFO("challenge_expired", "from", from, "to", to);
+
+    ChallengeErrorMessage error_msg;
+    if (!isUserInGame(from)) {
+      error_msg.error_message = "Challenge to " + to + " expired.";
+      notifyNonBlocking(network_server_->getClientFDs({from}), error_msg);
+    }
+    if (!isUserInGame(to)) {
+      error_msg.error_message = "Challenge from " + from + " expired.";
+      notifyNonBlocking(network_server_->getClientFDs({to}), error_msg);
+    }
+  }
+
+  // Hẹn giờ hết giờ cho bên đang đi, thay cho hẹn giờ của lượt trước
+  void armClock(const std::shared_ptr<GameStatus> &game) {
+    int64_t ms = game->msUntilFlag();
+    if (ms < 0)
+      return;
+
+    std::string game_id = game->game_id;
+    TimerWheel &wheel = TimerWheel::getInstance();
+    TimerId timer = wheel.schedule(std::chrono::milliseconds(ms), [this, game_id] {
+      onClockExpired(game_id);
+    });
+    wheel.cancel(game->swapClockTimer(timer));
+  }
+
+  // Callback của TimerWheel: bên đang đi hết giờ → đối thủ thắng. Chỉ đánh
+  // dấu hết giờ ở đây, việc kết thúc ván chạy trên luồng nền
+  void onClockExpired(const std::string &game_id) {
+    std::shared_ptr<GameStatus> game = getGame(game_id);
+    if (!game)
+      return; // Ván cờ đã kết thúc theo cách khác
+
+    if (!game->checkFlag()) {
+      // Timer chạy sớm hơn deadline (làm tròn theo tick) → hẹn lại
+      armClock(game);
+      return;
+    }
+
+    LOG_INFO("flag_fall", "game_id", game_id, "winner", game->winner);
+    postTask([this, game_id, game] { endGame(game_id, game); });
+  }
+
+  // Ván với máy và đang tới lượt máy đi
+  static bool isEngineTurn(const std::shared_ptr<GameStatus> &game) {
+    return game && game->engine_depth > 0 &&
+           game->isTurnOf(Const::ENGINE_USERNAME);
+  }
+
+  // Người chơi thật của ván cờ (bỏ máy), dùng để gửi thông báo
+  static std::vector<std::string> humanPlayers(const GameStatus &game) {
+    std::vector<std::string> players;
+    for (const std::string *name :
+         {&game.player_white_name, &game.player_black_name})
+      if (*name != Const::ENGINE_USERNAME)
+        players.push_back(*name);
+    return players;
+  }
+
+  /**
+   * @brief Gửi yêu cầu tìm nước của máy, luồng gọi trả về ngay. Thời gian suy
+   * nghĩ lấy từ đồng hồ của máy (Engine::moveTimeMs), tối đa
+   * --engine-move-ms; ván có đồng hồ thấp hơn được tìm trước.
+   */
+  void requestEngineMove(const std::shared_ptr<GameStatus> &game) {
+    {
+      std::lock_guard<std::mutex> lock(engine_jobs_mutex);
+      if (engine_stopping)
+        return;
+      engine_jobs++;
+    }
+    Metrics::getInstance().engine_searches.add(1);
+
+    uint32_t white_ms = 0, black_ms = 0;
+    game->getClocks(white_ms, black_ms);
+    bool engine_white = game->player_white_name == Const::ENGINE_USERNAME;
+
+    SearchLimits limits;
+    limits.clock_ms = engine_white ? white_ms : black_ms;
+    limits.time_ms = Engine::moveTimeMs(
+        limits.clock_ms, game->increment_time_ms,
+        ServerConfig::getInstance().engine_move_ms);
+    limits.max_depth = game->engine_depth;
+    limits.abort = &game->closed;
+
+    // Luồng tìm kiếm chạy ở mức ưu tiên thấp: chỉ chuyển kết quả sang luồng
+    // nền, việc đi nước và gửi thông báo không chạy trên luồng này
+    engine.submit(game->getBoard(), limits,
+                  [this, game](const SearchResult &result) {
+                    postTask([this, game, result] {
+                      onEngineResult(game, result);
+                      Metrics::getInstance().engine_searches.add(-1);
+                      std::lock_guard<std::mutex> lock(engine_jobs_mutex);
+                      engine_jobs--;
+                      engine_jobs_cv.notify_all();
+                    });
+                  });
+  }
+
+  /**
+   * @brief Đi nước máy vừa tìm (chạy trên luồng nền). Ván bị xóa giữa chừng
+   * (người chơi thoát, đầu hàng) thì tìm kiếm đã dừng sớm qua cờ closed và
+   * kết quả bị bỏ.
+   */
+  void onEngineResult(const std::shared_ptr<GameStatus> &game,
+                      const SearchResult &result) {
+    {
+      std::lock_guard<std::mutex> lock(engine_jobs_mutex);
+      if (engine_stopping)
+        return;
+    }
+    if (result.move == chess::Move::NO_MOVE || game->closed)
+      return;
+
+    TraceSpan span("engine.move");
+    Metrics &metrics = Metrics::getInstance();
+    metrics.engine_queue_wait_us.observe(result.wait_us);
+    metrics.engine_search_us.observe(result.time_ms * 1000);
+    metrics.engine_nodes.inc(result.nodes);
+
+    std::string uci_move = chess::uci::moveToUci(result.move);
+    LOG_INFO("engine_move", "game_id", game->game_id, "move", uci_move,
+             "depth", result.depth, "score", result.score, "nodes",
+             result.nodes, "nps",
+             result.nodes * 1000 / std::max<int64_t>(result.time_ms, 1),
+             "time_ms", result.time_ms, "wait_us", result.wait_us, "threads",
+             result.threads);
+
+    MoveResult move_result = makeMove(game->game_id, uci_move);
+    if (move_result == MoveResult::FLAGGED)
+      endGame(game->game_id, game);
+    else if (move_result == MoveResult::APPLIED)
+      onMoveApplied(game->game_id, game, uci_move);
   }
 
   std::shared_ptr<GameStatus> getGameByClientFd(int client_fd) {
     // Lấy username của client
     std::string username = network_server_->getUsername(client_fd);
 
-    // Duyệt qua tất cả các game đang diễn ra
+    // Duyệt qua tất cả các game đang diễn ra (luồng nền có thể đang xóa ván)
+    std::lock_guard<std::mutex> lock(games_mutex);
     for (const auto &game_pair : games) {
       std::shared_ptr<GameStatus> game = game_pair.second;
 
@@ -241,6 +495,79 @@ private:
     return nullptr; // Không tìm thấy game nào
   }
 
+  // Đóng khung keyframe (bàn cờ nén + danh sách nước đi) của ván cờ
+  SharedPacket encodeKeyframe(const std::shared_ptr<GameStatus> &game) {
+    GameKeyframeMessage keyframe;
+    keyframe.game_id = game->game_id;
+    keyframe.white_username = game->player_white_name;
+    keyframe.black_username = game->player_black_name;
+
+    chess::PackedBoard packed_board;
+    game->snapshot(packed_board, keyframe.moves);
+    std::copy(packed_board.begin(), packed_board.end(),
+              keyframe.packed_board.begin());
+
+    return NetworkServer::encodePacket(keyframe.getType(),
+                                       keyframe.serialize());
+  }
+
+  // Xóa client_fd khỏi mọi danh sách người xem (gọi khi đã khóa watchers_mutex)
+  void eraseWatcherLocked(int client_fd) {
+    for (auto it = watchers.begin(); it != watchers.end();) {
+      auto &fds = it->second;
+      fds.erase(std::remove(fds.begin(), fds.end(), client_fd), fds.end());
+      it = fds.empty() ? watchers.erase(it) : std::next(it);
+    }
+  }
+
+  // Đẩy một gói tin đã đóng khung đến mọi người xem của ván cờ.
+  // Không bao giờ chặn: người xem tụt lại quá xa bị gộp (bỏ các cập nhật tồn
+  // đọng, thay bằng một keyframe), nếu vẫn không theo kịp thì bị loại.
+  void pushToWatchers(const std::string &game_id, const SharedPacket &frame,
+                      const std::shared_ptr<GameStatus> &game) {
+    TraceSpan span("net.pushToWatchers");
+    std::vector<int> fds;
+    {
+      std::lock_guard<std::mutex> lock(watchers_mutex);
+      auto it = watchers.find(game_id);
+      if (it == watchers.end())
+        return;
+      fds = it->second;
+    }
+
+    SharedPacket keyframe; // Chỉ tạo khi có người xem cần gộp
+    std::vector<int> dropped;
+    for (int fd : fds) {
+      SendResult result =
+          network_server_->trySendEncoded(fd, frame, Const::WATCHER_MAX_BACKLOG);
+
+      if (result == SendResult::OVERFLOW && game) {
+        network_server_->discardBacklog(fd);
+        if (!keyframe)
+          keyframe = encodeKeyframe(game);
+        result = network_server_->trySendEncoded(fd, keyframe,
+                                                 Const::WATCHER_MAX_BACKLOG);
+      }
+
+      if (result != SendResult::QUEUED)
+        dropped.push_back(fd);
+    }
+
+    if (!dropped.empty()) {
+      std::lock_guard<std::mutex> lock(watchers_mutex);
+      auto it = watchers.find(game_id);
+      if (it != watchers.end()) {
+        auto &list = it->second;
+        for (int fd : dropped) {
+          list.erase(std::remove(list.begin(), list.end(), fd), list.end());
+          LOG_WARN("watcher_dropped", "game_id", game_id, "client_fd", fd);
+        }
+        if (list.empty())
+          watchers.erase(it);
+      }
+    }
+  }
+
 public:
   // Delete copy constructor - Ngăn sao chép instance
   GameManager(const GameManager &) = delete;
@@ -249,6 +576,17 @@ public:
   GameManager &operator=(const GameManager &) = delete;
 
   ~GameManager() {
+    // Dừng máy (kết quả còn lại bị bỏ) và chờ mọi yêu cầu tìm nước xong
+    {
+      std::lock_guard<std::mutex> lock(engine_jobs_mutex);
+      engine_stopping = true;
+    }
+    engine.stop();
+    {
+      std::unique_lock<std::mutex> lock(engine_jobs_mutex);
+      engine_jobs_cv.wait(lock, [this] { return engine_jobs == 0; });
+    }
+
     {
       // Lock mutex để set stop_matching an toàn
       std::lock_guard<std::mutex> lock(matchmaking_mutex);
@@ -262,6 +600,15 @@ public:
     if (matchmaking_thread.joinable()) {
       matchmaking_thread.join();
     }
+
+    // Chạy nốt các ván đang chờ kết thúc rồi dừng luồng nền
+    {
+      std::lock_guard<std::mutex> lock(tasks_mutex);
+      tasks_stopping = true;
+    }
+    tasks_cv.notify_one();
+    if (task_thread.joinable())
+      task_thread.join();
   }
 
   static GameManager &getInstance() {
@@ -269,6 +616,44 @@ public:
     return instance;
   }
 
+  /**
+   * @brief Lấy đối thủ phù hợp cho người chơi có thứ hạng rank1 ra khỏi queue.
+   *
+   * Duyệt toàn bộ queue một lần: bỏ các client đã ngắt kết nối, chọn ứng viên
+   * đầu tiên chênh lệch không quá 10 bậc, giữ nguyên thứ tự những người còn
+   * lại. Tách khỏi matchmakingLoop để đo được thời gian ghép cặp (bench).
+   *
+   * @return client_fd của đối thủ, -1 nếu không tìm thấy.
+   */
+  template <typename IsConnected, typename RankOf>
+  static int takeOpponent(std::queue<int> &queue, int rank1,
+                          IsConnected is_connected, RankOf rank_of) {
+    int matched_client_fd = -1; // -1 = chưa tìm thấy
+
+    // Lưu kích thước queue hiện tại (để duyệt đúng số lượng)
+    size_t queue_size = queue.size();
+
+    for (size_t i = 0; i < queue_size; i++) {
+      int candidate_fd = queue.front();
+      queue.pop();
+
+      // Ngắt kết nối → bỏ qua (không đưa lại vào queue)
+      if (!is_connected(candidate_fd))
+        continue;
+
+      // abs(rank1 - rank2) <= 10 (chênh không quá 10 bậc)
+      if (matched_client_fd == -1 &&
+          abs(rank1 - static_cast<int>(rank_of(candidate_fd))) <= 10) {
+        matched_client_fd = candidate_fd; // Tìm thấy đối thủ phù hợp!
+        continue;
+      }
+
+      queue.push(candidate_fd); // Giữ lại, thứ tự không đổi
+    }
+
+    return matched_client_fd;
+  }
+
   void init(NetworkServer &network_server, DataStorage &data_storage) {
     // Chỉ khởi tạo nếu chưa được khởi tạo
     if (!initialized_) {
@@ -282,10 +667,33 @@ public:
       // Đánh dấu đã khởi tạo xong
       initialized_ = true;
 
+      // Chưa có ván nào đang chơi: trận còn mở là trận bị bỏ dở khi server
+      // dừng lần trước
+      size_t abandoned = data_storage.closeAbandonedMatches();
+      if (abandoned > 0)
+        LOG_INFO("abandoned_matches_closed", "count", abandoned);
+
+      ServerConfig &config = ServerConfig::getInstance();
+      engine.configure(config.engine_threads, config.engine_hash_mb,
+                       Const::ENGINE_NICE);
+      // Phân tích sau ván chỉ chạy khi máy của ván đang chơi rảnh
+      Analyzer::getInstance().start(static_cast<int>(config.analysis_depth),
+                                    config.analysis_threads,
+                                    [this] { return engine.busy(); });
+      // Chỉ mục khai cuộc: dựng lại song song nếu lệch với lịch sử
+      OpeningExplorer::getInstance().load(
+          data_storage.getDataFilePath("explorer.idx"),
+          data_storage.finishedMatchCount(),
+          [&data_storage] { return data_storage.getFinishedMatchIds(); },
+          [&data_storage](const std::string &game_id, MatchModel &match) {
+            return data_storage.getFinishedMatch(game_id, match);
+          });
+
       // Tạo và khởi động matchmaking thread
       // &GameManager::matchmakingLoop: Con trỏ đến hàm thành viên
       // this: Con trỏ đến object GameManager hiện tại
       matchmaking_thread = std::thread(&GameManager::matchmakingLoop, this);
+      task_thread = std::thread(&GameManager::taskLoop, this);
     }
   }
 
@@ -303,6 +711,17 @@ public:
     // make_shared: Tạo shared_ptr, tự động quản lý bộ nhớ
     games[game_id] = std::make_shared<GameStatus>(
         game_id, player_white_name, player_black_name, initial_fen);
+    Metrics::getInstance().games_live.set(static_cast<int64_t>(games.size()));
+    Lobby::getInstance().enterGame(player_white_name, game_id);
+    Lobby::getInstance().enterGame(player_black_name, game_id);
+
+    // Người chơi bắt đầu ván mới thì thôi xem các ván khác
+    {
+      std::lock_guard<std::mutex> watchers_lock(watchers_mutex);
+      for (int fd : network_server_->getClientFDs(
+               {player_white_name, player_black_name}))
+        eraseWatcherLocked(fd);
+    }
 
     // Lấy địa chỉ IP của người chơi trắng
     std::string white_ip =
@@ -352,35 +771,126 @@ public:
   // Khi nào gọi:
   bool removeGame(const std::string &id) {
     std::lock_guard<std::mutex> lock(games_mutex);
-    // erase() trả về số lượng phần tử bị xóa
-    // > 0 = xóa thành công, 0 = không tìm thấy
-    return games.erase(id) > 0;
+    auto it = games.find(id);
+    if (it == games.end())
+      return false;
+
+    // Hủy hẹn giờ hết giờ còn treo của ván cờ
+    TimerWheel::getInstance().cancel(it->second->swapClockTimer(INVALID_TIMER));
+    eraseGameLocked(it);
+    return true;
+  }
+
+  /**
+   * @brief Nhận quyền kết thúc ván cờ: xóa ván khỏi games nếu đó vẫn là ván
+   * này. Chỉ một trong các đường kết thúc (hết nước, hết giờ, đầu hàng, ngắt
+   * kết nối) nhận được, các đường còn lại bỏ qua để không ghi kết quả và
+   * cập nhật Elo hai lần.
+   */
+  bool claimGame(const std::string &game_id,
+                 const std::shared_ptr<GameStatus> &game) {
+    std::lock_guard<std::mutex> lock(games_mutex);
+    auto it = games.find(game_id);
+    if (it == games.end() || it->second != game)
+      return false;
+
+    TimerWheel::getInstance().cancel(it->second->swapClockTimer(INVALID_TIMER));
+    eraseGameLocked(it);
+    return true;
+  }
+
+  // Xóa ván cờ khỏi games (đang giữ games_mutex), cập nhật sảnh chờ và metrics
+  void eraseGameLocked(
+      std::unordered_map<std::string, std::shared_ptr<GameStatus>>::iterator
+          it) {
+    Lobby &lobby = Lobby::getInstance();
+    lobby.leaveGame(it->second->player_white_name, it->first);
+    lobby.leaveGame(it->second->player_black_name, it->first);
+    it->second->closed = true;
+    games.erase(it);
+    Metrics::getInstance().games_live.set(static_cast<int64_t>(games.size()));
+  }
+
+  // Tính Elo sau ván (white_score: 1 trắng thắng, 0.5 hòa, 0 đen thắng),
+  // ghi vào storage và sảnh chờ
+  void applyRating(const std::string &white_username,
+                   const std::string &black_username, double white_score) {
+    // Ván với máy không tính Elo
+    if (white_username == Const::ENGINE_USERNAME ||
+        black_username == Const::ENGINE_USERNAME)
+      return;
+
+    RatingChange change;
+    if (!data_storage_->applyGameResult(white_username, black_username,
+                                        white_score, change))
+      return;
+    Lobby &lobby = Lobby::getInstance();
+    lobby.setElo(white_username, change.white_after);
+    lobby.setElo(black_username, change.black_after);
+    LOG_DEBUG("rating_updated", "white", white_username, "white_elo",
+              change.white_after, "black", black_username, "black_elo",
+              change.black_after);
+  }
+
+  // Ghi nhận lời mời thách đấu, hết hạn sau challenge_timeout_ms.
+  // Mời lại cùng một người sẽ làm mới thời hạn.
+  void addChallenge(const std::string &from, const std::string &to) {
+    std::lock_guard<std::mutex> lock(games_mutex);
+    uint64_t seq = ++challenge_seq;
+    TimerId timer = TimerWheel::getInstance().schedule(
+        std::chrono::milliseconds(
+            ServerConfig::getInstance().challenge_timeout_ms),
+        [this, from, to, seq] { onChallengeExpired(from, to, seq); });
+
+    PendingChallenge &challenge = pending_challenges[challengeKey(from, to)];
+    TimerWheel::getInstance().cancel(challenge.timer);
+    challenge = PendingChallenge{timer, seq};
+  }
+
+  // Lấy ra lời mời đang chờ để trả lời.
+  // @return false nếu lời mời không tồn tại hoặc đã hết hạn.
+  bool takeChallenge(const std::string &from, const std::string &to) {
+    std::lock_guard<std::mutex> lock(games_mutex);
+    auto it = pending_challenges.find(challengeKey(from, to));
+    if (it == pending_challenges.end())
+      return false;
+    TimerWheel::getInstance().cancel(it->second.timer);
+    pending_challenges.erase(it);
+    return true;
+  }
+
+  // Bắt đầu đồng hồ của ván cờ (gọi ngay sau khi gửi GAME_START).
+  // Không khóa games_mutex nên có thể gọi khi đang giữ khóa này.
+  void startClock(const std::shared_ptr<GameStatus> &game) {
+    if (!game)
+      return;
+    game->startClock(game->base_time_ms, game->increment_time_ms);
+    armClock(game);
   }
 
   // Hàm này là hàm TRUNG TÂM xử lý mọi nước đi từ client.
   void handleMove(int client_fd, const std::string &game_id,
                   const std::string &uci_move) {
-    // Thử thực hiện nước đi
-    if (makeMove(game_id, uci_move)) {
-      // NƯỚC ĐI HỢP LỆ - Cập nhật và thông báo
-
-      // Lấy thông tin game (để notify players)
-      std::shared_ptr<GameStatus> game = getGame(game_id);
+    ScopedTimer timer(Metrics::getInstance().move_latency_us);
+    TraceSpan span("game.handleMove");
 
-      // Lưu nước đi vào database
-      // Lưu cả: UCI move + FEN state sau nước đi (để có thể replay)
-      data_storage_->addMove(game_id, uci_move, getGameFen(game_id));
+    // Thử thực hiện nước đi (không được đi thay máy khi tới lượt máy)
+    MoveResult move_result = isEngineTurn(getGame(game_id))
+                                 ? MoveResult::ILLEGAL
+                                 : makeMove(game_id, uci_move);
 
-      // Gửi thông báo cập nhật cho CẢ HAI người chơi
-      notifyPlayers(game_id, game);
-
-      bool is_game_over = isGameOver(game_id);
+    if (move_result == MoveResult::FLAGGED) {
+      // HẾT GIỜ trước khi đi - nước đi bị bỏ qua, đối thủ thắng
+      std::shared_ptr<GameStatus> game = getGame(game_id);
+      if (game)
+        postTask([this, game_id, game] { endGame(game_id, game); });
+    } else if (move_result == MoveResult::APPLIED) {
+      // NƯỚC ĐI HỢP LỆ - Cập nhật và thông báo
+      std::shared_ptr<GameStatus> game = getGame(game_id);
 
-      if (is_game_over) {
-        // Game kết thúc → xử lý kết thúc (update ELO, send results)
-        endGame(game_id, game);
-        return; // Kết thúc hàm
-      }
+      // Ván với máy: nước của người chơi luôn chuyển lượt cho máy
+      if (onMoveApplied(game_id, game, uci_move) && game->engine_depth > 0)
+        requestEngineMove(game);
     } else {
       // NƯỚC ĐI KHÔNG HỢP LỆ - Gửi thông báo lỗi
 
@@ -397,6 +907,36 @@ public:
     }
   }
 
+  // Sau một nước đi hợp lệ (của người hoặc của máy): lưu, thông báo, kết thúc
+  // ván hoặc chuyển lượt. Trả về true nếu ván cờ tiếp tục.
+  bool onMoveApplied(const std::string &game_id,
+                     const std::shared_ptr<GameStatus> &game,
+                     const std::string &uci_move) {
+    if (!game)
+      return false;
+
+    // Lưu nước đi vào database
+    // Lưu cả: UCI move + FEN state sau nước đi (để có thể replay)
+    data_storage_->addMove(game_id, uci_move, getGameFen(game_id));
+
+    // Gửi thông báo cập nhật cho CẢ HAI người chơi
+    notifyPlayers(game_id, game);
+
+    bool is_game_over = isGameOver(game_id);
+
+    if (is_game_over) {
+      // Game kết thúc → xử lý kết thúc (update ELO, send results) trên luồng
+      // nền. GAME_END vẫn đến sau GAME_STATUS_UPDATE vừa xếp vào hàng đợi gửi
+      // (hàng đợi của mỗi client giữ đúng thứ tự)
+      postTask([this, game_id, game] { endGame(game_id, game); });
+      return false; // Kết thúc hàm
+    }
+
+    // Hẹn giờ hết giờ cho bên vừa được chuyển lượt
+    armClock(game);
+    return true;
+  }
+
   // Hàm này được gọi SAU MỖI NƯỚC ĐI để đồng bộ trạng thái game
   void notifyPlayers(const std::string &game_id,
                      const std::shared_ptr<GameStatus> &game) {
@@ -419,67 +959,71 @@ public:
       game_status_update_msg.message = ""; // Không có message đặc biệt
     }
 
-    // Serialize message thành bytes để gửi qua network
-    std::vector<uint8_t> serialized = game_status_update_msg.serialize();
+    // Đồng hồ hai bên tại thời điểm gửi
+    game->getClocks(game_status_update_msg.white_time_ms,
+                    game_status_update_msg.black_time_ms);
+
+    // Serialize một lần, gửi CÙNG gói tin cho cả hai người chơi và người xem
+    TraceSpan span("net.notifyPlayers");
+    SharedPacket frame = NetworkServer::encodePacket(
+        game_status_update_msg.getType(), game_status_update_msg.serialize());
+    network_server_->broadcastEncoded(
+        network_server_->getClientFDs({player_white_name, player_black_name}),
+        frame);
+    pushToWatchers(game_id, frame, game);
+  }
 
-    // Gửi cho người chơi trắng
-    network_server_->sendPacketToUsername(
-        player_white_name, MessageType::GAME_STATUS_UPDATE, serialized);
+  /**
+   * @brief Ghi kết quả ván (ván được chuyển sang matches.arc) rồi đưa ván vào
+   * phân tích nền và chỉ mục khai cuộc. Mọi đường kết thúc ván (hết nước,
+   * hết giờ, đầu hàng, ngắt kết nối) gọi hàm này một lần, sau khi
+   * claimGame() thành công.
+   */
+  void recordResult(const std::string &game_id, const std::string &winner,
+                    const std::string &reason) {
+    data_storage_->updateMatchResult(game_id, winner, reason);
 
-    // Gửi cho người chơi đen (CÙNG message)
-    network_server_->sendPacketToUsername(
-        player_black_name, MessageType::GAME_STATUS_UPDATE, serialized);
+    // Sử dụng try-catch vì việc lấy match từ DB có thể fail
+    try {
+      MatchModel match = data_storage_->getMatch(game_id);
+
+      // Phân tích nền (nếu được bật), kết quả lấy qua ANALYSIS_REQUEST
+      Analyzer::getInstance().enqueue(game_id);
+      OpeningExplorer::getInstance().addGame(match);
+    } catch (const std::exception &e) {
+      LOG_ERROR("finished_match_missing", "game_id", game_id, "error", e.what());
+    }
   }
 
+  // Chạy trên luồng nền (postTask): gửi GAME_END, ghi kết quả và cập nhật Elo
   void endGame(const std::string &game_id,
                const std::shared_ptr<GameStatus> &game) {
+    TraceSpan span("game.endGame");
+    if (!claimGame(game_id, game))
+      return; // Ván đã được kết thúc theo đường khác
+
     // Lấy tên hai người chơi từ game object
     std::string player_white_name = game->player_white_name;
     std::string player_black_name = game->player_black_name;
 
-    // Tại sao sleep?
-    // - Cho client kịp nhận và hiển thị nước đi cuối cùng
-    // - Tránh GameEnd message đến trước GameStatusUpdate message
-    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-
     // Lấy tên người thắng (hoặc "<0>" nếu hòa)
-    std::string winner = getGameWinner(game_id);
+    std::string winner = game->winner;
 
     // Lấy lý do kết thúc (checkmate, stalemate, etc.)
-    std::string reason = getGameResultReason(game_id);
+    std::string reason = game->getResultReason();
 
     // Lấy số nước đi (half-moves)
-    uint16_t half_moves_count = getGameHalfMovesCount(game_id);
+    uint16_t half_moves_count = game->getHalfMovesCount();
 
-    data_storage_->updateMatchResult(game_id, winner, reason);
-
-    // Lấy ELO hiện tại của cả hai người chơi
-    uint16_t white_elo = data_storage_->getUserELO(player_white_name);
-    uint16_t black_elo = data_storage_->getUserELO(player_black_name);
-
-    // Xét 3 trường hợp:
-    if (winner == "<0>") {
-      // CASE 1: HÒA (Draw)
-      // Không làm gì cả, ELO giữ nguyên
-
-    } else if (winner == player_white_name) {
-      // CASE 2: TRẮNG THẮNG
-      // Trắng: +3 điểm
-      data_storage_->updateUserELO(player_white_name, white_elo + 3);
-
-      // Đen: -3 điểm (nhưng không xuống dưới 0)
-      data_storage_->updateUserELO(player_black_name,
-                                   (black_elo >= 3) ? black_elo - 3 : 0);
-
-    } else {
-      // CASE 3: ĐEN THẮNG
-      // Đen: +3 điểm
-      data_storage_->updateUserELO(player_black_name, black_elo + 3);
+    recordResult(game_id, winner, reason);
 
-      // Trắng: -3 điểm (không xuống dưới 0)
-      data_storage_->updateUserELO(player_white_name,
-                                   (white_elo >= 3) ? white_elo - 3 : 0);
-    }
+    // Cập nhật Elo: hòa = 0.5 điểm mỗi bên
+    double white_score = 0.0;
+    if (winner == "<0>")
+      white_score = 0.5;
+    else if (winner == player_white_name)
+      white_score = 1.0;
+    applyRating(player_white_name, player_black_name, white_score);
 
     // Chuẩn bị message
     GameEndMessage game_end_msg;
@@ -488,57 +1032,13 @@ public:
     game_end_msg.reason = reason;          // Lý do kết thúc
     game_end_msg.half_moves_count = half_moves_count; // Số nước đi
 
-    // Serialize và gửi cho CẢ HAI người chơi
-    std::vector<uint8_t> serialized_end = game_end_msg.serialize();
-    network_server_->sendPacketToUsername(
-        player_white_name, MessageType::GAME_END, serialized_end);
-    network_server_->sendPacketToUsername(
-        player_black_name, MessageType::GAME_END, serialized_end);
-
-    // Sử dụng try-catch vì việc lấy match từ DB có thể fail
-    try {
-      // Lấy toàn bộ thông tin match từ database
-      MatchModel match = data_storage_->getMatch(game_id);
+    // Serialize một lần và gửi cho CẢ HAI người chơi
+    std::vector<std::string> players = humanPlayers(*game);
+    network_server_->broadcast(players, game_end_msg);
+    endWatching(game_id, game_end_msg);
 
-      // Chuẩn bị GameLog message
-      GameLogMessage game_log_msg;
-      game_log_msg.game_id = game_id;
-
-      // Chuyển timestamp C++ sang số (nanoseconds since epoch)
-      game_log_msg.start_time = match.start_time.time_since_epoch().count();
-      game_log_msg.end_time = match.end_time.time_since_epoch().count();
-
-      // Thông tin IP và kết quả
-      game_log_msg.white_ip = match.white_ip;
-      game_log_msg.black_ip = match.black_ip;
-      game_log_msg.winner = winner;
-      game_log_msg.reason = reason;
-
-      // Thu thập tất cả các nước đi từ match
-      // For-each loop: duyệt qua vector match.moves
-      for (const auto &move : match.moves) {
-        game_log_msg.moves.push_back(move.uci_move); // Thêm vào vector
-      }
-
-      // Serialize và gửi log cho cả hai người chơi
-      std::vector<uint8_t> serialized_log = game_log_msg.serialize();
-      network_server_->sendPacketToUsername(
-          player_white_name, MessageType::GAME_LOG, serialized_log);
-      network_server_->sendPacketToUsername(
-          player_black_name, MessageType::GAME_LOG, serialized_log);
-
-      // Log thành công
-      std::cout << "[GAME_LOG] Sent game log for " << game_id
-                << " to both players." << std::endl;
-
-    } catch (const std::exception &e) {
-      std::cerr << "[GAME_LOG] Failed to send game log: " << e.what()
-                << std::endl;
-    }
-
-    // Xóa game khỏi map `games` (giải phóng bộ nhớ)
-    // Lưu ý: CHỈ xóa khỏi RAM, KHÔNG xóa khỏi database
-    removeGame(game_id);
+    // Nhật ký ván không còn được đẩy cho người chơi: client tự yêu cầu bằng
+    // GAME_LOG_REQUEST khi cần
   }
 
   // Xử lý khi một client ngắt kết nối.
@@ -546,7 +1046,13 @@ public:
     std::string username = network_server_->getUsername(client_fd);
     std::shared_ptr<GameStatus> game = getGameByClientFd(client_fd);
 
-    if (game != nullptr) {
+    // Trận tự động chưa được chấp nhận: hủy như khi bị từ chối (không có kết
+    // quả, không tính Elo)
+    if (game != nullptr && handleAutoMatchDeclined(client_fd, game->game_id))
+      game = nullptr;
+
+    // Ván đang được kết thúc theo đường khác (ví dụ hết giờ) thì bỏ qua
+    if (game != nullptr && claimGame(game->game_id, game)) {
       std::string game_id = game->game_id;
       std::string opponent_name;
 
@@ -562,24 +1068,155 @@ public:
       game_end_msg.winner_username = opponent_name;
       game_end_msg.reason = "Opponent disconnected";
       game_end_msg.half_moves_count = game->getHalfMovesCount();
-      network_server_->sendPacketToUsername(
-          opponent_name, MessageType::GAME_END, game_end_msg.serialize());
+      if (opponent_name != Const::ENGINE_USERNAME)
+        network_server_->sendPacketToUsername(
+            opponent_name, MessageType::GAME_END, game_end_msg.serialize());
+      endWatching(game_id, game_end_msg);
+
+      // Người ngắt kết nối thua: ghi kết quả để lịch sử, phân tích và chỉ
+      // mục khai cuộc thấy ván như mọi ván đã kết thúc
+      recordResult(game_id, opponent_name, game_end_msg.reason);
+
+      // Update ratings (disconnect = lose)
+      applyRating(game->player_white_name, game->player_black_name,
+                  game->player_white_name == username ? 0.0 : 1.0);
+    }
 
-      // Update points (disconnect = lose: -3, opponent wins: +3)
-      int current_elo = data_storage_->getUserELO(username);
-      int current_opponent_elo = data_storage_->getUserELO(opponent_name);
-      int new_elo = (current_elo >= 3) ? current_elo - 3 : 0; // Lose -3
-      int new_opponent_elo = current_opponent_elo + 3;        // Win +3
+    // Remove the client from the matchmaking queue
+    removePlayerFromQueue(client_fd);
+
+    // Drop every pending challenge sent by or to the client
+    if (!username.empty()) {
+      std::lock_guard<std::mutex> lock(games_mutex);
+      for (auto it = pending_challenges.begin();
+           it != pending_challenges.end();) {
+        const std::string &key = it->first;
+        size_t split = key.find('\n');
+        if (key.compare(0, split, username) == 0 ||
+            key.compare(split + 1, std::string::npos, username) == 0) {
+          TimerWheel::getInstance().cancel(it->second.timer);
+          it = pending_challenges.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
 
-      data_storage_->updateUserELO(username, new_elo);
-      data_storage_->updateUserELO(opponent_name, new_opponent_elo);
+    // Remove the client from every watcher list
+    handleUnwatchGame(client_fd);
 
-      // Remove the game from the system
-      removeGame(game_id);
+    Lobby &lobby = Lobby::getInstance();
+    lobby.unsubscribe(client_fd);
+    if (!username.empty())
+      lobby.playerOffline(username);
+  }
+
+  /**
+   * @brief Client yêu cầu chơi với máy: tạo ván cờ (không tính Elo) giữa
+   * người chơi và Const::ENGINE_USERNAME, gửi GAME_START rồi bắt đầu đồng hồ.
+   * Cấp độ n giới hạn máy tìm tối đa 2n nước (0 = mạnh nhất).
+   */
+  void handlePlayVsEngine(int client_fd, PlayVsEngineMessage::Color color,
+                          uint8_t level) {
+    std::string username = network_server_->getUsername(client_fd);
+
+    std::string error;
+    if (username.empty())
+      error = "Please log in first.";
+    else if (isUserInGame(username))
+      error = "You are already in a game.";
+    if (!error.empty()) {
+      ChallengeErrorMessage error_msg;
+      error_msg.error_message = error;
+      network_server_->sendPacket(client_fd, error_msg.getType(),
+                                  error_msg.serialize());
+      return;
     }
 
-    // Remove the client from the matchmaking queue
+    // Không còn chờ ghép trận với người khác
     removePlayerFromQueue(client_fd);
+
+    if (color == PlayVsEngineMessage::Color::RANDOM) {
+      std::random_device rd;
+      color = (rd() & 1) ? PlayVsEngineMessage::Color::BLACK
+                         : PlayVsEngineMessage::Color::WHITE;
+    }
+    bool user_white = color != PlayVsEngineMessage::Color::BLACK;
+    std::string white = user_white ? username : Const::ENGINE_USERNAME;
+    std::string black = user_white ? Const::ENGINE_USERNAME : username;
+    if (level == 0 || level > Const::ENGINE_MAX_LEVEL)
+      level = Const::ENGINE_MAX_LEVEL;
+
+    std::string game_id = createGame(white, black);
+    std::shared_ptr<GameStatus> game = getGame(game_id);
+    game->engine_depth = 2 * level;
+
+    LOG_INFO("engine_game_started", "game_id", game_id, "white", white,
+             "black", black, "level", level);
+
+    GameStartMessage game_start_msg;
+    game_start_msg.game_id = game_id;
+    game_start_msg.player1_username = white;
+    game_start_msg.player2_username = black;
+    game_start_msg.starting_player_username = white;
+    game_start_msg.fen = chess::constants::STARTPOS;
+    network_server_->sendPacket(client_fd, game_start_msg.getType(),
+                                game_start_msg.serialize());
+
+    // Đồng hồ bắt đầu chạy từ lúc GAME_START được gửi
+    startClock(game);
+    if (!user_white)
+      requestEngineMove(game);
+  }
+
+  // Client yêu cầu xem một ván cờ: đăng ký vào danh sách người xem và gửi một
+  // keyframe duy nhất, sau đó người xem nhận các cập nhật như người chơi.
+  void handleWatchGame(int client_fd, const std::string &game_id) {
+    std::shared_ptr<GameStatus> game = getGame(game_id);
+    std::string username = network_server_->getUsername(client_fd);
+
+    std::string error;
+    if (game == nullptr || game->isGameOver())
+      error = "Game " + game_id + " does not exist or has ended.";
+    else if (game->player_white_name == username ||
+             game->player_black_name == username || isUserInGame(username))
+      error = "Cannot watch while playing a game.";
+
+    if (!error.empty()) {
+      WatchErrorMessage error_msg;
+      error_msg.error_message = error;
+      network_server_->sendPacket(client_fd, error_msg.getType(),
+                                  error_msg.serialize());
+      return;
+    }
+
+    // Giữ watchers_mutex khi chụp keyframe và xếp nó vào hàng đợi: mọi cập
+    // nhật sau thời điểm chụp đều được đẩy đi SAU keyframe
+    std::lock_guard<std::mutex> lock(watchers_mutex);
+    eraseWatcherLocked(client_fd); // Mỗi client chỉ xem một ván
+    watchers[game_id].push_back(client_fd);
+    network_server_->trySendEncoded(client_fd, encodeKeyframe(game),
+                                    Const::WATCHER_MAX_BACKLOG);
+
+    LOG_INFO("watch_started", "username", username, "game_id", game_id);
+  }
+
+  // Client ngừng xem (ván nào cũng vậy, vì mỗi client chỉ xem một ván)
+  void handleUnwatchGame(int client_fd) {
+    std::lock_guard<std::mutex> lock(watchers_mutex);
+    eraseWatcherLocked(client_fd);
+  }
+
+  // Ván cờ kết thúc: gửi GAME_END cho người xem rồi hủy danh sách người xem
+  void endWatching(const std::string &game_id,
+                   const GameEndMessage &game_end_msg) {
+    pushToWatchers(game_id,
+                   NetworkServer::encodePacket(game_end_msg.getType(),
+                                               game_end_msg.serialize()),
+                   nullptr);
+
+    std::lock_guard<std::mutex> lock(watchers_mutex);
+    watchers.erase(game_id);
   }
 
   bool isGameOver(const std::string &game_id) {
@@ -628,6 +1265,8 @@ public:
     {
       std::lock_guard<std::mutex> lock(matchmaking_mutex);
       matchmaking_queue.push(client_fd);
+      queued_at[client_fd] = std::chrono::steady_clock::now();
+      publishQueueDepthLocked();
     }
     cv.notify_one();
   }
@@ -643,6 +1282,8 @@ public:
       }
     }
     matchmaking_queue = new_queue;
+    queued_at.erase(client_fd);
+    publishQueueDepthLocked();
   }
 
   void handleAutoMatchAccepted(int client_fd, const std::string &game_id) {
@@ -657,6 +1298,7 @@ public:
 
       if (pending.player1_accepted && pending.player2_accepted) {
         // Both players accepted, game starts
+        TimerWheel::getInstance().cancel(pending.accept_timer);
 
         NetworkServer &network_server = NetworkServer::getInstance();
 
@@ -671,12 +1313,14 @@ public:
             game_start_msg.player1_username; // Player 1 starts
         game_start_msg.fen = chess::constants::STARTPOS;
 
-        std::vector<uint8_t> serialized = game_start_msg.serialize();
+        network_server.broadcast(
+            std::vector<int>{pending.player1_fd, pending.player2_fd},
+            game_start_msg);
 
-        network_server.sendPacket(pending.player1_fd, MessageType::GAME_START,
-                                  serialized);
-        network_server.sendPacket(pending.player2_fd, MessageType::GAME_START,
-                                  serialized);
+        // Đồng hồ bắt đầu chạy từ lúc GAME_START được gửi
+        auto game_it = games.find(game_id);
+        if (game_it != games.end())
+          startClock(game_it->second);
 
         // Remove from pending_games
         pending_games.erase(it);
@@ -684,27 +1328,39 @@ public:
     }
   }
 
-  void handleAutoMatchDeclined(int client_fd, const std::string &game_id) {
-    std::lock_guard<std::mutex> lock(games_mutex);
-    auto it = pending_games.find(game_id);
-    if (it != pending_games.end()) {
-      PendingGame pending = it->second;
+  // Trả về false nếu game_id không phải trận tự động đang chờ chấp nhận
+  bool handleAutoMatchDeclined(int client_fd, const std::string &game_id) {
+    PendingGame pending;
+    {
+      std::lock_guard<std::mutex> lock(games_mutex);
+      auto it = pending_games.find(game_id);
+      if (it == pending_games.end())
+        return false;
+      pending = it->second;
       pending_games.erase(it);
 
-      NetworkServer &network_server = NetworkServer::getInstance();
-
-      // Notify the other player about the declination
-      int other_fd = (client_fd == pending.player1_fd) ? pending.player2_fd
-                                                       : pending.player1_fd;
-      MatchDeclinedNotificationMessage decline_msg;
-      decline_msg.game_id = game_id;
-      std::vector<uint8_t> serialized = decline_msg.serialize();
-      network_server.sendPacket(other_fd, decline_msg.getType(), serialized);
-
-      // Requeue the other player
-      matchmaking_queue.push(other_fd);
-      cv.notify_one();
+      // The game never started: cancel the deadline and free it
+      TimerWheel::getInstance().cancel(pending.accept_timer);
+      auto game_it = games.find(game_id);
+      if (game_it != games.end())
+        eraseGameLocked(game_it);
     }
+    data_storage_->removeMatch(game_id);
+
+    NetworkServer &network_server = NetworkServer::getInstance();
+
+    // Notify the other player about the declination
+    int other_fd = (client_fd == pending.player1_fd) ? pending.player2_fd
+                                                     : pending.player1_fd;
+    MatchDeclinedNotificationMessage decline_msg;
+    decline_msg.game_id = game_id;
+    std::vector<uint8_t> serialized = decline_msg.serialize();
+    network_server.sendPacket(other_fd, decline_msg.getType(), serialized);
+
+    // Requeue the other player. games_mutex must be released first: the
+    // matchmaking loop takes matchmaking_mutex before games_mutex.
+    addPlayerToQueue(other_fd);
+    return true;
   }
 
   bool isUserInGame(const std::string &username) {
@@ -749,10 +1405,12 @@ public:
     return "";
   }
 
-  void endGameForSurrender(const std::string &game_id,
+  // Trả về false nếu ván đã được kết thúc theo đường khác (ví dụ hết giờ)
+  bool endGameForSurrender(const std::string &game_id,
                            const std::string &surrendering_player) {
-    DataStorage &datastorage = DataStorage::getInstance();
-    GameStatus *game = getGame(game_id).get();
+    std::shared_ptr<GameStatus> game = getGame(game_id);
+    if (!game || game->isGameOver() || !claimGame(game_id, game))
+      return false;
 
     std::string player_white_name = game->player_white_name;
     std::string player_black_name = game->player_black_name;
@@ -762,25 +1420,13 @@ public:
                              : player_white_name;
     std::string reason = "Player surrendered";
 
-    // Gọi hàm updateMatchResult để cập nhật kết quả trận đấu
-    datastorage.updateMatchResult(game_id, winner, reason);
+    // Ghi kết quả, phân tích nền và chỉ mục khai cuộc như mọi ván kết thúc
+    recordResult(game_id, winner, reason);
 
     // Update ELO: surrendering player loses, opponent wins
-    uint16_t white_elo = datastorage.getUserELO(player_white_name);
-    uint16_t black_elo = datastorage.getUserELO(player_black_name);
-
-    if (surrendering_player == player_white_name) {
-      datastorage.updateUserELO(player_white_name,
-                                (white_elo >= 3) ? white_elo - 3 : 0);
-      datastorage.updateUserELO(player_black_name, black_elo + 3);
-    } else {
-      datastorage.updateUserELO(player_black_name,
-                                (black_elo >= 3) ? black_elo - 3 : 0);
-      datastorage.updateUserELO(player_white_name, white_elo + 3);
-    }
-
-    // Remove game
-    removeGame(game_id);
+    applyRating(player_white_name, player_black_name,
+                surrendering_player == player_white_name ? 0.0 : 1.0);
+    return true;
   }
 };
 
@@ -2,9 +2,22 @@
 #define GAME_HPP
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "../chess_engine/chess.hpp"
+#include "../common/const.hpp"
+#include "timer_wheel.hpp"
+
+// Kết quả của một lần thực hiện nước đi
+enum class MoveResult {
+  ILLEGAL, // Nước đi không hợp lệ hoặc ván cờ đã kết thúc
+  APPLIED, // Nước đi đã được thực hiện
+  FLAGGED  // Bên đi đã hết giờ trước khi đi, ván cờ kết thúc vì hết giờ
+};
 
 /**
  * @class Game
@@ -23,6 +36,16 @@ public:
 
   std::string winner;
 
+  // Thể thức thời gian của ván (ms), đặt khi tạo ván, dùng cho startClock()
+  // và thời gian suy nghĩ của máy
+  int64_t base_time_ms = Const::DEFAULT_TIME * 1000LL;
+  int64_t increment_time_ms = Const::DEFAULT_INCREMENT * 1000LL;
+
+  // Ván với máy: độ sâu tối đa của máy (0 = ván giữa hai người)
+  int engine_depth = 0;
+  // Ván đã bị xóa khỏi GameManager (máy đang suy nghĩ thì dừng lại)
+  std::atomic<bool> closed{false};
+
   GameStatus(const std::string &id, const std::string &p1,
              const std::string &p2, const std::string &fen)
       : game_id(id), player_white_name(p1), player_black_name(p2), board(fen),
@@ -32,14 +55,31 @@ public:
     current_turn = isWhiteTurn ? player_white_name : player_black_name;
   }
 
-  bool makeMove(const std::string &uci_move) {
+  MoveResult makeMove(const std::string &uci_move) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (is_over)
+      return MoveResult::ILLEGAL;
+
+    auto now = std::chrono::steady_clock::now();
+    if (clock_running && remainingLocked(now) <= 0) {
+      flagLocked();
+      return MoveResult::FLAGGED;
+    }
+
     chess::Move move = chess::uci::uciToMove(board, uci_move);
 
     if (!isValidMove(board, move))
-      return false;
+      return MoveResult::ILLEGAL;
+
+    // Đồng hồ Fischer: trừ thời gian suy nghĩ, cộng thời gian cộng thêm
+    if (clock_running) {
+      moverClockLocked() = remainingLocked(now) + increment_ms;
+      turn_started = now;
+    }
 
     board.makeMove(move);
     half_moves_count++;
+    move_history.push_back(uci_move);
 
     // Kiểm tra kết quả trò chơi
     std::tie(reason, result) = board.isGameOver();
@@ -55,7 +95,7 @@ public:
         winner = current_turn;
     }
 
-    return true;
+    return MoveResult::APPLIED;
   }
 
   bool isInCheck() {
@@ -74,9 +114,83 @@ public:
     return board.isAttacked(king, opponent);
   }
 
-  bool isGameOver() { return is_over; }
+  bool isGameOver() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return is_over;
+  }
+
+  // Bắt đầu đồng hồ Fischer (gọi khi GAME_START được gửi đi)
+  void startClock(int64_t base_ms, int64_t increment) {
+    std::lock_guard<std::mutex> lock(mutex);
+    white_ms = black_ms = base_ms;
+    increment_ms = increment;
+    turn_started = std::chrono::steady_clock::now();
+    clock_running = true;
+  }
+
+  // Số ms còn lại tới khi bên đang đi hết giờ, -1 nếu đồng hồ không chạy
+  int64_t msUntilFlag() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!clock_running || is_over)
+      return -1;
+    return std::max<int64_t>(
+        0, remainingLocked(std::chrono::steady_clock::now()));
+  }
 
-  std::string getFen() { return board.getFen(); }
+  // Kiểm tra bên đang đi đã hết giờ chưa. Trả về true đúng MỘT lần, tại thời
+  // điểm ván cờ chuyển sang kết thúc vì hết giờ.
+  bool checkFlag() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (is_over || !clock_running ||
+        remainingLocked(std::chrono::steady_clock::now()) > 0)
+      return false;
+    flagLocked();
+    return true;
+  }
+
+  // Đọc đồng hồ hai bên (tính cả thời gian đã trôi của bên đang đi)
+  void getClocks(uint32_t &white_time_ms, uint32_t &black_time_ms) {
+    std::lock_guard<std::mutex> lock(mutex);
+    int64_t white = white_ms, black = black_ms;
+    if (clock_running && !is_over) {
+      int64_t remaining = remainingLocked(std::chrono::steady_clock::now());
+      (board.sideToMove() == chess::Color::WHITE ? white : black) = remaining;
+    }
+    white_time_ms = static_cast<uint32_t>(std::max<int64_t>(0, white));
+    black_time_ms = static_cast<uint32_t>(std::max<int64_t>(0, black));
+  }
+
+  // Thay timer hết giờ đang hẹn, trả về timer cũ để caller hủy
+  TimerId swapClockTimer(TimerId timer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::swap(clock_timer, timer);
+    return timer;
+  }
+
+  std::string getFen() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return board.getFen();
+  }
+
+  // Bản sao bàn cờ (kèm lịch sử để máy nhận ra lặp lại nước đi)
+  chess::Board getBoard() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return board;
+  }
+
+  bool isTurnOf(const std::string &username) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !is_over && current_turn == username;
+  }
+
+  // Chụp trạng thái hiện tại (bàn cờ nén 24 bytes + các nước đã đi) trong một
+  // lần khóa, dùng cho keyframe gửi người xem
+  void snapshot(chess::PackedBoard &packed_board,
+                std::vector<std::string> &moves) {
+    std::lock_guard<std::mutex> lock(mutex);
+    packed_board = chess::Board::Compact::encode(board);
+    moves = move_history;
+  }
 
   std::string getResult() {
     switch (result) {
@@ -90,6 +204,8 @@ public:
   }
 
   std::string getResultReason() {
+    if (flagged)
+      return "timeout";
     switch (reason) {
     case chess::GameResultReason::CHECKMATE:
       return "checkmate";
@@ -111,11 +227,43 @@ public:
 private:
   bool is_over;
 
+  std::mutex mutex; // Bảo vệ board và move_history
   chess::Board board;
+  std::vector<std::string> move_history;
   chess::GameResult result = chess::GameResult::NONE;
   chess::GameResultReason reason = chess::GameResultReason::NONE;
   int half_moves_count = 0;
 
+  // Đồng hồ Fischer (ms), chỉ chạy sau startClock()
+  bool clock_running = false;
+  bool flagged = false; // Ván cờ kết thúc vì hết giờ
+  int64_t white_ms = 0;
+  int64_t black_ms = 0;
+  int64_t increment_ms = 0;
+  std::chrono::steady_clock::time_point turn_started;
+  TimerId clock_timer = INVALID_TIMER;
+
+  int64_t &moverClockLocked() {
+    return board.sideToMove() == chess::Color::WHITE ? white_ms : black_ms;
+  }
+
+  // Thời gian còn lại của bên đang đi tại thời điểm now
+  int64_t remainingLocked(std::chrono::steady_clock::time_point now) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        now - turn_started);
+    return moverClockLocked() - elapsed.count();
+  }
+
+  // Bên đang đi hết giờ: đối thủ thắng
+  void flagLocked() {
+    moverClockLocked() = 0;
+    is_over = true;
+    flagged = true;
+    result = chess::GameResult::LOSE;
+    winner = (current_turn == player_white_name) ? player_black_name
+                                                 : player_white_name;
+  }
+
   bool isValidMove(const chess::Board &board, const chess::Move &move) {
     if (move == chess::Move::NO_MOVE) {
       return false;
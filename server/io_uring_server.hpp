@@ -0,0 +1,471 @@
+// IO_URING_SERVER_HPP - Backend mạng io_uring (tùy chọn) cho server
+
+#ifndef IO_URING_SERVER_HPP
+#define IO_URING_SERVER_HPP
+
+// Thư viện chuẩn C++
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Thư viện hệ thống
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Thư viện dự án
+#include "../common/const.hpp"
+#include "logger.hpp"
+#include "network_server.hpp"
+#include "structs.hpp"
+
+/**
+ * @brief Vòng io_uring tối thiểu gọi thẳng syscall (không dùng liburing):
+ * SQ/CQ được mmap, một provided buffer ring cho recv.
+ *
+ * Chỉ luồng đã gọi init() được submit (IORING_SETUP_SINGLE_ISSUER). Cờ này
+ * có từ Linux 6.0, cùng lúc với multishot recv, nên init() thất bại trên
+ * kernel cũ hơn và server quay về backend một luồng mỗi kết nối.
+ */
+class IoUring {
+public:
+  IoUring() = default;
+  IoUring(const IoUring &) = delete;
+  IoUring &operator=(const IoUring &) = delete;
+
+  ~IoUring() {
+    if (buffers != MAP_FAILED)
+      munmap(buffers, buffer_count * buffer_size);
+    if (buf_ring != MAP_FAILED)
+      munmap(buf_ring, buf_ring_bytes);
+    if (sqes != MAP_FAILED)
+      munmap(sqes, sqes_bytes);
+    if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr)
+      munmap(cq_ptr, cq_bytes);
+    if (sq_ptr != MAP_FAILED)
+      munmap(sq_ptr, sq_bytes);
+    if (ring_fd >= 0)
+      close(ring_fd);
+  }
+
+  /**
+   * @brief Tạo ring với entries ô SQ (CQ gấp 4 lần vì mỗi recv multishot sinh
+   * nhiều CQE) và đăng ký count bộ đệm recv, mỗi bộ đệm size byte.
+   * @return false (errno được giữ) nếu kernel không hỗ trợ.
+   */
+  bool init(unsigned entries, unsigned count, unsigned size) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 4;
+    ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd < 0)
+      return false;
+
+    sq_bytes = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cq_bytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap)
+      sq_bytes = cq_bytes = std::max(sq_bytes, cq_bytes);
+
+    sq_ptr = mmap(nullptr, sq_bytes, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ptr == MAP_FAILED)
+      return false;
+    cq_ptr = single_mmap
+                 ? sq_ptr
+                 : mmap(nullptr, cq_bytes, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+    if (cq_ptr == MAP_FAILED)
+      return false;
+    sqes_bytes = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = mmap(nullptr, sqes_bytes, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+      return false;
+
+    char *sq = static_cast<char *>(sq_ptr);
+    sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_entries = params.sq_entries;
+    sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+    char *cq = static_cast<char *>(cq_ptr);
+    cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    return registerBuffers(count, size);
+  }
+
+  /**
+   * @brief Ô SQE kế tiếp (đã xóa trắng). SQ đầy thì submit trước.
+   */
+  io_uring_sqe *nextSqe() {
+    unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+    if (local_tail - head >= sq_entries) {
+      submit(0);
+      head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+    }
+    unsigned index = local_tail & sq_mask;
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(sqes) + index;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array[index] = index;
+    local_tail++;
+    return sqe;
+  }
+
+  /**
+   * @brief Submit mọi SQE đã chuẩn bị và chờ ít nhất wait_nr CQE, trong một
+   * lần io_uring_enter.
+   */
+  int submit(unsigned wait_nr) {
+    __atomic_store_n(sq_tail, local_tail, __ATOMIC_RELEASE);
+    unsigned to_submit = local_tail - submitted;
+    int ret = static_cast<int>(
+        syscall(__NR_io_uring_enter, ring_fd, to_submit, wait_nr,
+                wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0));
+    if (ret > 0)
+      submitted += static_cast<unsigned>(ret);
+    return ret;
+  }
+
+  // Gọi fn cho mọi CQE đang có rồi trả các ô lại cho kernel
+  template <typename Fn> unsigned drain(Fn &&fn) {
+    unsigned head = *cq_head;
+    unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    for (unsigned i = head; i != tail; i++)
+      fn(cqes[i & cq_mask]);
+    __atomic_store_n(cq_head, tail, __ATOMIC_RELEASE);
+    return tail - head;
+  }
+
+  // Vùng dữ liệu của bộ đệm recv bid (do kernel chọn)
+  const uint8_t *buffer(uint16_t bid) const {
+    return static_cast<const uint8_t *>(buffers) +
+           static_cast<size_t>(bid) * buffer_size;
+  }
+
+  // Trả bộ đệm bid về buffer ring sau khi đã chép dữ liệu ra
+  void recycle(uint16_t bid) {
+    // Không dùng io_uring_buf_ring::bufs: khi biên dịch bằng C++,
+    // __DECLARE_FLEX_ARRAY đặt mảng lệch 8 byte so với kernel
+    io_uring_buf *bufs = static_cast<io_uring_buf *>(buf_ring);
+    io_uring_buf &buf = bufs[buf_tail & (buffer_count - 1)];
+    buf.addr = reinterpret_cast<uint64_t>(buffer(bid));
+    buf.len = buffer_size;
+    buf.bid = bid;
+    buf_tail++;
+    __atomic_store_n(&static_cast<io_uring_buf_ring *>(buf_ring)->tail,
+                     buf_tail, __ATOMIC_RELEASE);
+  }
+
+  static constexpr uint16_t BUFFER_GROUP = 0;
+
+private:
+  int ring_fd = -1;
+  void *sq_ptr = MAP_FAILED;
+  void *cq_ptr = MAP_FAILED;
+  void *sqes = MAP_FAILED;
+  size_t sq_bytes = 0, cq_bytes = 0, sqes_bytes = 0;
+
+  unsigned *sq_head = nullptr, *sq_tail = nullptr, *sq_array = nullptr;
+  unsigned sq_mask = 0, sq_entries = 0;
+  unsigned local_tail = 0; // SQE đã chuẩn bị
+  unsigned submitted = 0;  // SQE kernel đã nhận
+
+  unsigned *cq_head = nullptr, *cq_tail = nullptr;
+  unsigned cq_mask = 0;
+  io_uring_cqe *cqes = nullptr;
+
+  void *buf_ring = MAP_FAILED;
+  size_t buf_ring_bytes = 0;
+  void *buffers = MAP_FAILED;
+  unsigned buffer_count = 0; // Lũy thừa của 2
+  unsigned buffer_size = 0;
+  uint16_t buf_tail = 0;
+
+  bool registerBuffers(unsigned count, unsigned size) {
+    buffer_count = count;
+    buffer_size = size;
+    buf_ring_bytes = count * sizeof(io_uring_buf);
+    buf_ring = mmap(nullptr, buf_ring_bytes, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    buffers = mmap(nullptr, static_cast<size_t>(count) * size,
+                   PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf_ring == MAP_FAILED || buffers == MAP_FAILED)
+      return false;
+
+    io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring);
+    reg.ring_entries = count;
+    reg.bgid = BUFFER_GROUP;
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PBUF_RING,
+                &reg, 1) != 0)
+      return false;
+
+    for (unsigned bid = 0; bid < count; bid++)
+      recycle(static_cast<uint16_t>(bid));
+    return true;
+  }
+};
+
+/**
+ * @brief Backend mạng io_uring: một luồng (luồng gọi run()) nhận mọi kết nối
+ * bằng một accept multishot và đọc mọi socket bằng recv multishot vào
+ * provided buffer ring. Mỗi vòng lặp submit các SQE mới và lấy tất cả CQE
+ * đang có trong một io_uring_enter, thay cho một luồng và một recv() chặn
+ * cho mỗi client.
+ *
+ * Packet tách được giao cho một nhóm luồng xử lý, theo thứ tự của từng kết
+ * nối (mỗi kết nối chỉ được một luồng xử lý tại một thời điểm). Gửi vẫn đi
+ * qua hàng đợi outbound của NetworkServer như backend mặc định nhưng không
+ * chặn: phần còn lại được write_watcher gửi tiếp.
+ *
+ * Session là lớp xử lý của một kết nối:
+ *   Session(int client_fd), bool handle(const Packet &) (false = gói tin
+ *   hỏng, ngắt kết nối), void close() (dọn dẹp và đóng fd).
+ */
+template <typename Session> class IoUringServer {
+public:
+  explicit IoUringServer(NetworkServer &server) : server(server) {}
+
+  bool init() {
+    return ring.init(Const::IO_URING_ENTRIES, Const::IO_URING_BUFFERS,
+                     Const::IO_URING_BUFFER_SIZE);
+  }
+
+  /**
+   * @brief Chạy vòng sự kiện trên luồng đã gọi init() tới khi server.stop()
+   * được gọi, rồi dừng nhóm luồng xử lý (packet chưa xử lý bị bỏ). Các kết
+   * nối còn mở do caller đóng.
+   */
+  void run(unsigned workers) {
+    // Luồng xử lý dùng chung cho mọi kết nối: chỉ gửi không chặn
+    server.setBlockingSends(false);
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < workers; i++)
+      pool.emplace_back([this] { workerLoop(); });
+
+    LOG_INFO("io_backend", "backend", "io_uring", "workers", workers);
+    armAccept();
+    armStop();
+    while (!server.isStopping()) {
+      if (ring.submit(1) < 0 && errno != EINTR) {
+        LOG_ERROR("io_uring_enter_failed", "error", std::strerror(errno));
+        continue;
+      }
+      ring.drain([this](const io_uring_cqe &cqe) { complete(cqe); });
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(ready_mutex);
+      workers_stopping = true;
+    }
+    ready_cv.notify_all();
+    for (std::thread &worker : pool)
+      worker.join();
+  }
+
+private:
+  enum Op : uint64_t { ACCEPT = 1, RECV = 2, STOP = 3 };
+
+  struct Connection {
+    explicit Connection(int client_fd) : fd(client_fd), session(client_fd) {}
+
+    int fd;
+    Session session;
+    std::mutex mutex;           // Bảo vệ packets và các cờ bên dưới
+    std::deque<Packet> packets; // Chờ xử lý, theo thứ tự nhận
+    bool scheduled = false;     // Đang nằm trong ready hoặc đang được xử lý
+    bool closing = false;       // recv đã kết thúc, đóng sau packet cuối
+    bool failed = false;        // Gặp gói tin hỏng, bỏ các packet còn lại
+  };
+
+  NetworkServer &server;
+  IoUring ring;
+  std::unordered_map<int, std::shared_ptr<Connection>> connections; // Chỉ luồng run()
+
+  std::mutex ready_mutex;
+  std::condition_variable ready_cv;
+  std::deque<std::shared_ptr<Connection>> ready; // Kết nối có việc cần xử lý
+  bool workers_stopping = false;                 // Bảo vệ bởi ready_mutex
+
+  static uint64_t userData(Op op, int fd) {
+    return (static_cast<uint64_t>(op) << 32) | static_cast<uint32_t>(fd);
+  }
+
+  void armAccept() {
+    io_uring_sqe *sqe = ring.nextSqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = server.listenFd();
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = userData(ACCEPT, server.listenFd());
+  }
+
+  // Chờ stopFd() đọc được: CQE đánh thức vòng sự kiện khi server dừng
+  void armStop() {
+    io_uring_sqe *sqe = ring.nextSqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = server.stopFd();
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = userData(STOP, server.stopFd());
+  }
+
+  void armRecv(int fd) {
+    io_uring_sqe *sqe = ring.nextSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = IoUring::BUFFER_GROUP;
+    sqe->user_data = userData(RECV, fd);
+  }
+
+  void complete(const io_uring_cqe &cqe) {
+    Op op = static_cast<Op>(cqe.user_data >> 32);
+    int fd = static_cast<int>(cqe.user_data & 0xFFFFFFFF);
+    bool more = cqe.flags & IORING_CQE_F_MORE;
+
+    if (op == STOP)
+      return; // Vòng sự kiện tự kiểm tra server.isStopping()
+    if (op == ACCEPT) {
+      if (cqe.res >= 0)
+        opened(cqe.res);
+      else if (!server.isStopping())
+        LOG_WARN("accept_failed", "error", std::strerror(-cqe.res));
+      if (!more && !server.isStopping())
+        armAccept();
+      return;
+    }
+
+    auto it = connections.find(fd);
+    if (it == connections.end())
+      return;
+    if (cqe.res > 0) {
+      uint16_t bid = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+      std::vector<Packet> packets;
+      server.receiveBytes(fd, ring.buffer(bid), static_cast<size_t>(cqe.res),
+                          packets);
+      ring.recycle(bid);
+      if (!packets.empty())
+        enqueue(it->second, packets, false);
+      if (!more)
+        armRecv(fd);
+      return;
+    }
+    if (cqe.res == -ENOBUFS) {
+      armRecv(fd); // Hết bộ đệm trong lượt này, các bộ đệm đã được trả lại
+      return;
+    }
+    // 0 = client đóng (hoặc heartbeat đã shutdown), < 0 = lỗi: recv đã dừng
+    if (!more) {
+      enqueue(it->second, {}, true);
+      connections.erase(it);
+    }
+  }
+
+  void opened(int fd) {
+    server.connectionOpened(fd);
+    server.startHeartbeat(fd);
+    connections[fd] = std::make_shared<Connection>(fd);
+    armRecv(fd);
+  }
+
+  void enqueue(const std::shared_ptr<Connection> &connection,
+               std::vector<Packet> packets, bool closing) {
+    {
+      std::lock_guard<std::mutex> lock(connection->mutex);
+      if (!connection->failed)
+        for (Packet &packet : packets)
+          connection->packets.push_back(std::move(packet));
+      connection->closing = connection->closing || closing;
+      if (connection->scheduled)
+        return;
+      connection->scheduled = true;
+    }
+    {
+      std::lock_guard<std::mutex> lock(ready_mutex);
+      ready.push_back(connection);
+    }
+    ready_cv.notify_one();
+  }
+
+  void workerLoop() {
+    while (true) {
+      std::shared_ptr<Connection> connection;
+      {
+        std::unique_lock<std::mutex> lock(ready_mutex);
+        ready_cv.wait(lock,
+                      [this] { return workers_stopping || !ready.empty(); });
+        if (workers_stopping)
+          return;
+        connection = std::move(ready.front());
+        ready.pop_front();
+      }
+      process(*connection, connection);
+    }
+  }
+
+  /**
+   * @brief Xử lý tối đa Const::IO_WORKER_BATCH packet của một kết nối rồi
+   * nhường lượt cho kết nối khác (kết nối vẫn còn việc được xếp lại cuối
+   * hàng). Kết nối đã đóng được dọn sau packet cuối cùng.
+   */
+  void process(Connection &connection,
+               const std::shared_ptr<Connection> &self) {
+    for (uint32_t handled = 0;; handled++) {
+      Packet packet;
+      bool closed = false;
+      {
+        std::lock_guard<std::mutex> lock(connection.mutex);
+        if (connection.packets.empty()) {
+          if (!connection.closing) {
+            connection.scheduled = false;
+            return;
+          }
+          closed = true; // Luồng run() đã bỏ kết nối, không còn packet mới
+        } else if (handled >= Const::IO_WORKER_BATCH) {
+          break;
+        } else {
+          packet = std::move(connection.packets.front());
+          connection.packets.pop_front();
+        }
+      }
+      if (closed) {
+        connection.session.close();
+        return;
+      }
+
+      Tracer::getInstance().markFrameStart();
+      if (!connection.session.handle(packet)) {
+        // Gói tin hỏng: bỏ phần còn lại, recv kết thúc sau shutdown() và
+        // kết nối được đóng theo đường thông thường
+        std::lock_guard<std::mutex> lock(connection.mutex);
+        connection.failed = true;
+        connection.packets.clear();
+        shutdown(connection.fd, SHUT_RDWR);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(ready_mutex);
+    ready.push_back(self);
+    ready_cv.notify_one();
+  }
+};
+
+#endif // IO_URING_SERVER_HPP
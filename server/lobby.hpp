@@ -0,0 +1,309 @@
+// LOBBY_HPP - Danh sách người chơi online, cập nhật dần và lưu sẵn gói tin;
+// đẩy thay đổi (presence) cho các client đã đăng ký
+
+#ifndef LOBBY_HPP
+#define LOBBY_HPP
+
+// Thư viện chuẩn C++
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Thư viện dự án
+#include "../common/const.hpp"
+#include "../common/message.hpp"
+#include "logger.hpp"
+#include "network_server.hpp"
+#include "structs.hpp"
+#include "timer_wheel.hpp"
+
+/**
+ * @brief Lớp Lobby (Singleton) - Sảnh chờ: chỉ chứa người chơi đang online.
+ *
+ * Được cập nhật khi đăng nhập, ngắt kết nối, vào/ra ván và đổi Elo, thay vì
+ * dựng lại từ toàn bộ users mỗi lần client hỏi. Mỗi người chơi giữ sẵn bytes
+ * đã mã hóa của mình, các trang PLAYER_LIST đã đóng khung được cache cho tới
+ * lần thay đổi kế tiếp, nên một REQUEST_PLAYER_LIST tốn O(cỡ trang) (hoặc chỉ
+ * một lần tra cache).
+ *
+ * Client gửi SUBSCRIBE_PRESENCE sẽ nhận các thay đổi dưới dạng
+ * PRESENCE_UPDATE: thay đổi được gom trong Const::PRESENCE_TICK_MS, mỗi người
+ * chơi chỉ giữ sự kiện cuối cùng, rồi được gửi một lần (không chặn) trên luồng
+ * TimerWheel. Người đăng ký tồn đọng quá nhiều bị hủy đăng ký.
+ *
+ * Danh sách sắp xếp theo username để phân trang ổn định. Mutex của Lobby là
+ * khóa lá: có thể gọi khi đang giữ games_mutex.
+ */
+class Lobby {
+public:
+  Lobby(const Lobby &) = delete;
+  Lobby &operator=(const Lobby &) = delete;
+
+  static Lobby &getInstance() {
+    static Lobby instance;
+    return instance;
+  }
+
+  void playerOnline(const std::string &username, uint16_t elo) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = findLocked(username);
+    if (it == entries.end() || it->username != username)
+      it = entries.insert(it, Entry{username, elo, "", {}});
+    it->elo = elo;
+    it->game_id.clear();
+    encode(*it);
+    changedLocked(Kind::JOINED, *it);
+  }
+
+  void playerOffline(const std::string &username) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = findLocked(username);
+    if (it == entries.end() || it->username != username)
+      return;
+    changedLocked(Kind::LEFT, *it);
+    entries.erase(it);
+  }
+
+  void enterGame(const std::string &username, const std::string &game_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry *entry = entryLocked(username);
+    if (entry == nullptr)
+      return;
+    entry->game_id = game_id;
+    encode(*entry);
+    changedLocked(Kind::GAME_STARTED, *entry);
+  }
+
+  // Chỉ xóa nếu người chơi vẫn đang ở đúng ván game_id
+  void leaveGame(const std::string &username, const std::string &game_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry *entry = entryLocked(username);
+    if (entry == nullptr || entry->game_id != game_id)
+      return;
+    entry->game_id.clear();
+    encode(*entry);
+    changedLocked(Kind::GAME_ENDED, *entry);
+  }
+
+  void setElo(const std::string &username, uint16_t elo) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry *entry = entryLocked(username);
+    if (entry == nullptr || entry->elo == elo)
+      return;
+    entry->elo = elo;
+    encode(*entry);
+    changedLocked(Kind::RATING_CHANGED, *entry);
+  }
+
+  void subscribe(int client_fd) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (std::find(subscribers.begin(), subscribers.end(), client_fd) ==
+        subscribers.end())
+      subscribers.push_back(client_fd);
+  }
+
+  void unsubscribe(int client_fd) {
+    std::lock_guard<std::mutex> lock(mutex);
+    subscribers.erase(
+        std::remove(subscribers.begin(), subscribers.end(), client_fd),
+        subscribers.end());
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+  }
+
+  /**
+   * @brief Gói tin PLAYER_LIST (đã đóng khung) cho một trang.
+   * @param limit Số người chơi tối đa, 0 = Const::PLAYER_LIST_PAGE_SIZE.
+   */
+  SharedPacket page(uint16_t offset, uint8_t limit) {
+    if (limit == 0)
+      limit = Const::PLAYER_LIST_PAGE_SIZE;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    uint32_t key = (static_cast<uint32_t>(offset) << 8) | limit;
+    auto cached = pages.find(key);
+    if (cached != pages.end())
+      return cached->second;
+
+    size_t begin = std::min<size_t>(offset, entries.size());
+    size_t end = std::min<size_t>(begin + limit, entries.size());
+
+    std::vector<uint8_t> payload;
+    payload.push_back(0); // Số người chơi, điền sau
+    uint8_t count = 0;
+    for (size_t i = begin; i < end; i++) {
+      const std::vector<uint8_t> &encoded = entries[i].encoded;
+      // Payload không được vượt quá độ dài tối đa của một gói tin
+      if (payload.size() + encoded.size() + 4 > UINT16_MAX)
+        break;
+      payload.insert(payload.end(), encoded.begin(), encoded.end());
+      count++;
+    }
+    payload[0] = count;
+    payload.push_back(static_cast<uint8_t>(offset >> 8));
+    payload.push_back(static_cast<uint8_t>(offset & 0xFF));
+    uint16_t total = static_cast<uint16_t>(
+        std::min<size_t>(entries.size(), UINT16_MAX));
+    payload.push_back(static_cast<uint8_t>(total >> 8));
+    payload.push_back(static_cast<uint8_t>(total & 0xFF));
+
+    SharedPacket frame =
+        NetworkServer::encodePacket(MessageType::PLAYER_LIST, payload);
+    if (pages.size() >= MAX_CACHED_PAGES)
+      pages.clear();
+    pages[key] = frame;
+    return frame;
+  }
+
+private:
+  using Kind = PresenceUpdateMessage::Kind;
+
+  static constexpr size_t MAX_CACHED_PAGES = 64;
+
+  // Thay đổi chờ gửi: loại + bytes của người chơi sau thay đổi cuối cùng
+  struct PendingEvent {
+    Kind kind;
+    bool was_online; // Người chơi đã online từ đầu nhịp
+    std::vector<uint8_t> encoded;
+  };
+
+  struct Entry {
+    std::string username;
+    uint16_t elo;
+    std::string game_id;          // Rỗng = không trong ván nào
+    std::vector<uint8_t> encoded; // PlayerListMessage::Player đã mã hóa
+  };
+
+  std::vector<Entry> entries; // Sắp xếp theo username
+  std::unordered_map<uint32_t, SharedPacket> pages; // (offset, limit) -> gói
+  std::vector<int> subscribers;
+  std::vector<PendingEvent> pending;
+  std::unordered_map<std::string, size_t> pending_index; // username -> pending
+  bool flush_scheduled = false;
+  std::mutex mutex;
+
+  Lobby() = default;
+
+  std::vector<Entry>::iterator findLocked(const std::string &username) {
+    return std::lower_bound(entries.begin(), entries.end(), username,
+                            [](const Entry &entry, const std::string &name) {
+                              return entry.username < name;
+                            });
+  }
+
+  Entry *entryLocked(const std::string &username) {
+    auto it = findLocked(username);
+    if (it == entries.end() || it->username != username)
+      return nullptr;
+    return &*it;
+  }
+
+  // Xóa cache trang và ghi nhận thay đổi cho người đăng ký
+  void changedLocked(Kind kind, const Entry &entry) {
+    pages.clear();
+    if (subscribers.empty())
+      return;
+
+    auto it = pending_index.find(entry.username);
+    if (it == pending_index.end()) {
+      pending_index[entry.username] = pending.size();
+      pending.push_back(
+          PendingEvent{kind, kind != Kind::JOINED, entry.encoded});
+    } else {
+      // Trong cùng một nhịp chỉ trạng thái cuối cùng có ý nghĩa. JOINED/LEFT
+      // chỉ được gửi khi người chơi thực sự vào/ra sảnh trong nhịp đó (client
+      // dựa vào chúng để tính tổng số người online).
+      PendingEvent &event = pending[it->second];
+      if (kind == Kind::LEFT)
+        event.kind = Kind::LEFT;
+      else if (!event.was_online)
+        event.kind = Kind::JOINED;
+      else
+        event.kind = kind == Kind::JOINED ? Kind::GAME_ENDED : kind;
+      event.encoded = entry.encoded;
+    }
+
+    if (!flush_scheduled) {
+      flush_scheduled = true;
+      TimerWheel::getInstance().schedule(
+          std::chrono::milliseconds(Const::PRESENCE_TICK_MS),
+          [this] { flush(); });
+    }
+  }
+
+  // Gửi các thay đổi đã gom (chạy trên luồng TimerWheel, không được chặn)
+  void flush() {
+    std::vector<PendingEvent> events;
+    std::vector<int> targets;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      flush_scheduled = false;
+      events.swap(pending);
+      pending_index.clear();
+      targets = subscribers;
+    }
+    if (events.empty() || targets.empty())
+      return;
+
+    // Chia thành nhiều gói nếu vượt độ dài tối đa của một payload
+    std::vector<SharedPacket> frames;
+    std::vector<uint8_t> payload;
+    uint16_t count = 0;
+    auto close_frame = [&] {
+      payload[0] = static_cast<uint8_t>(count >> 8);
+      payload[1] = static_cast<uint8_t>(count & 0xFF);
+      frames.push_back(
+          NetworkServer::encodePacket(MessageType::PRESENCE_UPDATE, payload));
+    };
+    for (const PendingEvent &event : events) {
+      // Vào rồi ra trong cùng một nhịp: không có gì để báo
+      if (event.kind == Kind::LEFT && !event.was_online)
+        continue;
+      if (payload.empty() ||
+          payload.size() + 1 + event.encoded.size() > UINT16_MAX) {
+        if (!payload.empty())
+          close_frame();
+        payload.assign(2, 0);
+        count = 0;
+      }
+      payload.push_back(static_cast<uint8_t>(event.kind));
+      payload.insert(payload.end(), event.encoded.begin(), event.encoded.end());
+      count++;
+    }
+    if (payload.empty())
+      return;
+    close_frame();
+
+    NetworkServer &network_server = NetworkServer::getInstance();
+    for (int fd : targets) {
+      for (const SharedPacket &frame : frames) {
+        SendResult result = network_server.trySendEncoded(
+            fd, frame, Const::PRESENCE_MAX_BACKLOG);
+        if (result == SendResult::QUEUED)
+          continue;
+        if (result == SendResult::OVERFLOW)
+          LOG_WARN("presence_subscriber_dropped", "client_fd", fd);
+        unsubscribe(fd);
+        break;
+      }
+    }
+  }
+
+  static void encode(Entry &entry) {
+    PlayerListMessage::Player player;
+    player.username = entry.username;
+    player.elo = entry.elo;
+    player.in_game = !entry.game_id.empty();
+    player.game_id = entry.game_id;
+    entry.encoded.clear();
+    PlayerListMessage::serializePlayer(entry.encoded, player);
+  }
+};
+
+#endif // LOBBY_HPP
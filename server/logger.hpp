@@ -0,0 +1,506 @@
+// LOGGER_HPP - Ghi log có cấu trúc (JSON lines) bất đồng bộ cho server
+
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+// Thư viện chuẩn C++
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Cấp độ log. Giá trị số dùng được trong #if (LOG_COMPILE_LEVEL)
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+
+// Log dưới cấp này bị loại bỏ ngay khi biên dịch (không tốn gì khi chạy).
+// Build với -DLOG_COMPILE_LEVEL=0 để giữ lại LOG_DEBUG.
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+#endif
+
+enum class LogLevel : uint8_t {
+  DEBUG = LOG_LEVEL_DEBUG,
+  INFO = LOG_LEVEL_INFO,
+  WARN = LOG_LEVEL_WARN,
+  ERROR = LOG_LEVEL_ERROR
+};
+
+/**
+ * @brief Lớp Logger (Singleton) - Log bất đồng bộ, mỗi luồng một ring buffer.
+ *
+ * Luồng ghi log chỉ chép tham số (dạng nhị phân) vào ring buffer SPSC của
+ * chính nó, không khóa, không định dạng chuỗi, không I/O. Một luồng nền gom
+ * các ring buffer, định dạng thành JSON lines và ghi ra sink (stdout, stderr
+ * hoặc file) theo lô, mỗi lô một lần flush:
+ *
+ *   {"ts":"2026-01-01T08:00:00.123456Z","level":"info","thread":3,
+ *    "event":"move","game_id":"...","uci":"e2e4"}
+ *
+ * Cách dùng: LOG_INFO("event", "key1", value1, "key2", value2...). Tên event
+ * và key PHẢI là chuỗi hằng (chỉ con trỏ được lưu lại). Giá trị là số, bool,
+ * const char* hoặc std::string (được chép, cắt ở 255 byte).
+ *
+ * Ring buffer đầy thì bản ghi bị bỏ (không bao giờ chặn luồng xử lý); số bản
+ * ghi bị bỏ được báo lại trong một dòng "log_dropped".
+ */
+class Logger {
+public:
+  Logger(const Logger &) = delete;
+  Logger &operator=(const Logger &) = delete;
+
+  static Logger &getInstance() {
+    static Logger instance;
+    return instance;
+  }
+
+  ~Logger() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    cv.notify_one();
+    if (worker.joinable())
+      worker.join();
+    if (owns_sink)
+      std::fclose(sink);
+  }
+
+  /**
+   * @brief Chọn sink và cấp log khi chạy.
+   * @param path Đường dẫn file log (nối thêm), rỗng = stdout.
+   * @return false nếu không mở được file (log tiếp tục ra stdout).
+   */
+  bool configure(const std::string &path, LogLevel level) {
+    min_level.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+    if (path.empty())
+      return true;
+
+    FILE *file = std::fopen(path.c_str(), "a");
+    if (file == nullptr)
+      return false;
+    std::lock_guard<std::mutex> lock(mutex);
+    sink = file;
+    owns_sink = true;
+    return true;
+  }
+
+  // Ghi log ra stream có sẵn (ví dụ stderr); stream không bị đóng
+  void configure(FILE *stream, LogLevel level) {
+    min_level.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex);
+    sink = stream;
+    owns_sink = false;
+  }
+
+  static bool parseLevel(const std::string &name, LogLevel &level) {
+    if (name == "debug")
+      level = LogLevel::DEBUG;
+    else if (name == "info")
+      level = LogLevel::INFO;
+    else if (name == "warn")
+      level = LogLevel::WARN;
+    else if (name == "error")
+      level = LogLevel::ERROR;
+    else
+      return false;
+    return true;
+  }
+
+  bool enabled(LogLevel level) const {
+    return static_cast<uint8_t>(level) >=
+           min_level.load(std::memory_order_relaxed);
+  }
+
+  template <typename... Fields>
+  void log(LogLevel level, const char *event, const Fields &...fields) {
+    static_assert(sizeof...(Fields) % 2 == 0,
+                  "LOG_*: các trường phải theo cặp key, value");
+
+    Ring &ring = threadRing();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) == RING_CAPACITY) {
+      ring.dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    Record &record = ring.records[head % RING_CAPACITY];
+    record.time_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+    record.level = level;
+    record.event = event;
+    record.size = 0;
+    encodeFields(record, fields...);
+    ring.head.store(head + 1, std::memory_order_release);
+
+    // Chỉ đánh thức luồng nền khi nó có thể đang ngủ
+    if (!pending.exchange(true, std::memory_order_acq_rel))
+      cv.notify_one();
+  }
+
+private:
+  static constexpr size_t RECORD_DATA = 232;  // Byte dữ liệu mỗi bản ghi
+  static constexpr size_t FIELD_LIMIT = RECORD_DATA - 1; // Chừa 1 byte cho
+                                                         // dấu TRUNCATED
+  static constexpr size_t RING_CAPACITY = 64; // Bản ghi mỗi luồng
+
+  // Kiểu của một giá trị đã mã hóa
+  enum class Tag : uint8_t { INT, UINT, DOUBLE, BOOL, STRING, TRUNCATED };
+
+  struct Record {
+    uint64_t time_ns;
+    const char *event;
+    LogLevel level;
+    uint16_t size; // Số byte đã dùng trong data
+    uint8_t data[RECORD_DATA];
+  };
+
+  struct Ring {
+    std::atomic<uint64_t> head{0}; // Chỉ luồng sở hữu ghi
+    std::atomic<uint64_t> tail{0}; // Chỉ luồng nền ghi
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> retired{false}; // Luồng sở hữu đã kết thúc
+    uint32_t thread_id = 0;
+    Record records[RING_CAPACITY];
+  };
+
+  // Giữ ring của luồng hiện tại; báo cho luồng nền khi luồng kết thúc
+  struct RingHandle {
+    std::shared_ptr<Ring> ring;
+    ~RingHandle() {
+      if (ring)
+        ring->retired.store(true, std::memory_order_release);
+    }
+  };
+
+  std::vector<std::shared_ptr<Ring>> rings; // Bảo vệ bởi mutex
+  uint32_t next_thread_id = 1;
+  std::atomic<uint8_t> min_level{LOG_LEVEL_INFO};
+  std::atomic<bool> pending{false};
+
+  FILE *sink = stdout;
+  bool owns_sink = false; // sink do configure() mở (cần fclose)
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool stopping = false;
+  std::thread worker;
+
+  Logger() { worker = std::thread(&Logger::run, this); }
+
+  Ring &threadRing() {
+    thread_local RingHandle handle;
+    if (!handle.ring) {
+      handle.ring = std::make_shared<Ring>();
+      std::lock_guard<std::mutex> lock(mutex);
+      handle.ring->thread_id = next_thread_id++;
+      rings.push_back(handle.ring);
+    }
+    return *handle.ring;
+  }
+
+#pragma region Encoding
+
+  static bool put(Record &record, const void *bytes, size_t n) {
+    if (record.size + n > FIELD_LIMIT)
+      return false;
+    std::memcpy(record.data + record.size, bytes, n);
+    record.size += static_cast<uint16_t>(n);
+    return true;
+  }
+
+  template <typename T> static bool putValue(Record &record, Tag tag, T value) {
+    if (record.size + 1 + sizeof(T) > FIELD_LIMIT)
+      return false;
+    put(record, &tag, 1);
+    return put(record, &value, sizeof(T));
+  }
+
+  static bool putString(Record &record, const char *text, size_t length) {
+    if (length > 255)
+      length = 255;
+    if (record.size + size_t(2) > FIELD_LIMIT)
+      return false;
+    length = std::min(length, FIELD_LIMIT - record.size - 2);
+    Tag tag = Tag::STRING;
+    uint8_t len = static_cast<uint8_t>(length);
+    put(record, &tag, 1);
+    put(record, &len, 1);
+    return put(record, text, length);
+  }
+
+  template <typename T>
+  static bool encodeValue(Record &record, const T &value) {
+    if constexpr (std::is_same_v<T, bool>) {
+      return putValue(record, Tag::BOOL, static_cast<uint8_t>(value));
+    } else if constexpr (std::is_enum_v<T>) {
+      return putValue(record, Tag::INT, static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+      return putValue(record, Tag::INT, static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral_v<T>) {
+      return putValue(record, Tag::UINT, static_cast<uint64_t>(value));
+    } else if constexpr (std::is_floating_point_v<T>) {
+      return putValue(record, Tag::DOUBLE, static_cast<double>(value));
+    } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+      std::string_view text(value);
+      return putString(record, text.data(), text.size());
+    } else {
+      static_assert(sizeof(T) == 0, "LOG_*: kiểu giá trị không được hỗ trợ");
+      return false;
+    }
+  }
+
+  static void encodeFields(Record &) {}
+
+  template <typename Value, typename... Rest>
+  static void encodeFields(Record &record, const char *key, const Value &value,
+                           const Rest &...rest) {
+    if (!put(record, &key, sizeof(key)) || !encodeValue(record, value)) {
+      // Hết chỗ: đánh dấu để luồng nền ghi "truncated":true
+      record.data[record.size++] = static_cast<uint8_t>(Tag::TRUNCATED);
+      return;
+    }
+    encodeFields(record, rest...);
+  }
+
+#pragma endregion Encoding
+
+#pragma region Formatting
+
+  static void appendEscaped(std::string &out, const char *text, size_t length) {
+    out += '"';
+    for (size_t i = 0; i < length; i++) {
+      unsigned char c = static_cast<unsigned char>(text[i]);
+      if (c == '"' || c == '\\') {
+        out += '\\';
+        out += static_cast<char>(c);
+      } else if (c < 0x20) {
+        char escaped[8];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        out += escaped;
+      } else {
+        out += static_cast<char>(c);
+      }
+    }
+    out += '"';
+  }
+
+  static const char *levelName(LogLevel level) {
+    switch (level) {
+    case LogLevel::DEBUG:
+      return "debug";
+    case LogLevel::INFO:
+      return "info";
+    case LogLevel::WARN:
+      return "warn";
+    case LogLevel::ERROR:
+      return "error";
+    }
+    return "info";
+  }
+
+  static void appendRecord(std::string &out, const Record &record,
+                           uint32_t thread_id) {
+    time_t seconds = static_cast<time_t>(record.time_ns / 1000000000);
+    struct tm utc;
+    gmtime_r(&seconds, &utc);
+    char prefix[96];
+    size_t n = std::strftime(prefix, sizeof(prefix), "{\"ts\":\"%Y-%m-%dT%H:%M:%S",
+                             &utc);
+    std::snprintf(prefix + n, sizeof(prefix) - n,
+                  ".%06uZ\",\"level\":\"%s\",\"thread\":%u,\"event\":",
+                  static_cast<unsigned>((record.time_ns / 1000) % 1000000),
+                  levelName(record.level), thread_id);
+    out += prefix;
+    appendEscaped(out, record.event, std::strlen(record.event));
+
+    size_t pos = 0;
+    while (pos < record.size) {
+      if (static_cast<Tag>(record.data[pos]) == Tag::TRUNCATED) {
+        out += ",\"truncated\":true";
+        break;
+      }
+
+      const char *key;
+      std::memcpy(&key, record.data + pos, sizeof(key));
+      pos += sizeof(key);
+      out += ',';
+      appendEscaped(out, key, std::strlen(key));
+      out += ':';
+
+      if (static_cast<Tag>(record.data[pos]) == Tag::TRUNCATED) {
+        out += "null,\"truncated\":true";
+        break;
+      }
+      Tag tag = static_cast<Tag>(record.data[pos++]);
+      char number[32];
+      switch (tag) {
+      case Tag::INT: {
+        int64_t v;
+        std::memcpy(&v, record.data + pos, sizeof(v));
+        pos += sizeof(v);
+        std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(v));
+        out += number;
+        break;
+      }
+      case Tag::UINT: {
+        uint64_t v;
+        std::memcpy(&v, record.data + pos, sizeof(v));
+        pos += sizeof(v);
+        std::snprintf(number, sizeof(number), "%llu",
+                      static_cast<unsigned long long>(v));
+        out += number;
+        break;
+      }
+      case Tag::DOUBLE: {
+        double v;
+        std::memcpy(&v, record.data + pos, sizeof(v));
+        pos += sizeof(v);
+        std::snprintf(number, sizeof(number), "%.17g", v);
+        out += number;
+        break;
+      }
+      case Tag::BOOL:
+        out += record.data[pos++] ? "true" : "false";
+        break;
+      case Tag::STRING: {
+        uint8_t length = record.data[pos++];
+        appendEscaped(out, reinterpret_cast<const char *>(record.data + pos),
+                      length);
+        pos += length;
+        break;
+      }
+      case Tag::TRUNCATED:
+        break;
+      }
+    }
+    out += "}\n";
+  }
+
+#pragma endregion Formatting
+
+  // Gom mọi ring buffer vào out; trả về false nếu không có gì
+  bool drain(std::string &out) {
+    std::vector<std::shared_ptr<Ring>> snapshot;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      snapshot = rings;
+    }
+
+    bool any = false;
+    for (const auto &ring : snapshot) {
+      uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+      uint64_t head = ring->head.load(std::memory_order_acquire);
+      for (; tail < head; tail++) {
+        appendRecord(out, ring->records[tail % RING_CAPACITY], ring->thread_id);
+        any = true;
+      }
+      ring->tail.store(tail, std::memory_order_release);
+
+      uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+      if (dropped > 0) {
+        char line[128];
+        std::snprintf(line, sizeof(line),
+                      "{\"level\":\"warn\",\"thread\":%u,\"event\":"
+                      "\"log_dropped\",\"count\":%llu}\n",
+                      ring->thread_id, static_cast<unsigned long long>(dropped));
+        out += line;
+        any = true;
+      }
+    }
+
+    // Bỏ ring của các luồng đã kết thúc khi đã đọc hết
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < rings.size();) {
+      Ring &ring = *rings[i];
+      if (ring.retired.load(std::memory_order_acquire) &&
+          ring.tail.load(std::memory_order_relaxed) ==
+              ring.head.load(std::memory_order_acquire)) {
+        rings[i] = rings.back();
+        rings.pop_back();
+      } else {
+        i++;
+      }
+    }
+    return any;
+  }
+
+  // Vòng lặp của luồng nền
+  void run() {
+    std::string batch;
+    while (true) {
+      bool stop;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::seconds(1), [this] {
+          return stopping || pending.load(std::memory_order_acquire);
+        });
+        stop = stopping;
+      }
+      pending.store(false, std::memory_order_release);
+
+      batch.clear();
+      if (drain(batch)) {
+        FILE *out;
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          out = sink;
+        }
+        std::fwrite(batch.data(), 1, batch.size(), out);
+        std::fflush(out);
+      }
+
+      if (stop)
+        return;
+    }
+  }
+};
+
+#define LOG_AT(level, event, ...)                                              \
+  do {                                                                         \
+    Logger &logger_ = Logger::getInstance();                                   \
+    if (logger_.enabled(level))                                                \
+      logger_.log(level, event, ##__VA_ARGS__);                                \
+  } while (0)
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(event, ...) LOG_AT(LogLevel::DEBUG, event, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(event, ...)                                                  \
+  do {                                                                         \
+  } while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(event, ...) LOG_AT(LogLevel::INFO, event, ##__VA_ARGS__)
+#else
+#define LOG_INFO(event, ...)                                                   \
+  do {                                                                         \
+  } while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(event, ...) LOG_AT(LogLevel::WARN, event, ##__VA_ARGS__)
+#else
+#define LOG_WARN(event, ...)                                                   \
+  do {                                                                         \
+  } while (0)
+#endif
+
+#define LOG_ERROR(event, ...) LOG_AT(LogLevel::ERROR, event, ##__VA_ARGS__)
+
+#endif // LOGGER_HPP
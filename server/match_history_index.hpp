@@ -0,0 +1,113 @@
+// MATCH_HISTORY_INDEX_HPP - Chỉ mục các ván của từng người chơi theo thời gian
+
+#ifndef MATCH_HISTORY_INDEX_HPP
+#define MATCH_HISTORY_INDEX_HPP
+
+// Thư viện chuẩn C++
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Thư viện dự án
+#include "structs.hpp"
+
+/**
+ * @brief Chỉ mục phụ username → các game_id, sắp theo (thời gian bắt đầu,
+ * game_id) tăng dần.
+ *
+ * Ván mới luôn bắt đầu muộn nhất nên add() thường chỉ là push_back. Một trang
+ * lịch sử (mới nhất trước) được lấy bằng một lần tìm nhị phân theo con trỏ
+ * rồi đọc ngược limit phần tử: O(log n + limit), không phụ thuộc số ván của
+ * người chơi. Con trỏ là khóa của phần tử cuối trang trước, nên trang không
+ * bị lệch khi có ván mới chen vào đầu danh sách.
+ *
+ * Lớp không tự khóa: DataStorage gọi khi đang giữ matches_mutex.
+ */
+class MatchHistoryIndex {
+public:
+  struct Key {
+    int64_t start_ns = 0; // Thời điểm bắt đầu (ns từ epoch)
+    std::string game_id;
+
+    bool operator<(const Key &other) const {
+      return start_ns != other.start_ns ? start_ns < other.start_ns
+                                        : game_id < other.game_id;
+    }
+    bool operator==(const Key &other) const {
+      return start_ns == other.start_ns && game_id == other.game_id;
+    }
+  };
+
+  // Một dòng của trang lịch sử: match chỉ có thông tin chung (không có
+  // moves/analysis), plies là số nước đã đi
+  struct Entry {
+    Key key;
+    MatchModel match;
+    uint64_t plies = 0;
+  };
+
+  void add(const std::string &username, const Key &key) {
+    std::vector<Key> &games = by_user[username];
+    if (games.empty() || games.back() < key) {
+      games.push_back(key);
+      return;
+    }
+    auto it = std::lower_bound(games.begin(), games.end(), key);
+    if (it == games.end() || !(*it == key))
+      games.insert(it, key);
+  }
+
+  // Bỏ một ván khỏi danh sách của người chơi (ván chưa từng bắt đầu)
+  void remove(const std::string &username, const Key &key) {
+    auto user_it = by_user.find(username);
+    if (user_it == by_user.end())
+      return;
+    std::vector<Key> &games = user_it->second;
+    auto it = std::lower_bound(games.begin(), games.end(), key);
+    if (it != games.end() && *it == key)
+      games.erase(it);
+    if (games.empty())
+      by_user.erase(user_it);
+  }
+
+  bool contains(const std::string &username) const {
+    return by_user.count(username) > 0;
+  }
+
+  size_t count(const std::string &username) const {
+    auto it = by_user.find(username);
+    return it == by_user.end() ? 0 : it->second.size();
+  }
+
+  /**
+   * @brief Tối đa limit ván cũ hơn before (nullptr = từ ván mới nhất), mới
+   * nhất trước.
+   * @param has_more Còn ván cũ hơn phần tử cuối trang hay không.
+   */
+  std::vector<Key> page(const std::string &username, const Key *before,
+                        size_t limit, bool &has_more) const {
+    std::vector<Key> result;
+    has_more = false;
+    auto it = by_user.find(username);
+    if (it == by_user.end())
+      return result;
+
+    const std::vector<Key> &games = it->second;
+    size_t end = before == nullptr
+                     ? games.size()
+                     : std::lower_bound(games.begin(), games.end(), *before) -
+                           games.begin();
+    size_t begin = end > limit ? end - limit : 0;
+    for (size_t i = end; i > begin; i--)
+      result.push_back(games[i - 1]);
+    has_more = begin > 0;
+    return result;
+  }
+
+private:
+  std::unordered_map<std::string, std::vector<Key>> by_user;
+};
+
+#endif // MATCH_HISTORY_INDEX_HPP
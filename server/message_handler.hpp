@@ -1,11 +1,12 @@
 #ifndef MESSAGE_HANDLER_HPP
 #define MESSAGE_HANDLER_HPP
 
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <memory>
 #include <sstream>
-#include <iostream>
 #include <iomanip>
 
 #include "../common/protocol.hpp"
@@ -13,9 +14,14 @@
 #include "../common/const.hpp"
 #include "../common/utils.hpp"
 
+#include "analysis.hpp"
 #include "data_storage.hpp"
+#include "game_log_stream.hpp"
 #include "network_server.hpp"
+#include "opening_explorer.hpp"
 #include "game_manager.hpp"
+#include "lobby.hpp"
+#include "logger.hpp"
 
 /**
  * @brief Lớp MessageHandler xử lý các thông điệp (message) đến từ client trong ứng dụng cờ vua.
@@ -23,13 +29,16 @@
  * Lớp này chịu trách nhiệm:
  * - Phân tích và xử lý các loại packet đến từ client dựa trên MessageType.
  * - Quản lý đăng ký và đăng nhập người dùng, bao gồm kiểm tra tính hợp lệ và trạng thái đăng nhập.
- * - Xử lý các yêu cầu chơi game: nước đi, auto match, challenge, đầu hàng.
+ * - Xử lý các yêu cầu chơi game: nước đi, auto match, challenge, đầu hàng, chơi với máy.
  * - Gửi danh sách người chơi online và thông tin game.
+ * - Trả kết quả phân tích sau ván (ANALYSIS_REQUEST) và thống kê khai cuộc (EXPLORER_REQUEST).
+ * - Gửi nhật ký ván theo chunk (GAME_LOG_REQUEST / GAME_LOG_ACK).
  * - Tương tác với DataStorage để lưu trữ dữ liệu người dùng và trận đấu.
  * - Tương tác với NetworkServer để gửi packet và quản lý kết nối.
  * - Tương tác với GameManager để quản lý logic game và trận đấu.
  *
- * @note Lớp này không phải Singleton; mỗi instance có thể xử lý message độc lập.
+ * @note Lớp này không phải Singleton; mỗi kết nối có một instance riêng (giữ luồng gửi nhật ký
+ *       của kết nối đó).
  * @note Sử dụng các message classes từ common/message.hpp để serialize/deserialize.
  */
 class MessageHandler
@@ -40,6 +49,8 @@ private:
     DataStorage& storage;
     GameManager& gameManager;
 
+    GameLogStream game_log_stream; // Nhật ký đang gửi cho kết nối này
+
 public:
     /**
      * @brief Constructor với Dependency Injection
@@ -87,6 +98,19 @@ public:
             handleRequestPlayerList(client_fd, packet.payload);
             break;
 
+        case MessageType::SUBSCRIBE_PRESENCE:
+            // Bật/tắt nhận thay đổi sảnh chờ
+            handleSubscribePresence(client_fd, packet.payload);
+            break;
+
+        case MessageType::LEADERBOARD_REQUEST:
+            handleLeaderboardRequest(client_fd, packet.payload);
+            break;
+
+        case MessageType::MATCH_HISTORY_REQUEST:
+            handleMatchHistoryRequest(client_fd, packet.payload);
+            break;
+
         case MessageType::CHALLENGE_REQUEST:
             // Handle incoming challenge request
             handleChallengeRequest(client_fd, packet.payload);
@@ -103,6 +127,38 @@ public:
             handleSurrender(client_fd, packet.payload);
             break;
 
+        case MessageType::PLAY_VS_ENGINE:
+            handlePlayVsEngine(client_fd, packet.payload);
+            break;
+
+        case MessageType::ANALYSIS_REQUEST:
+            handleAnalysisRequest(client_fd, packet.payload);
+            break;
+
+        case MessageType::EXPLORER_REQUEST:
+            handleExplorerRequest(client_fd, packet.payload);
+            break;
+
+        case MessageType::GAME_LOG_REQUEST:
+            handleGameLogRequest(client_fd, packet.payload);
+            break;
+
+        case MessageType::GAME_LOG_ACK:
+            handleGameLogAck(client_fd, packet.payload);
+            break;
+
+        case MessageType::WATCH_GAME:
+            handleWatchGame(client_fd, packet.payload);
+            break;
+
+        case MessageType::UNWATCH_GAME:
+            handleUnwatchGame(client_fd, packet.payload);
+            break;
+
+        case MessageType::PONG:
+            // Không cần xử lý: NetworkServer đã ghi nhận client còn sống
+            break;
+
 
         default:
             // Handle unknown message type
@@ -116,14 +172,23 @@ private:
 
     void handleUnknown(int client_fd, const std::vector<uint8_t> &payload)
     {
-        std::cout << "[UNKNOWN]" << std::endl;
+        LOG_WARN("unknown_message", "client_fd", client_fd, "size", payload.size());
     }
 
     void handleRegister(int client_fd, const std::vector<uint8_t> &payload)
     {
         RegisterMessage message = RegisterMessage::deserialize(payload);
 
-        std::cout << "[REGISTER] username: " << message.username << std::endl;
+        LOG_INFO("register", "username", message.username, "client_fd", client_fd);
+
+        // Tên bắt đầu bằng '<' dành cho server ("<0>" = hòa, máy chơi cờ)
+        if (!message.username.empty() && message.username[0] == '<')
+        {
+            RegisterFailureMessage failureMessage;
+            failureMessage.error_message = "Username is reserved.";
+            server.sendPacket(client_fd, failureMessage.getType(), failureMessage.serialize());
+            return;
+        }
 
         bool isUserValid = storage.registerUser(message.username);
 
@@ -136,8 +201,11 @@ private:
 
             std::vector<uint8_t> serialized = successMessage.serialize();
 
-            server.sendPacket(client_fd, successMessage.getType(), serialized);
+            // Vào sảnh trước khi trả lời: client nhận SUCCESS rồi hỏi danh sách
+            // (từ kết nối khác) phải thấy người chơi này
             server.setUsername(client_fd, message.username);
+            Lobby::getInstance().playerOnline(message.username, Const::DEFAULT_ELO);
+            server.sendPacket(client_fd, successMessage.getType(), serialized);
         }
         else
         {
@@ -155,7 +223,7 @@ private:
     {
         LoginMessage message = LoginMessage::deserialize(payload);
 
-        std::cout << "[LOGIN] username: " << message.username << ", client_fd: " << client_fd << std::endl;
+        LOG_INFO("login", "username", message.username, "client_fd", client_fd);
 
         bool isUserValid = storage.validateUser(message.username);
         bool isLoggedIn = server.isUserLoggedIn(message.username);
@@ -171,8 +239,10 @@ private:
 
             std::vector<uint8_t> serialized = successMessage.serialize();
 
-            server.sendPacket(client_fd, successMessage.getType(), serialized);
+            // Vào sảnh trước khi trả lời (xem handleRegister)
             server.setUsername(client_fd, message.username);
+            Lobby::getInstance().playerOnline(message.username, elo);
+            server.sendPacket(client_fd, successMessage.getType(), serialized);
         }
         else if (!isUserValid)
         {
@@ -198,8 +268,8 @@ private:
     {
         MoveMessage message = MoveMessage::deserialize(payload);
 
-        std::cout << "[MOVE] game_id: " << message.game_id
-                  << ", uci_move: " << message.uci_move << std::endl;
+        LOG_DEBUG("move", "game_id", message.game_id, "uci", message.uci_move,
+                  "client_fd", client_fd);
 
         gameManager.handleMove(client_fd, message.game_id, message.uci_move);
     }
@@ -208,7 +278,7 @@ private:
     {
         AutoMatchRequestMessage message = AutoMatchRequestMessage::deserialize(payload);
 
-        std::cout << "[AUTO_MATCH_REQUEST] username: " << message.username << std::endl;
+        LOG_INFO("auto_match_request", "username", message.username, "client_fd", client_fd);
 
         gameManager.addPlayerToQueue(client_fd);
     }
@@ -217,7 +287,7 @@ private:
     {
         AutoMatchAcceptedMessage message = AutoMatchAcceptedMessage::deserialize(payload);
 
-        std::cout << "[AUTO_MATCH_ACCEPTED] game_id: " << message.game_id << std::endl;
+        LOG_INFO("auto_match_accepted", "game_id", message.game_id, "client_fd", client_fd);
 
         gameManager.handleAutoMatchAccepted(client_fd, message.game_id);
     }
@@ -226,7 +296,7 @@ private:
     {
         AutoMatchDeclinedMessage message = AutoMatchDeclinedMessage::deserialize(payload);
 
-        std::cout << "[AUTO_MATCH_DECLINED] game_id: " << message.game_id << std::endl;
+        LOG_INFO("auto_match_declined", "game_id", message.game_id, "client_fd", client_fd);
 
         gameManager.handleAutoMatchDeclined(client_fd, message.game_id);
     }
@@ -235,33 +305,113 @@ private:
     {
         RequestPlayerListMessage message = RequestPlayerListMessage::deserialize(payload);
 
-        std::cout << "[REQUEST_PLAYER_LIST] from " << server.getUsername(client_fd) << std::endl;
+        LOG_DEBUG("request_player_list", "client_fd", client_fd, "offset",
+                  message.offset, "limit", message.limit);
 
-        std::unordered_map<std::string, UserModel> players = storage.getPlayerList();
+        // Trang đã đóng khung sẵn trong Lobby, không phải dựng lại danh sách
+        server.sendEncoded(client_fd, Lobby::getInstance().page(message.offset, message.limit));
+    }
+
+    void handleSubscribePresence(int client_fd, const std::vector<uint8_t> &payload)
+    {
+        SubscribePresenceMessage message = SubscribePresenceMessage::deserialize(payload);
 
-        PlayerListMessage response;
+        LOG_DEBUG("subscribe_presence", "client_fd", client_fd, "subscribe",
+                  message.subscribe);
 
-        for (const auto &pair : players)
+        // Chỉ người đã đăng nhập mới được nhận thay đổi sảnh chờ
+        if (message.subscribe && !server.getUsername(client_fd).empty())
+            Lobby::getInstance().subscribe(client_fd);
+        else
+            Lobby::getInstance().unsubscribe(client_fd);
+    }
+
+    void handleLeaderboardRequest(int client_fd, const std::vector<uint8_t> &payload)
+    {
+        LeaderboardRequestMessage message = LeaderboardRequestMessage::deserialize(payload);
+
+        size_t limit = message.limit;
+        if (limit == 0 || limit > Const::LEADERBOARD_MAX_SIZE)
+            limit = Const::LEADERBOARD_MAX_SIZE;
+
+        LOG_DEBUG("leaderboard_request", "client_fd", client_fd, "mode",
+                  static_cast<int>(message.mode), "limit", limit);
+
+        // Tra chỉ mục Elo trong DataStorage: O(log n + limit)
+        LeaderboardResponseMessage response;
+        std::vector<RatingIndex::Entry> entries;
+        if (message.mode == LeaderboardRequestMessage::Mode::AROUND_ME)
         {
-            // return early not login player
-            if (!server.isUserLoggedIn(pair.second.username))
-            {
-                continue;
-            }
+            response.mode = LeaderboardRequestMessage::Mode::AROUND_ME;
+            entries = storage.getLeaderboardAround(server.getUsername(client_fd), limit, response.total);
+        }
+        else
+        {
+            entries = storage.getLeaderboardTop(limit, response.total);
+        }
 
-            PlayerListMessage::Player player;
-            player.username = pair.second.username;
-            player.elo = pair.second.elo;
-            player.in_game = gameManager.isUserInGame(player.username);
+        for (const auto &entry : entries)
+            response.entries.push_back({entry.rank, entry.username, entry.elo});
 
-            if (player.in_game)
-            {
-                player.game_id = gameManager.getUserGameId(player.username);
-            }
+        server.sendPacket(client_fd, response.getType(), response.serialize());
+    }
+
+    void handleMatchHistoryRequest(int client_fd, const std::vector<uint8_t> &payload)
+    {
+        MatchHistoryRequestMessage message = MatchHistoryRequestMessage::deserialize(payload);
 
-            response.players.push_back(player);
+        size_t limit = message.limit;
+        if (limit == 0)
+            limit = Const::MATCH_HISTORY_PAGE_SIZE;
+        if (limit > Const::MATCH_HISTORY_MAX_SIZE)
+            limit = Const::MATCH_HISTORY_MAX_SIZE;
+
+        MatchHistoryResponseMessage response;
+        response.username = message.username.empty() ? server.getUsername(client_fd) : message.username;
+        LOG_DEBUG("match_history_request", "client_fd", client_fd, "username",
+                  response.username, "limit", limit);
+
+        if (!storage.validateUser(response.username) && !storage.hasMatchHistory(response.username))
+        {
+            response.status = MatchHistoryResponseMessage::Status::NOT_FOUND;
+            server.sendPacket(client_fd, response.getType(), response.serialize());
+            return;
         }
 
+        // Tra chỉ mục lịch sử trong DataStorage: O(log n + limit)
+        MatchHistoryIndex::Key cursor{message.cursor_time, message.cursor_id};
+        std::vector<MatchHistoryIndex::Entry> entries = storage.getMatchHistory(
+            response.username, message.cursor_id.empty() ? nullptr : &cursor, limit,
+            response.total, response.has_more);
+
+        for (const auto &entry : entries)
+        {
+            const MatchModel &match = entry.match;
+            bool is_white = match.white_username == response.username;
+
+            MatchHistoryResponseMessage::Entry item;
+            item.game_id = match.game_id;
+            item.opponent = is_white ? match.black_username : match.white_username;
+            item.color = is_white ? 0 : 1;
+            if (match.result.empty())
+                item.outcome = MatchHistoryResponseMessage::Outcome::ONGOING;
+            else if (match.result == "<0>")
+                item.outcome = MatchHistoryResponseMessage::Outcome::DRAW;
+            else if (match.result == response.username)
+                item.outcome = MatchHistoryResponseMessage::Outcome::WIN;
+            else
+                item.outcome = MatchHistoryResponseMessage::Outcome::LOSS;
+            item.reason = match.reason;
+            item.start_time = entry.key.start_ns;
+            item.plies = static_cast<uint16_t>(std::min<uint64_t>(entry.plies, UINT16_MAX));
+            response.entries.push_back(item);
+        }
+
+        if (!entries.empty())
+        {
+            response.next_time = entries.back().key.start_ns;
+            response.next_id = entries.back().key.game_id;
+        }
         server.sendPacket(client_fd, response.getType(), response.serialize());
     }
 
@@ -272,12 +422,10 @@ private:
         std::string from_username = server.getUsername(client_fd);
         std::string to_username = message.to_username;
 
-        std::cout << "[CHALLENGE_REQUEST] from: " << from_username
-                  << ", to: " << to_username << std::endl;
-
         // Check if opponent is online
         bool is_opponent_online = server.isUserLoggedIn(to_username);
-        std::cout << "Opponent " << to_username << " online: " << is_opponent_online << std::endl;
+        LOG_INFO("challenge_request", "from", from_username, "to", to_username,
+                 "opponent_online", is_opponent_online);
 
         if (!is_opponent_online)
         {
@@ -297,9 +445,8 @@ private:
         int to_rank = storage.getUserRank(to_username);
         int rank_difference = abs(from_rank - to_rank);
         
-        std::cout << "Rank check - From: " << from_username << " (rank " << from_rank 
-                  << "), To: " << to_username << " (rank " << to_rank 
-                  << "), Difference: " << rank_difference << std::endl;
+        LOG_DEBUG("challenge_rank_check", "from", from_username, "from_rank", from_rank,
+                  "to", to_username, "to_rank", to_rank);
 
         if (rank_difference > 10)
         {
@@ -313,13 +460,17 @@ private:
 
             server.sendPacket(client_fd, error_msg.getType(), serialized);
             
-            std::cout << "[CHALLENGE_ERROR] Rank difference too large: " << rank_difference << std::endl;
+            LOG_INFO("challenge_rejected", "from", from_username, "to", to_username,
+                     "rank_difference", rank_difference);
             return;
         }
 
         // All checks passed, send challenge notification to opponent
         int to_client_fd = server.getClientFD(to_username);
 
+        // Challenge expires if not answered in time
+        gameManager.addChallenge(from_username, to_username);
+
         ChallengeNotificationMessage notification_msg;
 
         notification_msg.from_username = from_username;
@@ -329,8 +480,7 @@ private:
 
         server.sendPacket(to_client_fd, notification_msg.getType(), serialized);
 
-        std::cout << "[CHALLENGE_NOTIFICATION] Sent challenge from "
-                  << from_username << " to " << to_username << std::endl;
+        LOG_INFO("challenge_sent", "from", from_username, "to", to_username);
     }
 
     void handleChallengeResponse(int client_fd, const std::vector<uint8_t> &payload)
@@ -343,9 +493,18 @@ private:
         int challenger_fd = server.getClientFD(challenger_username);
         // challenged_fd is client_fd
 
-        std::cout << "[CHALLENGE_RESPONSE] from: " << challenged_username
-                  << ", challenged by: " << challenger_username
-                  << ", accepted: " << static_cast<uint8_t>(message.response) << std::endl;
+        // Only answer challenges that are still pending (not expired)
+        if (!gameManager.takeChallenge(challenger_username, challenged_username))
+        {
+            ChallengeErrorMessage error_msg;
+            error_msg.error_message = "Challenge from " + challenger_username + " is no longer valid.";
+            server.sendPacket(client_fd, error_msg.getType(), error_msg.serialize());
+            return;
+        }
+
+        LOG_INFO("challenge_response", "from", challenged_username,
+                 "challenger", challenger_username, "accepted",
+                 message.response == ChallengeResponseMessage::Response::ACCEPTED);
 
         if (message.response == ChallengeResponseMessage::Response::ACCEPTED)
         {
@@ -359,7 +518,8 @@ private:
             std::vector<uint8_t> serialized = challenge_accepted_msg.serialize();
             server.sendPacket(challenger_fd, challenge_accepted_msg.getType(), serialized);
 
-            std::cout << "Game " << game_id << " started." << std::endl;
+            LOG_INFO("game_started", "game_id", game_id, "white", challenger_username,
+                     "black", challenged_username);
 
             // Notify both players about the game start
             GameStartMessage game_start_msg;
@@ -371,10 +531,10 @@ private:
             game_start_msg.starting_player_username = challenger_username;
             game_start_msg.fen = chess::constants::STARTPOS;
 
-            std::vector<uint8_t> gs_serialized = game_start_msg.serialize();
+            server.broadcast(std::vector<int>{challenger_fd, client_fd}, game_start_msg);
 
-            server.sendPacket(challenger_fd, game_start_msg.getType(), gs_serialized);
-            server.sendPacket(client_fd, game_start_msg.getType(), gs_serialized);
+            // Đồng hồ bắt đầu chạy từ lúc GAME_START được gửi
+            gameManager.startClock(gameManager.getGame(game_id));
         }
         else
         {
@@ -387,7 +547,7 @@ private:
 
             server.sendPacket(challenger_fd, challenge_declined_msg.getType(), serialized);
 
-            std::cout << "Decline message sent to " << message.from_username << std::endl;
+            LOG_INFO("challenge_declined", "challenger", message.from_username);
         }
     }
 
@@ -396,20 +556,21 @@ private:
     {
         SurrenderMessage message = SurrenderMessage::deserialize(payload);
 
-        std::cout << "[SURRENDER] game_id: " << message.game_id
-                  << ", from_username: " << message.from_username << std::endl;
+        LOG_INFO("surrender", "game_id", message.game_id, "from", message.from_username);
 
         std::string surrendering_player = server.getUsername(client_fd);
         std::string opponent_username = gameManager.getOpponent(message.game_id, surrendering_player);
 
         if (opponent_username.empty())
         {
-            std::cerr << "Error: Could not find opponent for game_id: " << message.game_id << std::endl;
+            LOG_WARN("surrender_no_opponent", "game_id", message.game_id);
             return;
         }
 
-        // Dừng trận đấu
-        gameManager.endGameForSurrender(message.game_id, message.from_username);
+        // Dừng trận đấu (ván vừa kết thúc theo đường khác thì không báo lại)
+        uint16_t half_moves_count = gameManager.getGameHalfMovesCount(message.game_id);
+        if (!gameManager.endGameForSurrender(message.game_id, message.from_username))
+            return;
 
         // Thông báo kết thúc trò chơi
         GameEndMessage end_message;
@@ -417,14 +578,179 @@ private:
         end_message.game_id = message.game_id;
         end_message.winner_username = opponent_username;
         end_message.reason = surrendering_player + " has surrendered.";
-        end_message.half_moves_count = gameManager.getGameHalfMovesCount(message.game_id);
-
-        std::vector<uint8_t> serialized = end_message.serialize();
+        end_message.half_moves_count = half_moves_count;
 
-        server.sendPacket(client_fd, end_message.getType(), serialized); // Người đầu hàng
-        
+        // Người đầu hàng và đối thủ nhận cùng một gói tin (máy thì không cần)
+        std::vector<int> recipients{client_fd};
         int opponent_fd = server.getClientFD(opponent_username);
-        server.sendPacket(opponent_fd, end_message.getType(), serialized); // Đối thủ
+        if (opponent_fd != -1)
+            recipients.push_back(opponent_fd);
+        server.broadcast(recipients, end_message);
+        gameManager.endWatching(message.game_id, end_message);
+    }
+
+    void handlePlayVsEngine(int client_fd, const std::vector<uint8_t> &payload)
+    {
+        PlayVsEngineMessage message = PlayVsEngineMessage::deserialize(payload);
+
+        LOG_INFO("play_vs_engine", "client_fd", client_fd,
+                 "color", static_cast<int>(message.color), "level", message.level);
+
+        gameManager.handlePlayVsEngine(client_fd, message.color, message.level);
+    }
+
+    void handleAnalysisRequest(int client_fd, const std::vector<uint8_t> &payload)
+    {
+        AnalysisRequestMessage message = AnalysisRequestMessage::deserialize(payload);
+
+        AnalysisResponseMessage response;
+        response.game_id = message.game_id;
+        try
+        {
+            MatchModel match = storage.getMatch(message.game_id);
+            if (match.result.empty())
+            {
+                response.status = AnalysisResponseMessage::Status::NOT_FOUND; // Ván chưa kết thúc
+            }
+            else if (match.analysis_depth > 0)
+            {
+                response.status = AnalysisResponseMessage::Status::READY;
+                response.depth = static_cast<uint8_t>(match.analysis_depth);
+                for (const auto &move : match.analysis)
+                {
+                    int16_t eval = static_cast<int16_t>(std::clamp(move.eval, -32000, 32000));
+                    response.moves.push_back({eval, move.judgement, move.best});
+                }
+            }
+            else
+            {
+                // Ván cũ hoặc chưa tới lượt: xếp vào hàng đợi, client hỏi lại sau
+                response.status = Analyzer::getInstance().enqueue(message.game_id)
+                                      ? AnalysisResponseMessage::Status::PENDING
+                                      : AnalysisResponseMessage::Status::UNAVAILABLE;
+            }
+        }
+        catch (const std::exception &)
+        {
+            response.status = AnalysisResponseMessage::Status::NOT_FOUND;
+        }
+
+        LOG_DEBUG("analysis_request", "client_fd", client_fd, "game_id", message.game_id,
+                  "status", static_cast<int>(response.status));
+        server.sendPacket(client_fd, response.getType(), response.serialize());
+    }
+
+    void handleExplorerRequest(int client_fd, const std::vector<uint8_t> &payload)
+    {
+        ExplorerRequestMessage message = ExplorerRequestMessage::deserialize(payload);
+        auto start = std::chrono::steady_clock::now();
+
+        // Đi lại chuỗi nước từ thế cờ ban đầu, dừng ở nước không hợp lệ đầu tiên
+        ExplorerResponseMessage response;
+        chess::Board board;
+        if (message.moves.size() > Const::EXPLORER_MAX_LINE)
+        {
+            response.status = ExplorerResponseMessage::Status::INVALID_LINE;
+        }
+        for (const auto &uci : message.moves)
+        {
+            if (response.status != ExplorerResponseMessage::Status::OK)
+                break;
+            chess::Move move = chess::uci::uciToMove(board, uci);
+            chess::Movelist legal;
+            chess::movegen::legalmoves(legal, board);
+            if (move == chess::Move::NO_MOVE || std::find(legal.begin(), legal.end(), move) == legal.end())
+            {
+                response.status = ExplorerResponseMessage::Status::INVALID_LINE;
+                break;
+            }
+            board.makeMove(move);
+        }
+
+        OpeningExplorer &explorer = OpeningExplorer::getInstance();
+        response.games = static_cast<uint32_t>(explorer.gamesIndexed());
+        if (response.status == ExplorerResponseMessage::Status::OK)
+        {
+            for (const auto &stats : explorer.query(board))
+            {
+                response.moves.push_back({chess::uci::moveToUci(stats.move),
+                                          stats.white, stats.draws, stats.black});
+            }
+        }
+
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+        Metrics::getInstance().explorer_query_us.observe(micros);
+        LOG_DEBUG("explorer_request", "client_fd", client_fd, "plies", message.moves.size(),
+                  "status", static_cast<int>(response.status), "moves", response.moves.size(),
+                  "time_us", micros);
+        server.sendPacket(client_fd, response.getType(), response.serialize());
+    }
+
+    void handleGameLogRequest(int client_fd, const std::vector<uint8_t> &payload)
+    {
+        GameLogRequestMessage message = GameLogRequestMessage::deserialize(payload);
+
+        size_t window = message.window;
+        if (window == 0)
+            window = Const::GAME_LOG_WINDOW;
+        if (window > Const::GAME_LOG_MAX_WINDOW)
+            window = Const::GAME_LOG_MAX_WINDOW;
+
+        try
+        {
+            game_log_stream.start(storage.getMatch(message.game_id), window);
+        }
+        catch (const std::exception &)
+        {
+            game_log_stream.stop();
+            GameLogMessage not_found;
+            not_found.game_id = message.game_id;
+            not_found.status = GameLogMessage::Status::NOT_FOUND;
+            not_found.flags = GameLogMessage::FLAG_LAST;
+            server.sendPacket(client_fd, not_found.getType(), not_found.serialize());
+            return;
+        }
+
+        LOG_DEBUG("game_log_request", "client_fd", client_fd, "game_id", message.game_id,
+                  "window", window);
+        sendGameLogChunks(client_fd);
+    }
+
+    void handleGameLogAck(int client_fd, const std::vector<uint8_t> &payload)
+    {
+        GameLogAckMessage message = GameLogAckMessage::deserialize(payload);
+        game_log_stream.ack(message.game_id, message.seq);
+        sendGameLogChunks(client_fd);
+    }
+
+    // Gửi các chunk nhật ký cho tới khi hết cửa sổ hoặc hết ván
+    void sendGameLogChunks(int client_fd)
+    {
+        GameLogMessage chunk;
+        while (game_log_stream.next(chunk))
+        {
+            server.sendPacket(client_fd, chunk.getType(), chunk.serialize());
+        }
+    }
+
+    void handleWatchGame(int client_fd, const std::vector<uint8_t> &payload)
+    {
+        WatchGameMessage message = WatchGameMessage::deserialize(payload);
+
+        LOG_INFO("watch_game", "game_id", message.game_id, "client_fd", client_fd);
+
+        gameManager.handleWatchGame(client_fd, message.game_id);
+    }
+
+    void handleUnwatchGame(int client_fd, const std::vector<uint8_t> &payload)
+    {
+        UnwatchGameMessage message = UnwatchGameMessage::deserialize(payload);
+
+        LOG_INFO("unwatch_game", "game_id", message.game_id, "client_fd", client_fd);
+
+        gameManager.handleUnwatchGame(client_fd);
     }
 };
 
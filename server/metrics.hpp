@@ -0,0 +1,367 @@
+// METRICS_HPP - Bộ đếm, gauge và histogram độ trễ của server (không khóa)
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+// Thư viện chuẩn C++
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Thư viện dự án
+#include "../common/protocol.hpp"
+
+// Số shard của mỗi metric. Mỗi luồng ghi vào shard của mình (theo thứ tự tạo
+// luồng) nên các luồng handleClient không tranh nhau cùng một cache line.
+constexpr size_t METRIC_SHARDS = 8;
+
+inline size_t metricShard() {
+  static std::atomic<size_t> next_shard{0};
+  thread_local size_t shard = next_shard.fetch_add(1) % METRIC_SHARDS;
+  return shard;
+}
+
+/**
+ * @brief Nhóm N bộ đếm tăng dần (ví dụ: một bộ đếm cho mỗi MessageType).
+ * Ghi: một fetch_add relaxed trên shard của luồng hiện tại. Đọc: cộng các
+ * shard (chỉ khi xuất số liệu).
+ */
+template <size_t N> class CounterArray {
+public:
+  void inc(size_t slot, uint64_t n = 1) {
+    shards[metricShard()].values[slot].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  uint64_t value(size_t slot) const {
+    uint64_t total = 0;
+    for (const Shard &shard : shards)
+      total += shard.values[slot].load(std::memory_order_relaxed);
+    return total;
+  }
+
+private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, N> values{};
+  };
+  std::array<Shard, METRIC_SHARDS> shards;
+};
+
+class Counter {
+public:
+  void inc(uint64_t n = 1) { counter.inc(0, n); }
+  uint64_t value() const { return counter.value(0); }
+
+private:
+  CounterArray<1> counter;
+};
+
+// Giá trị tức thời (số kết nối đang mở, độ dài hàng đợi...)
+class Gauge {
+public:
+  void set(int64_t v) { current.store(v, std::memory_order_relaxed); }
+  void add(int64_t n) { current.fetch_add(n, std::memory_order_relaxed); }
+  int64_t value() const { return current.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<int64_t> current{0};
+};
+
+/**
+ * @brief Histogram độ trễ kiểu HDR (log-linear), đơn vị micro giây.
+ *
+ * Mỗi khoảng [2^k, 2^(k+1)) được chia thành 16 bucket đều nhau nên sai số
+ * tương đối của phân vị không quá 1/16 (~6%) trên toàn dải 1 µs .. 2^40 µs.
+ * Bucket index tính bằng vài phép dịch bit, không có vòng lặp hay khóa.
+ */
+class Histogram {
+public:
+  static constexpr int SUB_BITS = 4;
+  static constexpr uint64_t SUB_COUNT = 1ull << SUB_BITS;
+  static constexpr int MAX_BITS = 40;
+  static constexpr size_t BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+  void observe(uint64_t micros) {
+    Shard &shard = shards[metricShard()];
+    shard.buckets[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(micros, std::memory_order_relaxed);
+  }
+
+  // Ảnh chụp đã cộng mọi shard, dùng để tính phân vị
+  struct Snapshot {
+    std::array<uint64_t, BUCKETS> buckets{};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+
+    // Giá trị (µs) tại phân vị q (0..1): cận trên của bucket chứa phân vị
+    uint64_t quantile(double q) const {
+      if (count == 0)
+        return 0;
+      uint64_t rank = static_cast<uint64_t>(q * (count - 1)) + 1;
+      uint64_t seen = 0;
+      for (size_t i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank)
+          return bucketUpper(i);
+      }
+      return bucketUpper(BUCKETS - 1);
+    }
+  };
+
+  Snapshot snapshot() const {
+    Snapshot snap;
+    for (const Shard &shard : shards) {
+      for (size_t i = 0; i < BUCKETS; i++) {
+        uint64_t n = shard.buckets[i].load(std::memory_order_relaxed);
+        snap.buckets[i] += n;
+        snap.count += n;
+      }
+      snap.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+    return snap;
+  }
+
+  static size_t bucketIndex(uint64_t v) {
+    if (v < SUB_COUNT)
+      return static_cast<size_t>(v);
+    int msb = 63 - __builtin_clzll(v);
+    if (msb >= MAX_BITS)
+      return BUCKETS - 1;
+    int shift = msb - SUB_BITS;
+    return static_cast<size_t>((shift + 1) * SUB_COUNT +
+                               ((v >> shift) & (SUB_COUNT - 1)));
+  }
+
+  static uint64_t bucketUpper(size_t index) {
+    if (index < SUB_COUNT)
+      return index;
+    int shift = static_cast<int>(index / SUB_COUNT) - 1;
+    uint64_t sub = index % SUB_COUNT;
+    return ((SUB_COUNT + sub + 1) << shift) - 1;
+  }
+
+private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+    std::atomic<uint64_t> sum{0};
+  };
+  std::array<Shard, METRIC_SHARDS> shards;
+};
+
+// Đo thời gian của một phạm vi (scope) và ghi vào histogram khi ra khỏi scope
+class ScopedTimer {
+public:
+  explicit ScopedTimer(Histogram &histogram)
+      : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+
+  ~ScopedTimer() {
+    histogram.observe(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count()));
+  }
+
+private:
+  Histogram &histogram;
+  std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * @brief Lớp Metrics (Singleton) - Toàn bộ số liệu vận hành của server.
+ *
+ * Các metric là thành viên cố định (không đăng ký động) nên việc ghi chỉ là
+ * một thao tác atomic. render() xuất theo định dạng text của Prometheus; các
+ * histogram được xuất dưới dạng summary (phân vị tính sẵn + _sum + _count).
+ */
+class Metrics {
+public:
+  Counter connections_accepted; // Số kết nối đã accept
+  Gauge connections_open;       // Số kết nối đang mở
+  CounterArray<256> packets_in;  // Gói tin nhận, theo MessageType
+  CounterArray<256> packets_out; // Gói tin gửi (đã xếp hàng), theo MessageType
+  Histogram move_latency_us;     // Thời gian xử lý một nước đi
+  Histogram save_users_us;       // Thời gian ghi users.json
+  Histogram save_matches_us;     // Thời gian ghi matches.json
+  Gauge matchmaking_queue_depth; // Số người đang chờ ghép trận
+  Histogram matchmaking_wait_us; // Thời gian từ lúc xếp hàng đến lúc có trận
+  Gauge games_live;              // Số ván cờ đang diễn ra (kể cả chờ chấp nhận)
+  Gauge engine_searches;          // Số nước của máy đang chờ hoặc đang tìm
+  Histogram engine_queue_wait_us; // Thời gian chờ luồng tìm kiếm của máy
+  Histogram engine_search_us;     // Thời gian máy tìm một nước
+  Counter engine_nodes;           // Tổng số nút máy đã tìm
+  Gauge analysis_queue_depth;     // Số ván chờ phân tích sau ván
+  Counter analysis_games;         // Số ván đã phân tích
+  Histogram analysis_game_us;     // Thời gian phân tích một ván
+  Counter analysis_nodes;         // Tổng số nút bộ phân tích đã tìm
+  Histogram explorer_query_us;    // Thời gian trả lời một EXPLORER_REQUEST
+
+  Metrics(const Metrics &) = delete;
+  Metrics &operator=(const Metrics &) = delete;
+
+  static Metrics &getInstance() {
+    static Metrics instance;
+    return instance;
+  }
+
+  /**
+   * @brief Xuất toàn bộ metric theo định dạng Prometheus text exposition.
+   */
+  std::string render() const {
+    std::string out;
+    out.reserve(8192);
+
+    header(out, "chess_connections_accepted_total", "counter",
+           "TCP connections accepted.");
+    sample(out, "chess_connections_accepted_total", "",
+           connections_accepted.value());
+
+    header(out, "chess_connections_open", "gauge", "Open client connections.");
+    sample(out, "chess_connections_open", "", connections_open.value());
+
+    renderPackets(out, "chess_packets_in_total", "Packets received by type.",
+                  packets_in);
+    renderPackets(out, "chess_packets_out_total",
+                  "Packets queued for sending by type.", packets_out);
+
+    header(out, "chess_move_latency_seconds", "summary",
+           "Time to handle a MOVE request.");
+    renderSummary(out, "chess_move_latency_seconds", "", move_latency_us);
+
+    header(out, "chess_persistence_latency_seconds", "summary",
+           "Time to write a data file.");
+    renderSummary(out, "chess_persistence_latency_seconds", "file=\"users\"",
+                  save_users_us);
+    renderSummary(out, "chess_persistence_latency_seconds", "file=\"matches\"",
+                  save_matches_us);
+
+    header(out, "chess_matchmaking_queue_depth", "gauge",
+           "Players waiting for an automatic match.");
+    sample(out, "chess_matchmaking_queue_depth", "",
+           matchmaking_queue_depth.value());
+
+    header(out, "chess_matchmaking_wait_seconds", "summary",
+           "Time from joining the queue to being matched.");
+    renderSummary(out, "chess_matchmaking_wait_seconds", "",
+                  matchmaking_wait_us);
+
+    header(out, "chess_games_live", "gauge",
+           "Games in progress, including matches awaiting acceptance.");
+    sample(out, "chess_games_live", "", games_live.value());
+
+    header(out, "chess_engine_searches", "gauge",
+           "Engine moves queued or being searched.");
+    sample(out, "chess_engine_searches", "", engine_searches.value());
+
+    header(out, "chess_engine_queue_wait_seconds", "summary",
+           "Time an engine move waits for a search thread.");
+    renderSummary(out, "chess_engine_queue_wait_seconds", "",
+                  engine_queue_wait_us);
+
+    header(out, "chess_engine_search_seconds", "summary",
+           "Time spent searching one engine move.");
+    renderSummary(out, "chess_engine_search_seconds", "", engine_search_us);
+
+    header(out, "chess_engine_nodes_total", "counter",
+           "Positions searched by the engine.");
+    sample(out, "chess_engine_nodes_total", "", engine_nodes.value());
+
+    header(out, "chess_analysis_queue_depth", "gauge",
+           "Finished games waiting for post-game analysis.");
+    sample(out, "chess_analysis_queue_depth", "", analysis_queue_depth.value());
+
+    header(out, "chess_analysis_games_total", "counter",
+           "Finished games analysed.");
+    sample(out, "chess_analysis_games_total", "", analysis_games.value());
+
+    header(out, "chess_analysis_game_seconds", "summary",
+           "Time to analyse one finished game.");
+    renderSummary(out, "chess_analysis_game_seconds", "", analysis_game_us);
+
+    header(out, "chess_analysis_nodes_total", "counter",
+           "Positions searched by post-game analysis.");
+    sample(out, "chess_analysis_nodes_total", "", analysis_nodes.value());
+
+    header(out, "chess_explorer_query_seconds", "summary",
+           "Time to answer one opening explorer query.");
+    renderSummary(out, "chess_explorer_query_seconds", "", explorer_query_us);
+
+    return out;
+  }
+
+private:
+  Metrics() = default;
+
+  static void header(std::string &out, const char *name, const char *type,
+                     const char *help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+  }
+
+  template <typename T>
+  static void sample(std::string &out, const std::string &name,
+                     const std::string &labels, T value) {
+    out += name;
+    if (!labels.empty())
+      out += '{' + labels + '}';
+    out += ' ';
+    out += std::to_string(value);
+    out += '\n';
+  }
+
+  static void sampleSeconds(std::string &out, const std::string &name,
+                            const std::string &labels, uint64_t micros) {
+    char value[32];
+    std::snprintf(value, sizeof(value), "%.6f", micros / 1e6);
+    out += name;
+    if (!labels.empty())
+      out += '{' + labels + '}';
+    out += ' ';
+    out += value;
+    out += '\n';
+  }
+
+  static void renderPackets(std::string &out, const char *name,
+                            const char *help, const CounterArray<256> &packets) {
+    header(out, name, "counter", help);
+    for (size_t type = 0; type < 256; type++) {
+      const char *type_name = messageTypeName(static_cast<MessageType>(type));
+      uint64_t value = packets.value(type);
+      std::string label;
+      if (type_name != nullptr) {
+        label = std::string("type=\"") + type_name + '"';
+      } else {
+        if (value == 0)
+          continue;
+        // Client gửi loại gói tin không có trong enum
+        char hex[8];
+        std::snprintf(hex, sizeof(hex), "0x%02zx", type);
+        label = std::string("type=\"") + hex + '"';
+      }
+      sample(out, name, label, value);
+    }
+  }
+
+  static void renderSummary(std::string &out, const std::string &name,
+                            const std::string &labels,
+                            const Histogram &histogram) {
+    Histogram::Snapshot snap = histogram.snapshot();
+    std::string prefix = labels.empty() ? "" : labels + ",";
+    for (const char *q : {"0.5", "0.9", "0.99", "0.999"}) {
+      sampleSeconds(out, name, prefix + "quantile=\"" + q + "\"",
+                    snap.quantile(std::stod(q)));
+    }
+    sampleSeconds(out, name + "_sum", labels, snap.sum);
+    sample(out, name + "_count", labels, snap.count);
+  }
+};
+
+#endif // METRICS_HPP
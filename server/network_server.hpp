@@ -2,8 +2,11 @@
 #define NETWORK_SERVER_HPP
 
 // Thư viện chuẩn
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <cstring>
-#include <iostream>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <vector>
@@ -11,6 +14,7 @@
 // Thư viện socket (Linux)
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
@@ -18,7 +22,20 @@
 #include "../common/const.hpp"
 #include "../common/message.hpp"
 #include "../common/protocol.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "server_config.hpp"
 #include "structs.hpp"
+#include "timer_wheel.hpp"
+#include "tracer.hpp"
+#include "write_watcher.hpp"
+
+// Kết quả gửi không chặn (trySendEncoded)
+enum class SendResult {
+  QUEUED,   // Đã gửi hoặc đã xếp vào hàng đợi
+  OVERFLOW, // Hàng đợi của client vượt giới hạn, gói tin bị bỏ
+  FAILED    // Client không tồn tại hoặc socket lỗi
+};
 
 /**
  * @brief Lớp NetworkServer (Singleton) - Quản lý kết nối mạng của server.
@@ -28,9 +45,14 @@
 class NetworkServer {
 private:
   int server_fd; // File descriptor của server socket
-  std::unordered_map<int, ClientInfo>
+  int stop_fd;   // eventfd đọc được sau stop() (đánh thức backend io_uring)
+  std::atomic<bool> stopping{false}; // Đã gọi stop(): ngừng nhận kết nối
+  std::unordered_map<int, std::shared_ptr<ClientInfo>>
       clients;              // Map quản lý thông tin clients (Key: fd)
   std::mutex clients_mutex; // Mutex bảo vệ truy cập vào map clients
+  // false: sendEncoded() không bao giờ chặn (backend io_uring)
+  std::atomic<bool> blocking_sends{true};
+  WriteWatcher write_watcher; // Khai báo sau cùng: luồng dừng trước khi clients bị hủy
 
   /**
    * @brief Khởi tạo server socket, bind địa chỉ và bắt đầu lắng nghe.
@@ -40,10 +62,15 @@ private:
     // 1. Tạo socket TCP/IPv4
     server_fd = socket(AF_INET, SOCK_STREAM, 0);
     if (server_fd == -1) {
-      perror("socket failed");
+      LOG_ERROR("socket_failed", "error", std::strerror(errno));
       exit(EXIT_FAILURE);
     }
 
+    // Cho phép bind lại ngay khi khởi động lại: server chủ động đóng kết nối
+    // (heartbeat) nên cổng có thể còn socket ở trạng thái TIME_WAIT
+    int reuse = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
     // 2. Thiết lập địa chỉ server
     sockaddr_in address;
     std::memset(&address, 0, sizeof(address));
@@ -53,24 +80,174 @@ private:
 
     // 3. Bind socket
     if (bind(server_fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
-      perror("bind failed");
+      LOG_ERROR("bind_failed", "port", Const::SERVER_PORT, "error",
+                std::strerror(errno));
       close(server_fd);
       exit(EXIT_FAILURE);
     }
 
     // 4. Lắng nghe kết nối
     if (listen(server_fd, Const::BACKLOG) < 0) {
-      perror("listen failed");
+      LOG_ERROR("listen_failed", "error", std::strerror(errno));
       close(server_fd);
       exit(EXIT_FAILURE);
     }
 
-    std::cout << "Server đang lắng nghe trên: " << inet_ntoa(address.sin_addr)
-              << ":" << ntohs(address.sin_port) << " ..." << std::endl;
+    LOG_INFO("listening", "address", inet_ntoa(address.sin_addr), "port",
+             ntohs(address.sin_port));
+
+    stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stop_fd == -1)
+      LOG_ERROR("eventfd_failed", "error", std::strerror(errno));
   }
 
   // Constructor private (Singleton)
-  NetworkServer() : server_fd(-1) { initialize(Const::SERVER_PORT); }
+  NetworkServer() : server_fd(-1), stop_fd(-1) {
+    initialize(Const::SERVER_PORT);
+  }
+
+  /**
+   * @brief Lấy thông tin của client theo fd, nullptr nếu fd không phải kết
+   * nối đang mở (ClientInfo chỉ được tạo trong connectionOpened()).
+   * Trả về shared_ptr để ClientInfo vẫn hợp lệ khi đang gửi/nhận dù
+   * closeConnection() xóa nó khỏi map.
+   */
+  std::shared_ptr<ClientInfo> getClient(int client_fd) {
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    auto it = clients.find(client_fd);
+    return it != clients.end() ? it->second : nullptr;
+  }
+
+  /**
+   * @brief Ghi hàng đợi gửi của client ra socket.
+   * Luồng nào giữ được send_mutex sẽ ghi luôn các gói tin mà luồng khác đã
+   * xếp vào hàng đợi, nên một broadcast không phải chờ từng lệnh send().
+   * @param blocking false: không chờ send_mutex và không chờ socket (dùng cho
+   * người xem), phần chưa gửi được nằm lại trong hàng đợi và được write_watcher
+   * gửi tiếp khi socket ghi được.
+   * @return false nếu socket lỗi.
+   */
+  bool flushOutbound(int client_fd, const std::shared_ptr<ClientInfo> &client_ptr,
+                     bool blocking = true) {
+    ClientInfo &client = *client_ptr;
+    int flags = MSG_NOSIGNAL | (blocking ? 0 : MSG_DONTWAIT);
+
+    while (true) {
+      std::unique_lock<std::mutex> send_lock(client.send_mutex,
+                                             std::defer_lock);
+      if (blocking)
+        send_lock.lock();
+      else if (!send_lock.try_lock())
+        return true; // Luồng đang giữ send_mutex sẽ gửi hộ
+
+      while (true) {
+        SharedPacket frame;
+        size_t offset;
+        {
+          std::lock_guard<std::mutex> lock(client.outbound_mutex);
+          if (client.outbound.empty())
+            break;
+          frame = client.outbound.front();
+          offset = client.outbound_offset;
+        }
+
+        ssize_t sent = send(client_fd, frame->data() + offset,
+                            frame->size() - offset, flags);
+        if (sent < 0) {
+          if (errno == EINTR)
+            continue;
+          if (!blocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Socket đầy: gửi tiếp khi socket ghi được
+            watchWritable(client_fd, client_ptr);
+            return true;
+          }
+          LOG_WARN("send_failed", "client_fd", client_fd, "error",
+                   std::strerror(errno));
+          // Bỏ các gói tin còn lại, socket đã hỏng
+          std::lock_guard<std::mutex> lock(client.outbound_mutex);
+          client.outbound.clear();
+          client.outbound_offset = 0;
+          client.outbound_bytes = 0;
+          return false;
+        }
+
+        std::lock_guard<std::mutex> lock(client.outbound_mutex);
+        client.outbound_offset += static_cast<size_t>(sent);
+        client.outbound_bytes -= static_cast<size_t>(sent);
+        if (client.outbound_offset == frame->size()) {
+          client.outbound.pop_front();
+          client.outbound_offset = 0;
+        }
+      }
+
+      send_lock.unlock();
+
+      // Gói tin có thể được thêm vào sau khi hàng đợi rỗng nhưng trước khi nhả
+      // send_mutex -> kiểm tra lại để không bỏ sót
+      std::lock_guard<std::mutex> lock(client.outbound_mutex);
+      if (client.outbound.empty())
+        return true;
+    }
+  }
+
+  /**
+   * @brief Hẹn gửi nốt hàng đợi của client khi socket ghi được lại (chạy trên
+   * luồng của write_watcher, không chặn).
+   */
+  void watchWritable(int client_fd, const std::shared_ptr<ClientInfo> &client) {
+    std::weak_ptr<ClientInfo> weak = client;
+    write_watcher.watch(client_fd, [this, client_fd, weak] {
+      std::shared_ptr<ClientInfo> current = weak.lock();
+      if (current && isCurrentClient(client_fd, current))
+        flushOutbound(client_fd, current, false);
+    });
+  }
+
+  // fd vẫn thuộc kết nối này (fd có thể đã bị đóng và cấp lại cho kết nối khác)
+  bool isCurrentClient(int client_fd, const std::shared_ptr<ClientInfo> &client) {
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    auto it = clients.find(client_fd);
+    return it != clients.end() && it->second == client;
+  }
+
+  static int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  void scheduleHeartbeat(int client_fd, std::weak_ptr<ClientInfo> weak) {
+    TimerWheel::getInstance().schedule(
+        std::chrono::milliseconds(
+            ServerConfig::getInstance().heartbeat_interval_ms),
+        [this, client_fd, weak] { heartbeat(client_fd, weak); });
+  }
+
+  /**
+   * @brief Một nhịp heartbeat (chạy trên luồng TimerWheel, không được chặn).
+   * Client im lặng quá heartbeat_timeout_ms bị shutdown(): luồng handleClient
+   * đang chờ recv() (hoặc recv multishot của backend io_uring) sẽ nhận 0 byte
+   * và dọn dẹp như một lần ngắt kết nối bình thường. Ngược lại gửi PING
+   * không chặn và hẹn nhịp tiếp theo.
+   */
+  void heartbeat(int client_fd, const std::weak_ptr<ClientInfo> &weak) {
+    std::shared_ptr<ClientInfo> client = weak.lock();
+    if (!client || !isCurrentClient(client_fd, client))
+      return;
+
+    int64_t idle_ms = nowMs() - client->last_seen_ms.load();
+    if (idle_ms >= ServerConfig::getInstance().heartbeat_timeout_ms) {
+      LOG_INFO("client_idle_timeout", "client_fd", client_fd, "idle_ms",
+               idle_ms);
+      shutdown(client_fd, SHUT_RDWR);
+      return;
+    }
+
+    static const SharedPacket ping_frame =
+        encodePacket(MessageType::PING, PingMessage().serialize());
+    trySendEncoded(client_fd, ping_frame, Const::WATCHER_MAX_BACKLOG);
+    scheduleHeartbeat(client_fd, weak);
+  }
 
 public:
   // Ngăn copy/assignment để đảm bảo tính duy nhất của Singleton
@@ -81,6 +258,8 @@ public:
   ~NetworkServer() {
     if (server_fd != -1)
       close(server_fd);
+    if (stop_fd != -1)
+      close(stop_fd);
   }
 
   /**
@@ -102,35 +281,185 @@ public:
     int client_fd =
         accept(server_fd, (struct sockaddr *)&client_address, &client_len);
     if (client_fd < 0) {
-      perror("accept failed");
+      if (!stopping)
+        LOG_WARN("accept_failed", "error", std::strerror(errno));
       return -1;
     }
 
-    std::cout << "Client kết nối từ: " << inet_ntoa(client_address.sin_addr)
-              << ":" << ntohs(client_address.sin_port) << " (fd = " << client_fd
-              << ")" << std::endl;
+    connectionOpened(client_fd, client_address);
     return client_fd;
   }
 
+  // fd của socket lắng nghe (backend io_uring tự accept trên fd này)
+  int listenFd() const { return server_fd; }
+
+  /**
+   * @brief Ngừng nhận kết nối mới (gọi từ luồng shutdown). accept() đang chặn
+   * của backend mặc định trả về lỗi sau shutdown(), backend io_uring thức dậy
+   * khi stopFd() đọc được.
+   */
+  void stop() {
+    stopping = true;
+    uint64_t one = 1;
+    if (stop_fd != -1 && write(stop_fd, &one, sizeof(one)) < 0)
+      LOG_WARN("stop_wake_failed", "error", std::strerror(errno));
+    shutdown(server_fd, SHUT_RDWR);
+  }
+
+  bool isStopping() const { return stopping; }
+
+  int stopFd() const { return stop_fd; }
+
+  /**
+   * @brief Ghi nhận một kết nối đã được accept (metrics + log).
+   */
+  void connectionOpened(int client_fd, const sockaddr_in &client_address) {
+    {
+      std::lock_guard<std::mutex> lock(clients_mutex);
+      clients[client_fd] = std::make_shared<ClientInfo>();
+    }
+
+    Metrics &metrics = Metrics::getInstance();
+    metrics.connections_accepted.inc();
+    metrics.connections_open.add(1);
+
+    LOG_INFO("client_connected", "address",
+             inet_ntoa(client_address.sin_addr), "port",
+             ntohs(client_address.sin_port), "client_fd", client_fd);
+  }
+
+  // Như trên, địa chỉ lấy từ socket (accept multishot không trả địa chỉ)
+  void connectionOpened(int client_fd) {
+    sockaddr_in client_address;
+    socklen_t client_len = sizeof(client_address);
+    std::memset(&client_address, 0, sizeof(client_address));
+    getpeername(client_fd, (struct sockaddr *)&client_address, &client_len);
+    connectionOpened(client_fd, client_address);
+  }
+
+  /**
+   * @brief Đóng khung một gói tin (header + payload) vào buffer dùng chung.
+   * Kết quả có thể được đưa vào hàng đợi gửi của nhiều client mà không phải
+   * serialize hay copy lại.
+   */
+  static SharedPacket encodePacket(MessageType messageType,
+                                   const std::vector<uint8_t> &payload) {
+    // Giữ nguyên định dạng header của Packet::serialize()
+    uint16_t length = htons(static_cast<uint16_t>(payload.size()));
+
+    auto frame = std::make_shared<std::vector<uint8_t>>();
+    frame->reserve(Const::PACKET_HEADER_SIZE + payload.size());
+    frame->push_back(static_cast<uint8_t>(messageType));
+    frame->push_back(static_cast<uint8_t>((length >> 8) & 0xFF));
+    frame->push_back(static_cast<uint8_t>(length & 0xFF));
+    frame->insert(frame->end(), payload.begin(), payload.end());
+    return frame;
+  }
+
   /**
    * @brief Gửi gói tin đến client qua file descriptor.
    * Serialize packet và gửi qua socket.
    */
   bool sendPacket(int client_fd, MessageType messageType,
                   const std::vector<uint8_t> &payload) {
-    Packet packet;
-    packet.type = messageType;
-    packet.length = htons(static_cast<uint16_t>(payload.size()));
-    packet.payload = payload;
+    return sendEncoded(client_fd, encodePacket(messageType, payload));
+  }
 
-    std::vector<uint8_t> serialized = packet.serialize();
+  /**
+   * @brief Bắt đầu theo dõi heartbeat của client vừa kết nối.
+   */
+  void startHeartbeat(int client_fd) {
+    std::shared_ptr<ClientInfo> client = getClient(client_fd);
+    if (!client)
+      return;
+    client->last_seen_ms = nowMs();
+    scheduleHeartbeat(client_fd, client);
+  }
+
+  /**
+   * @brief Chọn cách sendEncoded() ghi ra socket. Backend io_uring tắt chế độ
+   * chặn: luồng xử lý dùng chung cho mọi kết nối không được đứng chờ một
+   * client chậm, phần chưa gửi được nằm trong hàng đợi cho write_watcher.
+   */
+  void setBlockingSends(bool blocking) { blocking_sends = blocking; }
 
-    ssize_t sent = send(client_fd, serialized.data(), serialized.size(), 0);
-    if (sent != static_cast<ssize_t>(serialized.size())) {
-      perror("send failed");
+  /**
+   * @brief Gửi một gói tin đã đóng khung đến client.
+   * Gói tin được xếp vào hàng đợi gửi của client rồi ghi ra socket. Ở chế độ
+   * không chặn, client tồn đọng quá Const::CLIENT_MAX_BACKLOG bị ngắt kết nối
+   * (không bỏ gói tin giữa chừng vì người chơi cần đủ mọi thông báo).
+   */
+  bool sendEncoded(int client_fd, const SharedPacket &frame) {
+    std::shared_ptr<ClientInfo> client = getClient(client_fd);
+    if (!client)
       return false;
+    bool blocking = blocking_sends;
+    {
+      std::lock_guard<std::mutex> lock(client->outbound_mutex);
+      if (!blocking &&
+          client->outbound_bytes + frame->size() > Const::CLIENT_MAX_BACKLOG) {
+        LOG_WARN("client_backlog_overflow", "client_fd", client_fd,
+                 "backlog_bytes", client->outbound_bytes);
+        shutdown(client_fd, SHUT_RDWR);
+        return false;
+      }
+      client->outbound.push_back(frame);
+      client->outbound_bytes += frame->size();
+    }
+    Metrics::getInstance().packets_out.inc(frame->front());
+    return flushOutbound(client_fd, client, blocking);
+  }
+
+  /**
+   * @brief Gửi gói tin đã đóng khung mà không bao giờ chặn luồng gọi.
+   * Dùng cho người xem: client chậm không được làm chậm người chơi.
+   * @param max_backlog Số byte tối đa được phép tồn đọng trong hàng đợi.
+   * @return SendResult::OVERFLOW nếu gói tin không được xếp vào hàng đợi vì
+   * client đã tồn đọng quá nhiều.
+   */
+  SendResult trySendEncoded(int client_fd, const SharedPacket &frame,
+                            size_t max_backlog) {
+    std::shared_ptr<ClientInfo> client;
+    {
+      std::lock_guard<std::mutex> lock(clients_mutex);
+      auto it = clients.find(client_fd);
+      if (it == clients.end())
+        return SendResult::FAILED;
+      client = it->second;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(client->outbound_mutex);
+      if (client->outbound_bytes + frame->size() > max_backlog)
+        return SendResult::OVERFLOW;
+      client->outbound.push_back(frame);
+      client->outbound_bytes += frame->size();
+    }
+    Metrics::getInstance().packets_out.inc(frame->front());
+    return flushOutbound(client_fd, client, false) ? SendResult::QUEUED
+                                                    : SendResult::FAILED;
+  }
+
+  /**
+   * @brief Bỏ các gói tin tồn đọng trong hàng đợi của client.
+   * Gói tin đầu hàng đợi được giữ lại vì có thể đang được gửi dở, bỏ nó sẽ làm
+   * hỏng luồng byte.
+   */
+  void discardBacklog(int client_fd) {
+    std::shared_ptr<ClientInfo> client;
+    {
+      std::lock_guard<std::mutex> lock(clients_mutex);
+      auto it = clients.find(client_fd);
+      if (it == clients.end())
+        return;
+      client = it->second;
+    }
+
+    std::lock_guard<std::mutex> lock(client->outbound_mutex);
+    while (client->outbound.size() > 1) {
+      client->outbound_bytes -= client->outbound.back()->size();
+      client->outbound.pop_back();
     }
-    return true;
   }
 
   /**
@@ -139,86 +468,190 @@ public:
   bool sendPacketToUsername(const std::string &username,
                             MessageType messageType,
                             const std::vector<uint8_t> &payload) {
-    std::lock_guard<std::mutex> lock(clients_mutex);
-    for (const auto &pair : clients) {
-      if (pair.second.username == username) {
-        return sendPacket(pair.first, messageType, payload);
-      }
+    int client_fd = getClientFD(username);
+    if (client_fd == -1) {
+      LOG_WARN("send_unknown_user", "username", username);
+      return false;
     }
-    std::cerr << "Username " << username << " không tìm thấy." << std::endl;
-    return false;
+    return sendPacket(client_fd, messageType, payload);
   }
 
   /**
-   * @brief Nhận gói tin từ client.
-   * Xử lý TCP stream: đọc dữ liệu vào buffer, ghép packet (Header + Payload) và
-   * trả về khi đủ.
-   * @return true nếu nhận đủ 1 packet, false nếu chưa đủ hoặc lỗi.
+   * @brief Gửi một gói tin đã đóng khung đến nhiều client.
+   * @return Số client nhận thành công.
    */
-  bool receivePacket(int client_fd, Packet &packet) {
-    // 1. Nhận dữ liệu từ socket
-    uint8_t buffer_temp[Const::BUFFER_SIZE];
-    ssize_t bytes_received =
-        recv(client_fd, buffer_temp, sizeof(buffer_temp), 0);
-    if (bytes_received <= 0)
-      return false;
-
-    // 2. Thêm vào buffer của client
-    {
-      std::lock_guard<std::mutex> lock(clients_mutex);
-      clients[client_fd].buffer.insert(clients[client_fd].buffer.end(),
-                                       buffer_temp,
-                                       buffer_temp + bytes_received);
+  size_t broadcastEncoded(const std::vector<int> &recipients,
+                          const SharedPacket &frame) {
+    size_t delivered = 0;
+    for (int client_fd : recipients) {
+      if (client_fd != -1 && sendEncoded(client_fd, frame))
+        delivered++;
     }
+    return delivered;
+  }
 
-    // 3. Xử lý buffer để tách packet
-    {
-      std::lock_guard<std::mutex> lock(clients[client_fd].mutex);
-      auto &buffer = clients[client_fd].buffer;
+  /**
+   * @brief Gửi cùng một message đến nhiều client (theo fd).
+   * Message chỉ được serialize và đóng khung một lần, mọi người nhận dùng
+   * chung một buffer.
+   * @return Số client nhận thành công.
+   */
+  template <typename Message>
+  size_t broadcast(const std::vector<int> &recipients, const Message &message) {
+    return broadcastEncoded(
+        recipients, encodePacket(message.getType(), message.serialize()));
+  }
 
-      while (buffer.size() >= 3) { // Header = 1 byte Type + 2 bytes Length
-        MessageType type = static_cast<MessageType>(buffer[0]);
-        uint16_t length = (static_cast<uint16_t>(buffer[1]) << 8) |
-                          static_cast<uint16_t>(buffer[2]);
-        length = ntohs(length);
+  /**
+   * @brief Gửi cùng một message đến nhiều người chơi (theo username).
+   * @return Số client nhận thành công.
+   */
+  template <typename Message>
+  size_t broadcast(const std::vector<std::string> &recipients,
+                   const Message &message) {
+    std::vector<int> client_fds = getClientFDs(recipients);
+    if (client_fds.size() != recipients.size()) {
+      LOG_WARN("broadcast_unknown_users", "missing",
+               recipients.size() - client_fds.size());
+    }
+    return broadcast(client_fds, message);
+  }
 
-        if (buffer.size() < 3 + length)
-          break; // Chưa đủ dữ liệu
+  /**
+   * @brief Tách một packet hoàn chỉnh từ đầu buffer nhận (nếu có).
+   * @return true nếu tách được, packet đã bị xóa khỏi buffer.
+   */
+  static bool extractPacket(std::vector<uint8_t> &buffer, Packet &packet) {
+    if (buffer.size() < Const::PACKET_HEADER_SIZE)
+      return false; // Header = 1 byte Type + 2 bytes Length
+
+    MessageType type = static_cast<MessageType>(buffer[0]);
+    uint16_t length = (static_cast<uint16_t>(buffer[1]) << 8) |
+                      static_cast<uint16_t>(buffer[2]);
+    length = ntohs(length);
+
+    if (buffer.size() < Const::PACKET_HEADER_SIZE + static_cast<size_t>(length))
+      return false; // Chưa đủ dữ liệu
+
+    // Trích xuất payload
+    std::vector<uint8_t> payload(buffer.begin() + Const::PACKET_HEADER_SIZE,
+                                 buffer.begin() + Const::PACKET_HEADER_SIZE +
+                                     length);
+    packet = Packet{type, length, payload};
+
+    // Xóa packet đã xử lý khỏi buffer
+    buffer.erase(buffer.begin(),
+                 buffer.begin() + Const::PACKET_HEADER_SIZE + length);
+    return true;
+  }
 
-        // Trích xuất payload
-        std::vector<uint8_t> payload(buffer.begin() + 3,
-                                     buffer.begin() + 3 + length);
-        packet = Packet{type, length, payload};
+  /**
+   * @brief Nhận gói tin từ client (Blocking).
+   * Xử lý TCP stream: packet còn sẵn trong buffer (nhiều packet đến trong
+   * cùng một lần recv) được trả về ngay; packet bị cắt ngang giữa hai lần recv
+   * được ghép lại trước khi trả về.
+   * @return true nếu nhận đủ 1 packet, false nếu kết nối đóng hoặc lỗi.
+   */
+  bool receivePacket(int client_fd, Packet &packet) {
+    std::shared_ptr<ClientInfo> client = getClient(client_fd);
+    if (!client)
+      return false;
+    uint8_t buffer_temp[Const::BUFFER_SIZE];
 
-        // Xóa packet đã xử lý khỏi buffer
-        buffer.erase(buffer.begin(), buffer.begin() + 3 + length);
-        return true;
+    while (true) {
+      Tracer::getInstance().markFrameStart();
+
+      // 1. Tách packet đã có trong buffer của client
+      {
+        std::lock_guard<std::mutex> lock(client->mutex);
+        if (extractPacket(client->buffer, packet)) {
+          Metrics::getInstance().packets_in.inc(
+              static_cast<uint8_t>(packet.type));
+          return true;
+        }
       }
+
+      // 2. Chưa đủ dữ liệu → nhận thêm từ socket
+      ssize_t bytes_received =
+          recv(client_fd, buffer_temp, sizeof(buffer_temp), 0);
+      if (bytes_received < 0 && errno == EINTR)
+        continue;
+      if (bytes_received <= 0)
+        return false;
+
+      client->last_seen_ms = nowMs(); // Mọi dữ liệu nhận được đều tính là còn sống
+
+      std::lock_guard<std::mutex> lock(client->mutex);
+      client->buffer.insert(client->buffer.end(), buffer_temp,
+                            buffer_temp + bytes_received);
+    }
+  }
+
+  /**
+   * @brief Nhận bytes đã được đọc sẵn từ socket (backend io_uring) và tách
+   * mọi packet hoàn chỉnh vào packets. Phần dư được giữ lại trong buffer của
+   * client cho lần nhận sau, giống receivePacket().
+   */
+  void receiveBytes(int client_fd, const uint8_t *data, size_t size,
+                    std::vector<Packet> &packets) {
+    std::shared_ptr<ClientInfo> client = getClient(client_fd);
+    if (!client)
+      return;
+    client->last_seen_ms = nowMs();
+
+    std::lock_guard<std::mutex> lock(client->mutex);
+    client->buffer.insert(client->buffer.end(), data, data + size);
+    Packet packet;
+    while (extractPacket(client->buffer, packet)) {
+      Metrics::getInstance().packets_in.inc(static_cast<uint8_t>(packet.type));
+      packets.push_back(std::move(packet));
     }
-    return false;
   }
 
   // ===== CÁC PHƯƠNG THỨC QUẢN LÝ CLIENT & UTILS =====
 
   void setUsername(int client_fd, const std::string &username) {
     std::lock_guard<std::mutex> lock(clients_mutex);
-    clients[client_fd].username = username;
+    auto it = clients.find(client_fd);
+    if (it != clients.end())
+      it->second->username = username;
   }
 
   std::string getUsername(int client_fd) {
     std::lock_guard<std::mutex> lock(clients_mutex);
-    return clients[client_fd].username;
+    auto it = clients.find(client_fd);
+    return (it != clients.end()) ? it->second->username : "";
   }
 
   int getClientFD(const std::string &username) {
     std::lock_guard<std::mutex> lock(clients_mutex);
     for (const auto &pair : clients) {
-      if (pair.second.username == username)
+      if (pair.second->username == username)
         return pair.first;
     }
     return -1;
   }
 
+  /**
+   * @brief Tra cứu fd của nhiều username trong một lần khóa clients_mutex.
+   * Username không online bị bỏ qua.
+   */
+  std::vector<int> getClientFDs(const std::vector<std::string> &usernames) {
+    std::vector<int> client_fds;
+    client_fds.reserve(usernames.size());
+
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    for (const auto &username : usernames) {
+      for (const auto &pair : clients) {
+        if (pair.second->username == username) {
+          client_fds.push_back(pair.first);
+          break;
+        }
+      }
+    }
+    return client_fds;
+  }
+
   std::string getClientIP(int client_fd) {
     sockaddr_in addr;
     socklen_t addr_len = sizeof(addr);
@@ -236,7 +669,7 @@ public:
   bool isUserLoggedIn(const std::string &username) {
     std::lock_guard<std::mutex> lock(clients_mutex);
     for (const auto &pair : clients) {
-      if (pair.second.username == username)
+      if (pair.second->username == username)
         return true;
     }
     return false;
@@ -248,18 +681,34 @@ public:
   }
 
   void closeConnection(int client_fd) {
-    close(client_fd);
+    // Xóa khỏi map TRƯỚC khi close(): fd có thể được cấp lại ngay cho kết nối
+    // mới, heartbeat cũ không được nhận nhầm kết nối đó
     std::lock_guard<std::mutex> lock(clients_mutex);
     clients.erase(client_fd);
+    close(client_fd);
+    Metrics::getInstance().connections_open.add(-1);
+  }
+
+  /**
+   * @brief shutdown() mọi kết nối: recv() đang chặn của các luồng client trả
+   * về 0 và các luồng tự dọn dẹp như khi client ngắt kết nối.
+   */
+  void shutdownAllConnections() {
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    for (auto &pair : clients)
+      shutdown(pair.first, SHUT_RDWR);
   }
 
   void closeAllConnections() {
     std::lock_guard<std::mutex> lock(clients_mutex);
-    close(server_fd);
+    if (server_fd != -1)
+      close(server_fd);
+    server_fd = -1;
     for (auto &pair : clients) {
       close(pair.first);
     }
     clients.clear();
+    Metrics::getInstance().connections_open.set(0);
   }
 
   void dispose() {
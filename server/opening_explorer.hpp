@@ -0,0 +1,415 @@
+// OPENING_EXPLORER_HPP - Thống kê nước đi theo thế cờ trên mọi ván đã lưu
+
+#ifndef OPENING_EXPLORER_HPP
+#define OPENING_EXPLORER_HPP
+
+// Thư viện chuẩn C++
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Thư viện hệ thống
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Thư viện dự án
+#include "../chess_engine/chess.hpp"
+#include "../common/const.hpp"
+#include "logger.hpp"
+#include "structs.hpp"
+#include "tracer.hpp"
+
+/**
+ * @brief Lớp OpeningExplorer (Singleton) - Chỉ mục khai cuộc.
+ *
+ * Với mỗi thế cờ (Board::hash()) trong Const::EXPLORER_MAX_PLIES nước đầu
+ * của mọi ván đã kết thúc, đếm số ván đi tiếp mỗi nước và kết quả (trắng
+ * thắng / hòa / đen thắng). Thế cờ trùng nhau do hoán vị nước đi được gộp.
+ *
+ * Chỉ mục là một bảng băm địa chỉ mở (dò tuyến tính) trong file được
+ * mmap, khóa là cặp (hash thế cờ, nước đi). Tra một thế cờ = sinh nước đi
+ * hợp lệ rồi dò từng cặp, nên không cần danh sách nước đi riêng cho mỗi thế
+ * cờ. Bảng được cập nhật khi ván kết thúc (addGame) và dựng lại song song từ
+ * lịch sử (rebuild) khi file thiếu hoặc lệch với matches.json. Khi tải quá
+ * 70%, bảng được chép sang file mới gấp đôi rồi đổi tên đè lên file cũ.
+ *
+ * @note Tra cứu giữ khóa chia sẻ, cập nhật giữ khóa độc quyền.
+ */
+class OpeningExplorer {
+public:
+  // Thống kê một nước đi từ thế cờ được hỏi
+  struct MoveStats {
+    chess::Move move;
+    uint32_t white = 0; // Số ván trắng thắng
+    uint32_t draws = 0;
+    uint32_t black = 0; // Số ván đen thắng
+
+    uint32_t total() const { return white + draws + black; }
+  };
+
+  OpeningExplorer(const OpeningExplorer &) = delete;
+  OpeningExplorer &operator=(const OpeningExplorer &) = delete;
+
+  static OpeningExplorer &getInstance() {
+    static OpeningExplorer instance;
+    return instance;
+  }
+
+  ~OpeningExplorer() { unmap(); }
+
+  /**
+   * @brief Mở (hoặc tạo mới) file chỉ mục.
+   * @return Số ván đã có trong chỉ mục; -1 nếu không mở được file.
+   */
+  int64_t open(const std::string &path) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    unmap();
+    this->path = path;
+    if (mapFile(path, 0) || createFile(path, Const::EXPLORER_MIN_CAPACITY))
+      return static_cast<int64_t>(header->games);
+    LOG_ERROR("explorer_open_failed", "path", path);
+    return -1;
+  }
+
+  // Danh sách game_id của mọi ván có kết quả
+  using ListGames = std::function<std::vector<std::string>()>;
+  // Đọc một ván theo game_id; false nếu không có hoặc chưa có kết quả
+  using FetchGame = std::function<bool(const std::string &, MatchModel &)>;
+
+  /**
+   * @brief Mở chỉ mục và dựng lại nếu số ván trong file khác finished, số
+   * ván có kết quả trong lịch sử (file mới, server dừng giữa chừng,
+   * matches.json bị sửa tay...). Chỉ khi phải dựng lại mới lấy danh sách ván
+   * và đọc từng ván.
+   */
+  void load(const std::string &path, uint64_t finished, const ListGames &list,
+            const FetchGame &fetch) {
+    int64_t indexed = open(path);
+    if (indexed < 0)
+      return;
+    if (static_cast<uint64_t>(indexed) == finished) {
+      LOG_INFO("explorer_loaded", "games", indexed);
+      return;
+    }
+    rebuild(list(), fetch);
+  }
+
+  /**
+   * @brief Dựng lại toàn bộ chỉ mục từ lịch sử. Các game_id được chia cho
+   * nhiều luồng, mỗi luồng tự đọc (giải mã) ván và đếm vào bảng riêng rồi
+   * gộp lại; bảng mới được ghi ra file tạm và đổi tên đè lên file cũ.
+   */
+  void rebuild(const std::vector<std::string> &game_ids,
+               const FetchGame &fetch) {
+    TraceSpan span("explorer.rebuild");
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<unsigned>(
+        threads, static_cast<unsigned>(std::max<size_t>(1, game_ids.size())));
+
+    std::vector<EdgeMap> partial(threads);
+    std::vector<uint64_t> games(threads, 0);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++)
+      workers.emplace_back([&, t] {
+        MatchModel match;
+        for (size_t i = t; i < game_ids.size(); i += threads) {
+          if (!fetch(game_ids[i], match) || match.result.empty())
+            continue;
+          replay(match, [&](uint64_t hash, uint16_t move, int outcome) {
+            count(partial[t][{hash, move}], outcome);
+          });
+          games[t]++;
+        }
+      });
+    for (std::thread &worker : workers)
+      worker.join();
+
+    EdgeMap &merged = partial[0];
+    for (unsigned t = 1; t < threads; t++)
+      for (const auto &[key, counts] : partial[t]) {
+        Counts &target = merged[key];
+        for (int i = 0; i < 3; i++)
+          target[i] += counts[i];
+      }
+    uint64_t total_games = 0;
+    for (uint64_t n : games)
+      total_games += n;
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (path.empty())
+      return;
+    uint64_t capacity = Const::EXPLORER_MIN_CAPACITY;
+    while (merged.size() * 10 >= capacity * 7)
+      capacity *= 2;
+    if (!rewrite(capacity, &merged, total_games))
+      return;
+    LOG_INFO("explorer_rebuilt", "games", total_games, "entries",
+             header->entries, "capacity", header->capacity, "threads", threads);
+  }
+
+  /**
+   * @brief Thêm một ván vừa kết thúc vào chỉ mục (bỏ qua ván chưa có kết
+   * quả).
+   */
+  void addGame(const MatchModel &match) {
+    if (match.result.empty())
+      return;
+    std::vector<std::pair<uint64_t, uint16_t>> edges;
+    int outcome = 0;
+    replay(match, [&](uint64_t hash, uint16_t move, int result) {
+      edges.emplace_back(hash, move);
+      outcome = result;
+    });
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (header == nullptr)
+      return;
+    for (const auto &[hash, move] : edges) {
+      if ((header->entries + 1) * 10 >= header->capacity * 7 &&
+          !rewrite(header->capacity * 2, nullptr, header->games))
+        return;
+      Entry &entry = slot(hash, move);
+      if (entry.move == 0) {
+        entry.hash = hash;
+        entry.move = move;
+        header->entries++;
+      }
+      (outcome == 0 ? entry.white : outcome == 1 ? entry.draws : entry.black)++;
+    }
+    header->games++;
+  }
+
+  /**
+   * @brief Các nước đã được chơi từ thế cờ board, nhiều ván nhất trước.
+   */
+  std::vector<MoveStats> query(const chess::Board &board) {
+    chess::Movelist moves;
+    chess::movegen::legalmoves(moves, board);
+    uint64_t hash = board.hash();
+
+    std::vector<MoveStats> result;
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex);
+      if (header == nullptr)
+        return result;
+      for (const chess::Move &move : moves) {
+        const Entry &entry = slot(hash, move.move());
+        if (entry.move != 0)
+          result.push_back({move, entry.white, entry.draws, entry.black});
+      }
+    }
+    std::sort(result.begin(), result.end(),
+              [](const MoveStats &a, const MoveStats &b) {
+                return a.total() > b.total();
+              });
+    return result;
+  }
+
+  // Số ván đã có trong chỉ mục
+  uint64_t gamesIndexed() {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return header ? header->games : 0;
+  }
+
+private:
+  static constexpr char MAGIC[8] = {'C', 'H', 'E', 'X', 'P', 'L', '0', '1'};
+
+  // Đầu file chỉ mục
+  struct Header {
+    char magic[8];
+    uint64_t capacity; // Số ô, lũy thừa của 2
+    uint64_t entries;  // Số ô đã dùng
+    uint64_t games;    // Số ván có kết quả đã xét (khớp với lịch sử)
+  };
+
+  // Một ô: nước đi move từ thế cờ hash; move = 0 là ô trống
+  struct Entry {
+    uint64_t hash;
+    uint16_t move;
+    uint16_t reserved;
+    uint32_t white;
+    uint32_t draws;
+    uint32_t black;
+  };
+  static_assert(sizeof(Entry) == 24, "Entry phải gọn 24 byte");
+
+  using Counts = std::array<uint32_t, 3>; // Trắng thắng, hòa, đen thắng
+  struct EdgeHash {
+    size_t operator()(const std::pair<uint64_t, uint16_t> &key) const {
+      return mix(key.first, key.second);
+    }
+  };
+  using EdgeMap =
+      std::unordered_map<std::pair<uint64_t, uint16_t>, Counts, EdgeHash>;
+
+  std::shared_mutex mutex; // Bảo vệ mapping và nội dung bảng
+  std::string path;
+  void *mapping = nullptr;
+  size_t mapping_size = 0;
+  Header *header = nullptr;
+  Entry *entries = nullptr;
+
+  OpeningExplorer() = default;
+
+  static uint64_t mix(uint64_t hash, uint16_t move) {
+    return hash ^ (uint64_t(move) * 0x9E3779B97F4A7C15ull);
+  }
+
+  static void count(Counts &counts, int outcome) { counts[outcome]++; }
+
+  // 0 trắng thắng, 1 hòa, 2 đen thắng; -1 nếu ván chưa có kết quả
+  static int outcomeOf(const MatchModel &match) {
+    if (match.result.empty())
+      return -1;
+    if (match.result == "<0>")
+      return 1;
+    if (match.result == match.white_username)
+      return 0;
+    if (match.result == match.black_username)
+      return 2;
+    return -1;
+  }
+
+  /**
+   * @brief Đi lại các nước đầu của ván, gọi visit(hash, move, outcome) cho
+   * mỗi nước (outcome: 0 trắng thắng, 1 hòa, 2 đen thắng).
+   * @return false nếu ván chưa có kết quả hoặc nước đi không hợp lệ.
+   */
+  template <typename Visit>
+  static bool replay(const MatchModel &match, Visit &&visit) {
+    int outcome = outcomeOf(match);
+    if (outcome < 0)
+      return false;
+
+    chess::Board board(match.start_fen);
+    size_t plies =
+        std::min<size_t>(match.moves.size(), Const::EXPLORER_MAX_PLIES);
+    for (size_t i = 0; i < plies; i++) {
+      chess::Move move = chess::uci::uciToMove(board, match.moves[i].uci_move);
+      if (move == chess::Move::NO_MOVE)
+        break;
+      visit(board.hash(), move.move(), outcome);
+      board.makeMove(move);
+    }
+    return true;
+  }
+
+  // Ô của (hash, move): ô đang chứa cặp đó hoặc ô trống đầu tiên
+  Entry &slot(uint64_t hash, uint16_t move) const {
+    uint64_t mask = header->capacity - 1;
+    for (uint64_t i = mix(hash, move) & mask;; i = (i + 1) & mask) {
+      Entry &entry = entries[i];
+      if (entry.move == 0 || (entry.hash == hash && entry.move == move))
+        return entry;
+    }
+  }
+
+  // Map file có sẵn; capacity = 0: chấp nhận mọi kích thước hợp lệ
+  bool mapFile(const std::string &file, uint64_t capacity) {
+    int fd = ::open(file.c_str(), O_RDWR);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(Header);
+    void *data = ok ? mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fd, 0)
+                    : MAP_FAILED;
+    ::close(fd);
+    if (data == MAP_FAILED)
+      return false;
+
+    Header *mapped = static_cast<Header *>(data);
+    uint64_t cap = mapped->capacity;
+    bool valid = std::memcmp(mapped->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 cap > 0 && (cap & (cap - 1)) == 0 &&
+                 (capacity == 0 || cap == capacity) &&
+                 size_t(st.st_size) == sizeof(Header) + cap * sizeof(Entry);
+    if (!valid) {
+      munmap(data, st.st_size);
+      return false;
+    }
+    mapping = data;
+    mapping_size = st.st_size;
+    header = mapped;
+    entries = reinterpret_cast<Entry *>(mapped + 1);
+    return true;
+  }
+
+  // Tạo file rỗng với capacity ô rồi map
+  bool createFile(const std::string &file, uint64_t capacity) {
+    int fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+      return false;
+    Header empty{};
+    std::memcpy(empty.magic, MAGIC, sizeof(MAGIC));
+    empty.capacity = capacity;
+    // ftruncate điền 0 cho phần còn lại, tức mọi ô đều trống
+    bool ok = ftruncate(fd, sizeof(Header) + capacity * sizeof(Entry)) == 0 &&
+              pwrite(fd, &empty, sizeof(empty), 0) == sizeof(empty);
+    ::close(fd);
+    return ok && mapFile(file, capacity);
+  }
+
+  /**
+   * @brief Ghi bảng mới với capacity ô: từ edges nếu có, nếu không thì chép
+   * các ô của bảng hiện tại. Ghi ra file tạm rồi đổi tên, nên file chỉ mục
+   * luôn là một bảng hoàn chỉnh. Gọi khi đang giữ khóa độc quyền.
+   */
+  bool rewrite(uint64_t capacity, const EdgeMap *edges, uint64_t games) {
+    std::string tmp = path + ".tmp";
+    std::vector<Entry> old;
+    if (edges == nullptr && header != nullptr)
+      for (uint64_t i = 0; i < header->capacity; i++)
+        if (entries[i].move != 0)
+          old.push_back(entries[i]);
+
+    unmap();
+    if (!createFile(tmp, capacity)) {
+      LOG_ERROR("explorer_write_failed", "path", tmp);
+      mapFile(path, 0);
+      return false;
+    }
+    auto insert = [this](uint64_t hash, uint16_t move, const Counts &counts) {
+      Entry &entry = slot(hash, move);
+      entry = Entry{hash, move, 0, counts[0], counts[1], counts[2]};
+      header->entries++;
+    };
+    if (edges != nullptr)
+      for (const auto &[key, counts] : *edges)
+        insert(key.first, key.second, counts);
+    for (const Entry &entry : old)
+      insert(entry.hash, entry.move, {entry.white, entry.draws, entry.black});
+    header->games = games;
+
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+      LOG_ERROR("explorer_write_failed", "path", path);
+      unmap();
+      mapFile(path, 0);
+      return false;
+    }
+    return true;
+  }
+
+  void unmap() {
+    if (mapping != nullptr)
+      munmap(mapping, mapping_size);
+    mapping = nullptr;
+    mapping_size = 0;
+    header = nullptr;
+    entries = nullptr;
+  }
+};
+
+#endif // OPENING_EXPLORER_HPP
@@ -0,0 +1,60 @@
+// RATING_HPP - Tính điểm Elo sau một ván cờ
+
+#ifndef RATING_HPP
+#define RATING_HPP
+
+// Thư viện chuẩn C++
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief Elo chuẩn: R' = R + K * (S - E), với E = 1 / (1 + 10^((Ro - R)/400)).
+ *
+ * Hệ số K theo kiểu FIDE: người chơi mới (chưa đủ PROVISIONAL_GAMES ván) thay
+ * đổi nhanh để sớm về đúng trình độ, người chơi từ MASTER_RATING trở lên thay
+ * đổi chậm.
+ */
+namespace Rating {
+constexpr uint32_t PROVISIONAL_GAMES = 30; // Số ván trước khi K giảm
+constexpr uint16_t MASTER_RATING = 2400;   // Từ mức này K nhỏ nhất
+constexpr int K_PROVISIONAL = 40;
+constexpr int K_STANDARD = 20;
+constexpr int K_MASTER = 10;
+
+// Điểm kỳ vọng của người chơi có rating trước đối thủ opponent
+inline double expectedScore(double rating, double opponent) {
+  return 1.0 / (1.0 + std::pow(10.0, (opponent - rating) / 400.0));
+}
+
+inline int kFactor(uint16_t rating, uint32_t games_played) {
+  if (games_played < PROVISIONAL_GAMES)
+    return K_PROVISIONAL;
+  return rating >= MASTER_RATING ? K_MASTER : K_STANDARD;
+}
+
+/**
+ * @brief Rating mới sau một ván.
+ * @param score Kết quả của người chơi: 1 thắng, 0.5 hòa, 0 thua.
+ */
+inline uint16_t updated(uint16_t rating, uint32_t games_played,
+                        uint16_t opponent, double score) {
+  double delta = kFactor(rating, games_played) *
+                 (score - expectedScore(rating, opponent));
+  long next = std::lround(rating + delta);
+  if (next < 0)
+    return 0;
+  if (next > UINT16_MAX)
+    return UINT16_MAX;
+  return static_cast<uint16_t>(next);
+}
+} // namespace Rating
+
+// Rating của hai người chơi trước và sau một ván
+struct RatingChange {
+  uint16_t white_before = 0;
+  uint16_t white_after = 0;
+  uint16_t black_before = 0;
+  uint16_t black_after = 0;
+};
+
+#endif // RATING_HPP
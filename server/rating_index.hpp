@@ -0,0 +1,131 @@
+// RATING_INDEX_HPP - Chỉ mục người chơi sắp xếp theo Elo (bảng xếp hạng, rank)
+
+#ifndef RATING_INDEX_HPP
+#define RATING_INDEX_HPP
+
+// Thư viện chuẩn C++
+#include <cstdint>
+#include <iterator>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Chỉ mục Elo được cập nhật dần (không sắp xếp lại toàn bộ users).
+ *
+ * Gồm hai cấu trúc luôn đồng bộ:
+ *   - Cây Fenwick đếm số người chơi theo từng giá trị Elo (0..65535), cho
+ *     rank = 1 + số người có Elo cao hơn trong O(log ELO_RANGE).
+ *   - std::set sắp xếp theo (Elo giảm dần, username tăng dần) để duyệt top-N
+ *     và cửa sổ quanh một người chơi trong O(log n + k).
+ *
+ * Người chơi cùng Elo có cùng rank (như getUserRank trước đây). Lớp không tự
+ * khóa: DataStorage gọi khi đang giữ users_mutex.
+ */
+class RatingIndex {
+public:
+  struct Entry {
+    uint32_t rank;
+    std::string username;
+    uint16_t elo;
+  };
+
+  void insert(const std::string &username, uint16_t elo) {
+    if (!sorted.insert(Key{elo, username}).second)
+      return;
+    add(elo, 1);
+  }
+
+  void update(const std::string &username, uint16_t old_elo,
+              uint16_t new_elo) {
+    if (old_elo == new_elo)
+      return;
+    if (sorted.erase(Key{old_elo, username}) > 0)
+      add(old_elo, -1);
+    insert(username, new_elo);
+  }
+
+  uint32_t size() const { return static_cast<uint32_t>(sorted.size()); }
+
+  // Thứ hạng của một người chơi có Elo elo (1 là cao nhất)
+  uint32_t rankOf(uint16_t elo) const {
+    return size() - countAtMost(elo) + 1;
+  }
+
+  // limit người chơi đứng đầu
+  std::vector<Entry> top(size_t limit) const {
+    return collect(sorted.begin(), limit);
+  }
+
+  /**
+   * @brief Cửa sổ limit người chơi quanh username (người đó ở giữa nếu có
+   * thể). Rỗng nếu không có trong chỉ mục.
+   */
+  std::vector<Entry> around(const std::string &username, uint16_t elo,
+                            size_t limit) const {
+    auto it = sorted.find(Key{elo, username});
+    if (it == sorted.end() || limit == 0)
+      return {};
+
+    // Lùi tối đa limit/2 bước, rồi lùi thêm nếu phía sau không đủ người
+    for (size_t back = 0; back < limit / 2 && it != sorted.begin(); back++)
+      --it;
+    size_t count = 0;
+    for (auto forward = it; forward != sorted.end() && count < limit;
+         ++forward)
+      count++;
+    for (; count < limit && it != sorted.begin(); count++)
+      --it;
+    return collect(it, limit);
+  }
+
+private:
+  static constexpr size_t ELO_RANGE = UINT16_MAX + 1;
+
+  // Sắp xếp: Elo giảm dần, cùng Elo thì theo username
+  struct Key {
+    uint16_t elo;
+    std::string username;
+
+    bool operator<(const Key &other) const {
+      if (elo != other.elo)
+        return elo > other.elo;
+      return username < other.username;
+    }
+  };
+
+  std::set<Key> sorted;
+  std::vector<int32_t> tree = std::vector<int32_t>(ELO_RANGE + 1, 0);
+
+  void add(uint16_t elo, int32_t delta) {
+    for (size_t i = size_t(elo) + 1; i <= ELO_RANGE; i += i & (~i + 1))
+      tree[i] += delta;
+  }
+
+  // Số người chơi có Elo <= elo
+  uint32_t countAtMost(uint16_t elo) const {
+    int64_t count = 0;
+    for (size_t i = size_t(elo) + 1; i > 0; i -= i & (~i + 1))
+      count += tree[i];
+    return static_cast<uint32_t>(count);
+  }
+
+  std::vector<Entry> collect(std::set<Key>::const_iterator it,
+                             size_t limit) const {
+    std::vector<Entry> entries;
+    uint32_t rank = 0;
+    uint16_t rank_elo = 0;
+    for (; it != sorted.end() && entries.size() < limit; ++it) {
+      // Chỉ tra cây Fenwick khi Elo đổi; cùng Elo thì cùng rank
+      if (entries.empty() || it->elo != rank_elo) {
+        rank = rankOf(it->elo);
+        rank_elo = it->elo;
+      }
+      entries.push_back(Entry{rank, it->username, it->elo});
+    }
+    return entries;
+  }
+};
+
+#endif // RATING_INDEX_HPP
@@ -0,0 +1,173 @@
+// SERVER_CONFIG_HPP - Cấu hình server đọc từ tham số dòng lệnh
+
+#ifndef SERVER_CONFIG_HPP
+#define SERVER_CONFIG_HPP
+
+// Thư viện chuẩn C++
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Thư viện dự án
+#include "../common/const.hpp"
+#include "logger.hpp"
+
+/**
+ * @brief Lớp ServerConfig (Singleton) - Các tham số vận hành của server.
+ *
+ * Giá trị mặc định lấy từ Const, có thể ghi đè bằng tham số dạng
+ * --ten-tham-so=gia-tri khi chạy server_main.
+ */
+class ServerConfig {
+public:
+  uint32_t heartbeat_interval_ms = Const::HEARTBEAT_INTERVAL_MS;
+  uint32_t heartbeat_timeout_ms = Const::HEARTBEAT_TIMEOUT_MS;
+  uint32_t match_accept_timeout_ms = Const::MATCH_ACCEPT_TIMEOUT_MS;
+  uint32_t challenge_timeout_ms = Const::CHALLENGE_TIMEOUT_MS;
+  std::string data_dir; // Thư mục chứa users.json/matches.json, rỗng = ../data/
+  std::string stats_socket; // Endpoint metrics; rỗng (mặc định) = tắt
+  LogLevel log_level = LogLevel::INFO;
+  std::string log_file; // Rỗng = ghi log ra stdout
+  std::string trace_file; // Rỗng = tắt tracing
+  uint32_t trace_sample = Const::TRACE_SAMPLE_EVERY; // Theo dõi 1/N request
+  uint32_t engine_threads = 0; // Tổng số luồng của máy, 0 = số lõi CPU
+  uint32_t engine_move_ms = Const::ENGINE_MOVE_MS;
+  uint32_t engine_hash_mb = Const::ENGINE_HASH_MB;
+  uint32_t analysis_depth = 0; // Độ sâu phân tích sau ván, 0 = tắt
+  uint32_t analysis_threads = Const::ANALYSIS_THREADS;
+  std::string io_backend = "threads"; // threads | uring
+  uint32_t io_workers = 0; // Luồng xử lý của backend io_uring, 0 = số lõi CPU
+
+  ServerConfig(const ServerConfig &) = delete;
+  ServerConfig &operator=(const ServerConfig &) = delete;
+
+  static ServerConfig &getInstance() {
+    static ServerConfig instance;
+    return instance;
+  }
+
+  /**
+   * @brief Đọc tham số dòng lệnh.
+   * @return false nếu có tham số không hợp lệ (đã in hướng dẫn sử dụng).
+   */
+  bool parseArgs(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+      std::string arg = argv[i];
+      size_t eq = arg.find('=');
+      std::string key = arg.substr(0, eq);
+      std::string value = (eq == std::string::npos) ? "" : arg.substr(eq + 1);
+
+      if (key == "--data-dir" && !value.empty()) {
+        data_dir = value;
+        continue;
+      }
+      if (key == "--stats-socket" && eq != std::string::npos) {
+        stats_socket = value;
+        continue;
+      }
+      if (key == "--log-file" && !value.empty()) {
+        log_file = value;
+        continue;
+      }
+      if (key == "--log-level" && Logger::parseLevel(value, log_level))
+        continue;
+      if (key == "--trace-file" && !value.empty()) {
+        trace_file = value;
+        continue;
+      }
+      if (key == "--io-backend" && (value == "threads" || value == "uring")) {
+        io_backend = value;
+        continue;
+      }
+
+      uint32_t *field = nullptr;
+      if (key == "--heartbeat-interval")
+        field = &heartbeat_interval_ms;
+      else if (key == "--heartbeat-timeout")
+        field = &heartbeat_timeout_ms;
+      else if (key == "--match-accept-timeout")
+        field = &match_accept_timeout_ms;
+      else if (key == "--challenge-timeout")
+        field = &challenge_timeout_ms;
+      else if (key == "--trace-sample")
+        field = &trace_sample;
+      else if (key == "--engine-threads")
+        field = &engine_threads;
+      else if (key == "--engine-move-ms")
+        field = &engine_move_ms;
+      else if (key == "--engine-hash-mb")
+        field = &engine_hash_mb;
+      else if (key == "--analysis-depth")
+        field = &analysis_depth;
+      else if (key == "--analysis-threads")
+        field = &analysis_threads;
+      else if (key == "--io-workers")
+        field = &io_workers;
+
+      if (field == nullptr || !parseUint(value, *field)) {
+        std::cerr << "Invalid argument: " << arg << std::endl;
+        printUsage(argv[0]);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void printUsage(const char *program) const {
+    std::cerr << "Usage: " << program << " [options] (thời gian tính bằng ms)\n"
+              << "  --heartbeat-interval=MS    (mặc định "
+              << Const::HEARTBEAT_INTERVAL_MS << ")\n"
+              << "  --heartbeat-timeout=MS     (mặc định "
+              << Const::HEARTBEAT_TIMEOUT_MS << ")\n"
+              << "  --match-accept-timeout=MS  (mặc định "
+              << Const::MATCH_ACCEPT_TIMEOUT_MS << ")\n"
+              << "  --challenge-timeout=MS     (mặc định "
+              << Const::CHALLENGE_TIMEOUT_MS << ")\n"
+              << "  --data-dir=PATH            (mặc định ../data/ cạnh file "
+                 "chạy)\n"
+              << "  --stats-socket=PATH        Bật endpoint metrics tại Unix "
+                 "socket PATH (mặc định tắt)\n"
+              << "  --log-level=LEVEL          debug|info|warn|error (mặc định "
+                 "info)\n"
+              << "  --log-file=PATH            Ghi log JSON lines vào file (mặc "
+                 "định stdout)\n"
+              << "  --trace-file=PATH          Ghi trace (Chrome trace-event) "
+                 "vào file\n"
+              << "  --trace-sample=N           Theo dõi 1 trên N request (mặc "
+                 "định "
+              << Const::TRACE_SAMPLE_EVERY << ")\n"
+              << "  --engine-threads=N         Tổng số luồng tìm kiếm của máy "
+                 "(mặc định số lõi)\n"
+              << "  --engine-move-ms=MS        Thời gian tối đa cho một nước "
+                 "của máy (mặc định "
+              << Const::ENGINE_MOVE_MS << ")\n"
+              << "  --engine-hash-mb=N         Bảng chuyển vị của máy (mặc định "
+              << Const::ENGINE_HASH_MB << ")\n"
+              << "  --analysis-depth=N         Bật phân tích sau ván với độ sâu "
+                 "N (mặc định tắt)\n"
+              << "  --analysis-threads=N       Số luồng phân tích (mặc định "
+              << Const::ANALYSIS_THREADS << ")\n"
+              << "  --io-backend=NAME          threads|uring (mặc định threads; "
+                 "uring cần Linux 6.0+, nếu không sẽ dùng threads)\n"
+              << "  --io-workers=N             Số luồng xử lý của backend uring "
+                 "(mặc định số lõi)"
+              << std::endl;
+  }
+
+private:
+  ServerConfig() = default;
+
+  static bool parseUint(const std::string &value, uint32_t &out) {
+    if (value.empty())
+      return false;
+    char *end = nullptr;
+    unsigned long parsed = std::strtoul(value.c_str(), &end, 10);
+    if (*end != '\0' || parsed == 0 || parsed > UINT32_MAX)
+      return false;
+    out = static_cast<uint32_t>(parsed);
+    return true;
+  }
+};
+
+#endif // SERVER_CONFIG_HPP
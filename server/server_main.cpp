@@ -1,74 +1,203 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <thread>
 #include <vector>
 #include <iostream>
 #include <csignal>
+#include <cstdlib>
+#include <pthread.h>
 
+#include "io_uring_server.hpp"
 #include "network_server.hpp"
 #include "message_handler.hpp"
+#include "server_config.hpp"
+#include "stats_endpoint.hpp"
+#include "logger.hpp"
+#include "tracer.hpp"
 
 #include "../common/message.hpp"
 #include "../common/const.hpp"
 
+/**
+ * @brief Xử lý các gói tin của một client, dùng chung cho hai backend mạng.
+ */
+class ClientSession
+{
+public:
+    explicit ClientSession(int client_fd)
+        : client_fd(client_fd),
+          message_handler(NetworkServer::getInstance(), DataStorage::getInstance(),
+                          GameManager::getInstance())
+    {
+    }
+
+    /**
+     * @brief Xử lý một gói tin.
+     * @return false nếu gói tin hỏng (cần ngắt kết nối client).
+     */
+    bool handle(const Packet &packet)
+    {
+        // Span gốc của request (nếu request này được lấy mẫu)
+        const char *type_name = messageTypeName(packet.type);
+        TraceRequest trace(type_name != nullptr ? type_name : "UNKNOWN",
+                           client_fd, packet.payload.size());
+
+        // Handle message. Payload hỏng (deserialize ném exception) không được
+        // làm sập server: chỉ ngắt kết nối client gửi gói tin đó
+        try
+        {
+            message_handler.handleMessage(client_fd, packet);
+        }
+        catch (const std::exception &e)
+        {
+            LOG_WARN("invalid_packet", "client_fd", client_fd, "error", e.what());
+            return false;
+        }
+        return true;
+    }
+
+    // Client đã ngắt kết nối (hoặc bị ngắt): dọn trạng thái rồi đóng socket.
+    // Khi server dừng, ván đang chơi được giữ nguyên (không xử thua ai)
+    void close()
+    {
+        LOG_INFO("client_disconnected", "client_fd", client_fd);
+        if (!NetworkServer::getInstance().isStopping())
+            GameManager::getInstance().clientDisconnected(client_fd);
+
+        NetworkServer::getInstance().closeConnection(client_fd);
+    }
+
+private:
+    int client_fd;
+    MessageHandler message_handler;
+};
+
 void handleClient(int client_fd);
+void waitForShutdown(sigset_t signals);
 
-int main()
+int main(int argc, char *argv[])
 {
+    // Đọc cấu hình từ tham số dòng lệnh
+    ServerConfig &config = ServerConfig::getInstance();
+    if (!config.parseArgs(argc, argv))
+        return 1;
+
+    // SIGINT/SIGTERM được chặn trước khi tạo bất kỳ luồng nào (luồng con kế
+    // thừa mask) và chỉ được nhận bởi luồng shutdown: luồng này chỉ báo cho
+    // vòng lặp chính dừng, việc dọn dẹp nằm ở cuối main()
+    sigset_t shutdown_signals;
+    sigemptyset(&shutdown_signals);
+    sigaddset(&shutdown_signals, SIGINT);
+    sigaddset(&shutdown_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &shutdown_signals, nullptr);
+
+    // Logger được khởi tạo trước các singleton khác để hủy sau cùng (còn ghi
+    // được log khi chúng dừng)
+    if (!Logger::getInstance().configure(config.log_file, config.log_level))
+        std::cerr << "Không mở được file log " << config.log_file
+                  << ", ghi log ra stdout." << std::endl;
+
+    // Tracing theo mẫu (không bắt buộc)
+    if (!config.trace_file.empty() &&
+        !Tracer::getInstance().configure(config.trace_file, config.trace_sample))
+        LOG_ERROR("trace_open_failed", "path", config.trace_file);
+
+    // Endpoint metrics cục bộ (không bắt buộc: lỗi chỉ được ghi log)
+    const std::string &stats_socket = config.stats_socket;
+    if (!stats_socket.empty())
+        StatsEndpoint::getInstance().start(stats_socket);
+
     // Khởi tạo các singletons
     NetworkServer &network_server = NetworkServer::getInstance();
     DataStorage &data_storage = DataStorage::getInstance();
     GameManager &game_manager = GameManager::getInstance();
 
+    std::thread shutdown_thread(waitForShutdown, shutdown_signals);
+
     // Khởi tạo GameManager với dependencies (DI)
     game_manager.init(network_server, data_storage);
 
-    // Tạo một vector chứa tất cả các thread xử lý client
-    std::vector<std::thread> client_threads;
-
-    while (true)
+    // Backend io_uring (nếu được chọn): vòng sự kiện chạy luôn trên luồng này
+    // tới khi server dừng. Kernel không hỗ trợ thì quay về một luồng cho mỗi
+    // client bên dưới
+    bool uring_started = false;
+    if (config.io_backend == "uring")
     {
-        int client_fd = network_server.acceptConnection();
-        if (client_fd != -1)
+        IoUringServer<ClientSession> uring_server(network_server);
+        if (uring_server.init())
+        {
+            unsigned workers = config.io_workers > 0
+                                   ? config.io_workers
+                                   : std::max(2u, std::thread::hardware_concurrency());
+            uring_server.run(workers);
+            uring_started = true;
+        }
+        else
         {
-            // Tạo một thread mới để xử lý client
-            client_threads.emplace_back(std::thread(handleClient, client_fd));
+            LOG_WARN("io_uring_unavailable", "error", std::strerror(errno),
+                     "fallback", "threads");
         }
     }
 
-    // Join tất cả các thread trước khi kết thúc chương trình
-    for (auto &th : client_threads)
+    if (!uring_started)
     {
-        if (th.joinable())
+        // Tạo một vector chứa tất cả các thread xử lý client
+        std::vector<std::thread> client_threads;
+
+        while (!network_server.isStopping())
+        {
+            int client_fd = network_server.acceptConnection();
+            if (client_fd != -1)
+            {
+                // Tạo một thread mới để xử lý client
+                client_threads.emplace_back(std::thread(handleClient, client_fd));
+            }
+        }
+
+        // Đánh thức các thread đang chờ recv() rồi join trước khi kết thúc
+        network_server.shutdownAllConnections();
+        for (auto &th : client_threads)
         {
-            th.join();
+            if (th.joinable())
+            {
+                th.join();
+            }
         }
     }
 
+    shutdown_thread.join();
     network_server.closeAllConnections();
+    StatsEndpoint::getInstance().stop();
 
+    // Elo được ghi trễ: lưu nốt trước khi thoát. Việc nền còn lại (máy, phân
+    // tích, ván đang kết thúc) dừng trong destructor của các singleton
+    data_storage.flushUsers();
+    LOG_INFO("server_stopped");
     return 0;
 }
 
+void waitForShutdown(sigset_t signals)
+{
+    int signal_number = 0;
+    sigwait(&signals, &signal_number);
+    LOG_INFO("server_shutdown", "signal", signal_number);
+
+    // Vòng lặp chính (accept hoặc io_uring) thức dậy và dọn dẹp
+    NetworkServer::getInstance().stop();
+}
+
 void handleClient(int client_fd)
 {
     NetworkServer &network_server = NetworkServer::getInstance();
-    DataStorage &storage = DataStorage::getInstance();
-    GameManager &game_manager = GameManager::getInstance();
-    MessageHandler message_handler(network_server, storage, game_manager);
+    ClientSession session(client_fd);
 
-    while (true)
-    {
-        Packet packet;
-        bool received = network_server.receivePacket(client_fd, packet);
-        if (!received)
-        {
-            std::cout << "Client " << client_fd << " ngắt kết nối." << std::endl;
-            game_manager.clientDisconnected(client_fd);
+    // Bắt đầu gửi PING định kỳ, client im lặng quá lâu sẽ bị ngắt kết nối
+    network_server.startHeartbeat(client_fd);
 
-            network_server.closeConnection(client_fd);
-            break;
-        }
-
-        // Handle message
-        message_handler.handleMessage(client_fd, packet);
+    Packet packet;
+    while (network_server.receivePacket(client_fd, packet) && session.handle(packet))
+    {
     }
+    session.close();
 }
\ No newline at end of file
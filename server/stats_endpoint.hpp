@@ -0,0 +1,160 @@
+// STATS_ENDPOINT_HPP - Endpoint Unix socket cục bộ xuất metrics
+
+#ifndef STATS_ENDPOINT_HPP
+#define STATS_ENDPOINT_HPP
+
+// Thư viện chuẩn C++
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// Thư viện hệ thống
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Thư viện dự án
+#include "logger.hpp"
+#include "metrics.hpp"
+
+/**
+ * @brief Lớp StatsEndpoint (Singleton) - Phục vụ Metrics::render() qua một
+ * Unix socket cục bộ.
+ *
+ * Mỗi kết nối nhận một bản số liệu rồi bị đóng. Nếu client gửi một request
+ * HTTP (bắt đầu bằng "GET"), phản hồi có kèm header HTTP để có thể scrape
+ * trực tiếp (endpoint tắt mặc định, bật bằng --stats-socket=PATH):
+ *
+ *   curl --unix-socket data/stats.sock http://localhost/metrics
+ *   socat - UNIX-CONNECT:data/stats.sock
+ *
+ * Socket được tạo với quyền 0600 (chỉ người chạy server dùng được) và không
+ * mở ra mạng. Path đã tồn tại thì không bị xóa: start() từ chối.
+ */
+class StatsEndpoint {
+public:
+  StatsEndpoint(const StatsEndpoint &) = delete;
+  StatsEndpoint &operator=(const StatsEndpoint &) = delete;
+
+  static StatsEndpoint &getInstance() {
+    static StatsEndpoint instance;
+    return instance;
+  }
+
+  ~StatsEndpoint() { stop(); }
+
+  /**
+   * @brief Tạo socket tại path và bắt đầu luồng phục vụ.
+   * @return false nếu không tạo được socket hoặc path đã tồn tại (server
+   * vẫn chạy bình thường).
+   */
+  bool start(const std::string &socket_path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+      LOG_ERROR("stats_path_too_long", "path", socket_path);
+      return false;
+    }
+    std::strncpy(address.sun_path, socket_path.c_str(),
+                 sizeof(address.sun_path) - 1);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+      LOG_ERROR("stats_socket_failed", "error", std::strerror(errno));
+      return false;
+    }
+
+    // umask khi bind để file socket có quyền 0600 ngay từ lúc xuất hiện.
+    // bind() thất bại (EADDRINUSE) nếu path đã tồn tại, kể cả socket cũ sót
+    // lại: path không do server tạo thì không xóa
+    mode_t old_mask = umask(0177);
+    bool bound = bind(listen_fd, reinterpret_cast<sockaddr *>(&address),
+                      sizeof(address)) == 0;
+    int bind_error = errno;
+    umask(old_mask);
+    if (!bound || listen(listen_fd, 8) < 0) {
+      LOG_ERROR("stats_bind_failed", "path", socket_path, "error",
+                std::strerror(bound ? errno : bind_error));
+      close(listen_fd);
+      listen_fd = -1;
+      if (bound)
+        unlink(socket_path.c_str());
+      return false;
+    }
+
+    path = socket_path;
+    worker = std::thread(&StatsEndpoint::serve, this);
+    LOG_INFO("stats_listening", "path", path);
+    return true;
+  }
+
+  void stop() {
+    if (listen_fd == -1)
+      return;
+    // shutdown() đánh thức accept() đang chặn trong luồng phục vụ
+    shutdown(listen_fd, SHUT_RDWR);
+    if (worker.joinable())
+      worker.join();
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(path.c_str()); // Socket do start() tạo
+  }
+
+private:
+  int listen_fd = -1;
+  std::string path;
+  std::thread worker;
+
+  StatsEndpoint() = default;
+
+  void serve() {
+    while (true) {
+      int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd < 0) {
+        if (errno == EINTR || errno == ECONNABORTED)
+          continue;
+        return; // Socket đã bị shutdown (dừng server)
+      }
+      respond(fd);
+      close(fd);
+    }
+  }
+
+  static void respond(int fd) {
+    // Đọc request (nếu có) trong thời gian ngắn, không chờ client im lặng
+    char request[512];
+    ssize_t received = 0;
+    pollfd pfd{fd, POLLIN, 0};
+    if (poll(&pfd, 1, 100) > 0)
+      received = recv(fd, request, sizeof(request), 0);
+    bool http = received >= 3 && std::strncmp(request, "GET", 3) == 0;
+
+    std::string body = Metrics::getInstance().render();
+    std::string response;
+    if (http) {
+      response = "HTTP/1.0 200 OK\r\n"
+                 "Content-Type: text/plain; version=0.0.4\r\n"
+                 "Content-Length: " +
+                 std::to_string(body.size()) + "\r\n\r\n";
+    }
+    response += body;
+
+    size_t offset = 0;
+    while (offset < response.size()) {
+      ssize_t sent = send(fd, response.data() + offset,
+                          response.size() - offset, MSG_NOSIGNAL);
+      if (sent < 0 && errno == EINTR)
+        continue;
+      if (sent <= 0)
+        return;
+      offset += static_cast<size_t>(sent);
+    }
+  }
+};
+
+#endif // STATS_ENDPOINT_HPP
@@ -1,7 +1,10 @@
 #ifndef STRUCTS_HPP
 #define STRUCTS_HPP
 
+#include <atomic>
 #include <chrono>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -12,15 +15,17 @@ using json = nlohmann::json;
 
 // Thông tin người dùng
 struct UserModel {
-  std::string username; // Tên đăng nhập
-  uint16_t elo;         // Điểm ELO
+  std::string username;       // Tên đăng nhập
+  uint16_t elo;               // Điểm ELO
+  uint32_t games_played = 0;  // Số ván đã tính điểm (quyết định hệ số K)
 
   // Chuyển sang JSON
-  json serialize() const { return {{"elo", elo}}; }
+  json serialize() const { return {{"elo", elo}, {"games", games_played}}; }
 
-  // Khôi phục từ JSON
+  // Khôi phục từ JSON (file cũ không có "games")
   static UserModel deserialize(const std::string &username, const json &j) {
-    return UserModel{username, j.at("elo").get<uint16_t>()};
+    return UserModel{username, j.at("elo").get<uint16_t>(),
+                     j.value("games", 0u)};
   }
 };
 
@@ -48,6 +53,16 @@ struct MatchModel {
   std::string result;      // Kết quả (1-0, 0-1, 1/2-1/2)
   std::string reason;      // Lý do (checkmate, timeout, resign)
 
+  // Phân tích sau ván (Analyzer), phần tử i ứng với moves[i]
+  struct MoveAnalysis {
+    int eval;          // Điểm sau nước đi (centipawn, góc nhìn bên trắng)
+    uint8_t judgement; // AnalysisResponseMessage::Judgement
+    std::string best;  // Nước máy chọn ở thế cờ trước nước đi (UCI)
+  };
+
+  std::vector<MoveAnalysis> analysis;
+  int analysis_depth = 0; // 0 = chưa phân tích
+
   // Chuyển sang JSON
   json serialize() const {
     json j;
@@ -72,6 +87,15 @@ struct MatchModel {
     j["result"] = result;
     j["reason"] = reason;
 
+    if (analysis_depth > 0) {
+      json analysis_json = json::array();
+      for (const auto &entry : analysis)
+        analysis_json.push_back({{"eval", entry.eval},
+                                 {"judgement", entry.judgement},
+                                 {"best", entry.best}});
+      j["analysis"] = {{"depth", analysis_depth}, {"moves", analysis_json}};
+    }
+
     return j;
   }
 
@@ -102,6 +126,16 @@ struct MatchModel {
     game.result = j.at("result").get<std::string>();
     game.reason = j.at("reason").get<std::string>();
 
+    // File cũ (hoặc ván chưa phân tích) không có "analysis"
+    if (j.contains("analysis")) {
+      const json &analysis_json = j.at("analysis");
+      game.analysis_depth = analysis_json.value("depth", 0);
+      for (const auto &entry : analysis_json.at("moves"))
+        game.analysis.push_back({entry.at("eval").get<int>(),
+                                 entry.at("judgement").get<uint8_t>(),
+                                 entry.at("best").get<std::string>()});
+    }
+
     return game;
   }
 };
@@ -113,6 +147,7 @@ struct PendingGame {
   int player2_fd;
   bool player1_accepted;
   bool player2_accepted;
+  uint64_t accept_timer = 0; // TimerId của hạn chấp nhận trận
 
   PendingGame()
       : game_id(""), player1_fd(-1), player2_fd(-1), player1_accepted(false),
@@ -123,11 +158,24 @@ struct PendingGame {
         player2_accepted(false) {}
 };
 
+// Gói tin đã đóng khung (header + payload), dùng chung giữa nhiều người nhận.
+// Được encode một lần, mỗi hàng đợi gửi chỉ giữ thêm một tham chiếu.
+using SharedPacket = std::shared_ptr<const std::vector<uint8_t>>;
+
 // Thông tin client kết nối
 struct ClientInfo {
   std::vector<uint8_t> buffer; // Bộ đệm nhận dữ liệu
   std::mutex mutex;            // Khóa bảo vệ buffer
   std::string username = "";   // Tên đăng nhập
+
+  std::deque<SharedPacket> outbound; // Hàng đợi gói tin chờ gửi
+  size_t outbound_offset = 0;        // Số byte của outbound.front() đã gửi
+  size_t outbound_bytes = 0;         // Tổng số byte còn nằm trong hàng đợi
+  std::mutex outbound_mutex;         // Khóa bảo vệ outbound
+  std::mutex send_mutex; // Chỉ một luồng ghi ra socket tại một thời điểm
+
+  // Thời điểm nhận dữ liệu gần nhất (ms, steady clock), dùng cho heartbeat
+  std::atomic<int64_t> last_seen_ms{0};
 };
 
 #endif // STRUCTS_HPP
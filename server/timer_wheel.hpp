@@ -0,0 +1,298 @@
+// TIMER_WHEEL_HPP - Bánh xe hẹn giờ phân tầng dùng chung cho toàn server
+
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+// Thư viện chuẩn C++
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thư viện dự án
+#include "../common/const.hpp"
+
+// ID của một timer: 32 bit cao = thế hệ (generation), 32 bit thấp = vị trí
+// trong slab. Thế hệ bắt đầu từ 1 nên 0 không bao giờ là ID hợp lệ.
+using TimerId = uint64_t;
+constexpr TimerId INVALID_TIMER = 0;
+
+/**
+ * @brief Lớp TimerWheel (Singleton) - Bánh xe hẹn giờ phân tầng (hierarchical
+ * timing wheel).
+ *
+ * Một luồng duy nhất quản lý mọi deadline của server (đồng hồ cờ, hạn chấp
+ * nhận trận, heartbeat...). Có 4 tầng x 256 ô, mỗi tick dài
+ * Const::TIMER_TICK_MS. Timer được đặt vào ô ứng với khoảng cách tới deadline;
+ * mỗi khi tầng dưới quay hết một vòng, ô kế tiếp của tầng trên được đổ
+ * (cascade) xuống tầng dưới.
+ *
+ * Thêm và hủy timer là O(1): mỗi ô là một danh sách liên kết đôi nội tại
+ * (intrusive) theo chỉ số trong slab, không cấp phát lại khi timer được dùng
+ * lại.
+ *
+ * @note Callback chạy trên luồng của TimerWheel (đã nhả khóa) nên phải ngắn.
+ * cancel() có thể chạy đua với lúc timer vừa hết hạn, callback cần tự kiểm tra
+ * lại trạng thái trước khi hành động.
+ */
+class TimerWheel {
+public:
+  using Callback = std::function<void()>;
+
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel &operator=(const TimerWheel &) = delete;
+
+  static TimerWheel &getInstance() {
+    static TimerWheel instance;
+    return instance;
+  }
+
+  ~TimerWheel() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    cv.notify_one();
+    if (worker.joinable())
+      worker.join();
+  }
+
+  /**
+   * @brief Hẹn giờ gọi callback sau một khoảng thời gian.
+   * @param delay Khoảng thời gian chờ (làm tròn lên theo tick, tối thiểu 1 tick).
+   * @return ID dùng để hủy timer.
+   */
+  TimerId schedule(std::chrono::milliseconds delay, Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Bánh xe rỗng không có gì để quay: đồng bộ tick hiện tại với thời gian
+    // thực để deadline mới được tính chính xác
+    if (active == 0)
+      current_tick = std::max(current_tick, nowTick());
+
+    int64_t ticks = (delay.count() + Const::TIMER_TICK_MS - 1) /
+                    static_cast<int64_t>(Const::TIMER_TICK_MS);
+    if (ticks < 1)
+      ticks = 1;
+
+    uint32_t index;
+    if (!free_nodes.empty()) {
+      index = free_nodes.back();
+      free_nodes.pop_back();
+    } else {
+      index = static_cast<uint32_t>(nodes.size());
+      nodes.emplace_back();
+    }
+
+    Node &node = nodes[index];
+    node.expires = current_tick + static_cast<uint64_t>(ticks);
+    node.callback = std::move(callback);
+    link(index);
+    active++;
+
+    cv.notify_one();
+    return (static_cast<uint64_t>(node.generation) << 32) | index;
+  }
+
+  /**
+   * @brief Hủy timer chưa hết hạn.
+   * @return false nếu timer đã chạy, đã bị hủy hoặc ID không hợp lệ.
+   */
+  bool cancel(TimerId id) {
+    if (id == INVALID_TIMER)
+      return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFF);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    if (index >= nodes.size() || nodes[index].generation != generation ||
+        nodes[index].slot == NIL)
+      return false;
+
+    unlink(index);
+    release(index);
+    return true;
+  }
+
+  /**
+   * @brief Số timer đang chờ.
+   */
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return active;
+  }
+
+private:
+  static constexpr int LEVELS = 4;
+  static constexpr int SLOT_BITS = 8;
+  static constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+  static constexpr uint32_t SLOT_MASK = SLOTS - 1;
+  static constexpr uint32_t NIL = UINT32_MAX;
+
+  struct Node {
+    uint64_t expires = 0;    // Tick hết hạn
+    uint32_t generation = 1; // Tăng mỗi lần node được giải phóng
+    uint32_t prev = NIL;     // Node trước trong cùng ô
+    uint32_t next = NIL;     // Node sau trong cùng ô
+    uint32_t slot = NIL;     // Ô đang chứa node, NIL nếu node rảnh
+    Callback callback;
+  };
+
+  std::vector<Node> nodes;                    // Slab chứa mọi timer
+  std::vector<uint32_t> free_nodes;           // Các node rảnh để dùng lại
+  std::array<uint32_t, LEVELS * SLOTS> heads; // Đầu danh sách của mỗi ô
+  uint64_t current_tick;                      // Tick đã xử lý xong
+  size_t active;                              // Số timer đang chờ
+
+  std::chrono::steady_clock::time_point start_time;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool stopping;
+  std::thread worker;
+
+  // Constructor private (Singleton)
+  TimerWheel()
+      : current_tick(0), active(0),
+        start_time(std::chrono::steady_clock::now()), stopping(false) {
+    heads.fill(NIL);
+    worker = std::thread(&TimerWheel::run, this);
+  }
+
+  uint64_t nowTick() const {
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(elapsed)
+            .count() /
+        Const::TIMER_TICK_MS);
+  }
+
+  // Đặt node vào ô phù hợp với khoảng cách từ tick hiện tại tới deadline
+  void link(uint32_t index) {
+    Node &node = nodes[index];
+    uint64_t delta =
+        node.expires > current_tick ? node.expires - current_tick : 0;
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1ull << (SLOT_BITS * (level + 1))))
+      level++;
+
+    // Deadline quá xa (> 2^32 tick) bị kéo về tầng cao nhất
+    uint64_t expires = node.expires;
+    if (level == LEVELS - 1 && delta >= (1ull << (SLOT_BITS * LEVELS)))
+      expires = current_tick + (1ull << (SLOT_BITS * LEVELS)) - 1;
+
+    uint32_t slot = static_cast<uint32_t>(level) * SLOTS +
+                    static_cast<uint32_t>((expires >> (SLOT_BITS * level)) &
+                                          SLOT_MASK);
+
+    node.slot = slot;
+    node.prev = NIL;
+    node.next = heads[slot];
+    if (node.next != NIL)
+      nodes[node.next].prev = index;
+    heads[slot] = index;
+  }
+
+  void unlink(uint32_t index) {
+    Node &node = nodes[index];
+    if (node.prev != NIL)
+      nodes[node.prev].next = node.next;
+    else
+      heads[node.slot] = node.next;
+    if (node.next != NIL)
+      nodes[node.next].prev = node.prev;
+    node.prev = node.next = node.slot = NIL;
+  }
+
+  void release(uint32_t index) {
+    Node &node = nodes[index];
+    node.callback = nullptr;
+    node.generation++;
+    free_nodes.push_back(index);
+    active--;
+  }
+
+  // Đổ toàn bộ node trong một ô của tầng trên xuống các tầng dưới.
+  // Trả về chỉ số ô để biết có cần đổ tiếp tầng kế trên hay không.
+  uint32_t cascade(int level) {
+    uint32_t index = static_cast<uint32_t>(
+        (current_tick >> (SLOT_BITS * level)) & SLOT_MASK);
+    uint32_t slot = static_cast<uint32_t>(level) * SLOTS + index;
+
+    uint32_t node = heads[slot];
+    heads[slot] = NIL;
+    while (node != NIL) {
+      uint32_t next = nodes[node].next;
+      link(node);
+      node = next;
+    }
+    return index;
+  }
+
+  // Tiến thêm một tick, gom callback của các timer hết hạn
+  void advance(std::vector<Callback> &expired) {
+    current_tick++;
+
+    uint32_t index = static_cast<uint32_t>(current_tick & SLOT_MASK);
+    if (index == 0) {
+      for (int level = 1; level < LEVELS; level++) {
+        if (cascade(level) != 0)
+          break;
+      }
+    }
+
+    uint32_t node = heads[index];
+    heads[index] = NIL;
+    while (node != NIL) {
+      uint32_t next = nodes[node].next;
+      if (nodes[node].expires > current_tick) {
+        link(node); // Deadline bị kéo về từ rất xa, chưa đến lúc
+      } else {
+        nodes[node].slot = NIL;
+        expired.push_back(std::move(nodes[node].callback));
+        release(node);
+      }
+      node = next;
+    }
+  }
+
+  // Vòng lặp của luồng TimerWheel
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::vector<Callback> expired;
+
+    while (!stopping) {
+      if (active == 0) {
+        cv.wait(lock, [this] { return stopping || active > 0; });
+        continue;
+      }
+
+      uint64_t target = nowTick();
+      while (current_tick < target && active > 0)
+        advance(expired);
+      if (active == 0)
+        current_tick = std::max(current_tick, target);
+
+      if (!expired.empty()) {
+        // Chạy callback ngoài khóa để callback có thể schedule/cancel
+        lock.unlock();
+        for (auto &callback : expired)
+          callback();
+        expired.clear();
+        lock.lock();
+        continue;
+      }
+
+      cv.wait_until(lock, start_time + std::chrono::milliseconds(
+                                           (current_tick + 1) *
+                                           Const::TIMER_TICK_MS));
+    }
+  }
+};
+
+#endif // TIMER_WHEEL_HPP
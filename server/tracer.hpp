@@ -0,0 +1,238 @@
+// TRACER_HPP - Lấy mẫu và ghi thời gian từng giai đoạn xử lý một request
+
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+// Thư viện chuẩn C++
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Thư viện hệ thống
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * @brief Lớp Tracer (Singleton) - Span tracing theo mẫu cho các request.
+ *
+ * Cứ sample_every request thì một request được theo dõi. Trong request đó mỗi
+ * TraceSpan ghi lại (tên, thời điểm bắt đầu, thời lượng) vào bộ đệm của luồng
+ * hiện tại; khi request kết thúc, toàn bộ span được ghi một lần ra file theo
+ * định dạng Chrome trace-event (mở bằng chrome://tracing hoặc Perfetto):
+ *
+ *   [{"name":"process_name","ph":"M","pid":123,"args":{"name":"server_main"}}
+ *   ,{"name":"MOVE","cat":"request","ph":"X","ts":1.000,"dur":850.250,...}
+ *   ,{"name":"storage.addMove","cat":"span","ph":"X","ts":20.125,...}
+ *
+ * Mỗi sự kiện bắt đầu bằng dấu phẩy nên file luôn là JSON hợp lệ sau khi thêm
+ * "]" (định dạng cho phép thiếu "]" khi server bị dừng đột ngột).
+ *
+ * Request không được lấy mẫu chỉ tốn một lần đọc biến thread_local mỗi span.
+ */
+class Tracer {
+public:
+  Tracer(const Tracer &) = delete;
+  Tracer &operator=(const Tracer &) = delete;
+
+  static Tracer &getInstance() {
+    static Tracer instance;
+    return instance;
+  }
+
+  ~Tracer() {
+    if (file != nullptr) {
+      std::fputs("]\n", file);
+      std::fclose(file);
+    }
+  }
+
+  /**
+   * @brief Mở file trace và bật tracing.
+   * @param sample Theo dõi 1 trên mỗi sample request (1 = mọi request).
+   * @return false nếu không mở được file (tracing vẫn tắt).
+   */
+  bool configure(const std::string &path, uint32_t sample) {
+    FILE *out = std::fopen(path.c_str(), "w");
+    if (out == nullptr)
+      return false;
+    std::fprintf(out,
+                 "[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+                 "\"args\":{\"name\":\"server_main\"}}\n",
+                 static_cast<int>(getpid()));
+    std::fflush(out);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    file = out;
+    sample_every = sample == 0 ? 1 : sample;
+    enabled.store(true, std::memory_order_release);
+    return true;
+  }
+
+  // Thời điểm đơn điệu tính bằng ns
+  static uint64_t now() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
+
+  /**
+   * @brief Ghi nhận thời điểm bytes của request kế tiếp vừa tới (sau recv).
+   * Giai đoạn tách gói tin (net.frame) được đo từ thời điểm này.
+   */
+  void markFrameStart() {
+    if (enabled.load(std::memory_order_relaxed))
+      threadTrace().frame_start_ns = now();
+  }
+
+  // Request của luồng hiện tại có đang được theo dõi không
+  static bool active() { return threadTrace().active; }
+
+private:
+  friend class TraceRequest;
+  friend class TraceSpan;
+
+  struct Event {
+    const char *name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+  };
+
+  // Trạng thái tracing của một luồng
+  struct ThreadTrace {
+    bool active = false;
+    uint64_t frame_start_ns = 0;
+    std::vector<Event> events;
+  };
+
+  std::atomic<bool> enabled{false};
+  std::atomic<uint64_t> request_counter{0};
+  uint32_t sample_every = 1;
+  uint64_t epoch_ns = now(); // Gốc thời gian của file trace
+  FILE *file = nullptr;
+  std::mutex mutex;
+
+  Tracer() = default;
+
+  static ThreadTrace &threadTrace() {
+    thread_local ThreadTrace trace;
+    return trace;
+  }
+
+  static long threadId() {
+    thread_local long tid = syscall(SYS_gettid);
+    return tid;
+  }
+
+  bool shouldSample() {
+    if (!enabled.load(std::memory_order_acquire))
+      return false;
+    return request_counter.fetch_add(1, std::memory_order_relaxed) %
+               sample_every ==
+           0;
+  }
+
+  // Ghi toàn bộ span của một request ra file
+  void flush(const char *request_name, const std::string &args,
+             const Event &root, std::vector<Event> &events) {
+    long tid = threadId();
+    int pid = static_cast<int>(getpid());
+    std::string out;
+    out.reserve(128 * (events.size() + 1));
+    appendEvent(out, request_name, "request", root, pid, tid, args);
+    for (const Event &event : events)
+      appendEvent(out, event.name, "span", event, pid, tid, "");
+    events.clear();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fwrite(out.data(), 1, out.size(), file);
+    std::fflush(file);
+  }
+
+  void appendEvent(std::string &out, const char *name, const char *category,
+                   const Event &event, int pid, long tid,
+                   const std::string &args) const {
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  ",{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,"
+                  "\"dur\":%.3f,\"pid\":%d,\"tid\":%ld",
+                  name, category, (event.start_ns - epoch_ns) / 1e3,
+                  event.duration_ns / 1e3, pid, tid);
+    out += line;
+    if (!args.empty()) {
+      out += ",\"args\":{";
+      out += args;
+      out += '}';
+    }
+    out += "}\n";
+  }
+};
+
+/**
+ * @brief Gốc của một request được lấy mẫu (đặt trong handleClient, ngay sau
+ * khi nhận đủ gói tin). Span gốc tính từ markFrameStart() đến khi xử lý xong.
+ */
+class TraceRequest {
+public:
+  TraceRequest(const char *name, int client_fd, size_t payload_size)
+      : name(name) {
+    Tracer &tracer = Tracer::getInstance();
+    if (!tracer.shouldSample())
+      return;
+
+    Tracer::ThreadTrace &trace = Tracer::threadTrace();
+    uint64_t start = Tracer::now();
+    root.start_ns = trace.frame_start_ns != 0 ? trace.frame_start_ns : start;
+    trace.events.push_back({"net.frame", root.start_ns, start - root.start_ns});
+    trace.active = true;
+    args = "\"client_fd\":" + std::to_string(client_fd) +
+           ",\"payload_bytes\":" + std::to_string(payload_size);
+  }
+
+  ~TraceRequest() {
+    Tracer::ThreadTrace &trace = Tracer::threadTrace();
+    if (!trace.active)
+      return;
+    trace.active = false;
+    root.duration_ns = Tracer::now() - root.start_ns;
+    Tracer::getInstance().flush(name, args, root, trace.events);
+  }
+
+  TraceRequest(const TraceRequest &) = delete;
+  TraceRequest &operator=(const TraceRequest &) = delete;
+
+private:
+  const char *name;
+  std::string args;
+  Tracer::Event root{nullptr, 0, 0};
+};
+
+// Đo một giai đoạn trong request đang được theo dõi (không làm gì nếu không)
+class TraceSpan {
+public:
+  explicit TraceSpan(const char *name) : name(name) {
+    if (Tracer::threadTrace().active)
+      start_ns = Tracer::now();
+  }
+
+  ~TraceSpan() {
+    if (start_ns == 0)
+      return;
+    Tracer::ThreadTrace &trace = Tracer::threadTrace();
+    if (trace.active)
+      trace.events.push_back({name, start_ns, Tracer::now() - start_ns});
+  }
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+  const char *name;
+  uint64_t start_ns = 0;
+};
+
+#endif // TRACER_HPP
@@ -0,0 +1,125 @@
+// WRITE_WATCHER_HPP - Chờ socket ghi được cho các lần gửi không chặn
+
+#ifndef WRITE_WATCHER_HPP
+#define WRITE_WATCHER_HPP
+
+// Thư viện chuẩn C++
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Thư viện hệ thống
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// Thư viện dự án
+#include "logger.hpp"
+
+/**
+ * @brief Một luồng poll(POLLOUT) cho các socket có hàng đợi gửi bị kẹt (lần
+ * gửi không chặn gặp EAGAIN). Mỗi lần watch() là một lần chờ: callback chạy
+ * một lần trên luồng này khi socket ghi được (hoặc lỗi/đã đóng) rồi fd bị bỏ
+ * khỏi danh sách, callback tự watch() lại nếu vẫn còn dữ liệu.
+ *
+ * Callback không được chặn. fd có thể đã bị đóng và cấp lại cho kết nối
+ * khác trước khi callback chạy, nên callback phải tự kiểm tra kết nối.
+ */
+class WriteWatcher {
+public:
+  using Callback = std::function<void()>;
+
+  WriteWatcher() {
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd < 0)
+      LOG_ERROR("write_watcher_failed", "error", std::strerror(errno));
+    else
+      worker = std::thread([this] { run(); });
+  }
+
+  WriteWatcher(const WriteWatcher &) = delete;
+  WriteWatcher &operator=(const WriteWatcher &) = delete;
+
+  ~WriteWatcher() {
+    stopping = true;
+    wake();
+    if (worker.joinable())
+      worker.join();
+    if (wake_fd >= 0)
+      close(wake_fd);
+  }
+
+  /**
+   * @brief Gọi on_writable một lần khi fd ghi được. fd đang được chờ thì
+   * callback mới thay cho callback cũ.
+   */
+  void watch(int fd, Callback on_writable) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      pending[fd] = std::move(on_writable);
+    }
+    wake();
+  }
+
+private:
+  int wake_fd = -1; // eventfd đánh thức poll() khi danh sách thay đổi
+  std::thread worker;
+  std::atomic<bool> stopping{false};
+  std::mutex mutex; // Bảo vệ pending
+  std::unordered_map<int, Callback> pending;
+
+  void wake() {
+    uint64_t one = 1;
+    if (wake_fd >= 0 && write(wake_fd, &one, sizeof(one)) < 0 &&
+        errno != EAGAIN)
+      LOG_WARN("write_watcher_wake_failed", "error", std::strerror(errno));
+  }
+
+  void run() {
+    std::vector<pollfd> fds;
+    std::vector<Callback> ready;
+    while (!stopping) {
+      fds.assign(1, pollfd{wake_fd, POLLIN, 0});
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto &entry : pending)
+          fds.push_back(pollfd{entry.first, POLLOUT, 0});
+      }
+
+      if (poll(fds.data(), fds.size(), -1) < 0) {
+        if (errno != EINTR)
+          LOG_ERROR("write_watcher_poll_failed", "error", std::strerror(errno));
+        continue;
+      }
+      if (fds[0].revents != 0) {
+        uint64_t count;
+        while (read(wake_fd, &count, sizeof(count)) > 0) {
+        }
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 1; i < fds.size(); i++) {
+          if (fds[i].revents == 0)
+            continue;
+          auto it = pending.find(fds[i].fd);
+          if (it == pending.end())
+            continue;
+          ready.push_back(std::move(it->second));
+          pending.erase(it);
+        }
+      }
+      for (Callback &callback : ready)
+        callback();
+      ready.clear();
+    }
+  }
+};
+
+#endif // WRITE_WATCHER_HPP